@@ -0,0 +1,34 @@
+#include "common.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// 统计堆分配次数：替换全局的 operator new / delete（数组和对齐版本默认转发到这里）。
+// Linux 上库内的分配也解析到这里（ELF 符号插入）；Windows 上 DLL 有自己的分配器，只能统计到本程序内的分配。
+// 单独放在一个文件里，避免编译器内联后把 new / free 的配对误报为不匹配
+namespace {
+std::atomic<uint64_t> g_allocs{0};
+} // namespace
+
+void *operator new(size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace bench {
+uint64_t heapAllocations() {
+    return g_allocs.load(std::memory_order_relaxed);
+}
+} // namespace bench
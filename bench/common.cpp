@@ -0,0 +1,416 @@
+#include "common.hpp"
+
+#include "llaisys/profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace bench {
+namespace {
+uint64_t splitmix64(uint64_t &state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+uint16_t to_bf16(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return static_cast<uint16_t>((bits + 0x7fff + ((bits >> 16) & 1)) >> 16);
+}
+
+// 只需要处理 [-1, 1] 附近的正规数和 0
+uint16_t to_fp16(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const int exp = static_cast<int>((bits >> 23) & 0xff) - 127 + 15;
+    if (exp <= 0) {
+        return sign;
+    }
+    if (exp >= 31) {
+        return sign | 0x7bff;
+    }
+    return sign | static_cast<uint16_t>(exp << 10) | static_cast<uint16_t>((bits >> 13) & 0x3ff);
+}
+
+size_t numel(const std::vector<size_t> &shape) {
+    size_t n = 1;
+    for (auto s : shape) {
+        n *= s;
+    }
+    return n;
+}
+
+std::string shapeKey(const std::string &name, const std::vector<size_t> &shape, llaisysDataType_t dtype) {
+    std::string key = name + ":" + dtypeName(dtype);
+    for (auto s : shape) {
+        key += "," + std::to_string(s);
+    }
+    return key;
+}
+
+} // namespace
+
+bool jsonField(const std::string &line, const std::string &name, std::string &value) {
+    const std::string pat = "\"" + name + "\":";
+    auto pos = line.find(pat);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    pos += pat.size();
+    while (pos < line.size() && line[pos] == ' ') {
+        pos++;
+    }
+    if (pos < line.size() && line[pos] == '"') {
+        const auto end = line.find('"', pos + 1);
+        value = line.substr(pos + 1, end - pos - 1);
+    } else {
+        const auto end = line.find_first_of(",}", pos);
+        value = line.substr(pos, end - pos);
+    }
+    return true;
+}
+
+ModelShape parseModel(const std::string &spec) {
+    static const std::vector<ModelShape> presets = {
+        {"tiny", 64, 4, 2, 16, 128, 200, 2},
+        {"qwen2-0.5b", 896, 14, 2, 64, 4864, 151936, 24},
+        {"qwen2-1.5b", 1536, 12, 2, 128, 8960, 151936, 28},
+        {"qwen2-7b", 3584, 28, 4, 128, 18944, 152064, 28},
+    };
+    for (auto &m : presets) {
+        if (m.name == spec) {
+            return m;
+        }
+    }
+    const auto dims = parseSizes(spec);
+    if (spec.find(':') == std::string::npos || (dims.size() != 6 && dims.size() != 7)) {
+        throw std::invalid_argument("unknown model: " + spec);
+    }
+    return {spec, dims[0], dims[1], dims[2], dims[3], dims[4], dims[5], dims.size() == 7 ? dims[6] : 1};
+}
+
+llaisysDataType_t parseDtype(const std::string &name) {
+    if (name == "f32") {
+        return LLAISYS_DTYPE_F32;
+    }
+    if (name == "f16") {
+        return LLAISYS_DTYPE_F16;
+    }
+    if (name == "bf16") {
+        return LLAISYS_DTYPE_BF16;
+    }
+    throw std::invalid_argument("unknown dtype: " + name);
+}
+
+const char *dtypeName(llaisysDataType_t dtype) {
+    switch (dtype) {
+    case LLAISYS_DTYPE_F32:
+        return "f32";
+    case LLAISYS_DTYPE_F16:
+        return "f16";
+    case LLAISYS_DTYPE_BF16:
+        return "bf16";
+    case LLAISYS_DTYPE_I64:
+        return "i64";
+    default:
+        return "?";
+    }
+}
+
+std::vector<std::string> split(const std::string &s, char sep) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, sep)) {
+        if (!item.empty()) {
+            out.push_back(item);
+        }
+    }
+    return out;
+}
+
+std::vector<size_t> parseSizes(const std::string &s) {
+    std::vector<size_t> out;
+    for (auto &item : split(s, s.find(':') != std::string::npos ? ':' : ',')) {
+        out.push_back(std::stoull(item));
+    }
+    return out;
+}
+
+void fillRandom(llaisysTensor_t t, float scale, uint64_t seed) {
+    std::vector<size_t> shape(tensorGetNdim(t));
+    tensorGetShape(t, shape.data());
+    const size_t n = numel(shape);
+    const auto dtype = tensorGetDataType(t);
+    auto next = [&]() { return scale * (static_cast<float>(splitmix64(seed) >> 40) * 0x1.0p-23f - 1.0f); };
+    if (dtype == LLAISYS_DTYPE_F32) {
+        std::vector<float> v(n);
+        std::generate(v.begin(), v.end(), next);
+        tensorLoad(t, v.data());
+    } else {
+        std::vector<uint16_t> v(n);
+        for (auto &x : v) {
+            x = dtype == LLAISYS_DTYPE_BF16 ? to_bf16(next()) : to_fp16(next());
+        }
+        tensorLoad(t, v.data());
+    }
+}
+
+Args::Args(const std::vector<std::string> &args, const std::vector<std::string> &allowed) {
+    for (size_t i = 0; i < args.size(); i++) {
+        const auto &arg = args[i];
+        const std::string name = arg.rfind("--", 0) == 0 ? arg.substr(2) : "";
+        if (name.empty() || std::find(allowed.begin(), allowed.end(), name) == allowed.end()) {
+            throw std::invalid_argument("unknown argument: " + arg);
+        }
+        if (i + 1 >= args.size()) {
+            throw std::invalid_argument("missing value for " + arg);
+        }
+        _values[name] = args[++i];
+    }
+}
+
+std::string Args::get(const std::string &name, const std::string &fallback) const {
+    auto it = _values.find(name);
+    return it == _values.end() ? fallback : it->second;
+}
+
+double Args::number(const std::string &name, double fallback) const {
+    auto it = _values.find(name);
+    return it == _values.end() ? fallback : std::stod(it->second);
+}
+
+Tensor::Tensor(const std::vector<size_t> &shape, llaisysDataType_t dtype) {
+    auto dims = shape;
+    _t = tensorCreate(dims.data(), dims.size(), dtype, LLAISYS_DEVICE_CPU, 0);
+}
+
+Tensor::~Tensor() {
+    tensorDestroy(_t);
+}
+
+void Tensor::fillRandom(float scale, uint64_t seed) {
+    bench::fillRandom(_t, scale, seed);
+}
+
+void Tensor::fillIndex(int64_t high, uint64_t seed) {
+    std::vector<size_t> shape(tensorGetNdim(_t));
+    tensorGetShape(_t, shape.data());
+    std::vector<int64_t> v(numel(shape));
+    for (auto &x : v) {
+        x = static_cast<int64_t>(splitmix64(seed) % static_cast<uint64_t>(high));
+    }
+    tensorLoad(_t, v.data());
+}
+
+void Tensor::fillValues(const std::vector<int64_t> &values) {
+    tensorLoad(_t, values.data());
+}
+
+tensor_ptr Workspace::random(const std::string &name, const std::vector<size_t> &shape, llaisysDataType_t dtype,
+                             float scale) {
+    auto &t = _tensors[shapeKey(name, shape, dtype)];
+    if (!t) {
+        t = std::make_shared<Tensor>(shape, dtype);
+        t->fillRandom(scale, _seed++);
+    }
+    return t;
+}
+
+tensor_ptr Workspace::index(const std::string &name, const std::vector<size_t> &shape, int64_t high) {
+    auto &t = _tensors[shapeKey(name, shape, LLAISYS_DTYPE_I64) + "<" + std::to_string(high)];
+    if (!t) {
+        t = std::make_shared<Tensor>(shape, LLAISYS_DTYPE_I64);
+        t->fillIndex(high, _seed++);
+    }
+    return t;
+}
+
+tensor_ptr Workspace::empty(const std::string &name, const std::vector<size_t> &shape, llaisysDataType_t dtype) {
+    auto &t = _tensors[shapeKey(name, shape, dtype)];
+    if (!t) {
+        t = std::make_shared<Tensor>(shape, dtype);
+    }
+    return t;
+}
+
+double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+Stats summarize(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    Stats s;
+    s.samples = samples.size();
+    if (samples.empty()) {
+        return s;
+    }
+    s.median_us = percentile(samples, 50);
+    s.p99_us = percentile(samples, 99);
+    s.min_us = samples.front();
+    for (auto x : samples) {
+        s.mean_us += x / samples.size();
+    }
+    return s;
+}
+
+size_t peakRssBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ? pmc.PeakWorkingSetSize : 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+Stats measure(const std::function<void()> &fn, const TimingOptions &opt) {
+    using clock = std::chrono::steady_clock;
+    auto elapsed_us = [](clock::time_point a, clock::time_point b) {
+        return std::chrono::duration<double, std::micro>(b - a).count();
+    };
+    for (size_t i = 0; i < opt.warmup; i++) {
+        fn();
+    }
+    // 估计单次耗时，决定每个样本内连续调用的次数
+    auto t0 = clock::now();
+    fn();
+    const double once = std::max(elapsed_us(t0, clock::now()), 1e-3);
+    const size_t inner = std::max<size_t>(1, static_cast<size_t>(opt.min_sample_us / once));
+
+    std::vector<double> samples;
+    const auto begin = clock::now();
+    while (samples.size() < std::max<size_t>(opt.reps, 1)) {
+        t0 = clock::now();
+        for (size_t i = 0; i < inner; i++) {
+            fn();
+        }
+        const auto t1 = clock::now();
+        samples.push_back(elapsed_us(t0, t1) / inner);
+        if (samples.size() >= 3 && elapsed_us(begin, t1) > opt.max_time_s * 1e6) {
+            break;
+        }
+    }
+    return summarize(std::move(samples));
+}
+
+void opCost(const std::function<void()> &fn, uint64_t &flops, uint64_t &bytes) {
+    llaisysProfilerClear();
+    llaisysProfilerSetEnabled(1);
+    fn();
+    llaisysProfilerSetEnabled(0);
+    std::string trace(llaisysProfilerChromeTrace(nullptr, 0) + 1, '\0');
+    llaisysProfilerChromeTrace(trace.data(), trace.size());
+    llaisysProfilerClear();
+    flops = bytes = 0;
+    // 一次调用可能对应多条记录（例如多个算子组成的一个测试点），全部累加
+    for (auto &line : split(trace, '\n')) {
+        std::string v;
+        if (jsonField(line, "flops", v)) {
+            flops += std::stoull(v);
+        }
+        if (jsonField(line, "bytes", v)) {
+            bytes += std::stoull(v);
+        }
+    }
+}
+
+std::string quote(const std::string &s) {
+    return "\"" + s + "\"";
+}
+
+void writeJson(const std::string &path, const std::map<std::string, std::string> &meta,
+               const std::vector<Result> &results) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    out << "{\"meta\": {";
+    bool first = true;
+    for (auto &[k, v] : meta) {
+        out << (first ? "" : ", ") << quote(k) << ": " << v;
+        first = false;
+    }
+    out << "},\n\"results\": [\n";
+    char buf[256];
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto &r = results[i];
+        out << "{\"key\": " << quote(r.key);
+        for (auto &[k, v] : r.fields) {
+            out << ", " << quote(k) << ": " << v;
+        }
+        std::snprintf(buf, sizeof(buf),
+                      ", \"samples\": %zu, \"median_us\": %.3f, \"p99_us\": %.3f, \"mean_us\": %.3f, \"min_us\": %.3f",
+                      r.stats.samples, r.stats.median_us, r.stats.p99_us, r.stats.mean_us, r.stats.min_us);
+        out << buf;
+        const double sec = r.stats.median_us * 1e-6;
+        if ((r.flops || r.bytes) && sec > 0) {
+            std::snprintf(buf, sizeof(buf), ", \"gflops\": %.3f, \"gbps\": %.3f", r.flops / sec / 1e9,
+                          r.bytes / sec / 1e9);
+            out << buf;
+        }
+        out << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+}
+
+std::map<std::string, double> readMedians(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    std::map<std::string, double> out;
+    std::string line, key, median;
+    while (std::getline(in, line)) {
+        if (jsonField(line, "key", key) && jsonField(line, "median_us", median)) {
+            out[key] = std::stod(median);
+        }
+    }
+    return out;
+}
+
+size_t compare(const std::map<std::string, double> &baseline, const std::map<std::string, double> &current,
+               double threshold) {
+    size_t regressions = 0, common = 0;
+    std::printf("%-64s %12s %12s %9s\n", "key", "base(us)", "new(us)", "change");
+    for (auto &[key, now] : current) {
+        auto it = baseline.find(key);
+        if (it == baseline.end() || it->second <= 0) {
+            continue;
+        }
+        common++;
+        const double change = now / it->second - 1.0;
+        const bool regressed = change > threshold;
+        regressions += regressed;
+        std::printf("%-64s %12.3f %12.3f %+8.1f%%%s\n", key.c_str(), it->second, now, 100.0 * change,
+                    regressed ? "  REGRESSION" : "");
+    }
+    std::printf("%zu common points, %zu regressions above %.1f%%\n", common, regressions, 100.0 * threshold);
+    return regressions;
+}
+} // namespace bench
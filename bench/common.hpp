@@ -0,0 +1,165 @@
+#pragma once
+
+#include "llaisys/tensor.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct LlaisysQwen2Model;
+
+// llaisys-bench 的公共部分：随机张量、计时与统计、JSON 结果的读写和与基线的比较。
+// 只使用 include/ 下的公开 C API，测到的就是 Python / C 调用方实际得到的性能（不含 ctypes 开销）
+namespace bench {
+// Qwen2 的模型尺寸
+struct ModelShape {
+    std::string name;
+    size_t hs;    // hidden size
+    size_t nh;    // attention heads
+    size_t nkvh;  // KV heads
+    size_t dh;    // head dim
+    size_t di;    // MLP intermediate size
+    size_t voc;   // vocabulary size
+    size_t nlayer;
+};
+
+// 按名字查找预置的尺寸（qwen2-0.5b / qwen2-1.5b / qwen2-7b / tiny），
+// 也接受 "hs:nh:nkvh:dh:di:voc[:nlayer]" 形式的自定义尺寸
+ModelShape parseModel(const std::string &spec);
+llaisysDataType_t parseDtype(const std::string &name);
+const char *dtypeName(llaisysDataType_t dtype);
+std::vector<std::string> split(const std::string &s, char sep);
+std::vector<size_t> parseSizes(const std::string &s);
+
+// "--name value" 形式的命令行参数
+class Args {
+private:
+    std::map<std::string, std::string> _values;
+
+public:
+    // allowed 为允许的参数名（不含 "--"），遇到未知参数时抛出异常
+    Args(const std::vector<std::string> &args, const std::vector<std::string> &allowed);
+    std::string get(const std::string &name, const std::string &fallback) const;
+    double number(const std::string &name, double fallback) const;
+    bool has(const std::string &name) const { return _values.count(name) > 0; }
+};
+
+// 填充 [-scale, scale) 的均匀随机数（浮点类型的张量）
+void fillRandom(llaisysTensor_t t, float scale, uint64_t seed);
+
+// 持有一个 llaisysTensor_t，析构时销毁
+class Tensor {
+private:
+    llaisysTensor_t _t;
+
+public:
+    Tensor(const std::vector<size_t> &shape, llaisysDataType_t dtype);
+    ~Tensor();
+    Tensor(const Tensor &) = delete;
+    Tensor &operator=(const Tensor &) = delete;
+
+    llaisysTensor_t get() const { return _t; }
+    // 填充 [-scale, scale) 的均匀随机数（浮点类型）
+    void fillRandom(float scale, uint64_t seed);
+    // 填充 [0, high) 的随机整数（int64）
+    void fillIndex(int64_t high, uint64_t seed);
+    void fillValues(const std::vector<int64_t> &values);
+};
+using tensor_ptr = std::shared_ptr<Tensor>;
+
+// 按 (名字, 形状, dtype) 缓存随机张量：权重在不同 M 之间复用，避免反复分配和填充
+class Workspace {
+private:
+    std::map<std::string, tensor_ptr> _tensors;
+    uint64_t _seed = 1;
+
+public:
+    tensor_ptr random(const std::string &name, const std::vector<size_t> &shape, llaisysDataType_t dtype,
+                      float scale = 1.0f);
+    tensor_ptr index(const std::string &name, const std::vector<size_t> &shape, int64_t high);
+    tensor_ptr empty(const std::string &name, const std::vector<size_t> &shape, llaisysDataType_t dtype);
+    void clear() { _tensors.clear(); }
+};
+
+// 计时参数：先 warmup 次，再测 reps 个样本（每个样本连续调用 inner 次取平均，使样本不短于 min_sample_us），
+// 总测量时间超过 max_time_s 且已有至少 3 个样本时提前结束
+struct TimingOptions {
+    size_t warmup = 3;
+    size_t reps = 20;
+    double min_sample_us = 50.0;
+    double max_time_s = 2.0;
+};
+
+struct Stats {
+    size_t samples = 0;
+    double median_us = 0;
+    double p99_us = 0;
+    double mean_us = 0;
+    double min_us = 0;
+};
+
+// 已排序样本的 nearest-rank 百分位，p 为 [0, 100]
+double percentile(const std::vector<double> &sorted, double p);
+// 排序后计算中位数、p99、均值、最小值
+Stats summarize(std::vector<double> samples);
+// 进程的峰值常驻内存（字节）
+size_t peakRssBytes();
+
+// 每次调用的耗时统计（微秒）
+Stats measure(const std::function<void()> &fn, const TimingOptions &opt);
+
+// 一条结果；key 唯一确定一个测试点，用于与基线比较
+struct Result {
+    std::string key;
+    std::map<std::string, std::string> fields; // 原样写入 JSON 的额外字段（字符串已带引号）
+    Stats stats;
+    uint64_t flops = 0;
+    uint64_t bytes = 0;
+};
+
+// 用 profiler 取一次调用的 FLOPs 和访存字节数（与算子内的统计口径一致）
+void opCost(const std::function<void()> &fn, uint64_t &flops, uint64_t &bytes);
+
+std::string quote(const std::string &s);
+// 从本工具写出的一行 JSON 中取出 "name": 后面的值（字符串去掉引号），没有该字段时返回 false
+bool jsonField(const std::string &line, const std::string &name, std::string &value);
+// JSON：{"meta": {...}, "results": [...]}，每条结果一行
+void writeJson(const std::string &path, const std::map<std::string, std::string> &meta,
+               const std::vector<Result> &results);
+// 读 writeJson 写出的文件，返回 key -> median_us
+std::map<std::string, double> readMedians(const std::string &path);
+
+// 打印每个共同测试点的变化，中位数变慢超过 threshold（比例）的记为回退，返回回退的个数
+size_t compare(const std::map<std::string, double> &baseline, const std::map<std::string, double> &current,
+               double threshold);
+
+// 机器峰值：calibrate 子命令测得，按线程数各一组
+struct Peaks {
+    size_t threads = 0;
+    double gbps = 0;   // 内存带宽（各个 STREAM 式 kernel 中最高的）
+    double gflops = 0; // FP32 FMA 吞吐
+};
+std::vector<Peaks> readPeaks(const std::string &path);
+// 线程数最接近 threads 的一组
+Peaks peaksFor(const std::vector<Peaks> &peaks, size_t threads);
+// 算术强度 flops / bytes 下的 roofline 上限（GFLOP/s）
+double rooflineGflops(const Peaks &p, double intensity);
+
+// 进程启动以来 operator new 的调用次数（alloc_count.cpp 替换了全局的 operator new / delete）
+uint64_t heapAllocations();
+
+// 按尺寸创建随机权重的 Qwen2 模型；end_token 为 -1，每个请求都生成满 max_new_tokens 个 token
+LlaisysQwen2Model *createModel(const ModelShape &shape, llaisysDataType_t dtype, size_t maxseq);
+
+// 子命令
+int opsMain(const std::vector<std::string> &args);
+int compareMain(const std::vector<std::string> &args);
+int modelMain(const std::vector<std::string> &args);
+int calibrateMain(const std::vector<std::string> &args);
+int replayMain(const std::vector<std::string> &args);
+int tuneMain(const std::vector<std::string> &args);
+int viewsMain(const std::vector<std::string> &args);
+} // namespace bench
@@ -0,0 +1,97 @@
+#include "common.hpp"
+
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace {
+const char *USAGE = R"(usage: llaisys-bench <command> [options]
+
+commands:
+  ops       benchmark every CPU op at real model shapes
+              --models   qwen2-1.5b,qwen2-7b   presets: tiny, qwen2-0.5b, qwen2-1.5b, qwen2-7b,
+                                               or hs:nh:nkvh:dh:di:voc
+              --dtypes   f32,bf16              f32 / f16 / bf16
+              --threads  <max>                 OpenMP thread counts, e.g. 1,8,32
+              --m        1,16,128,1024,4096    tokens per call (1 = decode)
+              --ctx      1024                  KV length for decode attention
+              --ops      <all>                 only these ops, e.g. linear,self_attention
+              --warmup 3  --reps 20  --max-time 2   timing per point (seconds)
+              --json     <path>                write results as JSON
+              --baseline <path>                compare with a saved JSON; exit 1 on regressions
+              --threshold 0.1                  regression threshold on the median
+              --roofline <path>                peaks from 'calibrate': adds flop/byte and % of roofline
+              --csv      <path>                plot-ready CSV (one row per point)
+  model     end-to-end throughput / latency of a Qwen2 model with random weights
+              --model       qwen2-1.5b           same presets / custom spec as above (":nlayer" may be appended)
+              --dtype       f32
+              --threads     <max>
+              --requests    32
+              --prompt-len  uniform:128:512      N, uniform:a:b or normal:mean:std
+              --output-len  uniform:64:256
+              --concurrency 1,4,16               requests kept in flight, one run per level
+              --chunk / --prefix-cache <bytes> / --maxseq / --seed
+              --trace <path>                     record the generated load as a request trace
+              --json / --baseline / --threshold  as above (compared on the median inter-token latency)
+  replay    re-drive a request trace (llaisysQwen2ModelSetTrace / Qwen2.start_trace) with random weights
+              --trace  <path>                    required
+              --model / --dtype                  default: the shape and dtype the trace was recorded with
+              --speed  1.0                       arrival-time scale; 0 submits everything at once
+              --threads / --limit <records> / --chunk / --prefix-cache <bytes>
+              --json / --baseline / --threshold  as above (compared on the median end-to-end latency)
+  tune      autotune linear / self_attention at every shape of a model and fill the tuning cache
+              --models qwen2-1.5b  --dtypes f32,bf16  --threads <max>
+              --m      1,2,4,...,512                 tokens per call (and decode batch sizes)
+              --ctx    128,512,2048                  KV lengths for decode attention
+              --cache  <path>                        default: $LLAISYS_TUNE_CACHE or ~/.cache/llaisys/tune.cache
+  views     cost of creating a view (slice / permute / view / reshape) through the C API:
+            ns and heap allocations per view
+              --warmup 3  --reps 20  --max-time 2
+              --json / --baseline / --threshold  as above
+  calibrate measure peak memory bandwidth (STREAM-like) and FP32 FMA throughput
+              --threads <max>  --mb 256 (per array)  --reps 10  --json <path>
+  compare   <baseline.json> <current.json> [--threshold 0.1]
+)";
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::fputs(USAGE, stderr);
+        return 2;
+    }
+    const std::string command = argv[1];
+    if (command == "-h" || command == "--help") {
+        std::fputs(USAGE, stdout);
+        return 0;
+    }
+    const std::vector<std::string> args(argv + 2, argv + argc);
+    try {
+        if (command == "ops") {
+            return bench::opsMain(args);
+        }
+        if (command == "model") {
+            return bench::modelMain(args);
+        }
+        if (command == "replay") {
+            return bench::replayMain(args);
+        }
+        if (command == "tune") {
+            return bench::tuneMain(args);
+        }
+        if (command == "views") {
+            return bench::viewsMain(args);
+        }
+        if (command == "calibrate") {
+            return bench::calibrateMain(args);
+        }
+        if (command == "compare") {
+            return bench::compareMain(args);
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "llaisys-bench: %s\n", e.what());
+        return 2;
+    }
+    std::fputs(USAGE, stderr);
+    return 2;
+}
@@ -0,0 +1,258 @@
+#include "common.hpp"
+
+#include "llaisys/models/qwen2.h"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace bench {
+namespace {
+using clock = std::chrono::steady_clock;
+
+// 长度分布："N"（固定）、"uniform:a:b"、"normal:mean:std"（截断到 [1, 3 * mean]）
+class LengthDist {
+private:
+    std::string _kind;
+    double _a = 0, _b = 0;
+
+public:
+    explicit LengthDist(const std::string &spec) {
+        const auto parts = split(spec, ':');
+        if (parts.size() == 1) {
+            _kind = "fixed";
+            _a = std::stod(parts[0]);
+        } else if (parts.size() == 3 && (parts[0] == "uniform" || parts[0] == "normal")) {
+            _kind = parts[0];
+            _a = std::stod(parts[1]);
+            _b = std::stod(parts[2]);
+        } else {
+            throw std::invalid_argument("bad length distribution: " + spec);
+        }
+    }
+
+    size_t sample(std::mt19937_64 &rng) const {
+        double x = _a;
+        if (_kind == "uniform") {
+            x = std::uniform_real_distribution<double>(_a, _b + 1)(rng);
+        } else if (_kind == "normal") {
+            x = std::clamp(std::normal_distribution<double>(_a, _b)(rng), 1.0, 3.0 * _a);
+        }
+        return std::max<size_t>(1, static_cast<size_t>(x));
+    }
+};
+
+struct Request {
+    size_t prompt_len;
+    size_t output_len;
+};
+
+struct Timing {
+    size_t prompt_len;
+    clock::time_point submit;
+    clock::time_point first;
+    clock::time_point last;
+    size_t ntoken = 0;
+};
+
+double ms(clock::time_point a, clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+} // namespace
+
+LlaisysQwen2Model *createModel(const ModelShape &shape, llaisysDataType_t dtype, size_t maxseq) {
+    LlaisysQwen2Meta meta{dtype, shape.nlayer, shape.hs, shape.nh, shape.nkvh, shape.dh, shape.di,
+                          maxseq, shape.voc, 1e-6f, 1e6f, -1}; // end_token = -1：每个请求都生成满 max_new_tokens
+    auto model = llaisysQwen2ModelCreate(&meta, LLAISYS_DEVICE_CPU, nullptr, 0);
+    auto *w = llaisysQwen2ModelWeights(model);
+    uint64_t seed = 1;
+    const float scale = 0.05f;
+    fillRandom(w->in_embed, 1.0f, seed++);
+    fillRandom(w->out_embed, scale, seed++);
+    fillRandom(w->out_norm_w, 1.0f, seed++);
+    for (size_t l = 0; l < shape.nlayer; l++) {
+        for (auto *t : {w->attn_norm_w, w->mlp_norm_w}) {
+            fillRandom(t[l], 1.0f, seed++);
+        }
+        for (auto *t : {w->attn_q_w, w->attn_q_b, w->attn_k_w, w->attn_k_b, w->attn_v_w, w->attn_v_b, w->attn_o_w,
+                        w->mlp_gate_w, w->mlp_up_w, w->mlp_down_w}) {
+            fillRandom(t[l], scale, seed++);
+        }
+    }
+    return model;
+}
+
+namespace {
+// 闭环压测：始终保持 concurrency 个请求在途，一个完成就提交下一个
+Result run(LlaisysQwen2Model *model, const std::vector<Request> &requests, size_t concurrency, size_t voc,
+           uint64_t seed, const std::string &key, bool report = true) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int64_t> token(0, static_cast<int64_t>(voc) - 1);
+    std::unordered_map<int64_t, Timing> inflight;
+    std::vector<double> ttft, itl;
+    std::vector<LlaisysQwen2StepOutput> outputs(concurrency * 8 + 16);
+    double prefill_ms = 0, decode_ms = 0;
+    size_t prompt_tokens = 0, output_tokens = 0, decode_tokens = 0, next = 0;
+
+    const auto begin = clock::now();
+    while (next < requests.size() || !inflight.empty()) {
+        while (next < requests.size() && inflight.size() < concurrency) {
+            const auto &r = requests[next++];
+            std::vector<int64_t> prompt(r.prompt_len);
+            for (auto &t : prompt) {
+                t = token(rng);
+            }
+            const int64_t id = llaisysQwen2ModelAddRequest(model, prompt.data(), prompt.size(), r.output_len);
+            inflight[id] = {r.prompt_len, clock::now(), {}, {}, 0};
+        }
+        const size_t n = llaisysQwen2ModelStep(model, outputs.data(), outputs.size());
+        const auto now = clock::now();
+        for (size_t i = 0; i < n; i++) {
+            auto it = inflight.find(outputs[i].request_id);
+            if (it == inflight.end()) {
+                continue;
+            }
+            auto &t = it->second;
+            if (t.ntoken == 0) {
+                t.first = now;
+                ttft.push_back(ms(t.submit, now));
+                prefill_ms += ms(t.submit, now);
+                prompt_tokens += t.prompt_len;
+            } else {
+                itl.push_back(ms(t.last, now));
+            }
+            t.last = now;
+            t.ntoken++;
+            output_tokens++;
+            if (outputs[i].finished) {
+                decode_ms += ms(t.first, t.last);
+                decode_tokens += t.ntoken - 1;
+                inflight.erase(it);
+            }
+        }
+    }
+    const double wall_s = ms(begin, clock::now()) / 1e3;
+
+    std::sort(ttft.begin(), ttft.end());
+    std::sort(itl.begin(), itl.end());
+    const double prefill_tps = prefill_ms > 0 ? prompt_tokens / (prefill_ms / 1e3) : 0;
+    const double decode_tps = decode_ms > 0 ? decode_tokens / (decode_ms / 1e3) : 0;
+    const double output_tps = output_tokens / wall_s;
+    if (report) {
+        std::printf("%5zu %6zu %9.2f %12.1f %12.1f %12.1f %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n", concurrency,
+                    requests.size(), wall_s, prefill_tps, decode_tps, output_tps, percentile(ttft, 50),
+                    percentile(ttft, 90), percentile(ttft, 99), percentile(itl, 50), percentile(itl, 90),
+                    percentile(itl, 99));
+        std::fflush(stdout);
+    }
+
+    // 与基线比较时看 ITL 的中位数
+    Result r;
+    r.key = key;
+    for (auto &x : itl) {
+        x *= 1e3;
+    }
+    r.stats = summarize(itl);
+    char buf[32];
+    auto num = [&](double x) {
+        std::snprintf(buf, sizeof(buf), "%.3f", x);
+        return std::string(buf);
+    };
+    r.fields = {{"concurrency", std::to_string(concurrency)},
+                {"requests", std::to_string(requests.size())},
+                {"wall_s", num(wall_s)},
+                {"prompt_tokens", std::to_string(prompt_tokens)},
+                {"output_tokens", std::to_string(output_tokens)},
+                {"prefill_tok_s", num(prefill_tps)},
+                {"decode_tok_s", num(decode_tps)},
+                {"output_tok_s", num(output_tps)},
+                {"ttft_p50_ms", num(percentile(ttft, 50))},
+                {"ttft_p90_ms", num(percentile(ttft, 90))},
+                {"ttft_p99_ms", num(percentile(ttft, 99))},
+                {"itl_p50_ms", num(percentile(itl, 50) / 1e3)},
+                {"itl_p90_ms", num(percentile(itl, 90) / 1e3)},
+                {"itl_p99_ms", num(percentile(itl, 99) / 1e3)}};
+    return r;
+}
+} // namespace
+
+// 端到端吞吐 / 延迟：按 meta 用随机权重构建模型（不需要下载 HF 权重），按给定的长度分布生成请求，
+// 对每个并发度做一次闭环压测。
+// prefill tok/s = prompt token 总数 / TTFT 之和，decode tok/s = 首 token 之后的 token 数 / 各请求 decode 时间之和
+// （二者都是单个请求看到的速度），output tok/s 为整体吞吐
+int modelMain(const std::vector<std::string> &args) {
+    const Args a(args, {"model", "dtype", "threads", "requests", "prompt-len", "output-len", "concurrency", "chunk",
+                        "prefix-cache", "maxseq", "seed", "trace", "json", "baseline", "threshold"});
+    const auto shape = parseModel(a.get("model", "qwen2-1.5b"));
+    const auto dtype = parseDtype(a.get("dtype", "f32"));
+    if (a.has("threads")) {
+        omp_set_num_threads(static_cast<int>(a.number("threads", 1)));
+    }
+    const size_t nreq = static_cast<size_t>(a.number("requests", 32));
+    const LengthDist prompt_dist(a.get("prompt-len", "uniform:128:512"));
+    const LengthDist output_dist(a.get("output-len", "uniform:64:256"));
+    const auto levels = parseSizes(a.get("concurrency", "1,4,16"));
+    const uint64_t seed = static_cast<uint64_t>(a.number("seed", 0));
+
+    std::mt19937_64 rng(seed);
+    std::vector<Request> requests(nreq);
+    size_t longest = 0;
+    for (auto &r : requests) {
+        r.prompt_len = prompt_dist.sample(rng);
+        r.output_len = output_dist.sample(rng);
+        longest = std::max(longest, r.prompt_len + r.output_len);
+    }
+    const size_t maxseq = static_cast<size_t>(a.number("maxseq", static_cast<double>(longest)));
+    if (maxseq < longest) {
+        throw std::invalid_argument("--maxseq is shorter than the longest request (" + std::to_string(longest) + ")");
+    }
+
+    std::printf("model %s (nlayer %zu, hs %zu, voc %zu) dtype %s, %d threads, %zu requests\n", shape.name.c_str(),
+                shape.nlayer, shape.hs, shape.voc, dtypeName(dtype), omp_get_max_threads(), nreq);
+    auto *model = createModel(shape, dtype, maxseq);
+    if (a.has("chunk")) {
+        llaisysQwen2ModelSetChunkSize(model, static_cast<size_t>(a.number("chunk", 0)));
+    }
+    if (a.has("prefix-cache")) {
+        llaisysQwen2ModelSetPrefixCache(model, 16, static_cast<size_t>(a.number("prefix-cache", 0)));
+    }
+    // 预热：一个短请求
+    run(model, {{std::min<size_t>(16, maxseq - 1), 1}}, 1, shape.voc, seed + 1000, "warmup", false);
+    if (a.has("trace")) {
+        llaisysQwen2ModelSetTrace(model, a.get("trace", "").c_str(), LLAISYS_QWEN2_TRACE_ANONYMOUS);
+    }
+    std::printf("\n%5s %6s %9s %12s %12s %12s %9s %9s %9s %9s %9s %9s\n", "conc", "reqs", "wall(s)", "prefill t/s",
+                "decode t/s", "output t/s", "ttft p50", "ttft p90", "ttft p99", "itl p50", "itl p90", "itl p99");
+    std::vector<Result> results;
+    for (size_t i = 0; i < levels.size(); i++) {
+        // 每个并发度用不同的 prompt 内容，避免命中上一轮留在前缀缓存里的块
+        const std::string key = "e2e|" + shape.name + "|" + dtypeName(dtype) + "|c" + std::to_string(levels[i]);
+        results.push_back(run(model, requests, std::max<size_t>(1, levels[i]), shape.voc, seed + i + 1, key));
+        results.back().fields["model"] = quote(shape.name);
+        results.back().fields["dtype"] = quote(dtypeName(dtype));
+    }
+    llaisysQwen2ModelDestroy(model);
+    const size_t rss = peakRssBytes();
+    std::printf("(ttft / itl in ms)\npeak RSS %.1f MiB\n", rss / 1048576.0);
+
+    if (a.has("json")) {
+        writeJson(a.get("json", ""), {{"suite", quote("model")}, {"peak_rss_bytes", std::to_string(rss)},
+                                      {"threads", std::to_string(omp_get_max_threads())}},
+                  results);
+    }
+    if (a.has("baseline")) {
+        std::map<std::string, double> current;
+        for (auto &r : results) {
+            current[r.key] = r.stats.median_us;
+        }
+        std::printf("\n");
+        return compare(readMedians(a.get("baseline", "")), current, a.number("threshold", 0.1)) ? 1 : 0;
+    }
+    return 0;
+}
+} // namespace bench
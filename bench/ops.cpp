@@ -0,0 +1,358 @@
+#include "common.hpp"
+
+#include "llaisys/autotune.h"
+#include "llaisys/ops.h"
+#include "llaisys/tensor.h"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+namespace bench {
+namespace {
+// 只在 decode 场景出现的算子（sample / 多序列 decode attention）只测 M 不超过这个值的点
+constexpr size_t DECODE_MAX_BATCH = 64;
+constexpr size_t PAGE_SIZE = 16;
+
+struct Case {
+    std::string op;    // 算子名（--ops 按这个过滤）
+    std::string name;  // 测试点名，同一算子的不同形状用后缀区分，如 linear.gate
+    std::string shape; // 人读的形状描述
+    std::function<void()> fn;
+};
+
+std::string dims(std::initializer_list<size_t> d) {
+    std::string s;
+    for (auto x : d) {
+        s += (s.empty() ? "" : "x") + std::to_string(x);
+    }
+    return s;
+}
+
+// 一个模型在 M 个 token 下的全部测试点；M = 1 时 attention 按 decode（KV 长度为 ctx）计算，否则按 prefill（causal，KV 长度为 M）。
+// 权重放在 wts 中跨 M 复用，激活放在 ws 中，测完这个 M 即释放
+std::vector<Case> makeCases(Workspace &wts, Workspace &ws, const ModelShape &m, llaisysDataType_t dt, size_t M,
+                            size_t ctx) {
+    std::vector<Case> cases;
+    const size_t qd = m.nh * m.dh, kvd = m.nkvh * m.dh;
+    const float w_scale = 0.05f;
+
+    auto linear = [&](const std::string &name, size_t n, size_t k, bool bias) {
+        auto out = ws.empty("act_" + name, {M, n}, dt);
+        auto in = ws.random("in", {M, k}, dt);
+        auto w = wts.random("w_" + name, {n, k}, dt, w_scale);
+        auto b = bias ? wts.random("b_" + name, {n}, dt, w_scale) : nullptr;
+        cases.push_back({"linear", "linear." + name, dims({M, k}) + "*" + dims({n, k}) + "^T", [=] {
+                             llaisysLinear(out->get(), in->get(), w->get(), b ? b->get() : nullptr);
+                         }});
+    };
+
+    {
+        auto out = ws.empty("hidden", {M, m.hs}, dt);
+        auto idx = ws.index("tokens", {M}, static_cast<int64_t>(m.voc));
+        auto w = wts.random("embed", {m.voc, m.hs}, dt);
+        cases.push_back({"embedding", "embedding", dims({M}) + " of " + dims({m.voc, m.hs}),
+                         [=] { llaisysEmbedding(out->get(), idx->get(), w->get()); }});
+    }
+    {
+        auto out = ws.empty("normed", {M, m.hs}, dt);
+        auto in = ws.random("in", {M, m.hs}, dt);
+        auto w = wts.random("norm_w", {m.hs}, dt);
+        cases.push_back({"rms_norm", "rms_norm", dims({M, m.hs}),
+                         [=] { llaisysRmsNorm(out->get(), in->get(), w->get(), 1e-6f); }});
+    }
+    linear("q", qd, m.hs, true);
+    linear("kv", kvd, m.hs, true);
+    {
+        auto out = ws.empty("q_rope", {M, m.nh, m.dh}, dt);
+        auto in = ws.random("q", {M, m.nh, m.dh}, dt);
+        auto pos = ws.index("pos", {M}, static_cast<int64_t>(ctx + M));
+        cases.push_back({"rope", "rope", dims({M, m.nh, m.dh}),
+                         [=] { llaisysROPE(out->get(), in->get(), pos->get(), 1e6f); }});
+    }
+    {
+        const size_t kvlen = M == 1 ? ctx : M;
+        auto out = ws.empty("attn", {M, m.nh, m.dh}, dt);
+        auto q = ws.random("q", {M, m.nh, m.dh}, dt);
+        auto k = ws.random("k", {kvlen, m.nkvh, m.dh}, dt);
+        auto v = ws.random("v", {kvlen, m.nkvh, m.dh}, dt);
+        const float scale = 1.0f / std::sqrt(static_cast<float>(m.dh));
+        cases.push_back({"self_attention", "self_attention", dims({M, m.nh, m.dh}) + " kv " + dims({kvlen, m.nkvh}),
+                         [=] { llaisysSelfAttention(out->get(), q->get(), k->get(), v->get(), scale); }});
+    }
+    if (M <= DECODE_MAX_BATCH) {
+        // M 条序列各 decode 一个 token，每条 KV 长度为 ctx
+        auto out = ws.empty("attn", {M, m.nh, m.dh}, dt);
+        auto q = ws.random("q", {M, m.nh, m.dh}, dt);
+        auto k = ws.random("k", {M * ctx, m.nkvh, m.dh}, dt);
+        auto v = ws.random("v", {M * ctx, m.nkvh, m.dh}, dt);
+        auto cu_q = ws.empty("cu_q", {M + 1}, LLAISYS_DTYPE_I64);
+        auto cu_k = ws.empty("cu_k", {M + 1}, LLAISYS_DTYPE_I64);
+        std::vector<int64_t> vq(M + 1), vk(M + 1);
+        for (size_t s = 0; s <= M; s++) {
+            vq[s] = static_cast<int64_t>(s);
+            vk[s] = static_cast<int64_t>(s * ctx);
+        }
+        cu_q->fillValues(vq);
+        cu_k->fillValues(vk);
+        const float scale = 1.0f / std::sqrt(static_cast<float>(m.dh));
+        cases.push_back({"self_attention_varlen", "self_attention_varlen.decode",
+                         dims({M}) + " seqs kv " + dims({ctx, m.nkvh, m.dh}), [=] {
+                             llaisysSelfAttentionVarlen(out->get(), q->get(), k->get(), v->get(), cu_q->get(),
+                                                        cu_k->get(), scale);
+                         }});
+    }
+    {
+        // 把 KV Cache 末尾 M 行所在的页重新汇总
+        const size_t len = std::max(ctx, M);
+        const size_t npages = (len + PAGE_SIZE - 1) / PAGE_SIZE;
+        auto k = ws.random("k", {len, m.nkvh, m.dh}, dt);
+        auto pmin = ws.empty("page_min", {npages, m.nkvh, m.dh}, LLAISYS_DTYPE_F32);
+        auto pmax = ws.empty("page_max", {npages, m.nkvh, m.dh}, LLAISYS_DTYPE_F32);
+        const size_t begin = len - M;
+        cases.push_back({"kv_page_summary", "kv_page_summary", dims({len, m.nkvh, m.dh}) + " from " + std::to_string(begin),
+                         [=] { llaisysKVPageSummary(pmin->get(), pmax->get(), k->get(), PAGE_SIZE, begin); }});
+    }
+    {
+        // KV Cache 转成按头排列的 [nkvh, len, dh]：dst 为它的 permute(1, 0, 2) 视图
+        const size_t len = std::max(ctx, M);
+        auto k = ws.random("k", {len, m.nkvh, m.dh}, dt);
+        auto out = ws.empty("k_head_major", {m.nkvh, len, m.dh}, dt);
+        size_t perm[3] = {1, 0, 2};
+        std::shared_ptr<LlaisysTensor> dst(tensorPermute(out->get(), perm), tensorDestroy);
+        cases.push_back({"rearrange", "rearrange.kv_head_major", dims({len, m.nkvh, m.dh}) + " -> " + dims({m.nkvh, len, m.dh}),
+                         [=] { llaisysRearrange(dst.get(), k->get()); }});
+    }
+    linear("o", m.hs, qd, false);
+    {
+        auto out = ws.empty("hidden", {M, m.hs}, dt);
+        auto a = ws.random("in", {M, m.hs}, dt);
+        auto b = ws.random("residual", {M, m.hs}, dt);
+        cases.push_back({"add", "add", dims({M, m.hs}), [=] { llaisysAdd(out->get(), a->get(), b->get()); }});
+    }
+    linear("gate", m.di, m.hs, false);
+    {
+        auto out = ws.empty("act", {M, m.di}, dt);
+        auto gate = ws.random("gate", {M, m.di}, dt);
+        auto up = ws.random("up", {M, m.di}, dt);
+        cases.push_back({"swiglu", "swiglu", dims({M, m.di}),
+                         [=] { llaisysSwiGLU(out->get(), gate->get(), up->get()); }});
+    }
+    linear("down", m.hs, m.di, false);
+    // 不融合的输出层（linear + argmax）作为 lm_head_topk 的对照，两者共用同一份权重
+    linear("lm_head", m.voc, m.hs, false);
+    {
+        auto idx = ws.empty("top_idx", {M, 1}, LLAISYS_DTYPE_I64);
+        auto val = ws.empty("top_val", {M, 1}, dt);
+        auto in = ws.random("in", {M, m.hs}, dt);
+        auto norm = wts.random("norm_w", {m.hs}, dt);
+        auto w = wts.random("w_lm_head", {m.voc, m.hs}, dt, w_scale);
+        cases.push_back({"lm_head_topk", "lm_head_topk", dims({M, m.hs}) + "*" + dims({m.voc, m.hs}) + "^T", [=] {
+                             llaisysLMHeadTopK(idx->get(), val->get(), in->get(), norm->get(), w->get(), 1e-6f);
+                         }});
+        auto lp = ws.empty("logprob", {M}, LLAISYS_DTYPE_F32);
+        auto targets = ws.index("targets", {M}, static_cast<int64_t>(m.voc));
+        cases.push_back({"lm_head_logprob", "lm_head_logprob", dims({M, m.hs}) + "*" + dims({m.voc, m.hs}) + "^T", [=] {
+                             llaisysLMHeadLogprob(lp->get(), in->get(), norm->get(), w->get(), targets->get(), 1e-6f);
+                         }});
+    }
+    if (M == 1) {
+        auto idx = ws.empty("max_idx", {1}, LLAISYS_DTYPE_I64);
+        auto val = ws.empty("max_val", {1}, dt);
+        auto logits = ws.random("logits", {m.voc}, dt);
+        cases.push_back({"argmax", "argmax", dims({m.voc}),
+                         [=] { llaisysArgmax(idx->get(), val->get(), logits->get()); }});
+    }
+    if (M <= DECODE_MAX_BATCH) {
+        auto idx = ws.empty("sampled", {M}, LLAISYS_DTYPE_I64);
+        auto logits = ws.random("logits", {M, m.voc}, dt, 8.0f);
+        cases.push_back({"sample", "sample", dims({M, m.voc}) + " T=0.8 k=50 p=0.9",
+                         [=] { llaisysSample(idx->get(), logits->get(), 0.8f, 50, 0.9f, 0); }});
+    }
+    return cases;
+}
+} // namespace
+
+int opsMain(const std::vector<std::string> &args) {
+    const Args a(args, {"models", "dtypes", "threads", "m", "ctx", "ops", "warmup", "reps", "max-time", "json",
+                        "baseline", "threshold", "roofline", "csv"});
+    std::vector<ModelShape> models;
+    for (auto &name : split(a.get("models", "qwen2-1.5b,qwen2-7b"), ',')) {
+        models.push_back(parseModel(name));
+    }
+    std::vector<llaisysDataType_t> dtypes;
+    for (auto &name : split(a.get("dtypes", "f32,bf16"), ',')) {
+        dtypes.push_back(parseDtype(name));
+    }
+    auto threads = parseSizes(a.get("threads", std::to_string(omp_get_max_threads())));
+    const auto ms = parseSizes(a.get("m", "1,16,128,1024,4096"));
+    const size_t ctx = static_cast<size_t>(a.number("ctx", 1024));
+    const auto only = split(a.get("ops", ""), ',');
+    TimingOptions timing;
+    timing.warmup = static_cast<size_t>(a.number("warmup", timing.warmup));
+    timing.reps = static_cast<size_t>(a.number("reps", timing.reps));
+    timing.max_time_s = a.number("max-time", timing.max_time_s);
+    // 有 calibrate 测得的峰值时，额外给出算术强度和达到 roofline 的百分比
+    const auto peaks = a.has("roofline") ? readPeaks(a.get("roofline", "")) : std::vector<Peaks>{};
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> csv(nullptr, std::fclose);
+    if (a.has("csv")) {
+        csv.reset(std::fopen(a.get("csv", "").c_str(), "w"));
+        if (!csv) {
+            throw std::runtime_error("cannot open " + a.get("csv", ""));
+        }
+        std::fprintf(csv.get(), "case,op,model,dtype,threads,m,median_us,p99_us,gflops,gbps,intensity,"
+                                "roofline_gflops,roofline_pct,bound\n");
+    }
+
+    std::vector<Result> results;
+    std::printf("%-30s %-11s %-5s %4s %6s %12s %12s %10s %9s %8s %7s  %s\n", "case", "model", "dtype", "thr", "M",
+                "median(us)", "p99(us)", "GFLOP/s", "GB/s", "flop/B", "%roof", "shape");
+    for (auto &model : models) {
+        for (auto dt : dtypes) {
+            Workspace weights; // 权重在同一模型、dtype 的不同 M 之间复用
+            for (auto M : ms) {
+                Workspace acts;
+                for (auto &c : makeCases(weights, acts, model, dt, M, ctx)) {
+                    if (!only.empty() && std::find(only.begin(), only.end(), c.op) == only.end()) {
+                        continue;
+                    }
+                    for (auto nt : threads) {
+                        omp_set_num_threads(static_cast<int>(nt));
+                        Result r;
+                        r.key = c.name + "|" + model.name + "|" + dtypeName(dt) + "|t" + std::to_string(nt) + "|m"
+                              + std::to_string(M);
+                        r.fields = {{"op", quote(c.op)}, {"case", quote(c.name)}, {"model", quote(model.name)},
+                                    {"dtype", quote(dtypeName(dt))}, {"threads", std::to_string(nt)},
+                                    {"m", std::to_string(M)}, {"shape", quote(c.shape)}};
+                        opCost(c.fn, r.flops, r.bytes);
+                        r.stats = measure(c.fn, timing);
+                        const double sec = r.stats.median_us * 1e-6;
+                        const double gflops = r.flops / sec / 1e9, gbps = r.bytes / sec / 1e9;
+                        const double intensity = r.bytes ? static_cast<double>(r.flops) / r.bytes : 0.0;
+                        double bound = 0, pct = 0;
+                        std::string limit;
+                        if (!peaks.empty() && r.flops > 0) {
+                            const auto p = peaksFor(peaks, nt);
+                            bound = rooflineGflops(p, intensity);
+                            pct = 100.0 * gflops / bound;
+                            limit = intensity * p.gbps < p.gflops ? "memory" : "compute";
+                        } else if (!peaks.empty() && r.bytes > 0) {
+                            // 没有计算量的算子（embedding）按带宽算
+                            const auto p = peaksFor(peaks, nt);
+                            pct = 100.0 * gbps / p.gbps;
+                            limit = "memory";
+                        }
+                        char pct_str[16] = "-";
+                        if (!limit.empty()) {
+                            std::snprintf(pct_str, sizeof(pct_str), "%.1f", pct);
+                            r.fields["roofline_pct"] = pct_str;
+                            r.fields["bound"] = quote(limit);
+                        }
+                        r.fields["intensity"] = std::to_string(intensity);
+                        std::printf("%-30s %-11s %-5s %4zu %6zu %12.2f %12.2f %10.2f %9.2f %8.2f %7s  %s\n",
+                                    c.name.c_str(), model.name.c_str(), dtypeName(dt), nt, M, r.stats.median_us,
+                                    r.stats.p99_us, gflops, gbps, intensity, pct_str, c.shape.c_str());
+                        std::fflush(stdout);
+                        if (csv) {
+                            std::fprintf(csv.get(), "%s,%s,%s,%s,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.4f,%.3f,%s,%s\n",
+                                         c.name.c_str(), c.op.c_str(), model.name.c_str(), dtypeName(dt), nt, M,
+                                         r.stats.median_us, r.stats.p99_us, gflops, gbps, intensity, bound,
+                                         limit.empty() ? "" : pct_str, limit.c_str());
+                        }
+                        results.push_back(std::move(r));
+                    }
+                }
+            }
+        }
+    }
+    omp_set_num_threads(static_cast<int>(threads.empty() ? 1 : threads.back()));
+
+    if (a.has("json")) {
+        writeJson(a.get("json", ""), {{"suite", quote("ops")}, {"ctx", std::to_string(ctx)},
+                                      {"max_threads", std::to_string(omp_get_num_procs())}},
+                  results);
+    }
+    if (a.has("baseline")) {
+        std::map<std::string, double> current;
+        for (auto &r : results) {
+            current[r.key] = r.stats.median_us;
+        }
+        std::printf("\n");
+        return compare(readMedians(a.get("baseline", "")), current, a.number("threshold", 0.1)) ? 1 : 0;
+    }
+    return 0;
+}
+
+// 离线调优：在模型的全部形状上调用一次被调优的算子（linear、self_attention），结果写入调优缓存。
+// linear 与 K/V 长度无关，只在第一个 ctx 下调用；attention 的 key 含 K/V 长度的分桶，每个 ctx 都调用
+int tuneMain(const std::vector<std::string> &args) {
+    const Args a(args, {"models", "dtypes", "threads", "m", "ctx", "cache"});
+    std::vector<ModelShape> models;
+    for (auto &name : split(a.get("models", "qwen2-1.5b"), ',')) {
+        models.push_back(parseModel(name));
+    }
+    std::vector<llaisysDataType_t> dtypes;
+    for (auto &name : split(a.get("dtypes", "f32,bf16"), ',')) {
+        dtypes.push_back(parseDtype(name));
+    }
+    auto threads = parseSizes(a.get("threads", std::to_string(omp_get_max_threads())));
+    const auto ms = parseSizes(a.get("m", "1,2,4,8,16,32,64,128,256,512"));
+    const auto ctxs = parseSizes(a.get("ctx", "128,512,2048"));
+    if (a.has("cache")) {
+        llaisysAutotuneSetCachePath(a.get("cache", "").c_str());
+    }
+    llaisysAutotuneSetMode(LLAISYS_AUTOTUNE_ON);
+    auto entries = [] {
+        std::string s(llaisysAutotuneEntries(nullptr, 0), '\0');
+        llaisysAutotuneEntries(s.data(), s.size() + 1);
+        return s;
+    };
+    const auto before = split(entries(), '\n').size();
+
+    for (auto &model : models) {
+        for (auto dt : dtypes) {
+            Workspace weights;
+            for (auto M : ms) {
+                for (size_t ci = 0; ci < ctxs.size(); ci++) {
+                    Workspace acts;
+                    for (auto &c : makeCases(weights, acts, model, dt, M, ctxs[ci])) {
+                        const bool tuned = (c.op == "linear" && ci == 0)
+                                        || (c.op == "self_attention" && (M == 1 || ci == 0))
+                                        || c.op == "self_attention_varlen";
+                        if (!tuned) {
+                            continue;
+                        }
+                        for (auto nt : threads) {
+                            omp_set_num_threads(static_cast<int>(nt));
+                            c.fn();
+                        }
+                    }
+                }
+                std::printf("tuned %s %s m=%zu\n", model.name.c_str(), dtypeName(dt), M);
+                std::fflush(stdout);
+            }
+        }
+    }
+    omp_set_num_threads(static_cast<int>(threads.empty() ? 1 : threads.back()));
+
+    const auto all = entries();
+    std::string path(llaisysAutotuneCachePath(nullptr, 0), '\0');
+    llaisysAutotuneCachePath(path.data(), path.size() + 1);
+    std::printf("\n%s", all.c_str());
+    std::printf("\n%zu new entries, %zu in total for this CPU, cache: %s\n", split(all, '\n').size() - before,
+                split(all, '\n').size(), path.empty() ? "(memory only)" : path.c_str());
+    return 0;
+}
+
+int compareMain(const std::vector<std::string> &args) {
+    if (args.size() < 2) {
+        throw std::invalid_argument("usage: llaisys-bench compare <baseline.json> <current.json> [--threshold 0.1]");
+    }
+    const Args a(std::vector<std::string>(args.begin() + 2, args.end()), {"threshold"});
+    return compare(readMedians(args[0]), readMedians(args[1]), a.number("threshold", 0.1)) ? 1 : 0;
+}
+} // namespace bench
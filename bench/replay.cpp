@@ -0,0 +1,240 @@
+#include "common.hpp"
+
+#include "llaisys/models/qwen2.h"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace bench {
+namespace {
+using clock = std::chrono::steady_clock;
+
+struct TraceDeleter {
+    void operator()(LlaisysQwen2Trace *t) const { llaisysQwen2TraceDestroy(t); }
+};
+
+struct Inflight {
+    size_t index;
+    clock::time_point arrival; // 按 trace 应该到达的时间（回放跟不上时早于实际提交的时间）
+    clock::time_point last;
+    std::vector<int64_t> outputs;
+};
+
+double ms(clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+std::string baseName(const std::string &path) {
+    const auto slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+void printLatency(const char *name, std::vector<double> replay, std::vector<double> recorded) {
+    if (replay.empty()) {
+        return;
+    }
+    std::sort(replay.begin(), replay.end());
+    std::sort(recorded.begin(), recorded.end());
+    std::printf("%-14s p50 %9.2f  p90 %9.2f  p99 %9.2f ms", name, percentile(replay, 50), percentile(replay, 90),
+                percentile(replay, 99));
+    if (!recorded.empty()) {
+        std::printf("   (recorded p50 %9.2f  p99 %9.2f)", percentile(recorded, 50), percentile(recorded, 99));
+    }
+    std::printf("\n");
+}
+} // namespace
+
+// 回放 llaisysQwen2ModelSetTrace 录下的负载：按记录的到达时间（乘以 1 / speed）提交请求，
+// 请求级记录通过 AddRequest / Step 执行（输出长度取实际生成的长度），infer 记录同步调用。
+// 模型默认使用 trace 记录的尺寸和 dtype、随机权重；prompt 由 trace 生成，共享前缀与原始负载一致
+int replayMain(const std::vector<std::string> &args) {
+    const Args a(args, {"trace", "model", "dtype", "threads", "speed", "limit", "chunk", "prefix-cache", "json",
+                        "baseline", "threshold"});
+    if (!a.has("trace")) {
+        throw std::invalid_argument("replay requires --trace <path>");
+    }
+    const auto path = a.get("trace", "");
+    std::unique_ptr<LlaisysQwen2Trace, TraceDeleter> trace(llaisysQwen2TraceLoad(path.c_str()));
+    LlaisysQwen2Meta meta;
+    llaisysQwen2TraceMeta(trace.get(), &meta);
+    const auto shape = a.has("model") ? parseModel(a.get("model", ""))
+                                      : ModelShape{"trace", meta.hs, meta.nh, meta.nkvh, meta.dh, meta.di, meta.voc,
+                                                   meta.nlayer};
+    const auto dtype = a.has("dtype") ? parseDtype(a.get("dtype", "")) : meta.dtype;
+    if (a.has("threads")) {
+        omp_set_num_threads(static_cast<int>(a.number("threads", 1)));
+    }
+    // speed 为回放速度的倍数，0 表示忽略到达间隔，一开始就提交全部请求
+    const double speed = a.number("speed", 1.0);
+    const size_t n = std::min(llaisysQwen2TraceNumRequests(trace.get()),
+                              static_cast<size_t>(a.number("limit", 1e18)));
+
+    std::vector<LlaisysQwen2TraceRequest> requests(n);
+    size_t longest = 1;
+    for (size_t i = 0; i < n; i++) {
+        llaisysQwen2TraceGetRequest(trace.get(), i, &requests[i]);
+        auto &r = requests[i];
+        // 录制时已经结束的请求按实际生成的长度回放，end_token 为 -1 的随机权重模型会生成满这么多
+        if (r.kind == LLAISYS_QWEN2_TRACE_REQUEST && r.finish_ns > 0) {
+            r.max_new_tokens = r.generated;
+        }
+        longest = std::max(longest, r.prompt_len + std::max<size_t>(r.max_new_tokens, 1) + 1);
+    }
+
+    std::printf("trace %s: %zu records, %s, recorded on %zu layers / hs %zu / voc %zu\n", path.c_str(), n,
+                llaisysQwen2TraceContent(trace.get()) == LLAISYS_QWEN2_TRACE_TOKENS ? "tokens" : "anonymous",
+                meta.nlayer, meta.hs, meta.voc);
+    std::printf("model %s (nlayer %zu, hs %zu, voc %zu) dtype %s, %d threads, speed %.2fx\n", shape.name.c_str(),
+                shape.nlayer, shape.hs, shape.voc, dtypeName(dtype), omp_get_max_threads(), speed);
+    auto *model = createModel(shape, dtype, longest);
+    if (a.has("chunk")) {
+        llaisysQwen2ModelSetChunkSize(model, static_cast<size_t>(a.number("chunk", 0)));
+    }
+    if (a.has("prefix-cache")) {
+        llaisysQwen2ModelSetPrefixCache(model, 16, static_cast<size_t>(a.number("prefix-cache", 0)));
+    }
+
+    std::unordered_map<int64_t, Inflight> inflight;
+    std::vector<LlaisysQwen2StepOutput> outputs(4096);
+    std::vector<int64_t> prompt(longest);
+    std::vector<double> ttft, itl, e2e, infer_ms, rec_e2e, rec_infer;
+    size_t prompt_tokens = 0, output_tokens = 0, late = 0, next = 0;
+
+    const auto start = clock::now();
+    auto due = [&](size_t i) {
+        return start + std::chrono::nanoseconds(speed > 0 ? static_cast<int64_t>(requests[i].arrival_ns / speed) : 0);
+    };
+    while (next < n || !inflight.empty()) {
+        while (next < n && due(next) <= clock::now()) {
+            const auto &r = requests[next];
+            const auto arrival = due(next);
+            if (clock::now() - arrival > std::chrono::milliseconds(1)) {
+                late++;
+            }
+            llaisysQwen2TracePrompt(trace.get(), next, shape.voc, prompt.data());
+            prompt_tokens += r.prompt_len;
+            if (r.kind == LLAISYS_QWEN2_TRACE_INFER) {
+                const auto t0 = clock::now();
+                int64_t token = r.temperature > 0
+                                  ? llaisysQwen2ModelInferSample(model, prompt.data(), r.prompt_len, r.temperature,
+                                                                 r.top_k, r.top_p)
+                                  : llaisysQwen2ModelInfer(model, prompt.data(), r.prompt_len);
+                infer_ms.push_back(ms(clock::now() - t0));
+                rec_infer.push_back((r.finish_ns - r.arrival_ns) / 1e6);
+                llaisysQwen2TraceSetOutput(trace.get(), next, &token, 1);
+                output_tokens++;
+            } else if (r.max_new_tokens > 0) {
+                const int64_t id = r.lookup_tokens > 0
+                                     ? llaisysQwen2ModelAddLookupRequest(model, prompt.data(), r.prompt_len,
+                                                                         r.max_new_tokens, r.lookup_tokens,
+                                                                         r.lookup_ngram)
+                                     : llaisysQwen2ModelAddRequest(model, prompt.data(), r.prompt_len,
+                                                                   r.max_new_tokens);
+                inflight[id] = {next, arrival, arrival, {}};
+                if (r.finish_ns > 0) {
+                    rec_e2e.push_back((r.finish_ns - r.arrival_ns) / 1e6);
+                }
+            }
+            next++;
+        }
+        if (inflight.empty()) {
+            if (next < n) {
+                std::this_thread::sleep_until(due(next));
+            }
+            continue;
+        }
+        const size_t m = llaisysQwen2ModelStep(model, outputs.data(), outputs.size());
+        const auto now = clock::now();
+        for (size_t i = 0; i < m; i++) {
+            auto it = inflight.find(outputs[i].request_id);
+            if (it == inflight.end()) {
+                continue;
+            }
+            auto &f = it->second;
+            (f.outputs.empty() ? ttft : itl).push_back(ms(now - (f.outputs.empty() ? f.arrival : f.last)));
+            f.last = now;
+            f.outputs.push_back(outputs[i].token);
+            output_tokens++;
+            if (outputs[i].finished) {
+                e2e.push_back(ms(now - f.arrival));
+                // 之后共享这条请求输出的 prompt 与 KV Cache 中的内容一致
+                llaisysQwen2TraceSetOutput(trace.get(), f.index, f.outputs.data(), f.outputs.size());
+                inflight.erase(it);
+            }
+        }
+    }
+    const double wall_s = ms(clock::now() - start) / 1e3;
+
+    LlaisysQwen2PrefixCacheStats pc;
+    llaisysQwen2ModelPrefixCacheStats(model, &pc);
+    LlaisysQwen2SpeculativeStats spec;
+    llaisysQwen2ModelSpeculativeStats(model, &spec);
+    llaisysQwen2ModelDestroy(model);
+
+    const double hit_rate = pc.query_tokens ? 100.0 * pc.hit_tokens / pc.query_tokens : 0.0;
+    std::printf("\nwall %.2f s, %zu prompt tokens, %zu output tokens, %zu of %zu records submitted late (> 1 ms)\n",
+                wall_s, prompt_tokens, output_tokens, late, n);
+    std::printf("throughput     %.1f output tok/s, %.1f total tok/s, %.2f req/s\n", output_tokens / wall_s,
+                (prompt_tokens + output_tokens) / wall_s, n / wall_s);
+    printLatency("ttft", ttft, {});
+    printLatency("itl", itl, {});
+    printLatency("e2e", e2e, rec_e2e);
+    printLatency("infer", infer_ms, rec_infer);
+    std::printf("prefix cache   %.1f%% of prompt tokens hit (%zu / %zu), %zu / %zu lookups hit, %zu evicted blocks\n",
+                hit_rate, pc.hit_tokens, pc.query_tokens, pc.hits, pc.lookups, pc.evicted_blocks);
+    if (spec.proposed > 0) {
+        std::printf("prompt lookup  %.1f%% of %zu proposals accepted\n", 100.0 * spec.accepted / spec.proposed,
+                    spec.proposed);
+    }
+    std::printf("peak RSS %.1f MiB\n", peakRssBytes() / 1048576.0);
+
+    // 与基线比较时看请求的端到端延迟（只有 infer 记录时看 infer 延迟）
+    Result r;
+    r.key = "replay|" + baseName(path) + "|" + shape.name + "|" + dtypeName(dtype);
+    std::vector<double> latency_us;
+    for (double x : e2e.empty() ? infer_ms : e2e) {
+        latency_us.push_back(x * 1e3);
+    }
+    r.stats = summarize(latency_us);
+    char buf[32];
+    auto num = [&](double x) {
+        std::snprintf(buf, sizeof(buf), "%.3f", x);
+        return std::string(buf);
+    };
+    std::sort(ttft.begin(), ttft.end());
+    std::sort(itl.begin(), itl.end());
+    r.fields = {{"records", std::to_string(n)},
+                {"wall_s", num(wall_s)},
+                {"prompt_tokens", std::to_string(prompt_tokens)},
+                {"output_tokens", std::to_string(output_tokens)},
+                {"output_tok_s", num(output_tokens / wall_s)},
+                {"ttft_p50_ms", num(percentile(ttft, 50))},
+                {"ttft_p99_ms", num(percentile(ttft, 99))},
+                {"itl_p50_ms", num(percentile(itl, 50))},
+                {"itl_p99_ms", num(percentile(itl, 99))},
+                {"prefix_hit_rate", num(hit_rate / 100)},
+                {"late_records", std::to_string(late)},
+                {"model", quote(shape.name)},
+                {"dtype", quote(dtypeName(dtype))}};
+    if (a.has("json")) {
+        writeJson(a.get("json", ""), {{"suite", quote("replay")}, {"trace", quote(baseName(path))},
+                                      {"speed", num(speed)}, {"threads", std::to_string(omp_get_max_threads())},
+                                      {"peak_rss_bytes", std::to_string(peakRssBytes())}},
+                  {r});
+    }
+    if (a.has("baseline")) {
+        std::printf("\n");
+        return compare(readMedians(a.get("baseline", "")), {{r.key, r.stats.median_us}}, a.number("threshold", 0.1))
+                 ? 1
+                 : 0;
+    }
+    return 0;
+}
+} // namespace bench
@@ -0,0 +1,215 @@
+#include "common.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+namespace bench {
+namespace {
+// FMA kernel 每个线程的独立累加器个数：足够多的依赖链才能填满 FMA 单元的流水线
+constexpr size_t FMA_LANES = 64;
+constexpr size_t FMA_ITERS = 1 << 16;
+constexpr size_t READ_LANES = 32;
+
+// 编译 llaisys-bench（以及库本身，二者使用相同的编译选项）时启用的指令集
+const char *isaName() {
+#if defined(__AVX512F__)
+    return "avx512f";
+#elif defined(__AVX2__) && defined(__FMA__)
+    return "avx2+fma";
+#elif defined(__AVX2__)
+    return "avx2";
+#elif defined(__AVX__)
+    return "avx";
+#elif defined(__SSE2__) || defined(_M_X64)
+    return "sse2";
+#elif defined(__ARM_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+template <typename F>
+double bestSeconds(size_t reps, F &&fn) {
+    double best = 1e30;
+    for (size_t r = 0; r < reps; r++) {
+        const auto t0 = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    }
+    return best;
+}
+
+// STREAM 式带宽：copy、triad，再加一个只读的 sum（decode 时的 GEMV 基本就是只读地流过权重）。
+// 每个 kernel 取 reps 次中最快的一次
+struct Bandwidth {
+    double copy = 0, triad = 0, read = 0;
+};
+
+Bandwidth measureBandwidth(size_t n, size_t reps) {
+    std::unique_ptr<float[]> a(new float[n]), b(new float[n]), c(new float[n]);
+    const auto len = static_cast<std::ptrdiff_t>(n);
+    // 各线程按 static 调度首次写入，页面落在对应线程的 NUMA 节点上
+#pragma omp parallel for schedule(static)
+    for (std::ptrdiff_t i = 0; i < len; i++) {
+        a[i] = 1.0f;
+        b[i] = 2.0f;
+        c[i] = 0.0f;
+    }
+    const double bytes = static_cast<double>(n) * sizeof(float);
+    Bandwidth bw;
+    bw.copy = 2 * bytes / bestSeconds(reps, [&] {
+#pragma omp parallel for schedule(static)
+        for (std::ptrdiff_t i = 0; i < len; i++) {
+            c[i] = a[i];
+        }
+    }) / 1e9;
+    const float s = 3.0f;
+    bw.triad = 3 * bytes / bestSeconds(reps, [&] {
+#pragma omp parallel for schedule(static)
+        for (std::ptrdiff_t i = 0; i < len; i++) {
+            a[i] = b[i] + s * c[i];
+        }
+    }) / 1e9;
+    // 只读 kernel 用 READ_LANES 个部分和，避免单条加法依赖链成为瓶颈
+    volatile float sink = 0;
+    bw.read = bytes / bestSeconds(reps, [&] {
+        float sum = 0;
+        const std::ptrdiff_t blocks = len / static_cast<std::ptrdiff_t>(READ_LANES);
+#pragma omp parallel reduction(+ : sum)
+        {
+            float part[READ_LANES] = {};
+#pragma omp for schedule(static)
+            for (std::ptrdiff_t blk = 0; blk < blocks; blk++) {
+                const float *p = b.get() + blk * static_cast<std::ptrdiff_t>(READ_LANES);
+#pragma omp simd
+                for (size_t j = 0; j < READ_LANES; j++) {
+                    part[j] += p[j];
+                }
+            }
+            for (size_t j = 0; j < READ_LANES; j++) {
+                sum += part[j];
+            }
+        }
+        sink = sum;
+    }) / 1e9;
+    (void)sink;
+    return bw;
+}
+
+// FP32 FMA 峰值：每个线程 FMA_LANES 条独立的 acc = acc * x + y 依赖链，数据都在寄存器里
+double measureFma(size_t reps) {
+    volatile float sink = 0;
+    const double seconds = bestSeconds(reps, [&] {
+        float total = 0;
+#pragma omp parallel reduction(+ : total)
+        {
+            float acc[FMA_LANES];
+            for (size_t j = 0; j < FMA_LANES; j++) {
+                acc[j] = static_cast<float>(j) * 1e-3f;
+            }
+            const float x = 0.999f, y = 1e-4f;
+            for (size_t it = 0; it < FMA_ITERS; it++) {
+#pragma omp simd
+                for (size_t j = 0; j < FMA_LANES; j++) {
+                    acc[j] = acc[j] * x + y;
+                }
+            }
+            for (size_t j = 0; j < FMA_LANES; j++) {
+                total += acc[j];
+            }
+        }
+        sink = total;
+    });
+    (void)sink;
+    int nthreads = 1;
+#pragma omp parallel
+    {
+#pragma omp single
+        nthreads = omp_get_num_threads();
+    }
+    return 2.0 * FMA_LANES * FMA_ITERS * nthreads / seconds / 1e9;
+}
+} // namespace
+
+std::vector<Peaks> readPeaks(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    std::vector<Peaks> out;
+    std::string line, threads, gbps, gflops;
+    while (std::getline(in, line)) {
+        if (jsonField(line, "threads", threads) && jsonField(line, "peak_gbps", gbps)
+            && jsonField(line, "peak_gflops", gflops)) {
+            out.push_back({std::stoull(threads), std::stod(gbps), std::stod(gflops)});
+        }
+    }
+    if (out.empty()) {
+        throw std::runtime_error("no peaks in " + path + " (write it with llaisys-bench calibrate)");
+    }
+    return out;
+}
+
+Peaks peaksFor(const std::vector<Peaks> &peaks, size_t threads) {
+    auto dist = [threads](const Peaks &p) { return p.threads > threads ? p.threads - threads : threads - p.threads; };
+    return *std::min_element(peaks.begin(), peaks.end(),
+                             [&](const Peaks &a, const Peaks &b) { return dist(a) < dist(b); });
+}
+
+double rooflineGflops(const Peaks &p, double intensity) {
+    return std::min(p.gflops, intensity * p.gbps);
+}
+
+// bf16 / f16 算子内部转换成 f32 计算，所以所有 dtype 共用 FP32 的计算峰值；
+// 带宽与 dtype 无关，低精度只是让同样的 FLOPs 对应更少的字节（更高的算术强度）
+int calibrateMain(const std::vector<std::string> &args) {
+    const Args a(args, {"threads", "mb", "reps", "json"});
+    const auto threads = parseSizes(a.get("threads", std::to_string(omp_get_max_threads())));
+    // 每个数组的大小，应远大于最后一级缓存
+    const size_t n = static_cast<size_t>(a.number("mb", 256)) * (1 << 20) / sizeof(float);
+    const size_t reps = static_cast<size_t>(a.number("reps", 10));
+
+    std::printf("isa %s, %d logical cpus, 3 x %zu MiB arrays\n", isaName(), omp_get_num_procs(),
+                n * sizeof(float) >> 20);
+    std::printf("%7s %11s %11s %11s %11s %13s\n", "threads", "copy GB/s", "triad GB/s", "read GB/s", "peak GB/s",
+                "fp32 GFLOP/s");
+    std::vector<std::string> lines;
+    char buf[256];
+    for (auto nt : threads) {
+        omp_set_num_threads(static_cast<int>(nt));
+        const auto bw = measureBandwidth(n, reps);
+        const double peak_bw = std::max({bw.copy, bw.triad, bw.read});
+        const double fma = measureFma(reps);
+        std::printf("%7zu %11.2f %11.2f %11.2f %11.2f %13.2f\n", nt, bw.copy, bw.triad, bw.read, peak_bw, fma);
+        std::fflush(stdout);
+        std::snprintf(buf, sizeof(buf),
+                      "{\"threads\": %zu, \"copy_gbps\": %.3f, \"triad_gbps\": %.3f, \"read_gbps\": %.3f, "
+                      "\"peak_gbps\": %.3f, \"peak_gflops\": %.3f}",
+                      nt, bw.copy, bw.triad, bw.read, peak_bw, fma);
+        lines.push_back(buf);
+    }
+    omp_set_num_threads(static_cast<int>(threads.empty() ? 1 : threads.back()));
+
+    if (a.has("json")) {
+        const auto path = a.get("json", "");
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        out << "{\"meta\": {\"suite\": \"calibrate\", \"isa\": " << quote(isaName())
+            << ", \"compute_dtype\": \"f32\", \"array_bytes\": " << n * sizeof(float) << "},\n\"peaks\": [\n";
+        for (size_t i = 0; i < lines.size(); i++) {
+            out << lines[i] << (i + 1 < lines.size() ? ",\n" : "\n");
+        }
+        out << "]}\n";
+    }
+    return 0;
+}
+} // namespace bench
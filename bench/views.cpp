@@ -0,0 +1,96 @@
+#include "common.hpp"
+
+#include "llaisys/tensor.h"
+
+#include <cstdio>
+
+namespace bench {
+namespace {
+struct ViewCase {
+    std::string name;
+    std::string shape;
+    std::function<llaisysTensor_t()> make; // 创建一个视图，调用者负责销毁
+};
+
+// 每个样本连续创建并销毁这么多个视图，计时按单个视图折算
+constexpr size_t BATCH = 1000;
+} // namespace
+
+// 视图创建的开销：slice / permute / view / reshape（不复制数据）经 C API 创建再销毁一个视图的耗时和堆分配次数。
+// 7 维的 permute 超过内联存放的维数，用来对比元数据退回堆上的情况
+int viewsMain(const std::vector<std::string> &args) {
+    const Args a(args, {"warmup", "reps", "max-time", "json", "baseline", "threshold"});
+    TimingOptions opt;
+    opt.warmup = static_cast<size_t>(a.number("warmup", 3));
+    opt.reps = static_cast<size_t>(a.number("reps", 20));
+    opt.max_time_s = a.number("max-time", 2);
+
+    Tensor t4({8, 16, 32, 64}, LLAISYS_DTYPE_F32);
+    Tensor t7({2, 3, 4, 5, 6, 7, 8}, LLAISYS_DTYPE_F32);
+    std::vector<ViewCase> cases = {
+        {"slice", "8x16x32x64[:, 4:12]", [&] { return tensorSlice(t4.get(), 1, 4, 12); }},
+        {"permute", "8x16x32x64 (0,2,1,3)",
+         [&] {
+             size_t order[] = {0, 2, 1, 3};
+             return tensorPermute(t4.get(), order);
+         }},
+        {"view", "8x16x32x64 -> 128x2048",
+         [&] {
+             size_t shape[] = {128, 2048};
+             return tensorView(t4.get(), shape, 2);
+         }},
+        {"reshape", "8x16x32x64 -> 8x16x2048",
+         [&] {
+             size_t shape[] = {8, 16, 2048};
+             return tensorReshape(t4.get(), shape, 3);
+         }},
+        {"permute.7d", "2x3x4x5x6x7x8 reversed",
+         [&] {
+             size_t order[] = {6, 5, 4, 3, 2, 1, 0};
+             return tensorPermute(t7.get(), order);
+         }},
+    };
+
+    std::printf("%-12s %10s %10s %13s  %s\n", "view", "ns/view", "p99 ns", "allocs/view", "shape");
+    std::vector<Result> results;
+    for (auto &c : cases) {
+        auto batch = [&] {
+            for (size_t i = 0; i < BATCH; i++) {
+                tensorDestroy(c.make());
+            }
+        };
+        const uint64_t before = heapAllocations();
+        batch();
+        const double allocs = static_cast<double>(heapAllocations() - before) / BATCH;
+
+        Result r;
+        r.key = "views." + c.name;
+        r.stats = measure(batch, opt);
+        // 换算成每个视图的耗时
+        for (double *v : {&r.stats.median_us, &r.stats.p99_us, &r.stats.mean_us, &r.stats.min_us}) {
+            *v /= BATCH;
+        }
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.2f", allocs);
+        r.fields["allocs_per_view"] = buf;
+        r.fields["shape"] = quote(c.shape);
+        std::printf("%-12s %10.1f %10.1f %13.2f  %s\n", c.name.c_str(), r.stats.median_us * 1e3,
+                    r.stats.p99_us * 1e3, allocs, c.shape.c_str());
+        std::fflush(stdout);
+        results.push_back(std::move(r));
+    }
+
+    if (a.has("json")) {
+        writeJson(a.get("json", ""), {{"suite", quote("views")}, {"batch", std::to_string(BATCH)}}, results);
+    }
+    if (a.has("baseline")) {
+        std::map<std::string, double> current;
+        for (auto &r : results) {
+            current[r.key] = r.stats.median_us;
+        }
+        std::printf("\n");
+        return compare(readMedians(a.get("baseline", "")), current, a.number("threshold", 0.1)) ? 1 : 0;
+    }
+    return 0;
+}
+} // namespace bench
@@ -54,6 +54,8 @@ typedef enum {
 // Runtime Types
 // Stream
 typedef void *llaisysStream_t;
+// Event：记录在 stream 上的一个时间点，用于跨 stream 的依赖
+typedef void *llaisysEvent_t;
 
 // Memory Copy Directions
 typedef enum {
@@ -0,0 +1,27 @@
+#ifndef LLAISYS_AUTOTUNE_H
+#define LLAISYS_AUTOTUNE_H
+
+#include "../llaisys.h"
+
+// 算子自动调优：linear、self_attention 第一次遇到某个 (形状, dtype, 线程数, CPU 型号) 时
+// 对候选的分块 / 线程划分方式计时，把最快的写入缓存文件，之后的调用和进程直接复用。调优不改变数值结果
+typedef enum {
+    LLAISYS_AUTOTUNE_OFF = 0,    // 总是使用默认配置
+    LLAISYS_AUTOTUNE_CACHED = 1, // 只读缓存，未命中时使用默认配置
+    LLAISYS_AUTOTUNE_ON = 2,     // 未命中时调优并写入缓存（默认，也可用环境变量 LLAISYS_AUTOTUNE=off/cached/on 设置）
+} llaisysAutotuneMode_t;
+
+__C {
+    __export void llaisysAutotuneSetMode(llaisysAutotuneMode_t mode);
+    __export llaisysAutotuneMode_t llaisysAutotuneMode();
+    // 缓存文件，默认 $LLAISYS_TUNE_CACHE 或 ~/.cache/llaisys/tune.cache；NULL 或空字符串表示只保存在内存中
+    __export void llaisysAutotuneSetCachePath(const char *path);
+    // 以下函数把结果写入 buf（最多 capacity 字节，含结尾的 '\0'），返回完整结果的长度（不含 '\0'）
+    __export size_t llaisysAutotuneCachePath(char *buf, size_t capacity);
+    // 当前 CPU 型号下已有的结果，每行 "key<TAB>配置<TAB>微秒"
+    __export size_t llaisysAutotuneEntries(char *buf, size_t capacity);
+    // 丢弃内存中的结果，下次使用时重新读取缓存文件
+    __export void llaisysAutotuneClear();
+}
+
+#endif // LLAISYS_AUTOTUNE_H
@@ -29,7 +29,61 @@ __C {
         llaisysTensor_t *mlp_down_w;
     };
 
+    // 前缀缓存统计：hit_tokens / query_tokens 即 token 级命中率
+    struct LlaisysQwen2PrefixCacheStats {
+        size_t lookups, hits;
+        size_t query_tokens, hit_tokens;
+        size_t cached_blocks, cached_bytes, evicted_blocks;
+        size_t offloaded_blocks, offloaded_bytes, paged_in_blocks;
+    };
+
+    // llaisysQwen2ModelStep 的输出：某个请求本步生成的 token
+    struct LlaisysQwen2StepOutput {
+        int64_t request_id;
+        int64_t token;
+        uint8_t finished;
+    };
+
+    // 投机解码统计：accepted / proposed 即接受率，generated / steps 即每次 target 前向产出的 token 数
+    struct LlaisysQwen2SpeculativeStats {
+        size_t steps;
+        size_t proposed, accepted;
+        size_t generated;
+    };
+
+    // llaisysQwen2ModelLogits 计算 logits 的位置
+    typedef enum {
+        LLAISYS_QWEN2_LOGITS_LAST = 0, // 只有最后一个 token
+        LLAISYS_QWEN2_LOGITS_ALL = 1,  // 所有 token
+    } llaisysQwen2LogitPositions_t;
+
+    // 请求 trace 记录的内容
+    typedef enum {
+        LLAISYS_QWEN2_TRACE_ANONYMOUS = 0, // 长度、到达 / 结束时间、生成参数，以及与此前哪条记录共享多长的前缀，不含 token
+        LLAISYS_QWEN2_TRACE_TOKENS = 1,    // 另外保存 prompt 和输出的 token id
+    } llaisysQwen2TraceContent_t;
+
+    typedef enum {
+        LLAISYS_QWEN2_TRACE_REQUEST = 0, // llaisysQwen2ModelAddRequest / AddLookupRequest 提交的请求
+        LLAISYS_QWEN2_TRACE_INFER = 1,   // llaisysQwen2ModelInfer / InferSample 的一次调用（生成一个 token）
+    } llaisysQwen2TraceKind_t;
+
+    // trace 中的一条记录，时间相对 trace 开始，单位 ns
+    struct LlaisysQwen2TraceRequest {
+        llaisysQwen2TraceKind_t kind;
+        int64_t request_id; // infer 为 -1
+        uint64_t arrival_ns, finish_ns; // 请求没有结束时 finish_ns 为 0
+        size_t prompt_len;
+        size_t shared_prefix; // 与此前某条记录（prompt + 输出）相同的前缀长度
+        size_t max_new_tokens, generated;
+        size_t lookup_tokens, lookup_ngram;
+        float temperature;
+        int64_t top_k;
+        float top_p;
+    };
+
     struct LlaisysQwen2Model;
+    struct LlaisysQwen2Trace;
 
     __export struct LlaisysQwen2Model *llaisysQwen2ModelCreate(const LlaisysQwen2Meta *meta, llaisysDeviceType_t device, int *device_ids, int ndevice);
 
@@ -37,6 +91,91 @@ __C {
 
     __export struct LlaisysQwen2Weights *llaisysQwen2ModelWeights(struct LlaisysQwen2Model * model);
 
+    // token_ids 为完整上下文；与上一次调用（或前缀缓存）相同的前缀不会重新计算
     __export int64_t llaisysQwen2ModelInfer(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken);
+
+    // 对完整上下文做前向，返回 positions 指定位置的 logits（新建的 [n, voc] 张量，由调用者 tensorDestroy）。
+    // final norm 和 LM head 只对这些位置计算
+    __export llaisysTensor_t llaisysQwen2ModelLogits(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, llaisysQwen2LogitPositions_t positions);
+
+    // 批量打分：第 i 个请求为 token_ids 中接下来的 ntokens[i] 个 token，其中前 prompt_lens[i] 个是 prompt。
+    // 所有请求拼成 ragged prefill 计算，把每个 continuation token 的 log 概率按顺序写入 logprobs
+    // （共 sum(ntokens[i] - prompt_lens[i]) 个），返回写入个数。不保留 KV Cache
+    __export size_t llaisysQwen2ModelScore(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t * ntokens, size_t * prompt_lens, size_t nrequest, float * logprobs);
+
+    // 同 llaisysQwen2ModelInfer，但按 temperature -> top_k -> top_p 采样（随机数见 llaisysQwen2ModelSetSeed）；
+    // top_k <= 0 表示不限制，top_p >= 1 表示不截断，temperature <= 0 或 top_k == 1 时等价于 argmax
+    __export int64_t llaisysQwen2ModelInferSample(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, float temperature, int64_t top_k, float top_p);
+
+    // 每步最多计算的 token 数（prefill 按此分块，并与其它请求的 decode 拼在同一步），0 表示不分块
+    __export void llaisysQwen2ModelSetChunkSize(struct LlaisysQwen2Model * model, size_t token_budget);
+
+    // 提交一个生成请求，返回请求 id
+    __export int64_t llaisysQwen2ModelAddRequest(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, size_t max_new_tokens);
+
+    // 同 llaisysQwen2ModelAddRequest，并为该请求开启 prompt lookup 投机：decode 时每步用 n-gram（最长 max_ngram）
+    // 匹配上下文提出至多 num_lookup_tokens 个候选，一次前向验证；贪心结果不变，每步可能输出多个 token
+    __export int64_t llaisysQwen2ModelAddLookupRequest(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, size_t max_new_tokens, size_t num_lookup_tokens, size_t max_ngram);
+
+    // 执行一步调度，把本步生成的 token 写入 outputs（最多 capacity 个），返回写入个数；
+    // finished 的请求在下一步被释放
+    __export size_t llaisysQwen2ModelStep(struct LlaisysQwen2Model * model, struct LlaisysQwen2StepOutput * outputs, size_t capacity);
+
+    // 尚未释放的请求数
+    __export size_t llaisysQwen2ModelNumRequests(struct LlaisysQwen2Model * model);
+
+    // 流式模式（StreamingLLM）：KV Cache 只保留前 sink 个 token 和最近 window 个 token，对话长度不受 maxseq 限制。
+    // window 为 0 时关闭；只能在没有进行中的请求时调用
+    __export void llaisysQwen2ModelSetStreaming(struct LlaisysQwen2Model * model, size_t sink, size_t window);
+
+    // 稀疏 attention（Quest）：decode 时每个 query 只读点积上界最高的 top_pages 页（每页 page_size 个位置）
+    // 和最近 recent 个位置，prefill 仍为稠密。page_size 为 0 时关闭；不能与流式模式同时使用
+    __export void llaisysQwen2ModelSetSparseAttention(struct LlaisysQwen2Model * model, size_t page_size, size_t top_pages, size_t recent);
+
+    // budget_bytes 为 0 时关闭前缀缓存；重新设置会清空已缓存的块和统计
+    __export void llaisysQwen2ModelSetPrefixCache(struct LlaisysQwen2Model * model, size_t block_size, size_t budget_bytes);
+
+    // 前缀缓存的冷存储：超出前缀缓存预算的块换出到 dir 下的内存映射文件（dir 为 NULL 或空串时为主机内存），
+    // 最多 budget_bytes 字节，命中时再换入。budget_bytes 为 0 时关闭；会清空前缀缓存
+    __export void llaisysQwen2ModelSetKVOffload(struct LlaisysQwen2Model * model, const char * dir, size_t budget_bytes);
+
+    // 默认序列的 KV 快照：保存 token 历史和全部 K/V 到 path（带版本号，校验模型 meta 和 hash）
+    __export void llaisysQwen2ModelSaveCache(struct LlaisysQwen2Model * model, const char * path);
+    // 映射快照并恢复到默认序列，返回 token 数；out_tokens 中写入至多 capacity 个 token 的历史
+    __export size_t llaisysQwen2ModelLoadCache(struct LlaisysQwen2Model * model, const char * path, int64_t * out_tokens, size_t capacity);
+
+    __export void llaisysQwen2ModelPrefixCacheStats(struct LlaisysQwen2Model * model, struct LlaisysQwen2PrefixCacheStats * stats);
+
+    // 投机解码一步：draft 提出 num_draft_tokens 个候选，model 一次前向验证。
+    // token_ids 为完整上下文，out_tokens 至少能容纳 num_draft_tokens + 1 个 token，返回写入个数；
+    // temperature <= 0 时为贪心，结果与逐个调用 llaisysQwen2ModelInfer 相同
+    __export size_t llaisysQwen2ModelSpeculativeStep(struct LlaisysQwen2Model * model, struct LlaisysQwen2Model * draft, int64_t * token_ids, size_t ntoken, size_t num_draft_tokens, float temperature, int64_t * out_tokens);
+
+    // 无 draft 模型的投机解码一步：用 prompt lookup 提出至多 num_lookup_tokens 个候选，其余同 llaisysQwen2ModelSpeculativeStep
+    __export size_t llaisysQwen2ModelLookupStep(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, size_t num_lookup_tokens, size_t max_ngram, float temperature, int64_t * out_tokens);
+
+    __export void llaisysQwen2ModelSpeculativeStats(struct LlaisysQwen2Model * model, struct LlaisysQwen2SpeculativeStats * stats);
+
+    // 采样用随机数种子
+    __export void llaisysQwen2ModelSetSeed(struct LlaisysQwen2Model * model, uint64_t seed);
+
+    // 把之后的请求（AddRequest / AddLookupRequest 以及每次 Infer / InferSample 调用）记录到 path（覆盖已有文件），
+    // path 为 NULL 或空串时停止记录
+    __export void llaisysQwen2ModelSetTrace(struct LlaisysQwen2Model * model, const char * path, llaisysQwen2TraceContent_t content);
+
+    // 读取 trace 用于回放
+    __export struct LlaisysQwen2Trace *llaisysQwen2TraceLoad(const char * path);
+    __export void llaisysQwen2TraceDestroy(struct LlaisysQwen2Trace * trace);
+    // 记录 trace 的模型的 meta
+    __export void llaisysQwen2TraceMeta(struct LlaisysQwen2Trace * trace, LlaisysQwen2Meta * meta);
+    __export llaisysQwen2TraceContent_t llaisysQwen2TraceContent(struct LlaisysQwen2Trace * trace);
+    __export size_t llaisysQwen2TraceNumRequests(struct LlaisysQwen2Trace * trace);
+    __export void llaisysQwen2TraceGetRequest(struct LlaisysQwen2Trace * trace, size_t index, struct LlaisysQwen2TraceRequest * request);
+    // 第 index 条记录回放用的 prompt（token 在 [0, voc) 内），out 至少能容纳 prompt_len 个 token，返回 prompt_len。
+    // 共享前缀与被共享的记录（prompt + 输出）一致；匿名模式下其余位置为确定的伪随机 token。
+    // 按记录顺序获取，前面的记录已经回放完时用 llaisysQwen2TraceSetOutput 告诉 trace 它实际的输出，
+    // 共享其输出的后续 prompt 才会与 KV Cache 中的内容一致
+    __export size_t llaisysQwen2TracePrompt(struct LlaisysQwen2Trace * trace, size_t index, size_t voc, int64_t * out);
+    __export void llaisysQwen2TraceSetOutput(struct LlaisysQwen2Trace * trace, size_t index, const int64_t * tokens, size_t ntoken);
 }
 #endif // LLAISYS_MODELS_QWEN2_H
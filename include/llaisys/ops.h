@@ -6,13 +6,29 @@
 __C {
     __export void llaisysAdd(llaisysTensor_t c, llaisysTensor_t a, llaisysTensor_t b);
     __export void llaisysArgmax(llaisysTensor_t max_idx, llaisysTensor_t max_val, llaisysTensor_t vals);
+    __export void llaisysCast(llaisysTensor_t out, llaisysTensor_t in);
     __export void llaisysEmbedding(llaisysTensor_t out, llaisysTensor_t index, llaisysTensor_t weight);
+    __export void llaisysKVPageSummary(llaisysTensor_t page_min, llaisysTensor_t page_max, llaisysTensor_t k, size_t page_size, size_t begin);
     __export void llaisysLinear(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t weight, llaisysTensor_t bias);
+    __export void llaisysLMHeadLogprob(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t norm_w, llaisysTensor_t weight, llaisysTensor_t targets, float eps);
+    __export void llaisysLMHeadTopK(llaisysTensor_t out_idx, llaisysTensor_t out_val, llaisysTensor_t in, llaisysTensor_t norm_w, llaisysTensor_t weight, float eps);
     __export void llaisysRearrange(llaisysTensor_t out, llaisysTensor_t in);
     __export void llaisysRmsNorm(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t weight, float eps);
     __export void llaisysROPE(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t pos_ids, float theta);
+    __export void llaisysSample(llaisysTensor_t out_idx, llaisysTensor_t logits, float temperature, int64_t top_k, float top_p, uint64_t seed);
+    __export void llaisysScale(llaisysTensor_t out, llaisysTensor_t in, float alpha);
     __export void llaisysSelfAttention(llaisysTensor_t attn_val, llaisysTensor_t q, llaisysTensor_t k, llaisysTensor_t v, float scale);
+    __export void llaisysSelfAttentionVarlen(llaisysTensor_t attn_val, llaisysTensor_t q, llaisysTensor_t k, llaisysTensor_t v, llaisysTensor_t cu_seqlens_q, llaisysTensor_t cu_seqlens_k, float scale);
     __export void llaisysSwiGLU(llaisysTensor_t out, llaisysTensor_t gate, llaisysTensor_t up);
+
+    // 延迟的逐元素运算（当前线程）：Begin 之后 Add / SwiGLU / Scale / Cast 只记录不执行，
+    // 在 Sync、最外层的 End、其他算子或读写张量数据（tensorGetData / tensorLoad / tensorDebug）之前一起执行，
+    // 相邻的、形状相同的运算融合成一次遍历。Begin / End 可以嵌套
+    __export void llaisysLazyBegin();
+    __export void llaisysLazyEnd();
+    __export void llaisysLazySync();
+    // 已缓存的融合程序个数（按表达式签名缓存）
+    __export size_t llaisysLazyCachedKernels();
 }
 
 #endif
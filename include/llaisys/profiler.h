@@ -0,0 +1,33 @@
+#ifndef LLAISYS_PROFILER_H
+#define LLAISYS_PROFILER_H
+
+#include "../llaisys.h"
+
+// 算子级 profiler：开启后每次算子调用记录耗时、形状、dtype、FLOPs 和访存字节数
+__C {
+    __export void llaisysProfilerSetEnabled(uint8_t enabled);
+    __export uint8_t llaisysProfilerEnabled();
+    // 丢弃已有的记录
+    __export void llaisysProfilerClear();
+    // 以下两个函数把结果写入 buf（最多 capacity 字节，含结尾的 '\0'），返回完整结果的长度（不含 '\0'）；
+    // 返回值 >= capacity 时说明被截断，可以按返回值重新分配后再调用
+    // Chrome trace JSON（chrome://tracing / Perfetto）
+    __export size_t llaisysProfilerChromeTrace(char *buf, size_t capacity);
+    // 按算子汇总的文本表格
+    __export size_t llaisysProfilerSummary(char *buf, size_t capacity);
+    __export void llaisysProfilerSaveChromeTrace(const char *path);
+    // 机器的 FP32 峰值（GFLOP/s）和内存带宽峰值（GB/s），设置后汇总表格加上算术强度和 % of roofline；
+    // 两者都为 0 时关闭
+    __export void llaisysProfilerSetRoofline(double peak_gflops, double peak_gbps);
+
+    // 硬件计数器（perf_event_open）：开启后 profiler 的每条记录附带 cycles、instructions、LLC / dTLB miss、
+    // 缺页、task clock 和内存控制器流量中可用的部分。返回是否至少有一个计数器可用，内核不允许时返回 0 且不影响计时
+    __export uint8_t llaisysProfilerSetCountersEnabled(uint8_t enabled);
+    __export uint8_t llaisysProfilerCountersEnabled();
+    // 每个计数器是否可用及原因（文本）
+    __export size_t llaisysProfilerCountersStatus(char *buf, size_t capacity);
+    // 按 (算子, 形状, dtype) 汇总的计数器，JSON 数组
+    __export size_t llaisysProfilerCounters(char *buf, size_t capacity);
+}
+
+#endif // LLAISYS_PROFILER_H
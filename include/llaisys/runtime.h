@@ -25,6 +25,14 @@ __C {
     // Memory copy
     typedef void (*memcpy_sync_api)(void *, const void *, size_t, llaisysMemcpyKind_t);//同步内存拷贝函数
     typedef void (*memcpy_async_api)(void *, const void *, size_t, llaisysMemcpyKind_t, llaisysStream_t);//异步内存拷贝函数
+    // Host function：把一个主机函数排进 stream，前面的任务完成后才执行（用来把算子等任意工作放进 stream）
+    typedef void (*launch_host_func_api)(llaisysStream_t, void (*)(void *), void *);
+    // Event
+    typedef llaisysEvent_t (*create_event_api)();
+    typedef void (*destroy_event_api)(llaisysEvent_t);
+    typedef void (*event_record_api)(llaisysEvent_t, llaisysStream_t);//在 stream 当前位置记录 event
+    typedef void (*stream_wait_event_api)(llaisysStream_t, llaisysEvent_t);//stream 之后的任务等 event 完成再执行，不阻塞主机
+    typedef void (*event_synchronize_api)(llaisysEvent_t);//主机等待 event 完成
 
     /*
     当框架启动时，它会检测你有哪种 GPU。如果是 NVIDIA，它就把这个结构体里的 malloc_device 赋值为 CUDA 的分配函数；如果是 CPU，就赋值为普通的 malloc
@@ -42,6 +50,12 @@ __C {
         free_host_api free_host;
         memcpy_sync_api memcpy_sync;
         memcpy_async_api memcpy_async;
+        launch_host_func_api launch_host_func;
+        create_event_api create_event;
+        destroy_event_api destroy_event;
+        event_record_api event_record;
+        stream_wait_event_api stream_wait_event;
+        event_synchronize_api event_synchronize;
     };
 
     // Llaisys API for getting the runtime APIs
@@ -63,6 +63,16 @@ __C {
         size_t dim,
         size_t start,
         size_t end);
+
+    // 连续的张量：本身连续时共享存储，否则复制一份（rearrange）
+    __export llaisysTensor_t tensorContiguous(
+        llaisysTensor_t tensor);
+
+    // 能用原步长表示时与 tensorView 相同（不要求连续），否则先复制成连续的
+    __export llaisysTensor_t tensorReshape(
+        llaisysTensor_t tensor,
+        size_t * shape,
+        size_t ndim);
 }
 
 #endif // LLAISYS_TENSOR_H
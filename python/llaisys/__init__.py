@@ -3,8 +3,11 @@ from .libllaisys import DeviceType
 from .libllaisys import DataType
 from .libllaisys import MemcpyKind
 from .libllaisys import llaisysStream_t as Stream
+from .libllaisys import llaisysEvent_t as Event
 from .tensor import Tensor
 from .ops import Ops
+from .profiler import Profiler
+from .autotune import Autotune
 from . import models
 from .models import *
 
@@ -14,7 +17,10 @@ __all__ = [
     "DataType",
     "MemcpyKind",
     "Stream",
+    "Event",
     "Tensor",
     "Ops",
+    "Profiler",
+    "Autotune",
     "models",
 ]
@@ -0,0 +1,51 @@
+from .libllaisys import LIB_LLAISYS, AutotuneMode
+from ctypes import create_string_buffer
+from typing import List, Optional, Tuple
+
+
+def _read(fn) -> str:
+    size = fn(None, 0)
+    buf = create_string_buffer(size + 1)
+    fn(buf, size + 1)
+    return buf.value.decode("utf-8")
+
+
+class Autotune:
+    """linear / self_attention 的自动调优。默认开启：第一次遇到某个形状时计时各个候选配置，
+    结果写入缓存文件（默认 ~/.cache/llaisys/tune.cache），之后的进程直接复用：
+
+        Autotune.set_cache_path("tune.cache")
+        Autotune.set_mode("cached")  # 只读缓存，不再调优
+    """
+
+    @staticmethod
+    def set_mode(mode: str):
+        """"off"：总是默认配置；"cached"：只用缓存中的结果；"on"：未命中时调优。"""
+        LIB_LLAISYS.llaisysAutotuneSetMode(AutotuneMode[mode.upper()])
+
+    @staticmethod
+    def mode() -> str:
+        return AutotuneMode(LIB_LLAISYS.llaisysAutotuneMode()).name.lower()
+
+    @staticmethod
+    def set_cache_path(path: Optional[str]):
+        """None 表示只保存在内存中。"""
+        LIB_LLAISYS.llaisysAutotuneSetCachePath(str(path).encode() if path else None)
+
+    @staticmethod
+    def cache_path() -> str:
+        return _read(LIB_LLAISYS.llaisysAutotuneCachePath)
+
+    @staticmethod
+    def entries() -> List[Tuple[str, str, float]]:
+        """当前 CPU 型号下的 (key, 配置, 微秒)。"""
+        result = []
+        for line in _read(LIB_LLAISYS.llaisysAutotuneEntries).splitlines():
+            key, config, us = line.split("\t")
+            result.append((key, config, float(us)))
+        return result
+
+    @staticmethod
+    def clear():
+        """丢弃内存中的结果，下次使用时重新读取缓存文件。"""
+        LIB_LLAISYS.llaisysAutotuneClear()
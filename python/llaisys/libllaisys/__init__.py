@@ -8,10 +8,18 @@ from .runtime import LlaisysRuntimeAPI
 from .llaisys_types import llaisysDeviceType_t, DeviceType
 from .llaisys_types import llaisysDataType_t, DataType
 from .llaisys_types import llaisysMemcpyKind_t, MemcpyKind
-from .llaisys_types import llaisysStream_t
+from .llaisys_types import llaisysStream_t, llaisysEvent_t
 from .tensor import llaisysTensor_t
 from .tensor import load_tensor
 from .ops import load_ops
+from .profiler import load_profiler
+from .autotune import load_autotune, AutotuneMode
+from .qwen2 import load_qwen2
+from .qwen2 import LlaisysQwen2Meta, LlaisysQwen2Weights, LlaisysQwen2PrefixCacheStats
+from .qwen2 import LlaisysQwen2StepOutput, LlaisysQwen2SpeculativeStats
+from .qwen2 import llaisysQwen2Model_t
+from .qwen2 import TraceContent, TraceKind, LlaisysQwen2TraceRequest, llaisysQwen2Trace_t
+from .qwen2 import LogitPositions, llaisysQwen2LogitPositions_t
 
 
 def load_shared_library():
@@ -38,12 +46,16 @@ LIB_LLAISYS = load_shared_library()
 load_runtime(LIB_LLAISYS)
 load_tensor(LIB_LLAISYS)
 load_ops(LIB_LLAISYS)
+load_profiler(LIB_LLAISYS)
+load_autotune(LIB_LLAISYS)
+load_qwen2(LIB_LLAISYS)
 
 
 __all__ = [
     "LIB_LLAISYS",
     "LlaisysRuntimeAPI",
     "llaisysStream_t",
+    "llaisysEvent_t",
     "llaisysTensor_t",
     "llaisysDataType_t",
     "DataType",
@@ -52,4 +64,17 @@ __all__ = [
     "llaisysMemcpyKind_t",
     "MemcpyKind",
     "llaisysStream_t",
+    "AutotuneMode",
+    "LlaisysQwen2Meta",
+    "LlaisysQwen2Weights",
+    "LlaisysQwen2PrefixCacheStats",
+    "LlaisysQwen2StepOutput",
+    "LlaisysQwen2SpeculativeStats",
+    "llaisysQwen2Model_t",
+    "TraceContent",
+    "TraceKind",
+    "LlaisysQwen2TraceRequest",
+    "llaisysQwen2Trace_t",
+    "LogitPositions",
+    "llaisysQwen2LogitPositions_t",
 ]
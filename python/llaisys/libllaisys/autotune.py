@@ -0,0 +1,31 @@
+from ctypes import c_char_p, c_int, c_size_t
+from enum import IntEnum
+
+
+class AutotuneMode(IntEnum):
+    OFF = 0
+    CACHED = 1
+    ON = 2
+
+
+llaisysAutotuneMode_t = c_int
+
+
+def load_autotune(lib):
+    lib.llaisysAutotuneSetMode.argtypes = [llaisysAutotuneMode_t]
+    lib.llaisysAutotuneSetMode.restype = None
+
+    lib.llaisysAutotuneMode.argtypes = []
+    lib.llaisysAutotuneMode.restype = llaisysAutotuneMode_t
+
+    lib.llaisysAutotuneSetCachePath.argtypes = [c_char_p]
+    lib.llaisysAutotuneSetCachePath.restype = None
+
+    lib.llaisysAutotuneCachePath.argtypes = [c_char_p, c_size_t]
+    lib.llaisysAutotuneCachePath.restype = c_size_t
+
+    lib.llaisysAutotuneEntries.argtypes = [c_char_p, c_size_t]
+    lib.llaisysAutotuneEntries.restype = c_size_t
+
+    lib.llaisysAutotuneClear.argtypes = []
+    lib.llaisysAutotuneClear.restype = None
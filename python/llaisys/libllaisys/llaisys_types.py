@@ -51,6 +51,8 @@ llaisysMemcpyKind_t = ctypes.c_int
 
 # Stream type (opaque pointer)
 llaisysStream_t = ctypes.c_void_p
+# Event type (opaque pointer)
+llaisysEvent_t = ctypes.c_void_p
 
 __all__ = [
     "llaisysDeviceType_t",
@@ -60,4 +62,5 @@ __all__ = [
     "llaisysMemcpyKind_t",
     "MemcpyKind",
     "llaisysStream_t",
+    "llaisysEvent_t",
 ]
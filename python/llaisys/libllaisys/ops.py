@@ -1,5 +1,5 @@
 from .tensor import llaisysTensor_t
-from ctypes import c_float
+from ctypes import c_float, c_int64, c_size_t, c_uint64
 
 def load_ops(lib):
     lib.llaisysAdd.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
@@ -8,12 +8,44 @@ def load_ops(lib):
     lib.llaisysArgmax.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
     lib.llaisysArgmax.restype = None
 
+    lib.llaisysCast.argtypes = [llaisysTensor_t, llaisysTensor_t]
+    lib.llaisysCast.restype = None
+
     lib.llaisysEmbedding.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
     lib.llaisysEmbedding.restype = None
 
+    lib.llaisysKVPageSummary.argtypes = [
+        llaisysTensor_t,  # page_min
+        llaisysTensor_t,  # page_max
+        llaisysTensor_t,  # k
+        c_size_t,  # page_size
+        c_size_t,  # begin
+    ]
+    lib.llaisysKVPageSummary.restype = None
+
     lib.llaisysLinear.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
     lib.llaisysLinear.restype = None
 
+    lib.llaisysLMHeadLogprob.argtypes = [
+        llaisysTensor_t,  # out
+        llaisysTensor_t,  # in
+        llaisysTensor_t,  # norm_w
+        llaisysTensor_t,  # weight
+        llaisysTensor_t,  # targets
+        c_float,  # eps
+    ]
+    lib.llaisysLMHeadLogprob.restype = None
+
+    lib.llaisysLMHeadTopK.argtypes = [
+        llaisysTensor_t,  # out_idx
+        llaisysTensor_t,  # out_val
+        llaisysTensor_t,  # in
+        llaisysTensor_t,  # norm_w
+        llaisysTensor_t,  # weight
+        c_float,  # eps
+    ]
+    lib.llaisysLMHeadTopK.restype = None
+
     lib.llaisysRearrange.argtypes = [llaisysTensor_t, llaisysTensor_t]
     lib.llaisysRearrange.restype = None
 
@@ -23,6 +55,19 @@ def load_ops(lib):
     lib.llaisysROPE.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t, c_float]
     lib.llaisysROPE.restype = None
 
+    lib.llaisysSample.argtypes = [
+        llaisysTensor_t,  # out_idx
+        llaisysTensor_t,  # logits
+        c_float,  # temperature
+        c_int64,  # top_k
+        c_float,  # top_p
+        c_uint64,  # seed
+    ]
+    lib.llaisysSample.restype = None
+
+    lib.llaisysScale.argtypes = [llaisysTensor_t, llaisysTensor_t, c_float]
+    lib.llaisysScale.restype = None
+
     lib.llaisysSelfAttention.argtypes = [
         llaisysTensor_t,  # attn_val
         llaisysTensor_t,  # q
@@ -32,5 +77,23 @@ def load_ops(lib):
     ]
     lib.llaisysSelfAttention.restype = None
 
+    lib.llaisysSelfAttentionVarlen.argtypes = [
+        llaisysTensor_t,  # attn_val
+        llaisysTensor_t,  # q
+        llaisysTensor_t,  # k
+        llaisysTensor_t,  # v
+        llaisysTensor_t,  # cu_seqlens_q
+        llaisysTensor_t,  # cu_seqlens_k
+        c_float,  # scale
+    ]
+    lib.llaisysSelfAttentionVarlen.restype = None
+
     lib.llaisysSwiGLU.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
     lib.llaisysSwiGLU.restype = None
+
+    for name in ["llaisysLazyBegin", "llaisysLazyEnd", "llaisysLazySync"]:
+        getattr(lib, name).argtypes = []
+        getattr(lib, name).restype = None
+
+    lib.llaisysLazyCachedKernels.argtypes = []
+    lib.llaisysLazyCachedKernels.restype = c_size_t
@@ -0,0 +1,36 @@
+from ctypes import c_char_p, c_double, c_size_t, c_uint8
+
+
+def load_profiler(lib):
+    lib.llaisysProfilerSetEnabled.argtypes = [c_uint8]
+    lib.llaisysProfilerSetEnabled.restype = None
+
+    lib.llaisysProfilerEnabled.argtypes = []
+    lib.llaisysProfilerEnabled.restype = c_uint8
+
+    lib.llaisysProfilerClear.argtypes = []
+    lib.llaisysProfilerClear.restype = None
+
+    lib.llaisysProfilerChromeTrace.argtypes = [c_char_p, c_size_t]
+    lib.llaisysProfilerChromeTrace.restype = c_size_t
+
+    lib.llaisysProfilerSummary.argtypes = [c_char_p, c_size_t]
+    lib.llaisysProfilerSummary.restype = c_size_t
+
+    lib.llaisysProfilerSaveChromeTrace.argtypes = [c_char_p]
+    lib.llaisysProfilerSaveChromeTrace.restype = None
+
+    lib.llaisysProfilerSetRoofline.argtypes = [c_double, c_double]
+    lib.llaisysProfilerSetRoofline.restype = None
+
+    lib.llaisysProfilerSetCountersEnabled.argtypes = [c_uint8]
+    lib.llaisysProfilerSetCountersEnabled.restype = c_uint8
+
+    lib.llaisysProfilerCountersEnabled.argtypes = []
+    lib.llaisysProfilerCountersEnabled.restype = c_uint8
+
+    lib.llaisysProfilerCountersStatus.argtypes = [c_char_p, c_size_t]
+    lib.llaisysProfilerCountersStatus.restype = c_size_t
+
+    lib.llaisysProfilerCounters.argtypes = [c_char_p, c_size_t]
+    lib.llaisysProfilerCounters.restype = c_size_t
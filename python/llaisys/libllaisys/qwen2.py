@@ -0,0 +1,295 @@
+from ctypes import POINTER, Structure, c_char_p, c_float, c_int, c_int64, c_size_t, c_uint8, c_uint64, c_void_p
+from .llaisys_types import llaisysDataType_t, llaisysDeviceType_t
+from .tensor import llaisysTensor_t
+from enum import IntEnum
+
+
+# llaisysQwen2ModelLogits 计算 logits 的位置
+class LogitPositions(IntEnum):
+    LAST = 0
+    ALL = 1
+
+
+llaisysQwen2LogitPositions_t = c_int
+
+
+class LlaisysQwen2Meta(Structure):
+    _fields_ = [
+        ("dtype", llaisysDataType_t),
+        ("nlayer", c_size_t),
+        ("hs", c_size_t),
+        ("nh", c_size_t),
+        ("nkvh", c_size_t),
+        ("dh", c_size_t),
+        ("di", c_size_t),
+        ("maxseq", c_size_t),
+        ("voc", c_size_t),
+        ("epsilon", c_float),
+        ("theta", c_float),
+        ("end_token", c_int64),
+    ]
+
+
+class LlaisysQwen2Weights(Structure):
+    _fields_ = [
+        ("in_embed", llaisysTensor_t),
+        ("out_embed", llaisysTensor_t),
+        ("out_norm_w", llaisysTensor_t),
+        ("attn_norm_w", POINTER(llaisysTensor_t)),
+        ("attn_q_w", POINTER(llaisysTensor_t)),
+        ("attn_q_b", POINTER(llaisysTensor_t)),
+        ("attn_k_w", POINTER(llaisysTensor_t)),
+        ("attn_k_b", POINTER(llaisysTensor_t)),
+        ("attn_v_w", POINTER(llaisysTensor_t)),
+        ("attn_v_b", POINTER(llaisysTensor_t)),
+        ("attn_o_w", POINTER(llaisysTensor_t)),
+        ("mlp_norm_w", POINTER(llaisysTensor_t)),
+        ("mlp_gate_w", POINTER(llaisysTensor_t)),
+        ("mlp_up_w", POINTER(llaisysTensor_t)),
+        ("mlp_down_w", POINTER(llaisysTensor_t)),
+    ]
+
+
+class LlaisysQwen2PrefixCacheStats(Structure):
+    _fields_ = [
+        ("lookups", c_size_t),
+        ("hits", c_size_t),
+        ("query_tokens", c_size_t),
+        ("hit_tokens", c_size_t),
+        ("cached_blocks", c_size_t),
+        ("cached_bytes", c_size_t),
+        ("evicted_blocks", c_size_t),
+        ("offloaded_blocks", c_size_t),
+        ("offloaded_bytes", c_size_t),
+        ("paged_in_blocks", c_size_t),
+    ]
+
+
+class LlaisysQwen2StepOutput(Structure):
+    _fields_ = [
+        ("request_id", c_int64),
+        ("token", c_int64),
+        ("finished", c_uint8),
+    ]
+
+
+class LlaisysQwen2SpeculativeStats(Structure):
+    _fields_ = [
+        ("steps", c_size_t),
+        ("proposed", c_size_t),
+        ("accepted", c_size_t),
+        ("generated", c_size_t),
+    ]
+
+
+# llaisysQwen2ModelSetTrace 记录的内容
+class TraceContent(IntEnum):
+    ANONYMOUS = 0
+    TOKENS = 1
+
+
+class TraceKind(IntEnum):
+    REQUEST = 0
+    INFER = 1
+
+
+class LlaisysQwen2TraceRequest(Structure):
+    _fields_ = [
+        ("kind", c_int),
+        ("request_id", c_int64),
+        ("arrival_ns", c_uint64),
+        ("finish_ns", c_uint64),
+        ("prompt_len", c_size_t),
+        ("shared_prefix", c_size_t),
+        ("max_new_tokens", c_size_t),
+        ("generated", c_size_t),
+        ("lookup_tokens", c_size_t),
+        ("lookup_ngram", c_size_t),
+        ("temperature", c_float),
+        ("top_k", c_int64),
+        ("top_p", c_float),
+    ]
+
+
+# Handle type
+llaisysQwen2Model_t = c_void_p
+llaisysQwen2Trace_t = c_void_p
+
+
+def load_qwen2(lib):
+    lib.llaisysQwen2ModelCreate.argtypes = [
+        POINTER(LlaisysQwen2Meta),
+        llaisysDeviceType_t,
+        POINTER(c_int),  # device_ids
+        c_int,  # ndevice
+    ]
+    lib.llaisysQwen2ModelCreate.restype = llaisysQwen2Model_t
+
+    lib.llaisysQwen2ModelDestroy.argtypes = [llaisysQwen2Model_t]
+    lib.llaisysQwen2ModelDestroy.restype = None
+
+    lib.llaisysQwen2ModelWeights.argtypes = [llaisysQwen2Model_t]
+    lib.llaisysQwen2ModelWeights.restype = POINTER(LlaisysQwen2Weights)
+
+    lib.llaisysQwen2ModelInfer.argtypes = [llaisysQwen2Model_t, POINTER(c_int64), c_size_t]
+    lib.llaisysQwen2ModelInfer.restype = c_int64
+
+    lib.llaisysQwen2ModelLogits.argtypes = [
+        llaisysQwen2Model_t,
+        POINTER(c_int64),  # token_ids
+        c_size_t,  # ntoken
+        llaisysQwen2LogitPositions_t,
+    ]
+    lib.llaisysQwen2ModelLogits.restype = llaisysTensor_t
+
+    lib.llaisysQwen2ModelScore.argtypes = [
+        llaisysQwen2Model_t,
+        POINTER(c_int64),  # token_ids
+        POINTER(c_size_t),  # ntokens
+        POINTER(c_size_t),  # prompt_lens
+        c_size_t,  # nrequest
+        POINTER(c_float),  # logprobs
+    ]
+    lib.llaisysQwen2ModelScore.restype = c_size_t
+
+    lib.llaisysQwen2ModelInferSample.argtypes = [
+        llaisysQwen2Model_t,
+        POINTER(c_int64),  # token_ids
+        c_size_t,  # ntoken
+        c_float,  # temperature
+        c_int64,  # top_k
+        c_float,  # top_p
+    ]
+    lib.llaisysQwen2ModelInferSample.restype = c_int64
+
+    lib.llaisysQwen2ModelSetChunkSize.argtypes = [llaisysQwen2Model_t, c_size_t]
+    lib.llaisysQwen2ModelSetChunkSize.restype = None
+
+    lib.llaisysQwen2ModelAddRequest.argtypes = [
+        llaisysQwen2Model_t,
+        POINTER(c_int64),  # token_ids
+        c_size_t,  # ntoken
+        c_size_t,  # max_new_tokens
+    ]
+    lib.llaisysQwen2ModelAddRequest.restype = c_int64
+
+    lib.llaisysQwen2ModelAddLookupRequest.argtypes = [
+        llaisysQwen2Model_t,
+        POINTER(c_int64),  # token_ids
+        c_size_t,  # ntoken
+        c_size_t,  # max_new_tokens
+        c_size_t,  # num_lookup_tokens
+        c_size_t,  # max_ngram
+    ]
+    lib.llaisysQwen2ModelAddLookupRequest.restype = c_int64
+
+    lib.llaisysQwen2ModelStep.argtypes = [
+        llaisysQwen2Model_t,
+        POINTER(LlaisysQwen2StepOutput),
+        c_size_t,  # capacity
+    ]
+    lib.llaisysQwen2ModelStep.restype = c_size_t
+
+    lib.llaisysQwen2ModelNumRequests.argtypes = [llaisysQwen2Model_t]
+    lib.llaisysQwen2ModelNumRequests.restype = c_size_t
+
+    lib.llaisysQwen2ModelSetStreaming.argtypes = [llaisysQwen2Model_t, c_size_t, c_size_t]
+    lib.llaisysQwen2ModelSetStreaming.restype = None
+
+    lib.llaisysQwen2ModelSetSparseAttention.argtypes = [llaisysQwen2Model_t, c_size_t, c_size_t, c_size_t]
+    lib.llaisysQwen2ModelSetSparseAttention.restype = None
+
+    lib.llaisysQwen2ModelSetPrefixCache.argtypes = [llaisysQwen2Model_t, c_size_t, c_size_t]
+    lib.llaisysQwen2ModelSetPrefixCache.restype = None
+
+    lib.llaisysQwen2ModelSetKVOffload.argtypes = [llaisysQwen2Model_t, c_char_p, c_size_t]
+    lib.llaisysQwen2ModelSetKVOffload.restype = None
+
+    lib.llaisysQwen2ModelSaveCache.argtypes = [llaisysQwen2Model_t, c_char_p]
+    lib.llaisysQwen2ModelSaveCache.restype = None
+
+    lib.llaisysQwen2ModelLoadCache.argtypes = [
+        llaisysQwen2Model_t,
+        c_char_p,  # path
+        POINTER(c_int64),  # out_tokens
+        c_size_t,  # capacity
+    ]
+    lib.llaisysQwen2ModelLoadCache.restype = c_size_t
+
+    lib.llaisysQwen2ModelPrefixCacheStats.argtypes = [
+        llaisysQwen2Model_t,
+        POINTER(LlaisysQwen2PrefixCacheStats),
+    ]
+    lib.llaisysQwen2ModelPrefixCacheStats.restype = None
+
+    lib.llaisysQwen2ModelSpeculativeStep.argtypes = [
+        llaisysQwen2Model_t,
+        llaisysQwen2Model_t,  # draft
+        POINTER(c_int64),  # token_ids
+        c_size_t,  # ntoken
+        c_size_t,  # num_draft_tokens
+        c_float,  # temperature
+        POINTER(c_int64),  # out_tokens
+    ]
+    lib.llaisysQwen2ModelSpeculativeStep.restype = c_size_t
+
+    lib.llaisysQwen2ModelLookupStep.argtypes = [
+        llaisysQwen2Model_t,
+        POINTER(c_int64),  # token_ids
+        c_size_t,  # ntoken
+        c_size_t,  # num_lookup_tokens
+        c_size_t,  # max_ngram
+        c_float,  # temperature
+        POINTER(c_int64),  # out_tokens
+    ]
+    lib.llaisysQwen2ModelLookupStep.restype = c_size_t
+
+    lib.llaisysQwen2ModelSpeculativeStats.argtypes = [
+        llaisysQwen2Model_t,
+        POINTER(LlaisysQwen2SpeculativeStats),
+    ]
+    lib.llaisysQwen2ModelSpeculativeStats.restype = None
+
+    lib.llaisysQwen2ModelSetSeed.argtypes = [llaisysQwen2Model_t, c_uint64]
+    lib.llaisysQwen2ModelSetSeed.restype = None
+
+    lib.llaisysQwen2ModelSetTrace.argtypes = [llaisysQwen2Model_t, c_char_p, c_int]
+    lib.llaisysQwen2ModelSetTrace.restype = None
+
+    lib.llaisysQwen2TraceLoad.argtypes = [c_char_p]
+    lib.llaisysQwen2TraceLoad.restype = llaisysQwen2Trace_t
+
+    lib.llaisysQwen2TraceDestroy.argtypes = [llaisysQwen2Trace_t]
+    lib.llaisysQwen2TraceDestroy.restype = None
+
+    lib.llaisysQwen2TraceMeta.argtypes = [llaisysQwen2Trace_t, POINTER(LlaisysQwen2Meta)]
+    lib.llaisysQwen2TraceMeta.restype = None
+
+    lib.llaisysQwen2TraceContent.argtypes = [llaisysQwen2Trace_t]
+    lib.llaisysQwen2TraceContent.restype = c_int
+
+    lib.llaisysQwen2TraceNumRequests.argtypes = [llaisysQwen2Trace_t]
+    lib.llaisysQwen2TraceNumRequests.restype = c_size_t
+
+    lib.llaisysQwen2TraceGetRequest.argtypes = [
+        llaisysQwen2Trace_t,
+        c_size_t,  # index
+        POINTER(LlaisysQwen2TraceRequest),
+    ]
+    lib.llaisysQwen2TraceGetRequest.restype = None
+
+    lib.llaisysQwen2TracePrompt.argtypes = [
+        llaisysQwen2Trace_t,
+        c_size_t,  # index
+        c_size_t,  # voc
+        POINTER(c_int64),  # out_tokens
+    ]
+    lib.llaisysQwen2TracePrompt.restype = c_size_t
+
+    lib.llaisysQwen2TraceSetOutput.argtypes = [
+        llaisysQwen2Trace_t,
+        c_size_t,  # index
+        POINTER(c_int64),  # tokens
+        c_size_t,  # ntoken
+    ]
+    lib.llaisysQwen2TraceSetOutput.restype = None
@@ -1,23 +1,255 @@
-from typing import Sequence
+from typing import List, Optional, Sequence, Tuple
 from ..libllaisys import LIB_LLAISYS
-from ..libllaisys import DeviceType
+from ..libllaisys import DeviceType, DataType
+from ..libllaisys import llaisysDeviceType_t
+from ..libllaisys import LlaisysQwen2Meta, LlaisysQwen2PrefixCacheStats
+from ..libllaisys import LlaisysQwen2StepOutput, LlaisysQwen2SpeculativeStats
+from ..libllaisys import LogitPositions, MemcpyKind
+from ..libllaisys import TraceContent, TraceKind, LlaisysQwen2TraceRequest
+from ..runtime import RuntimeAPI
+from ..tensor import Tensor
 
+from ctypes import byref, c_float, c_int64, c_size_t, c_uint64
 from pathlib import Path
+import json
 import safetensors
+import torch
+
+
+_TORCH_DTYPES = {
+    "float32": (torch.float32, DataType.F32),
+    "float16": (torch.float16, DataType.F16),
+    "bfloat16": (torch.bfloat16, DataType.BF16),
+}
+
+# HF 权重名 -> LlaisysQwen2Weights 字段（每层权重去掉 "model.layers.{i}." 前缀）
+_GLOBAL_WEIGHTS = {
+    "model.embed_tokens.weight": "in_embed",
+    "lm_head.weight": "out_embed",
+    "model.norm.weight": "out_norm_w",
+}
+_LAYER_WEIGHTS = {
+    "input_layernorm.weight": "attn_norm_w",
+    "self_attn.q_proj.weight": "attn_q_w",
+    "self_attn.q_proj.bias": "attn_q_b",
+    "self_attn.k_proj.weight": "attn_k_w",
+    "self_attn.k_proj.bias": "attn_k_b",
+    "self_attn.v_proj.weight": "attn_v_w",
+    "self_attn.v_proj.bias": "attn_v_b",
+    "self_attn.o_proj.weight": "attn_o_w",
+    "post_attention_layernorm.weight": "mlp_norm_w",
+    "mlp.gate_proj.weight": "mlp_gate_w",
+    "mlp.up_proj.weight": "mlp_up_w",
+    "mlp.down_proj.weight": "mlp_down_w",
+}
 
 
 class Qwen2:
 
     def __init__(self, model_path, device: DeviceType = DeviceType.CPU):
-        # TODO: Implement model constructor
-
         model_path = Path(model_path)
 
+        with open(model_path / "config.json", "r") as f:
+            config = json.load(f)
+        torch_dtype, dtype = _TORCH_DTYPES[config.get("torch_dtype", "bfloat16")]
+        self._torch_dtype = torch_dtype
+
+        end_token = config.get("eos_token_id", -1)
+        if isinstance(end_token, list):
+            end_token = end_token[0]
+
+        nh = config["num_attention_heads"]
+        self.meta = LlaisysQwen2Meta(
+            dtype=dtype,
+            nlayer=config["num_hidden_layers"],
+            hs=config["hidden_size"],
+            nh=nh,
+            nkvh=config.get("num_key_value_heads", nh),
+            dh=config["hidden_size"] // nh,
+            di=config["intermediate_size"],
+            maxseq=config["max_position_embeddings"],
+            voc=config["vocab_size"],
+            epsilon=config["rms_norm_eps"],
+            theta=config.get("rope_theta", 10000.0),
+            end_token=end_token,
+        )
+
+        self._device = device
+        self._model = LIB_LLAISYS.llaisysQwen2ModelCreate(
+            byref(self.meta), llaisysDeviceType_t(device), None, 0
+        )
+        self._weights = LIB_LLAISYS.llaisysQwen2ModelWeights(self._model).contents
+
         for file in sorted(model_path.glob("*.safetensors")):
-            data_ = safetensors.safe_open(file, framework="numpy", device="cpu")
+            data_ = safetensors.safe_open(file, framework="pt", device="cpu")
             for name_ in data_.keys():
-                ## TODO: load the model weights
-                pass
+                handle = self._weight_handle(name_)
+                if handle is None:
+                    continue
+                tensor = data_.get_tensor(name_).to(torch_dtype).contiguous()
+                LIB_LLAISYS.tensorLoad(handle, tensor.data_ptr())
+                if name_ == "model.embed_tokens.weight" and config.get(
+                    "tie_word_embeddings", False
+                ):
+                    LIB_LLAISYS.tensorLoad(self._weights.out_embed, tensor.data_ptr())
+
+    def _weight_handle(self, name: str):
+        if name in _GLOBAL_WEIGHTS:
+            return getattr(self._weights, _GLOBAL_WEIGHTS[name])
+        parts = name.split(".", 3)
+        if len(parts) == 4 and parts[0] == "model" and parts[1] == "layers":
+            field = _LAYER_WEIGHTS.get(parts[3])
+            if field is not None:
+                return getattr(self._weights, field)[int(parts[2])]
+        return None
+
+    def __del__(self):
+        if hasattr(self, "_model") and self._model is not None:
+            LIB_LLAISYS.llaisysQwen2ModelDestroy(self._model)
+            self._model = None
+
+    def set_chunk_size(self, token_budget: int = 512):
+        """每步最多计算的 token 数，0 表示 prefill 不分块。"""
+        LIB_LLAISYS.llaisysQwen2ModelSetChunkSize(self._model, c_size_t(token_budget))
+
+    def set_prefix_cache(self, block_size: int = 16, budget_bytes: int = 256 << 20):
+        """budget_bytes=0 关闭前缀缓存。"""
+        LIB_LLAISYS.llaisysQwen2ModelSetPrefixCache(
+            self._model, c_size_t(block_size), c_size_t(budget_bytes)
+        )
+
+    def set_kv_offload(self, budget_bytes: int = 1 << 30, path: Optional[str] = None):
+        """超出前缀缓存预算的 KV 块换出到 path 目录下的内存映射文件（None 为主机内存），budget_bytes=0 关闭。"""
+        LIB_LLAISYS.llaisysQwen2ModelSetKVOffload(
+            self._model, path.encode() if path else None, c_size_t(budget_bytes)
+        )
+
+    def save_cache(self, path: str):
+        """把当前对话（generate 使用的默认序列）的 token 历史和 KV Cache 写入快照文件。"""
+        LIB_LLAISYS.llaisysQwen2ModelSaveCache(self._model, str(path).encode())
+
+    def load_cache(self, path: str) -> List[int]:
+        """加载 save_cache 写出的快照（需为同一模型），返回恢复的 token 历史；之后以它为前缀的 generate 无需重新 prefill。"""
+        capacity = self.meta.maxseq
+        tokens = (c_int64 * capacity)()
+        n = LIB_LLAISYS.llaisysQwen2ModelLoadCache(
+            self._model, str(path).encode(), tokens, c_size_t(capacity)
+        )
+        return list(tokens[:n])
+
+    def set_streaming(self, sink: int = 4, window: int = 0):
+        """StreamingLLM 式的有界 KV Cache：只保留前 sink 个和最近 window 个 token，window=0 关闭。"""
+        LIB_LLAISYS.llaisysQwen2ModelSetStreaming(self._model, c_size_t(sink), c_size_t(window))
+
+    def set_sparse_attention(self, page_size: int = 16, top_pages: int = 64, recent: int = 128):
+        """Quest 式的稀疏 decode attention：每个 query 只读 top_pages 页和最近 recent 个 token，page_size=0 关闭。"""
+        LIB_LLAISYS.llaisysQwen2ModelSetSparseAttention(
+            self._model, c_size_t(page_size), c_size_t(top_pages), c_size_t(recent)
+        )
+
+    def prefix_cache_stats(self) -> dict:
+        stats = LlaisysQwen2PrefixCacheStats()
+        LIB_LLAISYS.llaisysQwen2ModelPrefixCacheStats(self._model, byref(stats))
+        result = {name: getattr(stats, name) for name, _ in stats._fields_}
+        result["hit_rate"] = (
+            stats.hit_tokens / stats.query_tokens if stats.query_tokens else 0.0
+        )
+        return result
+
+    def start_trace(self, path: str, tokens: bool = False):
+        """把之后的请求（generate / generate_batch 等）记录到 trace 文件，供 llaisys-bench replay 回放。
+        tokens=False 时不保存 token，只记录 prompt 长度与共享前缀的结构。"""
+        content = TraceContent.TOKENS if tokens else TraceContent.ANONYMOUS
+        LIB_LLAISYS.llaisysQwen2ModelSetTrace(self._model, str(path).encode(), content)
+
+    def stop_trace(self):
+        LIB_LLAISYS.llaisysQwen2ModelSetTrace(self._model, None, TraceContent.ANONYMOUS)
+
+    @staticmethod
+    def read_trace(path: str) -> List[dict]:
+        """读取 trace 文件中的记录；匿名 trace 的 prompt 为按共享前缀结构生成的伪 token。"""
+        trace = LIB_LLAISYS.llaisysQwen2TraceLoad(str(path).encode())
+        try:
+            meta = LlaisysQwen2Meta()
+            LIB_LLAISYS.llaisysQwen2TraceMeta(trace, byref(meta))
+            records = []
+            for i in range(LIB_LLAISYS.llaisysQwen2TraceNumRequests(trace)):
+                r = LlaisysQwen2TraceRequest()
+                LIB_LLAISYS.llaisysQwen2TraceGetRequest(trace, c_size_t(i), byref(r))
+                record = {name: getattr(r, name) for name, _ in r._fields_}
+                record["kind"] = TraceKind(r.kind).name.lower()
+                prompt = (c_int64 * max(r.prompt_len, 1))()
+                LIB_LLAISYS.llaisysQwen2TracePrompt(trace, c_size_t(i), c_size_t(meta.voc), prompt)
+                record["prompt"] = list(prompt[: r.prompt_len])
+                records.append(record)
+            return records
+        finally:
+            LIB_LLAISYS.llaisysQwen2TraceDestroy(trace)
+
+    def set_seed(self, seed: int):
+        LIB_LLAISYS.llaisysQwen2ModelSetSeed(self._model, c_uint64(seed))
+
+    def speculative_stats(self) -> dict:
+        stats = LlaisysQwen2SpeculativeStats()
+        LIB_LLAISYS.llaisysQwen2ModelSpeculativeStats(self._model, byref(stats))
+        result = {name: getattr(stats, name) for name, _ in stats._fields_}
+        result["acceptance_rate"] = (
+            stats.accepted / stats.proposed if stats.proposed else 0.0
+        )
+        result["tokens_per_forward"] = (
+            stats.generated / stats.steps if stats.steps else 0.0
+        )
+        return result
+
+    def logits(self, inputs: Sequence[int], positions: str = "last") -> torch.Tensor:
+        """返回 [n, voc] 的 logits：positions="last" 只算最后一个 token，"all" 算所有 token（用于打分）。"""
+        token_ids = (c_int64 * len(inputs))(*inputs)
+        result = Tensor(
+            tensor=LIB_LLAISYS.llaisysQwen2ModelLogits(
+                self._model,
+                token_ids,
+                c_size_t(len(inputs)),
+                LogitPositions[positions.upper()],
+            )
+        )
+        logits = torch.empty(result.shape(), dtype=self._torch_dtype)
+        RuntimeAPI(self._device).memcpy_sync(
+            logits.data_ptr(),
+            result.data_ptr(),
+            logits.numel() * logits.element_size(),
+            MemcpyKind.D2H,
+        )
+        return logits
+
+    def score(
+        self, pairs: Sequence[Tuple[Sequence[int], Sequence[int]]]
+    ) -> List[List[float]]:
+        """对每个 (prompt, continuation) 返回 continuation 中每个 token 的 log 概率。
+
+        所有请求拼成 ragged prefill（按 set_chunk_size 的 token 预算分步），不保留 KV Cache。
+        """
+        tokens, ntokens, prompt_lens = [], [], []
+        for prompt, continuation in pairs:
+            tokens.extend(prompt)
+            tokens.extend(continuation)
+            ntokens.append(len(prompt) + len(continuation))
+            prompt_lens.append(len(prompt))
+        total = sum(ntokens) - sum(prompt_lens)
+        logprobs = (c_float * total)()
+        LIB_LLAISYS.llaisysQwen2ModelScore(
+            self._model,
+            (c_int64 * len(tokens))(*tokens),
+            (c_size_t * len(pairs))(*ntokens),
+            (c_size_t * len(pairs))(*prompt_lens),
+            c_size_t(len(pairs)),
+            logprobs,
+        )
+
+        results, offset = [], 0
+        for n, p in zip(ntokens, prompt_lens):
+            results.append(list(logprobs[offset : offset + n - p]))
+            offset += n - p
+        return results
 
     def generate(
         self,
@@ -27,7 +259,119 @@ class Qwen2:
         top_p: float = 0.8,
         temperature: float = 0.8,
     ):
+        tokens = list(inputs)
+        if max_new_tokens is None:
+            max_new_tokens = self.meta.maxseq - len(tokens)
+
+        for _ in range(max_new_tokens):
+            token_ids = (c_int64 * len(tokens))(*tokens)
+            if top_k == 1 or temperature <= 0:
+                next_token = LIB_LLAISYS.llaisysQwen2ModelInfer(
+                    self._model, token_ids, c_size_t(len(tokens))
+                )
+            else:
+                next_token = LIB_LLAISYS.llaisysQwen2ModelInferSample(
+                    self._model,
+                    token_ids,
+                    c_size_t(len(tokens)),
+                    c_float(temperature),
+                    c_int64(top_k),
+                    c_float(top_p),
+                )
+            tokens.append(next_token)
+            if next_token == self.meta.end_token:
+                break
+
+        return tokens
+
+    def generate_batch(
+        self,
+        inputs: Sequence[Sequence[int]],
+        max_new_tokens: int = 128,
+        num_lookup_tokens=0,
+        max_ngram: int = 3,
+    ):
+        """同时生成多个请求：prefill 分块并与其它请求的 decode 交错执行（argmax 采样）。
+
+        num_lookup_tokens 可以是整数或与 inputs 等长的列表，>0 的请求开启 prompt lookup 投机。
+        """
+        if max_new_tokens <= 0:
+            return [list(prompt) for prompt in inputs]
+        if isinstance(num_lookup_tokens, int):
+            num_lookup_tokens = [num_lookup_tokens] * len(inputs)
+
+        results = {}
+        for prompt, lookup in zip(inputs, num_lookup_tokens):
+            token_ids = (c_int64 * len(prompt))(*prompt)
+            request_id = LIB_LLAISYS.llaisysQwen2ModelAddLookupRequest(
+                self._model,
+                token_ids,
+                c_size_t(len(prompt)),
+                c_size_t(max_new_tokens),
+                c_size_t(lookup),
+                c_size_t(max_ngram),
+            )
+            results[request_id] = list(prompt)
+        order = list(results.keys())
+
+        # 开启投机的请求每步最多输出 num_lookup_tokens + 1 个 token
+        per_step = 1 + max(num_lookup_tokens, default=0)
+        pending = set(order)
+        while pending:
+            capacity = LIB_LLAISYS.llaisysQwen2ModelNumRequests(self._model) * per_step
+            outputs = (LlaisysQwen2StepOutput * capacity)()
+            n = LIB_LLAISYS.llaisysQwen2ModelStep(self._model, outputs, c_size_t(capacity))
+            for i in range(n):
+                results[outputs[i].request_id].append(outputs[i].token)
+                if outputs[i].finished:
+                    pending.discard(outputs[i].request_id)
+
+        return [results[request_id] for request_id in order]
+
+    def generate_speculative(
+        self,
+        inputs: Sequence[int],
+        draft: "Qwen2" = None,
+        max_new_tokens: int = None,
+        num_draft_tokens: int = 4,
+        temperature: float = 0.0,
+        max_ngram: int = 3,
+    ):
+        """draft 为同词表的小模型；draft=None 时用 prompt lookup（n-gram 匹配上下文）提出候选。
+        temperature=0 时结果与 generate() 的贪心解码一致。"""
+        tokens = list(inputs)
+        if max_new_tokens is None:
+            max_new_tokens = self.meta.maxseq - len(tokens)
 
-        # TODO: Implement generate function
+        out_tokens = (c_int64 * (num_draft_tokens + 1))()
+        generated = 0
+        while generated < max_new_tokens:
+            token_ids = (c_int64 * len(tokens))(*tokens)
+            k = c_size_t(min(num_draft_tokens, max_new_tokens - generated - 1))
+            if draft is None:
+                n = LIB_LLAISYS.llaisysQwen2ModelLookupStep(
+                    self._model,
+                    token_ids,
+                    c_size_t(len(tokens)),
+                    k,
+                    c_size_t(max_ngram),
+                    c_float(temperature),
+                    out_tokens,
+                )
+            else:
+                n = LIB_LLAISYS.llaisysQwen2ModelSpeculativeStep(
+                    self._model,
+                    draft._model,
+                    token_ids,
+                    c_size_t(len(tokens)),
+                    k,
+                    c_float(temperature),
+                    out_tokens,
+                )
+            for i in range(n):
+                tokens.append(out_tokens[i])
+                generated += 1
+                if out_tokens[i] == self.meta.end_token:
+                    return tokens
 
-        return []
+        return tokens
@@ -1,6 +1,7 @@
 from .libllaisys import LIB_LLAISYS
 from .tensor import Tensor
-from ctypes import c_float, c_int
+from contextlib import contextmanager
+from ctypes import c_float, c_int, c_int64, c_size_t, c_uint64
 
 
 class Ops:
@@ -12,16 +13,61 @@ class Ops:
     def argmax(max_idx: Tensor, max_val: Tensor, vals: Tensor):
         LIB_LLAISYS.llaisysArgmax(max_idx.lib_tensor(), max_val.lib_tensor(), vals.lib_tensor())
 
+    @staticmethod
+    def cast(out: Tensor, inp: Tensor):
+        LIB_LLAISYS.llaisysCast(out.lib_tensor(), inp.lib_tensor())
+
     @staticmethod
     def embedding(out: Tensor, index: Tensor, weight: Tensor):
         LIB_LLAISYS.llaisysEmbedding(
             out.lib_tensor(), index.lib_tensor(), weight.lib_tensor()
         )
 
+    @staticmethod
+    def kv_page_summary(
+        page_min: Tensor, page_max: Tensor, k: Tensor, page_size: int, begin: int = 0
+    ):
+        LIB_LLAISYS.llaisysKVPageSummary(
+            page_min.lib_tensor(),
+            page_max.lib_tensor(),
+            k.lib_tensor(),
+            c_size_t(page_size),
+            c_size_t(begin),
+        )
+
     @staticmethod
     def linear(out: Tensor, inp: Tensor, weight: Tensor, bias: Tensor):
         LIB_LLAISYS.llaisysLinear(
-            out.lib_tensor(), inp.lib_tensor(), weight.lib_tensor(), bias.lib_tensor()
+            out.lib_tensor(),
+            inp.lib_tensor(),
+            weight.lib_tensor(),
+            bias.lib_tensor() if bias is not None else None,
+        )
+
+    @staticmethod
+    def lm_head_logprob(
+        out: Tensor, x: Tensor, norm_w: Tensor, weight: Tensor, targets: Tensor, eps: float
+    ):
+        LIB_LLAISYS.llaisysLMHeadLogprob(
+            out.lib_tensor(),
+            x.lib_tensor(),
+            norm_w.lib_tensor(),
+            weight.lib_tensor(),
+            targets.lib_tensor(),
+            c_float(eps),
+        )
+
+    @staticmethod
+    def lm_head_topk(
+        out_idx: Tensor, out_val: Tensor, x: Tensor, norm_w: Tensor, weight: Tensor, eps: float
+    ):
+        LIB_LLAISYS.llaisysLMHeadTopK(
+            out_idx.lib_tensor(),
+            out_val.lib_tensor(),
+            x.lib_tensor(),
+            norm_w.lib_tensor(),
+            weight.lib_tensor(),
+            c_float(eps),
         )
 
     @staticmethod
@@ -40,6 +86,28 @@ class Ops:
             out.lib_tensor(), inp.lib_tensor(), pos_ids.lib_tensor(), c_float(theta)
         )
 
+    @staticmethod
+    def sample(
+        out_idx: Tensor,
+        logits: Tensor,
+        temperature: float = 1.0,
+        top_k: int = 0,
+        top_p: float = 1.0,
+        seed: int = 0,
+    ):
+        LIB_LLAISYS.llaisysSample(
+            out_idx.lib_tensor(),
+            logits.lib_tensor(),
+            c_float(temperature),
+            c_int64(top_k),
+            c_float(top_p),
+            c_uint64(seed),
+        )
+
+    @staticmethod
+    def scale(out: Tensor, inp: Tensor, alpha: float):
+        LIB_LLAISYS.llaisysScale(out.lib_tensor(), inp.lib_tensor(), c_float(alpha))
+
     @staticmethod
     def self_attention(attn_val: Tensor, q: Tensor, k: Tensor, v: Tensor, scale: float):
         LIB_LLAISYS.llaisysSelfAttention(
@@ -50,6 +118,45 @@ class Ops:
             c_float(scale),
         )
 
+    @staticmethod
+    def self_attention_varlen(
+        attn_val: Tensor,
+        q: Tensor,
+        k: Tensor,
+        v: Tensor,
+        cu_seqlens_q: Tensor,
+        cu_seqlens_k: Tensor,
+        scale: float,
+    ):
+        LIB_LLAISYS.llaisysSelfAttentionVarlen(
+            attn_val.lib_tensor(),
+            q.lib_tensor(),
+            k.lib_tensor(),
+            v.lib_tensor(),
+            cu_seqlens_q.lib_tensor(),
+            cu_seqlens_k.lib_tensor(),
+            c_float(scale),
+        )
+
     @staticmethod
     def swiglu(out: Tensor, gate: Tensor, up: Tensor):
         LIB_LLAISYS.llaisysSwiGLU(out.lib_tensor(), gate.lib_tensor(), up.lib_tensor())
+
+    # with Ops.lazy(): 块内的 add / swiglu / scale / cast 延迟执行，相邻的融合成一次遍历，
+    # 在块结束、sync() 或其他算子之前执行
+    @staticmethod
+    @contextmanager
+    def lazy():
+        LIB_LLAISYS.llaisysLazyBegin()
+        try:
+            yield
+        finally:
+            LIB_LLAISYS.llaisysLazyEnd()
+
+    @staticmethod
+    def sync():
+        LIB_LLAISYS.llaisysLazySync()
+
+    @staticmethod
+    def lazy_cached_kernels() -> int:
+        return LIB_LLAISYS.llaisysLazyCachedKernels()
@@ -0,0 +1,114 @@
+from .libllaisys import LIB_LLAISYS
+from ctypes import create_string_buffer
+import json
+import os
+
+
+def _read(fn) -> str:
+    # 先取长度，再按长度分配缓冲区
+    size = fn(None, 0)
+    buf = create_string_buffer(size + 1)
+    fn(buf, size + 1)
+    return buf.value.decode("utf-8")
+
+
+class Profiler:
+    """算子级 profiler。关闭时几乎没有开销；也可以当作上下文管理器使用：
+
+        with Profiler() as prof:
+            model.generate(...)
+        print(prof.summary())
+        prof.save("trace.json")  # chrome://tracing / Perfetto
+
+    Profiler(counters=True) 同时开启硬件计数器，结果见 counters()
+    """
+
+    def __init__(self, counters: bool = False):
+        self._counters = counters
+
+    @staticmethod
+    def enable():
+        LIB_LLAISYS.llaisysProfilerSetEnabled(1)
+
+    @staticmethod
+    def disable():
+        LIB_LLAISYS.llaisysProfilerSetEnabled(0)
+
+    @staticmethod
+    def enabled() -> bool:
+        return bool(LIB_LLAISYS.llaisysProfilerEnabled())
+
+    @staticmethod
+    def clear():
+        LIB_LLAISYS.llaisysProfilerClear()
+
+    @staticmethod
+    def chrome_trace() -> dict:
+        return json.loads(_read(LIB_LLAISYS.llaisysProfilerChromeTrace))
+
+    @staticmethod
+    def summary() -> str:
+        return _read(LIB_LLAISYS.llaisysProfilerSummary)
+
+    @staticmethod
+    def save(path: str):
+        LIB_LLAISYS.llaisysProfilerSaveChromeTrace(str(path).encode("utf-8"))
+
+    @staticmethod
+    def set_roofline(peak_gflops: float, peak_gbps: float):
+        """设置机器峰值后 summary() 多出 flop/B 和 %roof 两列；都传 0 关闭"""
+        LIB_LLAISYS.llaisysProfilerSetRoofline(float(peak_gflops), float(peak_gbps))
+
+    @staticmethod
+    def load_roofline(path: str, threads: int = None) -> dict:
+        """读取 `llaisys-bench calibrate --json` 的结果，取线程数最接近的一组峰值"""
+        with open(path) as f:
+            peaks = json.load(f)["peaks"]
+        if threads is None:
+            threads = os.cpu_count() or 1
+        best = min(peaks, key=lambda p: abs(p["threads"] - threads))
+        Profiler.set_roofline(best["peak_gflops"], best["peak_gbps"])
+        return best
+
+    @staticmethod
+    def enable_counters() -> bool:
+        """打开 perf_event 硬件计数器，返回是否至少有一个可用（原因见 counters_status()）"""
+        return bool(LIB_LLAISYS.llaisysProfilerSetCountersEnabled(1))
+
+    @staticmethod
+    def disable_counters():
+        LIB_LLAISYS.llaisysProfilerSetCountersEnabled(0)
+
+    @staticmethod
+    def counters_enabled() -> bool:
+        return bool(LIB_LLAISYS.llaisysProfilerCountersEnabled())
+
+    @staticmethod
+    def counters_status() -> str:
+        return _read(LIB_LLAISYS.llaisysProfilerCountersStatus)
+
+    @staticmethod
+    def counters() -> list:
+        """按 (op, shapes, dtype) 汇总的计数器，按总时间降序；不可用的计数器不出现。
+        同时给出 ipc = instructions / cycles 和 ghz = cycles / task_clock_ns"""
+        rows = json.loads(_read(LIB_LLAISYS.llaisysProfilerCounters))
+        for r in rows:
+            if r.get("cycles"):
+                if "instructions" in r:
+                    r["ipc"] = r["instructions"] / r["cycles"]
+                if r.get("task_clock_ns"):
+                    r["ghz"] = r["cycles"] / r["task_clock_ns"]
+        return rows
+
+    def __enter__(self):
+        self.clear()
+        if self._counters:
+            self.enable_counters()
+        self.enable()
+        return self
+
+    def __exit__(self, *exc):
+        self.disable()
+        if self._counters:
+            self.disable_counters()
+        return False
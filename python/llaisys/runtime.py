@@ -1,5 +1,6 @@
 from . import libllaisys
 from .libllaisys import LIB_LLAISYS
+from .libllaisys.runtime import host_func_t
 from ctypes import c_void_p
 
 
@@ -8,6 +9,8 @@ class RuntimeAPI:
         self._api = LIB_LLAISYS.llaisysGetRuntimeAPI(
             libllaisys.llaisysDeviceType_t(device_type)
         )
+        # 排进 stream 的 Python 回调在执行前不能被回收
+        self._host_funcs = []
 
     def get_device_count(self) -> int:
         result = self._api.contents.get_device_count()
@@ -66,3 +69,28 @@ class RuntimeAPI:
         self._api.contents.memcpy_async(
             dst, src, size, libllaisys.llaisysMemcpyKind_t(kind), stream
         )
+
+    def launch_host_func(self, stream: libllaisys.llaisysStream_t, fn) -> None:
+        """把 fn() 排进 stream，在之前提交的任务完成后执行。"""
+        callback = host_func_t(lambda _: fn())
+        self._host_funcs.append(callback)
+        self._api.contents.launch_host_func(stream, callback, None)
+
+    def create_event(self) -> libllaisys.llaisysEvent_t:
+        return self._api.contents.create_event()
+
+    def destroy_event(self, event: libllaisys.llaisysEvent_t) -> None:
+        self._api.contents.destroy_event(event)
+
+    def event_record(
+        self, event: libllaisys.llaisysEvent_t, stream: libllaisys.llaisysStream_t
+    ) -> None:
+        self._api.contents.event_record(event, stream)
+
+    def stream_wait_event(
+        self, stream: libllaisys.llaisysStream_t, event: libllaisys.llaisysEvent_t
+    ) -> None:
+        self._api.contents.stream_wait_event(stream, event)
+
+    def event_synchronize(self, event: libllaisys.llaisysEvent_t) -> None:
+        self._api.contents.event_synchronize(event)
@@ -95,3 +95,12 @@ class Tensor:
                 self._tensor, c_size_t(dim), c_size_t(start), c_size_t(end)
             )
         )
+
+    def contiguous(self):
+        return Tensor(tensor=LIB_LLAISYS.tensorContiguous(self._tensor))
+
+    def reshape(self, *shape: int):
+        _shape = (c_size_t * len(shape))(*shape)
+        return Tensor(
+            tensor=LIB_LLAISYS.tensorReshape(self._tensor, _shape, c_size_t(len(shape)))
+        )
@@ -1,11 +1,20 @@
 #include "../runtime_api.hpp"
+#include "cpu_stream.hpp"
 
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace llaisys::device::cpu {
 
 namespace runtime_api {
+// 所有存活的 stream，deviceSynchronize 逐个等待。句柄是裸指针，这里持有共享所有权：
+// 等待时不持有锁（排进 stream 的主机函数可以创建 / 销毁 stream），正在被等待的 stream 也不会被释放
+std::mutex streams_mutex;
+std::unordered_map<Stream *, std::shared_ptr<Stream>> streams;
+
 int getDeviceCount() {
     return 1;
 }
@@ -15,18 +24,48 @@ void setDevice(int) {
 }
 
 void deviceSynchronize() {
-    // do nothing
+    std::vector<std::shared_ptr<Stream>> alive;
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex);
+        for (auto &[ptr, stream] : streams) {
+            alive.push_back(stream);
+        }
+    }
+    for (auto &stream : alive) {
+        stream->synchronize();
+    }
 }
 
+// 每个 stream 有自己的工作线程，提交到不同 stream 的任务可以并发执行；
+// 空 stream（nullptr）是默认 stream，提交给它的任务在调用线程上同步执行
 llaisysStream_t createStream() {
-    return (llaisysStream_t)0; // null stream
+    auto stream = std::make_shared<Stream>();
+    std::lock_guard<std::mutex> lock(streams_mutex);
+    streams.emplace(stream.get(), stream);
+    return stream.get();
 }
 
+// 最后一个引用释放时执行完剩下的任务并退出工作线程；正被 deviceSynchronize 等待时推迟到它等完之后
 void destroyStream(llaisysStream_t stream) {
-    // do nothing
+    if (stream == nullptr) {
+        return;
+    }
+    std::shared_ptr<Stream> s;
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex);
+        auto it = streams.find(static_cast<Stream *>(stream));
+        if (it == streams.end()) {
+            return;
+        }
+        s = std::move(it->second);
+        streams.erase(it);
+    }
 }
+
 void streamSynchronize(llaisysStream_t stream) {
-    // do nothing
+    if (stream != nullptr) {
+        static_cast<Stream *>(stream)->synchronize();
+    }
 }
 
 void *mallocDevice(size_t size) {
@@ -50,7 +89,32 @@ void memcpySync(void *dst, const void *src, size_t size, llaisysMemcpyKind_t kin
 }
 
 void memcpyAsync(void *dst, const void *src, size_t size, llaisysMemcpyKind_t kind, llaisysStream_t stream) {
-    memcpySync(dst, src, size, kind);
+    launch(stream, [=] { memcpySync(dst, src, size, kind); });
+}
+
+void launchHostFunc(llaisysStream_t stream, void (*fn)(void *), void *user_data) {
+    launch(stream, [=] { fn(user_data); });
+}
+
+llaisysEvent_t createEvent() {
+    return new Event();
+}
+
+void destroyEvent(llaisysEvent_t event) {
+    // 已经排进 stream 的 record / wait 持有 event 的状态，可以直接释放
+    delete static_cast<Event *>(event);
+}
+
+void eventRecord(llaisysEvent_t event, llaisysStream_t stream) {
+    static_cast<Event *>(event)->record(static_cast<Stream *>(stream));
+}
+
+void streamWaitEvent(llaisysStream_t stream, llaisysEvent_t event) {
+    static_cast<Event *>(event)->wait(static_cast<Stream *>(stream));
+}
+
+void eventSynchronize(llaisysEvent_t event) {
+    static_cast<Event *>(event)->synchronize();
 }
 
 static const LlaisysRuntimeAPI RUNTIME_API = {
@@ -65,7 +129,13 @@ static const LlaisysRuntimeAPI RUNTIME_API = {
     &mallocHost,
     &freeHost,
     &memcpySync,
-    &memcpyAsync};
+    &memcpyAsync,
+    &launchHostFunc,
+    &createEvent,
+    &destroyEvent,
+    &eventRecord,
+    &streamWaitEvent,
+    &eventSynchronize};
 
 } // namespace runtime_api
 
@@ -0,0 +1,113 @@
+#include "cpu_stream.hpp"
+
+#include <algorithm>
+
+namespace llaisys::device::cpu {
+Stream::Stream() : _worker(&Stream::_run, this) {}
+
+Stream::~Stream() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_one();
+    _worker.join();
+}
+
+void Stream::_run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        _wake.wait(lock, [this] { return _stop || !_queue.empty(); });
+        if (_queue.empty()) {
+            return; // _stop 且已经没有任务
+        }
+        auto task = std::move(_queue.front());
+        _queue.pop_front();
+        _busy = true;
+        lock.unlock();
+        try {
+            task();
+        } catch (...) {
+            lock.lock();
+            if (!_error) {
+                _error = std::current_exception();
+            }
+            lock.unlock();
+        }
+        lock.lock();
+        _busy = false;
+        if (_queue.empty()) {
+            _idle.notify_all();
+        }
+    }
+}
+
+void Stream::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push_back(std::move(task));
+    }
+    _wake.notify_one();
+}
+
+void Stream::synchronize() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this] { return _queue.empty() && !_busy; });
+    if (_error) {
+        auto error = _error;
+        _error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void Event::record(Stream *stream) {
+    auto state = _state;
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        id = ++state->recorded;
+    }
+    auto complete = [state, id] {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->completed = std::max(state->completed, id);
+        }
+        state->done.notify_all();
+    };
+    if (stream == nullptr) {
+        complete();
+    } else {
+        stream->enqueue(complete);
+    }
+}
+
+void Event::wait(Stream *stream) {
+    auto state = _state;
+    uint64_t target;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        target = state->recorded;
+    }
+    auto block = [state, target] {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&] { return state->completed >= target; });
+    };
+    if (stream == nullptr) {
+        block();
+    } else {
+        stream->enqueue(block);
+    }
+}
+
+void Event::synchronize() {
+    wait(nullptr);
+}
+
+void launch(llaisysStream_t stream, std::function<void()> task) {
+    if (stream == nullptr) {
+        task();
+    } else {
+        static_cast<Stream *>(stream)->enqueue(std::move(task));
+    }
+}
+} // namespace llaisys::device::cpu
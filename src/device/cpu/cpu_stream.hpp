@@ -0,0 +1,63 @@
+#pragma once
+
+#include "llaisys.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace llaisys::device::cpu {
+// CPU stream：一个工作线程按提交顺序执行的任务队列。
+// 任务抛出的异常会被记下来，在下一次 synchronize 时重新抛出（之后的任务照常执行）
+class Stream {
+private:
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _idle;
+    std::deque<std::function<void()>> _queue;
+    bool _busy = false;
+    bool _stop = false;
+    std::exception_ptr _error;
+    std::thread _worker;
+
+    void _run();
+
+public:
+    Stream();
+    // 先执行完已经提交的任务再退出
+    ~Stream();
+
+    Stream(const Stream &) = delete;
+    Stream &operator=(const Stream &) = delete;
+
+    void enqueue(std::function<void()> task);
+    void synchronize();
+};
+
+// Event：每次 record 在 stream 中排入一个标记，标记被执行时 event 完成。
+// wait / synchronize 只等调用时最近一次 record，之后的 record 不影响已经开始的等待
+class Event {
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable done;
+        uint64_t recorded = 0;
+        uint64_t completed = 0;
+    };
+    std::shared_ptr<State> _state = std::make_shared<State>();
+
+public:
+    void record(Stream *stream);
+    // 在 stream 中排入一个等待：之后提交的任务要等 event 完成才执行；stream 为空时直接阻塞调用者
+    void wait(Stream *stream);
+    void synchronize();
+};
+
+// 把任意主机工作（例如一个算子）排进 stream；空 stream 表示默认 stream，直接同步执行
+void launch(llaisysStream_t stream, std::function<void()> task);
+} // namespace llaisys::device::cpu
@@ -49,7 +49,31 @@ void memcpySync(void *dst, const void *src, size_t size, llaisysMemcpyKind_t kin
     TO_BE_IMPLEMENTED();
 }
 
-void memcpyAsync(void *dst, const void *src, size_t size, llaisysMemcpyKind_t kind) {
+void memcpyAsync(void *dst, const void *src, size_t size, llaisysMemcpyKind_t kind, llaisysStream_t stream) {
+    TO_BE_IMPLEMENTED();
+}
+
+void launchHostFunc(llaisysStream_t stream, void (*fn)(void *), void *user_data) {
+    TO_BE_IMPLEMENTED();
+}
+
+llaisysEvent_t createEvent() {
+    TO_BE_IMPLEMENTED();
+}
+
+void destroyEvent(llaisysEvent_t event) {
+    TO_BE_IMPLEMENTED();
+}
+
+void eventRecord(llaisysEvent_t event, llaisysStream_t stream) {
+    TO_BE_IMPLEMENTED();
+}
+
+void streamWaitEvent(llaisysStream_t stream, llaisysEvent_t event) {
+    TO_BE_IMPLEMENTED();
+}
+
+void eventSynchronize(llaisysEvent_t event) {
     TO_BE_IMPLEMENTED();
 }
 
@@ -65,7 +89,13 @@ static const LlaisysRuntimeAPI RUNTIME_API = {
     &mallocHost,
     &freeHost,
     &memcpySync,
-    &memcpyAsync};
+    &memcpyAsync,
+    &launchHostFunc,
+    &createEvent,
+    &destroyEvent,
+    &eventRecord,
+    &streamWaitEvent,
+    &eventSynchronize};
 
 } // namespace runtime_api
 
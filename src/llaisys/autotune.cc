@@ -0,0 +1,44 @@
+#include "llaisys/autotune.h"
+
+#include "../utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+size_t copy_out(const std::string &s, char *buf, size_t capacity) {
+    if (buf && capacity > 0) {
+        const size_t n = std::min(s.size(), capacity - 1);
+        std::memcpy(buf, s.data(), n);
+        buf[n] = '\0';
+    }
+    return s.size();
+}
+} // namespace
+
+__C {
+    void llaisysAutotuneSetMode(llaisysAutotuneMode_t mode) {
+        CHECK_ARGUMENT(mode >= LLAISYS_AUTOTUNE_OFF && mode <= LLAISYS_AUTOTUNE_ON, "Autotune: invalid mode");
+        llaisys::autotune::setMode(static_cast<llaisys::autotune::Mode>(mode));
+    }
+
+    llaisysAutotuneMode_t llaisysAutotuneMode() {
+        return static_cast<llaisysAutotuneMode_t>(llaisys::autotune::mode());
+    }
+
+    void llaisysAutotuneSetCachePath(const char *path) {
+        llaisys::autotune::setCachePath(path ? path : "");
+    }
+
+    size_t llaisysAutotuneCachePath(char *buf, size_t capacity) {
+        return copy_out(llaisys::autotune::cachePath(), buf, capacity);
+    }
+
+    size_t llaisysAutotuneEntries(char *buf, size_t capacity) {
+        return copy_out(llaisys::autotune::entries(), buf, capacity);
+    }
+
+    void llaisysAutotuneClear() {
+        llaisys::autotune::clear();
+    }
+}
@@ -0,0 +1,257 @@
+#include "llaisys/models/qwen2.h"
+
+#include "../llaisys_tensor.hpp"
+
+#include "../../models/qwen2/qwen2.hpp"
+#include "../../utils.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+__C {
+    struct LlaisysQwen2Model {
+        std::unique_ptr<llaisys::models::Qwen2> model;
+        LlaisysQwen2Weights weights;
+        // 每层权重句柄数组，weights 中的指针指向这里
+        std::vector<std::vector<llaisysTensor_t>> layer_handles;
+        std::vector<llaisysTensor_t> handles;
+    };
+
+    static llaisysTensor_t wrapTensor(LlaisysQwen2Model * model, llaisys::tensor_t tensor) {
+        auto handle = new LlaisysTensor{tensor};
+        model->handles.push_back(handle);
+        return handle;
+    }
+
+    static llaisysTensor_t *wrapLayers(LlaisysQwen2Model * model, const std::vector<llaisys::tensor_t> &tensors) {
+        std::vector<llaisysTensor_t> layer;
+        for (auto &tensor : tensors) {
+            layer.push_back(wrapTensor(model, tensor));
+        }
+        model->layer_handles.push_back(std::move(layer));
+        return model->layer_handles.back().data();
+    }
+
+    struct LlaisysQwen2Model *llaisysQwen2ModelCreate(const LlaisysQwen2Meta *meta, llaisysDeviceType_t device, int *device_ids, int ndevice) {
+        int device_id = (device_ids != nullptr && ndevice > 0) ? device_ids[0] : 0;
+        auto model = new LlaisysQwen2Model;
+        model->model = std::make_unique<llaisys::models::Qwen2>(*meta, device, device_id);
+        // 先预留，保证 push_back 时内部数组地址不变
+        model->layer_handles.reserve(12);
+
+        auto &w = model->model->weights();
+        model->weights.in_embed = wrapTensor(model, w.in_embed);
+        model->weights.out_embed = wrapTensor(model, w.out_embed);
+        model->weights.out_norm_w = wrapTensor(model, w.out_norm_w);
+        model->weights.attn_norm_w = wrapLayers(model, w.attn_norm_w);
+        model->weights.attn_q_w = wrapLayers(model, w.attn_q_w);
+        model->weights.attn_q_b = wrapLayers(model, w.attn_q_b);
+        model->weights.attn_k_w = wrapLayers(model, w.attn_k_w);
+        model->weights.attn_k_b = wrapLayers(model, w.attn_k_b);
+        model->weights.attn_v_w = wrapLayers(model, w.attn_v_w);
+        model->weights.attn_v_b = wrapLayers(model, w.attn_v_b);
+        model->weights.attn_o_w = wrapLayers(model, w.attn_o_w);
+        model->weights.mlp_norm_w = wrapLayers(model, w.mlp_norm_w);
+        model->weights.mlp_gate_w = wrapLayers(model, w.mlp_gate_w);
+        model->weights.mlp_up_w = wrapLayers(model, w.mlp_up_w);
+        model->weights.mlp_down_w = wrapLayers(model, w.mlp_down_w);
+        return model;
+    }
+
+    void llaisysQwen2ModelDestroy(struct LlaisysQwen2Model * model) {
+        if (model == nullptr) {
+            return;
+        }
+        for (auto handle : model->handles) {
+            delete handle;
+        }
+        delete model;
+    }
+
+    struct LlaisysQwen2Weights *llaisysQwen2ModelWeights(struct LlaisysQwen2Model * model) {
+        return &model->weights;
+    }
+
+    int64_t llaisysQwen2ModelInfer(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken) {
+        return model->model->infer(token_ids, ntoken);
+    }
+
+    llaisysTensor_t llaisysQwen2ModelLogits(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, llaisysQwen2LogitPositions_t positions) {
+        size_t nlogits = 0;
+        switch (positions) {
+        case LLAISYS_QWEN2_LOGITS_LAST:
+            nlogits = 1;
+            break;
+        case LLAISYS_QWEN2_LOGITS_ALL:
+            nlogits = ntoken;
+            break;
+        default:
+            CHECK_ARGUMENT(false, "Qwen2: unknown logit positions");
+        }
+        return new LlaisysTensor{model->model->logits(token_ids, ntoken, nlogits)};
+    }
+
+    size_t llaisysQwen2ModelScore(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t * ntokens, size_t * prompt_lens, size_t nrequest, float * logprobs) {
+        std::vector<llaisys::models::ScoreRequest> requests;
+        for (size_t i = 0; i < nrequest; i++) {
+            requests.push_back({token_ids, ntokens[i], prompt_lens[i]});
+            token_ids += ntokens[i];
+        }
+        auto result = model->model->score(requests);
+        std::copy(result.begin(), result.end(), logprobs);
+        return result.size();
+    }
+
+    int64_t llaisysQwen2ModelInferSample(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, float temperature, int64_t top_k, float top_p) {
+        return model->model->infer(token_ids, ntoken, temperature, top_k, top_p);
+    }
+
+    void llaisysQwen2ModelSetChunkSize(struct LlaisysQwen2Model * model, size_t token_budget) {
+        model->model->setChunkSize(token_budget);
+    }
+
+    int64_t llaisysQwen2ModelAddRequest(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, size_t max_new_tokens) {
+        return model->model->addRequest(token_ids, ntoken, max_new_tokens);
+    }
+
+    int64_t llaisysQwen2ModelAddLookupRequest(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, size_t max_new_tokens, size_t num_lookup_tokens, size_t max_ngram) {
+        return model->model->addRequest(token_ids, ntoken, max_new_tokens, num_lookup_tokens, max_ngram);
+    }
+
+    size_t llaisysQwen2ModelStep(struct LlaisysQwen2Model * model, struct LlaisysQwen2StepOutput * outputs, size_t capacity) {
+        auto results = model->model->step();
+        CHECK_ARGUMENT(results.size() <= capacity, "Qwen2: step output buffer is too small");
+        for (size_t i = 0; i < results.size(); i++) {
+            outputs[i].request_id = results[i].request_id;
+            outputs[i].token = results[i].token;
+            outputs[i].finished = uint8_t(results[i].finished);
+        }
+        return results.size();
+    }
+
+    size_t llaisysQwen2ModelNumRequests(struct LlaisysQwen2Model * model) {
+        return model->model->numRequests();
+    }
+
+    void llaisysQwen2ModelSetStreaming(struct LlaisysQwen2Model * model, size_t sink, size_t window) {
+        model->model->setStreaming(sink, window);
+    }
+
+    void llaisysQwen2ModelSetSparseAttention(struct LlaisysQwen2Model * model, size_t page_size, size_t top_pages, size_t recent) {
+        model->model->setSparseAttention(page_size, top_pages, recent);
+    }
+
+    void llaisysQwen2ModelSetPrefixCache(struct LlaisysQwen2Model * model, size_t block_size, size_t budget_bytes) {
+        model->model->setPrefixCache(block_size, budget_bytes);
+    }
+
+    void llaisysQwen2ModelSetKVOffload(struct LlaisysQwen2Model * model, const char * dir, size_t budget_bytes) {
+        model->model->setKVOffload(dir ? dir : "", budget_bytes);
+    }
+
+    void llaisysQwen2ModelSaveCache(struct LlaisysQwen2Model * model, const char * path) {
+        model->model->saveCache(path);
+    }
+
+    size_t llaisysQwen2ModelLoadCache(struct LlaisysQwen2Model * model, const char * path, int64_t * out_tokens, size_t capacity) {
+        auto tokens = model->model->loadCache(path);
+        std::copy(tokens.begin(), tokens.begin() + std::min(tokens.size(), capacity), out_tokens);
+        return tokens.size();
+    }
+
+    void llaisysQwen2ModelPrefixCacheStats(struct LlaisysQwen2Model * model, struct LlaisysQwen2PrefixCacheStats * stats) {
+        auto s = model->model->prefixCacheStats();
+        stats->lookups = s.lookups;
+        stats->hits = s.hits;
+        stats->query_tokens = s.query_tokens;
+        stats->hit_tokens = s.hit_tokens;
+        stats->cached_blocks = s.cached_blocks;
+        stats->cached_bytes = s.cached_bytes;
+        stats->evicted_blocks = s.evicted_blocks;
+        stats->offloaded_blocks = s.offloaded_blocks;
+        stats->offloaded_bytes = s.offloaded_bytes;
+        stats->paged_in_blocks = s.paged_in_blocks;
+    }
+
+    size_t llaisysQwen2ModelSpeculativeStep(struct LlaisysQwen2Model * model, struct LlaisysQwen2Model * draft, int64_t * token_ids, size_t ntoken, size_t num_draft_tokens, float temperature, int64_t * out_tokens) {
+        auto tokens = model->model->speculate(*draft->model, token_ids, ntoken, num_draft_tokens, temperature);
+        std::copy(tokens.begin(), tokens.end(), out_tokens);
+        return tokens.size();
+    }
+
+    size_t llaisysQwen2ModelLookupStep(struct LlaisysQwen2Model * model, int64_t * token_ids, size_t ntoken, size_t num_lookup_tokens, size_t max_ngram, float temperature, int64_t * out_tokens) {
+        auto tokens = model->model->lookupStep(token_ids, ntoken, num_lookup_tokens, max_ngram, temperature);
+        std::copy(tokens.begin(), tokens.end(), out_tokens);
+        return tokens.size();
+    }
+
+    void llaisysQwen2ModelSpeculativeStats(struct LlaisysQwen2Model * model, struct LlaisysQwen2SpeculativeStats * stats) {
+        auto s = model->model->speculativeStats();
+        stats->steps = s.steps;
+        stats->proposed = s.proposed;
+        stats->accepted = s.accepted;
+        stats->generated = s.generated;
+    }
+
+    void llaisysQwen2ModelSetSeed(struct LlaisysQwen2Model * model, uint64_t seed) {
+        model->model->setSeed(seed);
+    }
+
+    void llaisysQwen2ModelSetTrace(struct LlaisysQwen2Model * model, const char * path, llaisysQwen2TraceContent_t content) {
+        model->model->setTrace(path ? path : "", content);
+    }
+
+    struct LlaisysQwen2Trace {
+        llaisys::models::RequestTrace trace;
+    };
+
+    struct LlaisysQwen2Trace *llaisysQwen2TraceLoad(const char * path) {
+        CHECK_ARGUMENT(path != nullptr, "Qwen2: trace path is null");
+        return new LlaisysQwen2Trace{llaisys::models::RequestTrace(path)};
+    }
+
+    void llaisysQwen2TraceDestroy(struct LlaisysQwen2Trace * trace) {
+        delete trace;
+    }
+
+    void llaisysQwen2TraceMeta(struct LlaisysQwen2Trace * trace, LlaisysQwen2Meta * meta) {
+        *meta = trace->trace.meta();
+    }
+
+    llaisysQwen2TraceContent_t llaisysQwen2TraceContent(struct LlaisysQwen2Trace * trace) {
+        return trace->trace.content();
+    }
+
+    size_t llaisysQwen2TraceNumRequests(struct LlaisysQwen2Trace * trace) {
+        return trace->trace.requests().size();
+    }
+
+    void llaisysQwen2TraceGetRequest(struct LlaisysQwen2Trace * trace, size_t index, struct LlaisysQwen2TraceRequest * request) {
+        CHECK_ARGUMENT(index < trace->trace.requests().size(), "Qwen2: trace index out of range");
+        const auto &r = trace->trace.requests()[index];
+        request->kind = r.kind;
+        request->request_id = r.request_id;
+        request->arrival_ns = r.arrival_ns;
+        request->finish_ns = r.finish_ns;
+        request->prompt_len = r.prompt_len;
+        request->shared_prefix = r.shared;
+        request->max_new_tokens = r.max_new_tokens;
+        request->generated = r.generated;
+        request->lookup_tokens = r.lookup_tokens;
+        request->lookup_ngram = r.lookup_ngram;
+        request->temperature = r.temperature;
+        request->top_k = r.top_k;
+        request->top_p = r.top_p;
+    }
+
+    size_t llaisysQwen2TracePrompt(struct LlaisysQwen2Trace * trace, size_t index, size_t voc, int64_t * out) {
+        const auto &prompt = trace->trace.prompt(index, voc);
+        std::copy(prompt.begin(), prompt.end(), out);
+        return prompt.size();
+    }
+
+    void llaisysQwen2TraceSetOutput(struct LlaisysQwen2Trace * trace, size_t index, const int64_t * tokens, size_t ntoken) {
+        trace->trace.setOutput(index, tokens, ntoken);
+    }
+}
@@ -4,11 +4,17 @@
 
 #include "../ops/add/op.hpp"
 #include "../ops/argmax/op.hpp"
+#include "../ops/cast/op.hpp"
 #include "../ops/embedding/op.hpp"
+#include "../ops/kv_page_summary/op.hpp"
 #include "../ops/linear/op.hpp"
+#include "../ops/lm_head/op.hpp"
+#include "../ops/pointwise/op.hpp"
 #include "../ops/rearrange/op.hpp"
 #include "../ops/rms_norm/op.hpp"
 #include "../ops/rope/op.hpp"
+#include "../ops/sample/op.hpp"
+#include "../ops/scale/op.hpp"
 #include "../ops/self_attention/op.hpp"
 #include "../ops/swiglu/op.hpp"
 
@@ -19,11 +25,23 @@ __C {
     void llaisysArgmax(llaisysTensor_t max_idx, llaisysTensor_t max_val, llaisysTensor_t vals) {
         llaisys::ops::argmax(max_idx->tensor, max_val->tensor, vals->tensor);
     }
+    void llaisysCast(llaisysTensor_t out, llaisysTensor_t in) {
+        llaisys::ops::cast(out->tensor, in->tensor);
+    }
     void llaisysEmbedding(llaisysTensor_t out, llaisysTensor_t index, llaisysTensor_t weight) {
         llaisys::ops::embedding(out->tensor, index->tensor, weight->tensor);
     }
+    void llaisysKVPageSummary(llaisysTensor_t page_min, llaisysTensor_t page_max, llaisysTensor_t k, size_t page_size, size_t begin) {
+        llaisys::ops::kv_page_summary(page_min->tensor, page_max->tensor, k->tensor, page_size, begin);
+    }
     void llaisysLinear(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t weight, llaisysTensor_t bias) {
-        llaisys::ops::linear(out->tensor, in->tensor, weight->tensor, bias->tensor);
+        llaisys::ops::linear(out->tensor, in->tensor, weight->tensor, bias ? bias->tensor : nullptr);
+    }
+    void llaisysLMHeadLogprob(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t norm_w, llaisysTensor_t weight, llaisysTensor_t targets, float eps) {
+        llaisys::ops::lm_head_logprob(out->tensor, in->tensor, norm_w->tensor, weight->tensor, targets->tensor, eps);
+    }
+    void llaisysLMHeadTopK(llaisysTensor_t out_idx, llaisysTensor_t out_val, llaisysTensor_t in, llaisysTensor_t norm_w, llaisysTensor_t weight, float eps) {
+        llaisys::ops::lm_head_topk(out_idx->tensor, out_val->tensor, in->tensor, norm_w->tensor, weight->tensor, eps);
     }
     void llaisysRearrange(llaisysTensor_t out, llaisysTensor_t in) {
         llaisys::ops::rearrange(out->tensor, in->tensor);
@@ -34,10 +52,32 @@ __C {
     void llaisysROPE(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t pos_ids, float theta) {
         llaisys::ops::rope(out->tensor, in->tensor, pos_ids->tensor, theta);
     }
+    void llaisysSample(llaisysTensor_t out_idx, llaisysTensor_t logits, float temperature, int64_t top_k, float top_p, uint64_t seed) {
+        llaisys::ops::sample(out_idx->tensor, logits->tensor, temperature, top_k, top_p, seed);
+    }
+    void llaisysScale(llaisysTensor_t out, llaisysTensor_t in, float alpha) {
+        llaisys::ops::scale(out->tensor, in->tensor, alpha);
+    }
     void llaisysSelfAttention(llaisysTensor_t attn_val, llaisysTensor_t q, llaisysTensor_t k, llaisysTensor_t v, float scale) {
         llaisys::ops::self_attention(attn_val->tensor, q->tensor, k->tensor, v->tensor, scale);
     }
+    void llaisysSelfAttentionVarlen(llaisysTensor_t attn_val, llaisysTensor_t q, llaisysTensor_t k, llaisysTensor_t v, llaisysTensor_t cu_seqlens_q, llaisysTensor_t cu_seqlens_k, float scale) {
+        llaisys::ops::self_attention_varlen(attn_val->tensor, q->tensor, k->tensor, v->tensor, cu_seqlens_q->tensor, cu_seqlens_k->tensor, scale);
+    }
     void llaisysSwiGLU(llaisysTensor_t out, llaisysTensor_t gate, llaisysTensor_t up) {
         llaisys::ops::swiglu(out->tensor, gate->tensor, up->tensor);
     }
+
+    void llaisysLazyBegin() {
+        llaisys::ops::pointwise::begin();
+    }
+    void llaisysLazyEnd() {
+        llaisys::ops::pointwise::end();
+    }
+    void llaisysLazySync() {
+        llaisys::ops::pointwise::sync();
+    }
+    size_t llaisysLazyCachedKernels() {
+        return llaisys::ops::pointwise::cachedKernels();
+    }
 }
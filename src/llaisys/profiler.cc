@@ -0,0 +1,67 @@
+#include "llaisys/profiler.h"
+
+#include "../utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+size_t copy_out(const std::string &s, char *buf, size_t capacity) {
+    if (buf && capacity > 0) {
+        const size_t n = std::min(s.size(), capacity - 1);
+        std::memcpy(buf, s.data(), n);
+        buf[n] = '\0';
+    }
+    return s.size();
+}
+} // namespace
+
+__C {
+    void llaisysProfilerSetEnabled(uint8_t enabled) {
+        llaisys::profiler::setEnabled(enabled != 0);
+    }
+
+    uint8_t llaisysProfilerEnabled() {
+        return llaisys::profiler::enabled() ? 1 : 0;
+    }
+
+    void llaisysProfilerClear() {
+        llaisys::profiler::clear();
+    }
+
+    size_t llaisysProfilerChromeTrace(char *buf, size_t capacity) {
+        return copy_out(llaisys::profiler::chromeTrace(), buf, capacity);
+    }
+
+    size_t llaisysProfilerSummary(char *buf, size_t capacity) {
+        return copy_out(llaisys::profiler::summary(), buf, capacity);
+    }
+
+    void llaisysProfilerSaveChromeTrace(const char *path) {
+        std::ofstream out(path, std::ios::trunc);
+        CHECK_ARGUMENT(out.good(), std::string("Profiler: cannot open ") + path);
+        out << llaisys::profiler::chromeTrace();
+    }
+
+    void llaisysProfilerSetRoofline(double peak_gflops, double peak_gbps) {
+        CHECK_ARGUMENT(peak_gflops >= 0 && peak_gbps >= 0, "Profiler: roofline peaks must be non-negative");
+        llaisys::profiler::setRoofline(peak_gflops, peak_gbps);
+    }
+
+    uint8_t llaisysProfilerSetCountersEnabled(uint8_t enabled) {
+        return llaisys::profiler::counters::setEnabled(enabled != 0) ? 1 : 0;
+    }
+
+    uint8_t llaisysProfilerCountersEnabled() {
+        return llaisys::profiler::counters::enabled() ? 1 : 0;
+    }
+
+    size_t llaisysProfilerCountersStatus(char *buf, size_t capacity) {
+        return copy_out(llaisys::profiler::counters::status(), buf, capacity);
+    }
+
+    size_t llaisysProfilerCounters(char *buf, size_t capacity) {
+        return copy_out(llaisys::profiler::countersJson(), buf, capacity);
+    }
+}
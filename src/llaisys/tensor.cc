@@ -1,5 +1,7 @@
 #include "llaisys_tensor.hpp"
 
+#include "../ops/pointwise/op.hpp"
+
 #include <vector>
 
 __C {
@@ -9,7 +11,7 @@ __C {
         llaisysDataType_t dtype,
         llaisysDeviceType_t device_type,
         int device_id) {
-        std::vector<size_t> shape_vec(shape, shape + ndim);
+        llaisys::shape_t shape_vec(shape, shape + ndim);
         return new LlaisysTensor{llaisys::Tensor::create(shape_vec, dtype, device_type, device_id)};
     }
 
@@ -20,6 +22,8 @@ __C {
 
     void *tensorGetData(
         llaisysTensor_t tensor) {
+        // 调用者会直接读写数据，先执行延迟的逐元素运算
+        llaisys::ops::pointwise::sync();
         return tensor->tensor->data();
     }
 
@@ -57,6 +61,7 @@ __C {
 
     void tensorDebug(
         llaisysTensor_t tensor) {
+        llaisys::ops::pointwise::sync();
         tensor->tensor->debug();
     }
 
@@ -68,6 +73,7 @@ __C {
     void tensorLoad(
         llaisysTensor_t tensor,
         const void *data) {
+        llaisys::ops::pointwise::sync();
         tensor->tensor->load(data);
     }
 
@@ -75,14 +81,14 @@ __C {
         llaisysTensor_t tensor,
         size_t * shape,
         size_t ndim) {
-        std::vector<size_t> shape_vec(shape, shape + ndim);
+        llaisys::shape_t shape_vec(shape, shape + ndim);
         return new LlaisysTensor{tensor->tensor->view(shape_vec)};
     }
 
     llaisysTensor_t tensorPermute(
         llaisysTensor_t tensor,
         size_t * order) {
-        std::vector<size_t> order_vec(order, order + tensor->tensor->ndim());
+        llaisys::shape_t order_vec(order, order + tensor->tensor->ndim());
         return new LlaisysTensor{tensor->tensor->permute(order_vec)};
     }
 
@@ -93,4 +99,17 @@ __C {
         size_t end) {
         return new LlaisysTensor{tensor->tensor->slice(dim, start, end)};
     }
+
+    llaisysTensor_t tensorContiguous(
+        llaisysTensor_t tensor) {
+        return new LlaisysTensor{tensor->tensor->contiguous()};
+    }
+
+    llaisysTensor_t tensorReshape(
+        llaisysTensor_t tensor,
+        size_t *shape,
+        size_t ndim) {
+        llaisys::shape_t shape_vec(shape, shape + ndim);
+        return new LlaisysTensor{tensor->tensor->reshape(shape_vec)};
+    }
 }
@@ -0,0 +1,133 @@
+#include "cold_store.hpp"
+
+#include "../../utils.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace llaisys::models {
+namespace {
+std::string temp_path(const std::string &dir) {
+    static std::atomic<size_t> counter{0};
+#ifdef _WIN32
+    const auto pid = static_cast<size_t>(GetCurrentProcessId());
+#else
+    const auto pid = static_cast<size_t>(getpid());
+#endif
+    return dir + "/llaisys-kv-" + std::to_string(pid) + "-" + std::to_string(counter++) + ".bin";
+}
+} // namespace
+
+ColdStore::ColdStore(const std::string &dir, size_t slot_bytes, size_t budget_bytes)
+    : _slot_bytes(slot_bytes), _nslots(slot_bytes > 0 ? budget_bytes / slot_bytes : 0), _data(nullptr) {
+    CHECK_ARGUMENT(_nslots > 0, "ColdStore: budget is smaller than one block");
+    const size_t bytes = _slot_bytes * _nslots;
+#ifdef _WIN32
+    _file = INVALID_HANDLE_VALUE;
+    if (!dir.empty()) {
+        _file = CreateFileA(temp_path(dir).c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_NEW,
+                            FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+        CHECK_ARGUMENT(_file != INVALID_HANDLE_VALUE, "ColdStore: cannot create the offload file");
+    }
+    _mapping = CreateFileMappingA(_file, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32),
+                                  static_cast<DWORD>(bytes & 0xffffffffu), nullptr);
+    if (_mapping != nullptr) {
+        _data = static_cast<std::byte *>(MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes));
+    }
+    if (_data == nullptr) {
+        if (_mapping != nullptr) {
+            CloseHandle(_mapping);
+        }
+        if (_file != INVALID_HANDLE_VALUE) {
+            CloseHandle(_file);
+        }
+        throw std::runtime_error("ColdStore: cannot map the offload storage");
+    }
+#else
+    void *addr = MAP_FAILED;
+    if (dir.empty()) {
+        addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    } else {
+        const auto path = temp_path(dir);
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        CHECK_ARGUMENT(fd >= 0, "ColdStore: cannot create the offload file");
+        // 映射建立后文件名就不再需要，进程退出时空间自动回收
+        unlink(path.c_str());
+        if (ftruncate(fd, static_cast<off_t>(bytes)) == 0) {
+            addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+    }
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("ColdStore: cannot map the offload storage");
+    }
+    _data = static_cast<std::byte *>(addr);
+#endif
+    _free.reserve(_nslots);
+    for (size_t slot = _nslots; slot > 0; slot--) {
+        _free.push_back(slot - 1);
+    }
+}
+
+ColdStore::~ColdStore() {
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+    CloseHandle(_mapping);
+    if (_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(_file);
+    }
+#else
+    munmap(_data, _slot_bytes * _nslots);
+#endif
+}
+
+size_t ColdStore::slotBytes() const {
+    return _slot_bytes;
+}
+
+size_t ColdStore::capacity() const {
+    return _nslots;
+}
+
+bool ColdStore::full() const {
+    return _free.empty();
+}
+
+size_t ColdStore::put(const std::byte *src) {
+    ASSERT(!_free.empty(), "ColdStore: no free slot");
+    const size_t slot = _free.back();
+    _free.pop_back();
+    std::memcpy(_data + slot * _slot_bytes, src, _slot_bytes);
+    return slot;
+}
+
+const std::byte *ColdStore::data(size_t slot) const {
+    return _data + slot * _slot_bytes;
+}
+
+void ColdStore::release(size_t slot) {
+    _free.push_back(slot);
+}
+
+void ColdStore::prefetch(size_t slot) const {
+#ifndef _WIN32
+    // madvise 要求地址按页对齐
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const auto begin = reinterpret_cast<uintptr_t>(data(slot)) / page * page;
+    const auto end = reinterpret_cast<uintptr_t>(data(slot)) + _slot_bytes;
+    madvise(reinterpret_cast<void *>(begin), end - begin, MADV_WILLNEED);
+#else
+    (void)slot;
+#endif
+}
+} // namespace llaisys::models
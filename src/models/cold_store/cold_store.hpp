@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace llaisys::models {
+// KV 块的冷存储：固定大小的槽位，放在一段内存映射里。
+// dir 非空时映射 dir 下的一个临时文件（本地 NVMe 等），由操作系统按需换出 / 换入，进程退出后自动删除；
+// dir 为空时映射匿名内存（主机 RAM）。文件在创建时按容量截断，只有写过的槽位才真正占用磁盘。
+class ColdStore {
+private:
+    size_t _slot_bytes;
+    size_t _nslots;
+    std::byte *_data;
+    std::vector<size_t> _free;
+#ifdef _WIN32
+    void *_file;
+    void *_mapping;
+#endif
+
+public:
+    ColdStore(const std::string &dir, size_t slot_bytes, size_t budget_bytes);
+    ~ColdStore();
+
+    ColdStore(const ColdStore &) = delete;
+    ColdStore &operator=(const ColdStore &) = delete;
+
+    size_t slotBytes() const;
+    size_t capacity() const;
+    bool full() const;
+
+    // 写入一个槽位，返回槽位编号；调用前需确认 !full()
+    size_t put(const std::byte *src);
+    const std::byte *data(size_t slot) const;
+    void release(size_t slot);
+    // 提示操作系统提前把槽位读进页缓存（异步），之后的 data() 读取不再阻塞在磁盘上
+    void prefetch(size_t slot) const;
+};
+} // namespace llaisys::models
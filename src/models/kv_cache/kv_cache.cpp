@@ -0,0 +1,217 @@
+#include "kv_cache.hpp"
+
+#include "../../core/llaisys_core.hpp"
+#include "../../ops/kv_page_summary/op.hpp"
+#include "../../utils.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace llaisys::models {
+KVCache::KVCache(size_t nlayer, size_t nkvh, size_t dh, size_t maxseq,
+                 llaisysDataType_t dtype, llaisysDeviceType_t device_type, int device_id,
+                 size_t sink, size_t window, size_t page)
+    : _nlayer(nlayer), _nkvh(nkvh), _dh(dh), _maxseq(maxseq),
+      _dtype(dtype), _device_type(device_type), _device_id(device_id), _capacity(0),
+      _sink(window > 0 ? sink : 0), _window(window), _ring(window > 0 ? 2 * window - 1 : 0), _written(0),
+      _page(page), _k(nlayer), _v(nlayer), _page_min(page > 0 ? nlayer : 0), _page_max(page > 0 ? nlayer : 0) {
+    CHECK_ARGUMENT(page == 0 || window == 0, "KVCache: page summaries do not support the sliding window");
+}
+
+size_t KVCache::size() const {
+    return _tokens.size();
+}
+
+size_t KVCache::capacity() const {
+    return _capacity;
+}
+
+size_t KVCache::maxseq() const {
+    return _maxseq;
+}
+
+size_t KVCache::sink() const {
+    return _sink;
+}
+
+size_t KVCache::window() const {
+    return _window;
+}
+
+size_t KVCache::maxChunk() const {
+    return _window > 0 ? _window : std::numeric_limits<size_t>::max();
+}
+
+size_t KVCache::pageSize() const {
+    return _page;
+}
+
+size_t KVCache::nlayer() const {
+    return _nlayer;
+}
+
+size_t KVCache::rowBytes() const {
+    return _nkvh * _dh * utils::dsize(_dtype);
+}
+
+const std::vector<int64_t> &KVCache::tokens() const {
+    return _tokens;
+}
+
+std::vector<std::pair<size_t, size_t>> KVCache::_rows(size_t pos, size_t n) const {
+    if (_window == 0) {
+        return {{pos, n}};
+    }
+    std::vector<std::pair<size_t, size_t>> rows;
+    if (pos < _sink) {
+        const size_t m = std::min(n, _sink - pos);
+        rows.push_back({pos, m});
+        pos += m;
+        n -= m;
+    }
+    while (n > 0) {
+        const size_t row = _sink + (pos - _sink) % _ring;
+        const size_t m = std::min(n, _sink + _ring - row);
+        rows.push_back({row, m});
+        pos += m;
+        n -= m;
+    }
+    return rows;
+}
+
+size_t KVCache::_oldest() const {
+    if (_window == 0) {
+        return 0;
+    }
+    return _written > _sink + _ring ? _written - _ring : _sink;
+}
+
+void KVCache::reserve(size_t n) {
+    // 流式模式下行数有上限，位置不受 maxseq 限制
+    const size_t limit = _window > 0 ? _sink + _ring : _maxseq;
+    CHECK_ARGUMENT(_window > 0 || n <= _maxseq, "KVCache: sequence length exceeds maxseq");
+    n = std::min(n, limit);
+    if (n <= _capacity) {
+        return;
+    }
+    // 按倍增扩容，避免一次性按 maxseq 分配（maxseq 可能非常大）
+    size_t new_cap = std::max<size_t>(_capacity * 2, 64);
+    new_cap = std::min(std::max(new_cap, n), limit);
+
+    core::context().setDevice(_device_type, _device_id);
+    auto api = core::context().runtime().api();
+    for (size_t l = 0; l < _nlayer; l++) {
+        auto k = Tensor::create({new_cap, _nkvh, _dh}, _dtype, _device_type, _device_id);
+        auto v = Tensor::create({new_cap, _nkvh, _dh}, _dtype, _device_type, _device_id);
+        // 扩容前 ring 还没有回绕，已有内容都在前 size() 行
+        if (size() > 0) {
+            api->memcpy_sync(k->data(), _k[l]->data(), std::min(size(), _capacity) * rowBytes(), LLAISYS_MEMCPY_D2D);
+            api->memcpy_sync(v->data(), _v[l]->data(), std::min(size(), _capacity) * rowBytes(), LLAISYS_MEMCPY_D2D);
+        }
+        _k[l] = k;
+        _v[l] = v;
+        if (_page > 0) {
+            const size_t npages = (new_cap + _page - 1) / _page;
+            auto page_min = Tensor::create({npages, _nkvh, _dh}, LLAISYS_DTYPE_F32, _device_type, _device_id);
+            auto page_max = Tensor::create({npages, _nkvh, _dh}, LLAISYS_DTYPE_F32, _device_type, _device_id);
+            if (_page_min[l]) {
+                const size_t bytes = _page_min[l]->numel() * sizeof(float);
+                api->memcpy_sync(page_min->data(), _page_min[l]->data(), bytes, LLAISYS_MEMCPY_D2D);
+                api->memcpy_sync(page_max->data(), _page_max[l]->data(), bytes, LLAISYS_MEMCPY_D2D);
+            }
+            _page_min[l] = page_min;
+            _page_max[l] = page_max;
+        }
+    }
+    _capacity = new_cap;
+}
+
+tensor_t KVCache::keys(size_t layer, size_t begin, size_t end) const {
+    return _k[layer]->slice(0, begin, end);
+}
+
+tensor_t KVCache::values(size_t layer, size_t begin, size_t end) const {
+    return _v[layer]->slice(0, begin, end);
+}
+
+tensor_t KVCache::pageMin(size_t layer) const {
+    return _page > 0 ? _page_min[layer] : nullptr;
+}
+
+tensor_t KVCache::pageMax(size_t layer) const {
+    return _page > 0 ? _page_max[layer] : nullptr;
+}
+
+void KVCache::store(size_t layer, size_t pos, const std::byte *k, const std::byte *v, size_t n) {
+    ASSERT(n <= maxChunk(), "KVCache: too many tokens in one write for the sliding window");
+    ASSERT(_window > 0 || pos + n <= _capacity, "KVCache: store beyond reserved capacity");
+    core::context().setDevice(_device_type, _device_id);
+    auto api = core::context().runtime().api();
+    for (auto [row, m] : _rows(pos, n)) {
+        api->memcpy_sync(_k[layer]->data() + row * rowBytes(), k, m * rowBytes(), LLAISYS_MEMCPY_D2D);
+        api->memcpy_sync(_v[layer]->data() + row * rowBytes(), v, m * rowBytes(), LLAISYS_MEMCPY_D2D);
+        k += m * rowBytes();
+        v += m * rowBytes();
+    }
+    if (_page > 0) {
+        // 回滚后重写的页也会整页重新计算，摘要不会包含已丢弃的 K
+        ops::kv_page_summary(_page_min[layer], _page_max[layer], keys(layer, 0, pos + n), _page, pos);
+    }
+}
+
+void KVCache::commit(const int64_t *token_ids, size_t n) {
+    ASSERT(_window > 0 || size() + n <= _capacity, "KVCache: commit beyond reserved capacity");
+    _tokens.insert(_tokens.end(), token_ids, token_ids + n);
+    _written = std::max(_written, size());
+}
+
+void KVCache::truncate(size_t n) {
+    if (n >= size()) {
+        return;
+    }
+    if (_window > 0) {
+        // 位置 n 的 query 需要 [n + 1 - window, n) 的窗口；被更大的位置覆盖过就只能从 sink 之后重算
+        const size_t needed = std::max(_sink, n + 1 > _window ? n + 1 - _window : 0);
+        if (_oldest() > needed) {
+            n = std::min(n, _sink);
+        }
+        if (n <= _sink) {
+            _written = n;
+        }
+    }
+    _tokens.resize(n);
+}
+
+size_t KVCache::packedBytes(size_t n) const {
+    return _nlayer * 2 * n * rowBytes();
+}
+
+void KVCache::copyOut(size_t begin, size_t n, std::byte *dst) const {
+    ASSERT(begin + n <= size(), "KVCache: copyOut range out of bounds");
+    ASSERT(begin + n <= _sink || std::max(begin, _sink) >= _oldest(), "KVCache: copyOut range already evicted");
+    core::context().setDevice(_device_type, _device_id);
+    auto api = core::context().runtime().api();
+    const auto rows = _rows(begin, n);
+    for (size_t l = 0; l < _nlayer; l++) {
+        for (auto &cache : {_k[l], _v[l]}) {
+            for (auto [row, m] : rows) {
+                api->memcpy_sync(dst, cache->data() + row * rowBytes(), m * rowBytes(), LLAISYS_MEMCPY_D2D);
+                dst += m * rowBytes();
+            }
+        }
+    }
+}
+
+void KVCache::copyIn(size_t pos, const int64_t *token_ids, size_t n, const std::byte *src) {
+    ASSERT(pos <= size(), "KVCache: copyIn would leave a hole in the cache");
+    truncate(pos);
+    ASSERT(pos == size(), "KVCache: copyIn position already evicted");
+    reserve(pos + n);
+    const size_t bytes = n * rowBytes();
+    for (size_t l = 0; l < _nlayer; l++) {
+        store(l, pos, src, src + bytes, n);
+        src += 2 * bytes;
+    }
+    commit(token_ids, n);
+}
+} // namespace llaisys::models
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+
+#include <vector>
+
+namespace llaisys::models {
+// 单条序列的 KV Cache：每层一块连续的 [capacity, nkvh, dh] 存储，
+// 这样 self_attention 可以直接读取 [0, size) 的 slice，不需要拼接。
+//
+// 流式模式（window > 0，StreamingLLM）：只保留前 sink 个 token 和最近的 token，非 sink 部分是一个 ring buffer，
+// 位置 pos >= sink 存在第 sink + (pos - sink) % ring 行，显存与序列长度无关。
+// ring = 2 * window - 1：单次前向最多写 window 个 token（maxChunk），
+// 这样块内最早的 query 仍能看到完整的窗口，且回滚不超过 window 个 token 时不会丢失需要的 K/V。
+//
+// 分页摘要（page > 0，稀疏 attention 用）：每 page 个位置一页，每层额外维护 [npages, nkvh, dh] 的 float32
+// 每维最小值 / 最大值，写入 K 时重新计算被写到的页。
+class KVCache {
+private:
+    size_t _nlayer;
+    size_t _nkvh;
+    size_t _dh;
+    size_t _maxseq;
+    llaisysDataType_t _dtype;
+    llaisysDeviceType_t _device_type;
+    int _device_id;
+    size_t _capacity;
+    size_t _sink;
+    size_t _window;
+    size_t _ring;
+    size_t _written; // 写入过的最大位置 + 1，ring 中保留的是 [_written - ring, _written)
+    size_t _page;
+    std::vector<int64_t> _tokens; // 已写入 KV 的 token，长度即 size()
+    std::vector<tensor_t> _k;
+    std::vector<tensor_t> _v;
+    std::vector<tensor_t> _page_min;
+    std::vector<tensor_t> _page_max;
+
+    // 逻辑位置 [pos, pos + n) 对应的物理行，ring 回绕时分成两段：{起始行, 行数}
+    std::vector<std::pair<size_t, size_t>> _rows(size_t pos, size_t n) const;
+    // 最早仍保留着的非 sink 位置
+    size_t _oldest() const;
+
+public:
+    // window 为 0 时保留全部 token（不超过 maxseq）；否则为流式模式，序列长度不受 maxseq 限制。
+    // page > 0 时维护分页摘要（不能与流式模式同时使用）
+    KVCache(size_t nlayer, size_t nkvh, size_t dh, size_t maxseq,
+            llaisysDataType_t dtype, llaisysDeviceType_t device_type, int device_id,
+            size_t sink = 0, size_t window = 0, size_t page = 0);
+    ~KVCache() = default;
+
+    size_t size() const;
+    size_t capacity() const;
+    size_t maxseq() const;
+    size_t sink() const;
+    size_t window() const;
+    // 单次前向最多写入的 token 数
+    size_t maxChunk() const;
+    size_t pageSize() const;
+    size_t nlayer() const;
+    // 每个 token 在单层中 K（或 V）所占的字节数
+    size_t rowBytes() const;
+    const std::vector<int64_t> &tokens() const;
+
+    // 保证可以容纳 n 个 token，按倍增扩容并保留已有内容（流式模式最多 sink + ring 行）
+    void reserve(size_t n);
+    // [begin, end) 行的 K/V 视图，形状为 [end - begin, nkvh, dh]；流式模式下行号不等于位置
+    tensor_t keys(size_t layer, size_t begin, size_t end) const;
+    tensor_t values(size_t layer, size_t begin, size_t end) const;
+    // 分页摘要 [capacity / page 向上取整, nkvh, dh]，page 为 0 时为空
+    tensor_t pageMin(size_t layer) const;
+    tensor_t pageMax(size_t layer) const;
+    // 把 n 个 token 的 K/V（[n, nkvh, dh]）写到位置 [pos, pos + n)，流式模式下按 ring 回绕
+    void store(size_t layer, size_t pos, const std::byte *k, const std::byte *v, size_t n);
+
+    // forward 写完 [size, size + n) 的 KV 之后登记这些 token
+    void commit(const int64_t *token_ids, size_t n);
+    // 回退到前 n 个 token（丢弃之后的 KV）。流式模式下如果 n 需要的窗口已经被覆盖，
+    // 只保留 min(n, sink) 个 token，其余由调用方重新计算
+    void truncate(size_t n);
+
+    // 打包格式为 [nlayer][K, V][n][nkvh * dh]，用于在 cache 之外保存一段 KV
+    size_t packedBytes(size_t n) const;
+    // 把 [begin, begin + n) 的 KV 打包拷贝到 dst（流式模式下这些位置必须还在 cache 中）
+    void copyOut(size_t begin, size_t n, std::byte *dst) const;
+    // 把打包的 KV 拷贝到 [pos, pos + n)，并登记对应 token；要求 pos <= size()
+    void copyIn(size_t pos, const int64_t *token_ids, size_t n, const std::byte *src);
+};
+} // namespace llaisys::models
@@ -0,0 +1,199 @@
+#include "kv_snapshot.hpp"
+
+#include "../../utils.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace llaisys::models {
+namespace {
+constexpr char SNAPSHOT_MAGIC[8] = {'L', 'L', 'A', 'I', 'S', 'Y', 'K', 'V'};
+
+// 所有字段都是定长整数，浮点按位保存，文件头与编译器的结构体布局无关
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint64_t nlayer, hs, nh, nkvh, dh, di, maxseq, voc;
+    uint32_t epsilon_bits, theta_bits;
+    int64_t end_token;
+    uint64_t model_hash;
+    uint64_t ntoken;
+    uint64_t kv_bytes;
+};
+static_assert(sizeof(SnapshotHeader) == 120, "SnapshotHeader must have no padding");
+
+uint32_t float_bits(float x) {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+SnapshotHeader make_header(const LlaisysQwen2Meta &meta, uint64_t model_hash, size_t ntoken, size_t kv_bytes) {
+    SnapshotHeader h{};
+    std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = KV_SNAPSHOT_VERSION;
+    h.dtype = static_cast<uint32_t>(meta.dtype);
+    h.nlayer = meta.nlayer;
+    h.hs = meta.hs;
+    h.nh = meta.nh;
+    h.nkvh = meta.nkvh;
+    h.dh = meta.dh;
+    h.di = meta.di;
+    h.maxseq = meta.maxseq;
+    h.voc = meta.voc;
+    h.epsilon_bits = float_bits(meta.epsilon);
+    h.theta_bits = float_bits(meta.theta);
+    h.end_token = meta.end_token;
+    h.model_hash = model_hash;
+    h.ntoken = ntoken;
+    h.kv_bytes = kv_bytes;
+    return h;
+}
+
+// 只读映射整个文件
+class MappedFile {
+private:
+    const std::byte *_data = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    HANDLE _file = INVALID_HANDLE_VALUE;
+    HANDLE _mapping = nullptr;
+#endif
+
+public:
+    explicit MappedFile(const std::string &path) {
+#ifdef _WIN32
+        _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        CHECK_ARGUMENT(_file != INVALID_HANDLE_VALUE, "KVSnapshot: cannot open the snapshot file");
+        LARGE_INTEGER size;
+        GetFileSizeEx(_file, &size);
+        _size = static_cast<size_t>(size.QuadPart);
+        if (_size > 0) {
+            _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (_mapping != nullptr) {
+                _data = static_cast<const std::byte *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+            }
+            if (_data == nullptr) {
+                _close();
+                throw std::runtime_error("KVSnapshot: cannot map the snapshot file");
+            }
+        }
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        CHECK_ARGUMENT(fd >= 0, "KVSnapshot: cannot open the snapshot file");
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            _size = static_cast<size_t>(st.st_size);
+            void *addr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                _data = static_cast<const std::byte *>(addr);
+                // K/V 会被顺序读一遍
+                madvise(addr, _size, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+        if (_size > 0 && _data == nullptr) {
+            throw std::runtime_error("KVSnapshot: cannot map the snapshot file");
+        }
+#endif
+    }
+
+    ~MappedFile() {
+        _close();
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const std::byte *data() const { return _data; }
+    size_t size() const { return _size; }
+
+private:
+    void _close() {
+#ifdef _WIN32
+        if (_data != nullptr) {
+            UnmapViewOfFile(_data);
+        }
+        if (_mapping != nullptr) {
+            CloseHandle(_mapping);
+            _mapping = nullptr;
+        }
+        if (_file != INVALID_HANDLE_VALUE) {
+            CloseHandle(_file);
+            _file = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (_data != nullptr) {
+            munmap(const_cast<std::byte *>(_data), _size);
+        }
+#endif
+        _data = nullptr;
+    }
+};
+} // namespace
+
+void saveKVSnapshot(const std::string &path, const LlaisysQwen2Meta &meta, uint64_t model_hash, const KVCache &cache) {
+    CHECK_ARGUMENT(cache.window() == 0, "KVSnapshot: streaming caches cannot be saved");
+    const size_t ntoken = cache.size();
+    const size_t kv_bytes = cache.packedBytes(ntoken);
+    std::vector<std::byte> kv(kv_bytes);
+    cache.copyOut(0, ntoken, kv.data());
+    const auto header = make_header(meta, model_hash, ntoken, kv_bytes);
+
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        CHECK_ARGUMENT(out.good(), "KVSnapshot: cannot create the snapshot file");
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(cache.tokens().data()), ntoken * sizeof(int64_t));
+        out.write(reinterpret_cast<const char *>(kv.data()), kv_bytes);
+        out.close();
+        if (!out) {
+            std::filesystem::remove(tmp);
+            throw std::runtime_error("KVSnapshot: failed to write the snapshot file");
+        }
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+size_t loadKVSnapshot(const std::string &path, const LlaisysQwen2Meta &meta, uint64_t model_hash, KVCache &cache) {
+    MappedFile file(path);
+    SnapshotHeader header;
+    CHECK_ARGUMENT(file.size() >= sizeof(header), "KVSnapshot: file too small");
+    std::memcpy(&header, file.data(), sizeof(header));
+    CHECK_ARGUMENT(std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) == 0,
+                   "KVSnapshot: not a KV snapshot file");
+    CHECK_ARGUMENT(header.version == KV_SNAPSHOT_VERSION, "KVSnapshot: unsupported snapshot version");
+
+    const size_t ntoken = header.ntoken;
+    const auto expected = make_header(meta, model_hash, ntoken, cache.packedBytes(ntoken));
+    CHECK_ARGUMENT(header.model_hash == expected.model_hash, "KVSnapshot: snapshot was saved by a different model");
+    // model_hash 之前的字段即模型 meta
+    CHECK_ARGUMENT(std::memcmp(&header, &expected, offsetof(SnapshotHeader, model_hash)) == 0,
+                   "KVSnapshot: model meta mismatch");
+    CHECK_ARGUMENT(header.kv_bytes == expected.kv_bytes
+                       && file.size() == sizeof(header) + ntoken * sizeof(int64_t) + header.kv_bytes,
+                   "KVSnapshot: truncated or corrupted snapshot");
+    CHECK_ARGUMENT(ntoken <= meta.maxseq, "KVSnapshot: snapshot exceeds maxseq");
+
+    // token 历史在文件头之后，按 8 字节对齐
+    const auto *tokens = reinterpret_cast<const int64_t *>(file.data() + sizeof(header));
+    cache.truncate(0);
+    cache.copyIn(0, tokens, ntoken, file.data() + sizeof(header) + ntoken * sizeof(int64_t));
+    return ntoken;
+}
+} // namespace llaisys::models
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "llaisys/models/qwen2.h"
+
+#include "../kv_cache/kv_cache.hpp"
+
+#include <string>
+
+namespace llaisys::models {
+// KV Cache 快照文件：固定长度的文件头（magic、版本、模型 meta、模型 hash、token 数），
+// 之后是 token 历史（int64）和 KVCache::copyOut 格式的全部 K/V。
+// 格式变化时递增版本号，旧版本的文件直接拒绝加载
+constexpr uint32_t KV_SNAPSHOT_VERSION = 1;
+
+// 写入 cache 中的全部 token（先写临时文件再改名，中途失败不会留下半个快照）
+void saveKVSnapshot(const std::string &path, const LlaisysQwen2Meta &meta, uint64_t model_hash, const KVCache &cache);
+// 把快照映射到内存后直接拷进 cache（原有内容被替换），返回 token 数。
+// 版本、meta 或模型 hash 不一致时抛出 std::invalid_argument
+size_t loadKVSnapshot(const std::string &path, const LlaisysQwen2Meta &meta, uint64_t model_hash, KVCache &cache);
+} // namespace llaisys::models
@@ -0,0 +1,290 @@
+#include "prefix_cache.hpp"
+
+#include "../../utils.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+
+namespace llaisys::models {
+PrefixCache::PrefixCache(size_t block_size, size_t budget_bytes, const std::string &offload_dir, size_t offload_bytes)
+    : _block_size(block_size), _budget_bytes(budget_bytes), _clock(0), _offload_dir(offload_dir),
+      _offload_bytes(offload_bytes), _api(device::getRuntimeAPI(LLAISYS_DEVICE_CPU)), _stream(nullptr),
+      _inflight(false) {
+    CHECK_ARGUMENT(block_size > 0, "PrefixCache: block size must be positive");
+    if (_offload_bytes > 0) {
+        _stream = _api->create_stream();
+    }
+}
+
+PrefixCache::~PrefixCache() {
+    _wait();
+    if (_offload_bytes > 0) {
+        _api->destroy_stream(_stream);
+    }
+}
+
+size_t PrefixCache::blockSize() const {
+    return _block_size;
+}
+
+size_t PrefixCache::budgetBytes() const {
+    return _budget_bytes;
+}
+
+const PrefixCacheStats &PrefixCache::stats() const {
+    return _stats;
+}
+
+void PrefixCache::_pageIn(Node *node) {
+    const size_t bytes = _cold->slotBytes();
+    auto block = std::make_shared<KVBlock>();
+    block->tokens = node->key;
+    block->kv.resize(bytes);
+    _api->memcpy_async(block->kv.data(), _cold->data(node->slot), bytes, LLAISYS_MEMCPY_H2H, _stream);
+    _inflight = true;
+    // 槽位只会在 _wait() 之后被重新写入（_evict 先同步），这里可以直接归还
+    _cold->release(node->slot);
+    node->slot = NO_SLOT;
+    node->block = block;
+    _stats.offloaded_blocks--;
+    _stats.offloaded_bytes -= bytes;
+    _stats.paged_in_blocks++;
+    _stats.cached_blocks++;
+    _stats.cached_bytes += bytes;
+}
+
+void PrefixCache::_wait() {
+    if (_inflight) {
+        _api->stream_synchronize(_stream);
+        _inflight = false;
+    }
+}
+
+std::vector<kv_block_t> PrefixCache::match(const int64_t *token_ids, size_t max_tokens) {
+    std::vector<kv_block_t> blocks;
+    Node *node = &_root;
+    _clock++;
+    std::vector<int64_t> key(_block_size);
+    for (size_t pos = 0; pos + _block_size <= max_tokens; pos += _block_size) {
+        key.assign(token_ids + pos, token_ids + pos + _block_size);
+        auto it = node->children.find(key);
+        if (it == node->children.end()) {
+            break;
+        }
+        node = it->second.get();
+        node->last_access = _clock;
+        if (!node->block) {
+            _pageIn(node);
+        }
+        blocks.push_back(node->block);
+    }
+    _wait();
+    // 换入的块计入热预算，可能需要换出别的块；返回的块由调用者持有，被换出也可以安全读取
+    _evict();
+    return blocks;
+}
+
+size_t PrefixCache::prefetch(const int64_t *token_ids, size_t max_tokens) {
+    Node *node = &_root;
+    _clock++;
+    size_t count = 0;
+    std::vector<int64_t> key(_block_size);
+    for (size_t pos = 0; pos + _block_size <= max_tokens; pos += _block_size) {
+        key.assign(token_ids + pos, token_ids + pos + _block_size);
+        auto it = node->children.find(key);
+        if (it == node->children.end()) {
+            break;
+        }
+        node = it->second.get();
+        node->last_access = _clock;
+        if (!node->block) {
+            _cold->prefetch(node->slot);
+            _pageIn(node);
+            count++;
+        }
+    }
+    return count;
+}
+
+void PrefixCache::record(size_t query_tokens, size_t hit_tokens) {
+    _stats.lookups++;
+    _stats.query_tokens += query_tokens;
+    if (hit_tokens > 0) {
+        _stats.hits++;
+        _stats.hit_tokens += hit_tokens;
+    }
+}
+
+void PrefixCache::insert(const KVCache &cache, size_t n) {
+    ASSERT(n <= cache.size(), "PrefixCache: insert range exceeds cached tokens");
+    const auto &tokens = cache.tokens();
+    const size_t block_bytes = cache.packedBytes(_block_size);
+    if (block_bytes > _budget_bytes) {
+        return;
+    }
+
+    Node *node = &_root;
+    _clock++;
+    std::vector<int64_t> key(_block_size);
+    for (size_t pos = 0; pos + _block_size <= n; pos += _block_size) {
+        key.assign(tokens.begin() + pos, tokens.begin() + pos + _block_size);
+        auto it = node->children.find(key);
+        if (it == node->children.end()) {
+            auto block = std::make_shared<KVBlock>();
+            block->tokens = key;
+            block->kv.resize(block_bytes);
+            cache.copyOut(pos, _block_size, block->kv.data());
+
+            auto child = std::make_unique<Node>();
+            child->key = key;
+            child->block = block;
+            child->parent = node;
+            it = node->children.emplace(key, std::move(child)).first;
+            _stats.cached_blocks++;
+            _stats.cached_bytes += block_bytes;
+        }
+        node = it->second.get();
+        node->last_access = _clock;
+    }
+    _evict();
+}
+
+void PrefixCache::_drop(Node *leaf) {
+    if (leaf->block) {
+        _stats.cached_blocks--;
+        _stats.cached_bytes -= leaf->block->kv.size();
+    } else {
+        _cold->release(leaf->slot);
+        _stats.offloaded_blocks--;
+        _stats.offloaded_bytes -= _cold->slotBytes();
+    }
+    _stats.evicted_blocks++;
+    Node *parent = leaf->parent;
+    parent->children.erase(leaf->key);
+}
+
+void PrefixCache::_offload() {
+    // 热块按最近访问时间从旧到新换出；同一次访问的路径上先换出深的节点，冷叶子按 LRU 丢弃
+    std::vector<std::pair<Node *, size_t>> hot;
+    auto older = [](const Node *a, const Node *b) { return a->last_access > b->last_access; };
+    std::priority_queue<Node *, std::vector<Node *>, decltype(older)> cold_leaves(older);
+    std::vector<std::pair<Node *, size_t>> stack{{&_root, 0}};
+    while (!stack.empty()) {
+        auto [node, depth] = stack.back();
+        stack.pop_back();
+        if (node != &_root && node->block) {
+            hot.emplace_back(node, depth);
+        } else if (node != &_root && node->children.empty()) {
+            cold_leaves.push(node);
+        }
+        for (auto &child : node->children) {
+            stack.emplace_back(child.second.get(), depth + 1);
+        }
+    }
+    std::sort(hot.begin(), hot.end(), [](const auto &a, const auto &b) {
+        return a.first->last_access < b.first->last_access
+            || (a.first->last_access == b.first->last_access && a.second > b.second);
+    });
+
+    for (auto &[node, depth] : hot) {
+        if (_stats.cached_bytes <= _budget_bytes) {
+            break;
+        }
+        const size_t bytes = node->block->kv.size();
+        if (!_cold) {
+            if (_offload_bytes < bytes) {
+                return;
+            }
+            _cold = std::make_unique<ColdStore>(_offload_dir, bytes, _offload_bytes);
+        }
+        while (_cold->full() && !cold_leaves.empty()) {
+            Node *leaf = cold_leaves.top();
+            cold_leaves.pop();
+            Node *parent = leaf->parent;
+            _drop(leaf);
+            if (parent != &_root && parent->children.empty() && !parent->block) {
+                cold_leaves.push(parent);
+            }
+        }
+        if (_cold->full()) {
+            return;
+        }
+        node->slot = _cold->put(node->block->kv.data());
+        node->block.reset();
+        _stats.cached_blocks--;
+        _stats.cached_bytes -= bytes;
+        _stats.offloaded_blocks++;
+        _stats.offloaded_bytes += bytes;
+    }
+}
+
+void PrefixCache::_evict() {
+    if (_stats.cached_bytes <= _budget_bytes) {
+        return;
+    }
+    // 换出 / 丢弃都可能覆盖或释放正在换入的槽位，先等之前的换入完成
+    _wait();
+    if (_offload_bytes > 0) {
+        _offload();
+        if (_stats.cached_bytes <= _budget_bytes) {
+            return;
+        }
+    }
+    // 冷存储也腾不出位置时直接丢弃热块。只有丢弃热块才能减少 cached_bytes，所以候选是子树中没有其他热块的热节点
+    //（冷的后代依赖它的前缀，随它一起丢弃），按最近访问时间从旧到新淘汰。
+    // hot_below[n] 为 n 下面最近一层热块的个数（中间只隔着冷节点），降到 0 时 n 成为候选
+    std::unordered_map<const Node *, size_t> hot_below;
+    std::vector<Node *> hot;
+    std::vector<std::pair<Node *, Node *>> stack{{&_root, &_root}}; // (节点, 最近的热祖先，没有时为根)
+    while (!stack.empty()) {
+        auto [node, anc] = stack.back();
+        stack.pop_back();
+        if (node != &_root && node->block) {
+            hot_below[anc]++;
+            hot.push_back(node);
+            anc = node;
+        }
+        for (auto &child : node->children) {
+            stack.emplace_back(child.second.get(), anc);
+        }
+    }
+    auto older = [](const Node *a, const Node *b) { return a->last_access > b->last_access; };
+    std::priority_queue<Node *, std::vector<Node *>, decltype(older)> candidates(older);
+    for (Node *node : hot) {
+        if (hot_below[node] == 0) {
+            candidates.push(node);
+        }
+    }
+
+    while (_stats.cached_bytes > _budget_bytes && !candidates.empty()) {
+        Node *node = candidates.top();
+        candidates.pop();
+        Node *anc = node->parent;
+        while (anc != &_root && !anc->block) {
+            anc = anc->parent;
+        }
+        _dropSubtree(node);
+        if (anc != &_root && --hot_below[anc] == 0) {
+            candidates.push(anc);
+        }
+    }
+}
+
+void PrefixCache::_dropSubtree(Node *node) {
+    while (!node->children.empty()) {
+        _dropSubtree(node->children.begin()->second.get());
+    }
+    _drop(node);
+}
+
+void PrefixCache::clear() {
+    _wait();
+    _root.children.clear();
+    _cold.reset();
+    _stats.cached_blocks = 0;
+    _stats.cached_bytes = 0;
+    _stats.offloaded_blocks = 0;
+    _stats.offloaded_bytes = 0;
+}
+} // namespace llaisys::models
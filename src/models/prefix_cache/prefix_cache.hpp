@@ -0,0 +1,98 @@
+#pragma once
+
+#include "../../device/runtime_api.hpp"
+#include "../cold_store/cold_store.hpp"
+#include "../kv_cache/kv_cache.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llaisys::models {
+// 一个前缀块：block_size 个 token 的 KV，按 KVCache::copyOut 的格式打包。
+// 创建后不再修改，由 shared_ptr 计数，被淘汰时正在使用它的请求仍然可以安全读取。
+struct KVBlock {
+    std::vector<int64_t> tokens;
+    std::vector<std::byte> kv;
+};
+using kv_block_t = std::shared_ptr<const KVBlock>;
+
+struct PrefixCacheStats {
+    size_t lookups = 0;      // 需要 prefill 的查询次数
+    size_t hits = 0;         // 至少命中一个块的查询次数
+    size_t query_tokens = 0; // 查询时需要 prefill 的 token 总数
+    size_t hit_tokens = 0;   // 由前缀缓存提供、省掉 prefill 的 token 数
+    size_t cached_blocks = 0;
+    size_t cached_bytes = 0;
+    size_t evicted_blocks = 0;
+    size_t offloaded_blocks = 0; // 当前在冷存储中的块
+    size_t offloaded_bytes = 0;
+    size_t paged_in_blocks = 0;  // 从冷存储换入的累计块数
+};
+
+// 以 token id 为键的基数树（按 block 粒度分段），节点持有对应的 KV 块。
+// 只有叶子节点可以被淘汰，淘汰顺序为 LRU，总字节数不超过 budget。
+//
+// 开启冷存储（offload_bytes > 0）时，超出 budget 的热块先按 LRU 换出到 ColdStore（内存映射的文件或主机内存），
+// 节点留在树中，之后命中时再换入；冷存储也满了才真正丢弃热块（最久未用、子树中没有其他热块的节点）。
+// 换入用 CPU runtime 的 memcpy_async 发到自己的 stream 上：prefetch 只发起拷贝，
+// 下一次 match / insert 前才同步，中间可以与其它序列的计算重叠。
+class PrefixCache {
+private:
+    static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
+    struct Node {
+        std::vector<int64_t> key;
+        kv_block_t block;     // 热块；换出到冷存储后为空
+        size_t slot = NO_SLOT; // 冷存储中的槽位
+        Node *parent = nullptr;
+        std::map<std::vector<int64_t>, std::unique_ptr<Node>> children;
+        uint64_t last_access = 0;
+    };
+
+    size_t _block_size;
+    size_t _budget_bytes;
+    uint64_t _clock;
+    Node _root;
+    PrefixCacheStats _stats;
+    std::string _offload_dir;
+    size_t _offload_bytes;
+    std::unique_ptr<ColdStore> _cold;
+    const LlaisysRuntimeAPI *_api;
+    llaisysStream_t _stream;
+    bool _inflight; // _stream 上还有没完成的换入
+
+    void _pageIn(Node *node);
+    void _wait();
+    // 把最久未用的热块换出到冷存储，冷存储满时先丢弃最久未用的冷叶子
+    void _offload();
+    void _drop(Node *leaf);
+    // 丢弃 node 和它的整棵子树
+    void _dropSubtree(Node *node);
+    void _evict();
+
+public:
+    // offload_bytes 为 0 时不使用冷存储；offload_dir 为空时冷存储在主机内存中
+    PrefixCache(size_t block_size, size_t budget_bytes, const std::string &offload_dir = "", size_t offload_bytes = 0);
+    ~PrefixCache();
+
+    PrefixCache(const PrefixCache &) = delete;
+    PrefixCache &operator=(const PrefixCache &) = delete;
+
+    size_t blockSize() const;
+    size_t budgetBytes() const;
+    const PrefixCacheStats &stats() const;
+
+    // 返回 token_ids 最长的块对齐前缀匹配（按顺序），最多覆盖 max_tokens 个 token。
+    // 路径上在冷存储中的块会先换入。
+    std::vector<kv_block_t> match(const int64_t *token_ids, size_t max_tokens);
+    // 对即将 match 的前缀提前发起冷块的换入（不等待完成），返回发起换入的块数
+    size_t prefetch(const int64_t *token_ids, size_t max_tokens);
+    // 记录一次查询的结果：需要计算的 token 数，以及其中由前缀缓存提供的 token 数
+    void record(size_t query_tokens, size_t hit_tokens);
+    // 把 cache 中前 n 个 token 里所有完整的块插入树中（已存在的块只刷新访问时间）
+    void insert(const KVCache &cache, size_t n);
+    void clear();
+};
+} // namespace llaisys::models
@@ -0,0 +1,724 @@
+#include "qwen2.hpp"
+
+#include "../../core/llaisys_core.hpp"
+#include "../../utils.hpp"
+#include "../kv_snapshot/kv_snapshot.hpp"
+
+#include "../../ops/add/op.hpp"
+#include "../../ops/embedding/op.hpp"
+#include "../../ops/linear/op.hpp"
+#include "../../ops/lm_head/op.hpp"
+#include "../../ops/rms_norm/op.hpp"
+#include "../../ops/rope/op.hpp"
+#include "../../ops/sample/op.hpp"
+#include "../../ops/self_attention/op.hpp"
+#include "../../ops/swiglu/op.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace llaisys::models {
+// 默认前缀缓存配置：16 个 token 一个块，最多占用 256 MiB
+constexpr size_t DEFAULT_PREFIX_BLOCK_SIZE = 16;
+constexpr size_t DEFAULT_PREFIX_CACHE_BYTES = size_t(256) << 20;
+// 默认每步最多计算 512 个 token
+constexpr size_t DEFAULT_CHUNK_SIZE = 512;
+// top_k 不超过这个值时，候选直接在融合的 LM head 中选出，不生成完整 logits
+constexpr size_t MAX_FUSED_TOP_K = 256;
+// 一次前向中新 token 不超过这个数的序列才使用稀疏 attention，prefill 仍然是稠密的
+constexpr size_t SPARSE_MAX_QUERY_TOKENS = 16;
+// 模型 hash 对每个权重只取开头、中间、结尾各这么多字节，快照加载时不用读完全部权重
+constexpr size_t MODEL_HASH_SAMPLE_BYTES = 4096;
+
+Qwen2::Qwen2(const LlaisysQwen2Meta &meta, llaisysDeviceType_t device_type, int device_id)
+    : _meta(meta), _device_type(device_type), _device_id(device_id),
+      _cache(meta.nlayer, meta.nkvh, meta.dh, meta.maxseq, meta.dtype, device_type, device_id),
+      _scheduler(DEFAULT_CHUNK_SIZE), _next_request_id(0), _sink(0), _window(0),
+      _page(0), _top_pages(0), _recent(0), _offload_bytes(0) {
+    const size_t hs = meta.hs, nh = meta.nh, nkvh = meta.nkvh, dh = meta.dh, di = meta.di;
+    const auto dtype = meta.dtype;
+
+    _weights.in_embed = _tensor({meta.voc, hs}, dtype);
+    _weights.out_embed = _tensor({meta.voc, hs}, dtype);
+    _weights.out_norm_w = _tensor({hs}, dtype);
+    for (size_t l = 0; l < meta.nlayer; l++) {
+        _weights.attn_norm_w.push_back(_tensor({hs}, dtype));
+        _weights.attn_q_w.push_back(_tensor({nh * dh, hs}, dtype));
+        _weights.attn_q_b.push_back(_tensor({nh * dh}, dtype));
+        _weights.attn_k_w.push_back(_tensor({nkvh * dh, hs}, dtype));
+        _weights.attn_k_b.push_back(_tensor({nkvh * dh}, dtype));
+        _weights.attn_v_w.push_back(_tensor({nkvh * dh, hs}, dtype));
+        _weights.attn_v_b.push_back(_tensor({nkvh * dh}, dtype));
+        _weights.attn_o_w.push_back(_tensor({hs, nh * dh}, dtype));
+        _weights.mlp_norm_w.push_back(_tensor({hs}, dtype));
+        _weights.mlp_gate_w.push_back(_tensor({di, hs}, dtype));
+        _weights.mlp_up_w.push_back(_tensor({di, hs}, dtype));
+        _weights.mlp_down_w.push_back(_tensor({hs, di}, dtype));
+    }
+
+    setPrefixCache(DEFAULT_PREFIX_BLOCK_SIZE, DEFAULT_PREFIX_CACHE_BYTES);
+}
+
+const LlaisysQwen2Meta &Qwen2::meta() const {
+    return _meta;
+}
+
+Qwen2Weights &Qwen2::weights() {
+    return _weights;
+}
+
+tensor_t Qwen2::_tensor(const shape_t &shape, llaisysDataType_t dtype) const {
+    return Tensor::create(shape, dtype, _device_type, _device_id);
+}
+
+KVCache Qwen2::_newCache() const {
+    return KVCache(_meta.nlayer, _meta.nkvh, _meta.dh, _meta.maxseq, _meta.dtype, _device_type, _device_id,
+                   _sink, _window, _page);
+}
+
+size_t Qwen2::_maxContext() const {
+    // 流式模式只保留 sink + 窗口，序列长度不受 maxseq 限制
+    return _window > 0 ? std::numeric_limits<size_t>::max() : _meta.maxseq;
+}
+
+uint64_t Qwen2::_modelHash() const {
+    // FNV-1a：权重形状加上每个权重的三段采样
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](const std::byte *data, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            hash = (hash ^ static_cast<uint64_t>(data[i])) * 0x100000001b3ULL;
+        }
+    };
+    std::vector<tensor_t> tensors{_weights.in_embed, _weights.out_embed, _weights.out_norm_w};
+    for (auto *group : {&_weights.attn_norm_w, &_weights.attn_q_w, &_weights.attn_q_b, &_weights.attn_k_w,
+                        &_weights.attn_k_b, &_weights.attn_v_w, &_weights.attn_v_b, &_weights.attn_o_w,
+                        &_weights.mlp_norm_w, &_weights.mlp_gate_w, &_weights.mlp_up_w, &_weights.mlp_down_w}) {
+        tensors.insert(tensors.end(), group->begin(), group->end());
+    }
+
+    core::context().setDevice(_device_type, _device_id);
+    auto api = core::context().runtime().api();
+    std::vector<std::byte> sample(MODEL_HASH_SAMPLE_BYTES);
+    for (auto &t : tensors) {
+        const uint64_t numel = t->numel();
+        mix(reinterpret_cast<const std::byte *>(&numel), sizeof(numel));
+        const size_t bytes = t->numel() * t->elementSize();
+        const size_t n = std::min(bytes, MODEL_HASH_SAMPLE_BYTES);
+        for (size_t offset : {size_t(0), (bytes - n) / 2, bytes - n}) {
+            api->memcpy_sync(sample.data(), t->data() + offset, n, LLAISYS_MEMCPY_D2H);
+            mix(sample.data(), n);
+        }
+    }
+    return hash;
+}
+
+void Qwen2::saveCache(const std::string &path) {
+    saveKVSnapshot(path, _meta, _modelHash(), _cache);
+}
+
+std::vector<int64_t> Qwen2::loadCache(const std::string &path) {
+    // 快照只记录完整的 token 历史，流式 cache 无法恢复；稀疏模式的页摘要在写入时重新计算
+    CHECK_ARGUMENT(_window == 0, "Qwen2: cannot load a snapshot in streaming mode");
+    loadKVSnapshot(path, _meta, _modelHash(), _cache);
+    return _cache.tokens();
+}
+
+void Qwen2::setStreaming(size_t sink, size_t window) {
+    CHECK_ARGUMENT(_scheduler.size() == 0, "Qwen2: cannot change streaming mode with requests in flight");
+    CHECK_ARGUMENT(window == 0 || _page == 0, "Qwen2: streaming mode does not support sparse attention");
+    _sink = window > 0 ? sink : 0;
+    _window = window;
+    _cache = _newCache();
+}
+
+void Qwen2::setSparseAttention(size_t page_size, size_t top_pages, size_t recent) {
+    CHECK_ARGUMENT(_scheduler.size() == 0, "Qwen2: cannot change sparse attention with requests in flight");
+    CHECK_ARGUMENT(page_size == 0 || _window == 0, "Qwen2: sparse attention does not support streaming mode");
+    CHECK_ARGUMENT(page_size == 0 || top_pages > 0, "Qwen2: sparse attention needs at least one page");
+    _page = page_size;
+    _top_pages = page_size > 0 ? top_pages : 0;
+    _recent = page_size > 0 ? recent : 0;
+    _cache = _newCache();
+}
+
+int64_t Qwen2::infer(const int64_t *token_ids, size_t ntoken) {
+    const uint64_t arrival = _trace ? _trace->now() : 0;
+    const int64_t token = _argmax(_prefill(token_ids, ntoken, 1))[0];
+    if (_trace) {
+        _trace->infer(arrival, token_ids, ntoken, token, 0.0f, 1, 1.0f);
+    }
+    return token;
+}
+
+int64_t Qwen2::infer(const int64_t *token_ids, size_t ntoken, float temperature, int64_t top_k, float top_p) {
+    const uint64_t arrival = _trace ? _trace->now() : 0;
+    const int64_t token = _sample(_prefill(token_ids, ntoken, 1), temperature, top_k, top_p);
+    if (_trace) {
+        _trace->infer(arrival, token_ids, ntoken, token, temperature, top_k, top_p);
+    }
+    return token;
+}
+
+tensor_t Qwen2::logits(const int64_t *token_ids, size_t ntoken, size_t nlogits) {
+    return _lmHead(_prefill(token_ids, ntoken, nlogits));
+}
+
+tensor_t Qwen2::_prefill(const int64_t *token_ids, size_t ntoken, size_t nlogits) {
+    CHECK_ARGUMENT(ntoken > 0, "Qwen2: infer requires at least one token");
+    CHECK_ARGUMENT(ntoken <= _maxContext(), "Qwen2: context exceeds maxseq");
+    CHECK_ARGUMENT(nlogits > 0 && nlogits <= ntoken, "Qwen2: invalid number of logits");
+
+    size_t start = _reusePrefix(_cache, token_ids, ntoken, nlogits);
+    const size_t reused = start;
+    // 长 prompt 按块 prefill；每块只取落在末尾 nlogits 个位置内的 hidden states
+    const size_t chunk = std::min(_scheduler.tokenBudget() > 0 ? _scheduler.tokenBudget() : ntoken, _cache.maxChunk());
+    const size_t first_logit = ntoken - nlogits;
+    std::vector<tensor_t> pieces;
+    while (start < ntoken) {
+        const size_t n = std::min(chunk, ntoken - start);
+        const size_t end = start + n;
+        auto piece = _forward({{&_cache, token_ids + start, n, end > first_logit ? end - std::max(start, first_logit) : 0}});
+        if (piece) {
+            pieces.push_back(piece);
+        }
+        start = end;
+    }
+    auto hidden = pieces.size() == 1 ? pieces[0] : _concatRows(pieces);
+    _cachePrefix(_cache, reused);
+    return hidden;
+}
+
+std::vector<int64_t> Qwen2::speculate(Qwen2 &draft, const int64_t *token_ids, size_t ntoken,
+                                      size_t k, float temperature) {
+    CHECK_ARGUMENT(ntoken > 0, "Qwen2: speculate requires at least one token");
+    CHECK_ARGUMENT(draft.meta().voc <= _meta.voc, "Qwen2: draft vocabulary exceeds target vocabulary");
+    // 候选 token 也要放进两个模型的 cache
+    const size_t maxseq = std::min(_maxContext(), draft._maxContext());
+    CHECK_ARGUMENT(ntoken <= maxseq, "Qwen2: context exceeds maxseq");
+    // 验证的一次前向不能超过滑动窗口允许的块大小
+    k = std::min({k, maxseq - ntoken, _cache.maxChunk() - 1});
+
+    // draft 逐个提出候选，保留每一步的分布用于接受判定
+    const size_t draft_voc = draft.meta().voc;
+    std::vector<int64_t> context(token_ids, token_ids + ntoken);
+    std::vector<int64_t> proposals;
+    std::vector<float> draft_probs;
+    draft_probs.reserve(k * draft_voc);
+    for (size_t i = 0; i < k; i++) {
+        auto row = logitsToHost(draft.logits(context.data(), context.size(), 1));
+        logitsToProbs(row.data(), draft_voc, temperature);
+        const int64_t token = sampleFromProbs(row.data(), draft_voc, _rng);
+        draft_probs.insert(draft_probs.end(), row.begin(), row.end());
+        proposals.push_back(token);
+        context.push_back(token);
+    }
+
+    return _verify(token_ids, ntoken, proposals, draft_probs, draft_voc, temperature);
+}
+
+std::vector<int64_t> Qwen2::lookupStep(const int64_t *token_ids, size_t ntoken, size_t k, size_t max_ngram,
+                                       float temperature) {
+    CHECK_ARGUMENT(ntoken > 0, "Qwen2: speculate requires at least one token");
+    CHECK_ARGUMENT(ntoken <= _maxContext(), "Qwen2: context exceeds maxseq");
+    auto proposals = promptLookup(token_ids, ntoken, max_ngram,
+                                  std::min({k, _maxContext() - ntoken, _cache.maxChunk() - 1}));
+    return _verify(token_ids, ntoken, proposals, {}, 0, temperature);
+}
+
+std::vector<int64_t> Qwen2::_verify(const int64_t *token_ids, size_t ntoken, const std::vector<int64_t> &proposals,
+                                    const std::vector<float> &draft_probs, size_t draft_voc, float temperature) {
+    const size_t k = proposals.size();
+    std::vector<int64_t> context(token_ids, token_ids + ntoken);
+    context.insert(context.end(), proposals.begin(), proposals.end());
+
+    // 一次前向验证全部候选：取最后 k + 1 个位置的 logits
+    auto target_probs = logitsToHost(logits(context.data(), context.size(), k + 1));
+    for (size_t i = 0; i <= k; i++) {
+        logitsToProbs(target_probs.data() + i * _meta.voc, _meta.voc, temperature);
+    }
+    auto accepted = acceptDraft(proposals, draft_probs, draft_voc, target_probs, _meta.voc, _rng);
+    // 回滚被拒绝候选的 K/V
+    _cache.truncate(ntoken + accepted.size() - 1);
+
+    _spec_stats.steps++;
+    _spec_stats.proposed += k;
+    _spec_stats.accepted += accepted.size() - 1;
+    _spec_stats.generated += accepted.size();
+    return accepted;
+}
+
+SpeculativeStats Qwen2::speculativeStats() const {
+    return _spec_stats;
+}
+
+void Qwen2::setSeed(uint64_t seed) {
+    _rng.seed(seed);
+}
+
+void Qwen2::_cachePrefix(const KVCache &cache, size_t prev_size) {
+    // 新凑满的块写入前缀缓存（生成的 token 也会成为下一轮对话的前缀）；流式 cache 会丢弃旧 token，不参与
+    if (_prefix_cache && cache.window() == 0) {
+        const size_t block = _prefix_cache->blockSize();
+        if (cache.size() / block > prev_size / block) {
+            _prefix_cache->insert(cache, cache.size());
+        }
+    }
+}
+
+size_t Qwen2::_reusePrefix(KVCache &cache, const int64_t *token_ids, size_t ntoken, size_t nlogits) {
+    // 需要 logits 的 token 必须参与前向
+    const size_t limit = ntoken - std::max<size_t>(nlogits, 1);
+    const auto &cached = cache.tokens();
+    size_t common = 0;
+    const size_t bound = std::min(limit, cached.size());
+    while (common < bound && cached[common] == token_ids[common]) {
+        common++;
+    }
+    cache.truncate(common);
+    // 流式 cache 回滚太多时会退回到 sink，之后的 token 需要重新计算
+    common = cache.size();
+    if (!_prefix_cache || cache.window() > 0 || common == limit) {
+        return common;
+    }
+
+    const size_t block = _prefix_cache->blockSize();
+    auto blocks = _prefix_cache->match(token_ids, limit);
+    size_t reused = common;
+    for (size_t i = common / block; i < blocks.size(); i++) {
+        cache.copyIn(i * block, blocks[i]->tokens.data(), block, blocks[i]->kv.data());
+        reused = (i + 1) * block;
+    }
+    _prefix_cache->record(ntoken - common, reused - common);
+    return reused;
+}
+
+std::vector<float> Qwen2::score(const std::vector<ScoreRequest> &requests) {
+    std::vector<size_t> offsets;
+    size_t total = 0;
+    for (auto &req : requests) {
+        CHECK_ARGUMENT(req.prompt_len > 0 && req.prompt_len <= req.ntoken, "Qwen2: score requires a non-empty prompt");
+        CHECK_ARGUMENT(req.ntoken <= _maxContext(), "Qwen2: context exceeds maxseq");
+        offsets.push_back(total);
+        total += req.ntoken - req.prompt_len;
+    }
+    std::vector<float> logprobs(total);
+
+    // 第 j 个位置的 logits 给 token j + 1 打分：需要前向的是 token_ids[0, ntoken - 1)，
+    // 其中 [prompt_len - 1, ntoken - 1) 这些位置需要 logits
+    struct Pending {
+        size_t index;
+        size_t pos;
+        std::unique_ptr<KVCache> cache;
+    };
+    std::vector<Pending> active;
+    size_t next = 0;
+    const size_t budget = _scheduler.tokenBudget() == 0 ? std::numeric_limits<size_t>::max() : _scheduler.tokenBudget();
+    core::context().setDevice(_device_type, _device_id);
+    auto api = core::context().runtime().api();
+
+    while (next < requests.size() || !active.empty()) {
+        // 未算完的 token 不足一步的预算时，按顺序接纳新请求（KV Cache 只为接纳的请求分配）
+        size_t queued = 0;
+        for (auto &p : active) {
+            queued += requests[p.index].ntoken - 1 - p.pos;
+        }
+        for (; next < requests.size() && queued < budget; next++) {
+            auto &req = requests[next];
+            if (req.ntoken == req.prompt_len) {
+                continue;
+            }
+            auto cache = std::make_unique<KVCache>(_newCache());
+            cache->reserve(req.ntoken - 1);
+            active.push_back({next, 0, std::move(cache)});
+            queued += req.ntoken - 1;
+        }
+        if (active.empty()) {
+            break;
+        }
+
+        // 按到达顺序用完本步的 token 预算
+        size_t left = budget;
+        std::vector<ForwardItem> items;
+        std::vector<int64_t> targets;
+        std::vector<size_t> out_pos;
+        for (auto &p : active) {
+            if (left == 0) {
+                break;
+            }
+            auto &req = requests[p.index];
+            const size_t len = req.ntoken - 1, first = req.prompt_len - 1;
+            const size_t n = std::min({left, len - p.pos, p.cache->maxChunk()}), end = p.pos + n;
+            const size_t nlogits = end > first ? end - std::max(p.pos, first) : 0;
+            for (size_t j = end - nlogits; j < end; j++) {
+                targets.push_back(req.token_ids[j + 1]);
+                out_pos.push_back(offsets[p.index] + j - first);
+            }
+            items.push_back({p.cache.get(), req.token_ids + p.pos, n, nlogits});
+            left -= n;
+        }
+
+        auto hidden = _forward(items);
+        if (hidden) {
+            // 融合的 log_softmax + gather，不生成 logits
+            const size_t m = targets.size();
+            auto target_ids = _tensor({m}, LLAISYS_DTYPE_I64);
+            target_ids->load(targets.data());
+            auto out = _tensor({m}, LLAISYS_DTYPE_F32);
+            ops::lm_head_logprob(out, hidden, _weights.out_norm_w, _weights.out_embed, target_ids, _meta.epsilon);
+            std::vector<float> host(m);
+            api->memcpy_sync(host.data(), out->data(), m * sizeof(float), LLAISYS_MEMCPY_D2H);
+            for (size_t i = 0; i < m; i++) {
+                logprobs[out_pos[i]] = host[i];
+            }
+        }
+
+        // 算完的请求立刻释放 KV Cache
+        for (size_t i = 0; i < items.size(); i++) {
+            active[i].pos += items[i].ntoken;
+        }
+        active.erase(std::remove_if(active.begin(), active.end(),
+                                    [&](const Pending &p) { return p.pos == requests[p.index].ntoken - 1; }),
+                     active.end());
+    }
+    return logprobs;
+}
+
+int64_t Qwen2::addRequest(const int64_t *token_ids, size_t ntoken, size_t max_new_tokens,
+                          size_t lookup_tokens, size_t lookup_ngram) {
+    CHECK_ARGUMENT(ntoken > 0, "Qwen2: request requires at least one token");
+    CHECK_ARGUMENT(ntoken < _maxContext(), "Qwen2: prompt exceeds maxseq");
+
+    auto seq = std::make_unique<Sequence>();
+    seq->id = _next_request_id++;
+    seq->tokens.assign(token_ids, token_ids + ntoken);
+    seq->prompt_len = ntoken;
+    seq->max_new_tokens = max_new_tokens;
+    seq->lookup_tokens = lookup_tokens;
+    seq->lookup_ngram = lookup_ngram;
+    seq->cache = std::make_unique<KVCache>(_newCache());
+    seq->finished = max_new_tokens == 0;
+    if (_trace) {
+        _trace->request(seq->id, token_ids, ntoken, max_new_tokens, lookup_tokens, lookup_ngram);
+    }
+    // 前缀在冷存储中时先发起异步换入，等本步其它序列的计算完成后再复用
+    if (!seq->finished && _prefix_cache && _window == 0 && _prefix_cache->prefetch(token_ids, ntoken - 1) > 0) {
+        seq->paging_in = true;
+    } else {
+        _reusePrefix(*seq->cache, token_ids, ntoken);
+    }
+    return _scheduler.add(std::move(seq)).id;
+}
+
+void Qwen2::_finishPageIn() {
+    for (auto *seq : _scheduler.pagingIn()) {
+        _reusePrefix(*seq->cache, seq->tokens.data(), seq->tokens.size());
+        seq->paging_in = false;
+    }
+}
+
+std::vector<StepOutput> Qwen2::step() {
+    std::vector<StepOutput> outputs;
+    _scheduler.release();
+    auto chunks = _scheduler.schedule();
+    if (chunks.empty()) {
+        // 只剩正在换入的序列，没有可以重叠的计算，直接等换入完成
+        _finishPageIn();
+        chunks = _scheduler.schedule();
+        if (chunks.empty()) {
+            return outputs;
+        }
+    }
+
+    // 开启 prompt lookup 的 decode 序列在最后一个 token 后面追加候选，一起验证
+    std::vector<std::vector<int64_t>> lookups(chunks.size());
+    std::vector<ForwardItem> items;
+    std::vector<size_t> prev_sizes;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        auto &seq = *chunks[i].seq;
+        prev_sizes.push_back(seq.cache->size());
+        const int64_t *token_ids = seq.tokens.data() + seq.cache->size();
+        size_t ntoken = chunks[i].ntoken;
+        size_t nlogits = chunks[i].sample ? 1 : 0;
+        if (seq.decoding() && seq.lookup_tokens > 0) {
+            const size_t k = std::min({seq.lookup_tokens,
+                                       seq.max_new_tokens - seq.generated - 1,
+                                       _maxContext() - seq.tokens.size(),
+                                       seq.cache->maxChunk() - 1});
+            auto proposals = promptLookup(seq.tokens.data(), seq.tokens.size(), seq.lookup_ngram, k);
+            if (!proposals.empty()) {
+                lookups[i].assign(token_ids, token_ids + ntoken);
+                lookups[i].insert(lookups[i].end(), proposals.begin(), proposals.end());
+                token_ids = lookups[i].data();
+                ntoken = nlogits = lookups[i].size();
+            }
+        }
+        items.push_back({seq.cache.get(), token_ids, ntoken, nlogits});
+    }
+    auto hidden = _forward(items);
+    auto tokens = hidden ? _argmax(hidden) : std::vector<int64_t>{};
+
+    size_t row = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        auto &seq = *chunks[i].seq;
+        if (chunks[i].sample) {
+            // 贪心验证：候选与上一位置的 argmax 相同则接受，第一个不同的位置用 argmax 修正
+            const size_t nproposal = lookups[i].empty() ? 0 : lookups[i].size() - 1;
+            size_t accepted = 0;
+            for (size_t j = 0; j <= nproposal && !seq.finished; j++) {
+                int64_t token = tokens[row + j];
+                seq.tokens.push_back(token);
+                seq.generated++;
+                seq.finished = token == _meta.end_token
+                            || seq.generated >= seq.max_new_tokens
+                            || seq.tokens.size() >= _maxContext();
+                outputs.push_back({seq.id, token, seq.finished});
+                if (j == nproposal || token != lookups[i][j + 1]) {
+                    break;
+                }
+                accepted++;
+            }
+            row += nproposal + 1;
+            if (nproposal > 0) {
+                // cache 中只保留到倒数第二个 token，回滚未被接受的候选
+                seq.cache->truncate(seq.tokens.size() - 1);
+                _spec_stats.steps++;
+                _spec_stats.proposed += nproposal;
+                _spec_stats.accepted += accepted;
+                _spec_stats.generated += accepted + 1;
+            }
+            if (seq.finished && _trace) {
+                _trace->finish(seq.id, seq.tokens.data(), seq.tokens.size(), seq.generated);
+            }
+        }
+        _cachePrefix(*seq.cache, prev_sizes[i]);
+    }
+    _finishPageIn();
+    return outputs;
+}
+
+size_t Qwen2::numRequests() const {
+    return _scheduler.size();
+}
+
+void Qwen2::setChunkSize(size_t token_budget) {
+    _scheduler.setTokenBudget(token_budget);
+}
+
+tensor_t Qwen2::_forward(const std::vector<ForwardItem> &items) {
+    const size_t hs = _meta.hs, nh = _meta.nh, nkvh = _meta.nkvh, dh = _meta.dh, di = _meta.di;
+    const auto dtype = _meta.dtype;
+    const float scale = 1.0f / std::sqrt(static_cast<float>(dh));
+
+    // 拼接所有序列的 token 和位置
+    std::vector<int64_t> index_host;
+    std::vector<int64_t> pos_host;
+    std::vector<size_t> offsets;
+    std::vector<size_t> logit_rows;
+    std::vector<int64_t> sink_pos_host;
+    std::vector<size_t> kvlens;
+    bool use_sink_pos = false;
+    for (auto &item : items) {
+        ASSERT(item.cache->window() == _window && item.cache->sink() == _sink && item.cache->pageSize() == _page,
+               "Qwen2: KV cache does not match the attention mode");
+        ASSERT(item.ntoken <= item.cache->maxChunk(), "Qwen2: chunk exceeds the sliding window");
+        const size_t past = item.cache->size();
+        item.cache->reserve(past + item.ntoken);
+        kvlens.push_back(past + item.ntoken);
+        offsets.push_back(index_host.size());
+        index_host.insert(index_host.end(), item.token_ids, item.token_ids + item.ntoken);
+        for (size_t j = 0; j < item.ntoken; j++) {
+            pos_host.push_back(static_cast<int64_t>(past + j));
+            // 流式模式下 query 与 sink 之间按 cache 内的距离计算 RoPE：query 在 cache 中的位置最多为 sink + window - 1
+            if (_window > 0) {
+                sink_pos_host.push_back(static_cast<int64_t>(std::min(past + j, _sink + _window - 1)));
+                use_sink_pos = use_sink_pos || sink_pos_host.back() != pos_host.back();
+            }
+        }
+        for (size_t j = item.ntoken - item.nlogits; j < item.ntoken; j++) {
+            logit_rows.push_back(offsets.back() + j);
+        }
+    }
+    const size_t ntoken = index_host.size();
+    offsets.push_back(ntoken); // 即 varlen attention 的 cu_seqlens
+    std::vector<ops::SequenceKV> layer_kv(items.size());
+
+    auto index = _tensor({ntoken}, LLAISYS_DTYPE_I64);
+    index->load(index_host.data());
+    auto pos_ids = _tensor({ntoken}, LLAISYS_DTYPE_I64);
+    pos_ids->load(pos_host.data());
+    // 窗口还没有滑动时 sink 位置的 query 与普通 query 相同，不需要额外计算
+    tensor_t sink_pos_ids, q_sink;
+    if (use_sink_pos) {
+        sink_pos_ids = _tensor({ntoken}, LLAISYS_DTYPE_I64);
+        sink_pos_ids->load(sink_pos_host.data());
+        q_sink = _tensor({ntoken, nh, dh}, dtype);
+    }
+
+    // 中间结果在所有层之间复用
+    auto x = _tensor({ntoken, hs}, dtype);
+    auto h = _tensor({ntoken, hs}, dtype);
+    auto q = _tensor({ntoken, nh, dh}, dtype);
+    auto k = _tensor({ntoken, nkvh, dh}, dtype);
+    auto v = _tensor({ntoken, nkvh, dh}, dtype);
+    auto attn = _tensor({ntoken, nh, dh}, dtype);
+    auto o = _tensor({ntoken, hs}, dtype);
+    auto gate = _tensor({ntoken, di}, dtype);
+    auto up = _tensor({ntoken, di}, dtype);
+    auto act = _tensor({ntoken, di}, dtype);
+    auto q2d = q->view({ntoken, nh * dh});
+    auto k2d = k->view({ntoken, nkvh * dh});
+    auto v2d = v->view({ntoken, nkvh * dh});
+    auto attn2d = attn->view({ntoken, nh * dh});
+
+    core::context().setDevice(_device_type, _device_id);
+    auto api = core::context().runtime().api();
+
+    ops::embedding(x, index, _weights.in_embed);
+
+    for (size_t l = 0; l < _meta.nlayer; l++) {
+        // --- Attention ---
+        ops::rms_norm(h, x, _weights.attn_norm_w[l], _meta.epsilon);
+        ops::linear(q2d, h, _weights.attn_q_w[l], _weights.attn_q_b[l]);
+        ops::linear(k2d, h, _weights.attn_k_w[l], _weights.attn_k_b[l]);
+        ops::linear(v2d, h, _weights.attn_v_w[l], _weights.attn_v_b[l]);
+        if (q_sink) {
+            ops::rope(q_sink, q, sink_pos_ids, _meta.theta);
+        }
+        ops::rope(q, q, pos_ids, _meta.theta);
+        ops::rope(k, k, pos_ids, _meta.theta);
+
+        // 每条序列的新 K/V 追加进自己的 cache，再用一次 varlen attention 让各序列只看自己的全部历史
+        for (size_t i = 0; i < items.size(); i++) {
+            auto &item = items[i];
+            const size_t begin = offsets[i], end = begin + item.ntoken;
+            item.cache->store(l, item.cache->size(), k->slice(0, begin, end)->data(), v->slice(0, begin, end)->data(), item.ntoken);
+            // 流式 cache 读整个 ring buffer
+            const size_t rows = std::min(kvlens[i], item.cache->capacity());
+            layer_kv[i] = {item.cache->keys(l, 0, rows), item.cache->values(l, 0, rows), kvlens[i],
+                           item.cache->pageMin(l), item.cache->pageMax(l),
+                           _page > 0 && item.ntoken <= SPARSE_MAX_QUERY_TOKENS};
+        }
+        ops::self_attention_varlen(attn, q, layer_kv, offsets, scale, {_sink, _window, _page, _top_pages, _recent},
+                                   q_sink);
+        ops::linear(o, attn2d, _weights.attn_o_w[l], nullptr);
+        ops::add(x, x, o);
+
+        // --- MLP ---
+        ops::rms_norm(h, x, _weights.mlp_norm_w[l], _meta.epsilon);
+        ops::linear(gate, h, _weights.mlp_gate_w[l], nullptr);
+        ops::linear(up, h, _weights.mlp_up_w[l], nullptr);
+        ops::swiglu(act, gate, up);
+        ops::linear(o, act, _weights.mlp_down_w[l], nullptr);
+        ops::add(x, x, o);
+    }
+    for (auto &item : items) {
+        item.cache->commit(item.token_ids, item.ntoken);
+    }
+
+    if (logit_rows.empty()) {
+        return nullptr;
+    }
+    // 只取需要 logits 的行，之后的 norm 和 LM head 只对这些行计算
+    const size_t m = logit_rows.size();
+    auto hidden = _tensor({m, hs}, dtype);
+    const size_t row_bytes = hs * utils::dsize(dtype);
+    for (size_t i = 0; i < m; i++) {
+        api->memcpy_sync(hidden->data() + i * row_bytes, x->data() + logit_rows[i] * row_bytes, row_bytes, LLAISYS_MEMCPY_D2D);
+    }
+    return hidden;
+}
+
+tensor_t Qwen2::_concatRows(const std::vector<tensor_t> &pieces) {
+    size_t rows = 0;
+    for (auto &piece : pieces) {
+        rows += piece->shape()[0];
+    }
+    auto out = _tensor({rows, _meta.hs}, _meta.dtype);
+    core::context().setDevice(_device_type, _device_id);
+    auto api = core::context().runtime().api();
+    std::byte *dst = out->data();
+    for (auto &piece : pieces) {
+        const size_t bytes = piece->numel() * piece->elementSize();
+        api->memcpy_sync(dst, piece->data(), bytes, LLAISYS_MEMCPY_D2D);
+        dst += bytes;
+    }
+    return out;
+}
+
+tensor_t Qwen2::_lmHead(tensor_t hidden) {
+    auto normed = _tensor(hidden->shape(), _meta.dtype);
+    ops::rms_norm(normed, hidden, _weights.out_norm_w, _meta.epsilon);
+    auto logits = _tensor({hidden->shape()[0], _meta.voc}, _meta.dtype);
+    ops::linear(logits, normed, _weights.out_embed, nullptr);
+    return logits;
+}
+
+std::vector<int64_t> Qwen2::_argmax(tensor_t hidden) {
+    const size_t m = hidden->shape()[0];
+    auto max_idx = _tensor({m, 1}, LLAISYS_DTYPE_I64);
+    auto max_val = _tensor({m, 1}, _meta.dtype);
+    ops::lm_head_topk(max_idx, max_val, hidden, _weights.out_norm_w, _weights.out_embed, _meta.epsilon);
+
+    std::vector<int64_t> tokens(m);
+    core::context().setDevice(_device_type, _device_id);
+    core::context().runtime().api()->memcpy_sync(tokens.data(), max_idx->data(), m * sizeof(int64_t), LLAISYS_MEMCPY_D2H);
+    return tokens;
+}
+
+int64_t Qwen2::_sample(tensor_t hidden, float temperature, int64_t top_k, float top_p) {
+    if (temperature <= 0.0f || top_k == 1) {
+        return _argmax(hidden)[0];
+    }
+    auto idx = _tensor({1}, LLAISYS_DTYPE_I64);
+    core::context().setDevice(_device_type, _device_id);
+    auto api = core::context().runtime().api();
+    if (top_k > 0 && static_cast<size_t>(top_k) <= MAX_FUSED_TOP_K) {
+        // top-k 候选在 LM head 中直接选出，只在这 k 个 logits 上做 temperature / top-p 采样
+        const size_t k = std::min(static_cast<size_t>(top_k), _meta.voc);
+        auto cand_idx = _tensor({1, k}, LLAISYS_DTYPE_I64);
+        auto cand_val = _tensor({1, k}, _meta.dtype);
+        ops::lm_head_topk(cand_idx, cand_val, hidden, _weights.out_norm_w, _weights.out_embed, _meta.epsilon);
+        ops::sample(idx, cand_val, temperature, 0, top_p, _rng());
+
+        int64_t j = 0;
+        api->memcpy_sync(&j, idx->data(), sizeof(int64_t), LLAISYS_MEMCPY_D2H);
+        int64_t next_token = 0;
+        api->memcpy_sync(&next_token, cand_idx->data() + j * sizeof(int64_t), sizeof(int64_t), LLAISYS_MEMCPY_D2H);
+        return next_token;
+    }
+    ops::sample(idx, _lmHead(hidden), temperature, top_k, top_p, _rng());
+
+    int64_t next_token = 0;
+    api->memcpy_sync(&next_token, idx->data(), sizeof(int64_t), LLAISYS_MEMCPY_D2H);
+    return next_token;
+}
+
+void Qwen2::setPrefixCache(size_t block_size, size_t budget_bytes) {
+    if (budget_bytes == 0) {
+        _prefix_cache.reset();
+        return;
+    }
+    _prefix_cache = std::make_unique<PrefixCache>(block_size, budget_bytes, _offload_dir, _offload_bytes);
+}
+
+void Qwen2::setKVOffload(const std::string &dir, size_t budget_bytes) {
+    _offload_dir = dir;
+    _offload_bytes = budget_bytes;
+    if (_prefix_cache) {
+        setPrefixCache(_prefix_cache->blockSize(), _prefix_cache->budgetBytes());
+    }
+}
+
+PrefixCacheStats Qwen2::prefixCacheStats() const {
+    return _prefix_cache ? _prefix_cache->stats() : PrefixCacheStats{};
+}
+
+void Qwen2::setTrace(const std::string &path, llaisysQwen2TraceContent_t content) {
+    _trace.reset();
+    if (!path.empty()) {
+        _trace = std::make_unique<RequestTraceWriter>(path, content, _meta);
+    }
+}
+} // namespace llaisys::models
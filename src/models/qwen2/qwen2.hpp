@@ -0,0 +1,179 @@
+#pragma once
+
+#include "llaisys/models/qwen2.h"
+
+#include "../../tensor/tensor.hpp"
+#include "../kv_cache/kv_cache.hpp"
+#include "../prefix_cache/prefix_cache.hpp"
+#include "../request_trace/request_trace.hpp"
+#include "../scheduler/scheduler.hpp"
+#include "../speculative/speculative.hpp"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace llaisys::models {
+struct Qwen2Weights {
+    tensor_t in_embed;
+    tensor_t out_embed;
+    tensor_t out_norm_w;
+    std::vector<tensor_t> attn_norm_w;
+    std::vector<tensor_t> attn_q_w;
+    std::vector<tensor_t> attn_q_b;
+    std::vector<tensor_t> attn_k_w;
+    std::vector<tensor_t> attn_k_b;
+    std::vector<tensor_t> attn_v_w;
+    std::vector<tensor_t> attn_v_b;
+    std::vector<tensor_t> attn_o_w;
+    std::vector<tensor_t> mlp_norm_w;
+    std::vector<tensor_t> mlp_gate_w;
+    std::vector<tensor_t> mlp_up_w;
+    std::vector<tensor_t> mlp_down_w;
+};
+
+// 一次前向中属于同一条序列的一段 token
+struct ForwardItem {
+    KVCache *cache;
+    const int64_t *token_ids;
+    size_t ntoken;
+    size_t nlogits; // 需要 logits 的末尾 token 数（0 表示不需要）
+};
+
+// 打分请求：token_ids[0, prompt_len) 为 prompt，其后为需要打分的 continuation
+struct ScoreRequest {
+    const int64_t *token_ids;
+    size_t ntoken;
+    size_t prompt_len;
+};
+
+struct StepOutput {
+    int64_t request_id;
+    int64_t token;
+    bool finished;
+};
+
+// prompt lookup 默认最长匹配的 n-gram
+constexpr size_t DEFAULT_LOOKUP_NGRAM = 3;
+
+class Qwen2 {
+private:
+    LlaisysQwen2Meta _meta;
+    llaisysDeviceType_t _device_type;
+    int _device_id;
+    Qwen2Weights _weights;
+    KVCache _cache;
+    std::unique_ptr<PrefixCache> _prefix_cache;
+    Scheduler _scheduler;
+    int64_t _next_request_id;
+    std::mt19937_64 _rng;
+    SpeculativeStats _spec_stats;
+    // 流式模式：保留前 _sink 个 token 和最近 _window 个 token（_window 为 0 表示关闭）
+    size_t _sink;
+    size_t _window;
+    // 稀疏 attention：decode 时每个 query 只看 _top_pages 页（每页 _page 个位置）和最近 _recent 个位置（_page 为 0 表示关闭）
+    size_t _page;
+    size_t _top_pages;
+    size_t _recent;
+    // 前缀缓存的冷存储（_offload_bytes 为 0 表示关闭）
+    std::string _offload_dir;
+    size_t _offload_bytes;
+    // 请求 trace（为空表示不记录）
+    std::unique_ptr<RequestTraceWriter> _trace;
+
+    tensor_t _tensor(const shape_t &shape, llaisysDataType_t dtype) const;
+    // 按当前流式 / 稀疏模式创建一个空的 KV Cache
+    KVCache _newCache() const;
+    // 单条序列允许的最大长度
+    size_t _maxContext() const;
+    // 由权重采样得到的模型 hash，用于校验 KV 快照
+    uint64_t _modelHash() const;
+    // 复用 cache 中（以及前缀缓存中）与 token_ids 相同的前缀，返回需要开始计算的位置；
+    // 末尾 nlogits 个 token 必须参与前向
+    size_t _reusePrefix(KVCache &cache, const int64_t *token_ids, size_t ntoken, size_t nlogits = 1);
+    // 把多条序列的新 token 拼成一个 batch 做前向：线性层一次算完，attention 用一次 varlen 调用按序列各自做 mask。
+    // 返回各序列末尾 nlogits 个 token 的 hidden states [m, hs]（final norm 之前，按 items 顺序），没有则返回 nullptr
+    tensor_t _forward(const std::vector<ForwardItem> &items);
+    // 默认序列的前向（长 prompt 分块），返回末尾 nlogits 个 token 的 hidden states
+    tensor_t _prefill(const int64_t *token_ids, size_t ntoken, size_t nlogits);
+    tensor_t _concatRows(const std::vector<tensor_t> &pieces);
+    // final norm + LM head，得到完整 logits [m, voc]
+    tensor_t _lmHead(tensor_t hidden);
+    // 融合的 final norm + LM head + argmax，不生成完整 logits
+    std::vector<int64_t> _argmax(tensor_t hidden);
+    int64_t _sample(tensor_t hidden, float temperature, int64_t top_k, float top_p);
+    // 对 token_ids[0, ntoken) 之后的候选 proposals 做一次前向验证，回滚未被接受的 K/V 并更新统计
+    std::vector<int64_t> _verify(const int64_t *token_ids, size_t ntoken, const std::vector<int64_t> &proposals,
+                                 const std::vector<float> &draft_probs, size_t draft_voc, float temperature);
+    // 把 cache 中新凑满的块写入前缀缓存
+    void _cachePrefix(const KVCache &cache, size_t prev_size);
+    // 正在换入前缀的请求：等换入完成后复用前缀，之后参与调度
+    void _finishPageIn();
+
+public:
+    Qwen2(const LlaisysQwen2Meta &meta, llaisysDeviceType_t device_type, int device_id);
+    ~Qwen2() = default;
+
+    const LlaisysQwen2Meta &meta() const;
+    Qwen2Weights &weights();
+
+    // token_ids 为完整上下文（prompt + 已生成的 token），返回下一个 token（argmax）
+    int64_t infer(const int64_t *token_ids, size_t ntoken);
+    // 同 infer，但按 temperature / top_k / top_p 采样下一个 token
+    int64_t infer(const int64_t *token_ids, size_t ntoken, float temperature, int64_t top_k, float top_p);
+    // 同 infer，但返回最后 nlogits 个位置的 logits [nlogits, voc]；
+    // LM head 只对这些位置计算（nlogits = ntoken 即全部位置，用于打分）
+    tensor_t logits(const int64_t *token_ids, size_t ntoken, size_t nlogits);
+
+    // 批量打分：多个请求拼成 ragged prefill（按 token 预算分步），返回每个 continuation token 的 log 概率，
+    // 按请求顺序拼接。每个请求使用临时 KV Cache，算完即释放，不写入前缀缓存
+    std::vector<float> score(const std::vector<ScoreRequest> &requests);
+
+    // 投机解码一步：draft 模型自回归提出 k 个候选，本模型一次前向验证全部候选。
+    // 返回 1..k+1 个 token；temperature <= 0 时为贪心，输出与逐个 infer 完全一致
+    std::vector<int64_t> speculate(Qwen2 &draft, const int64_t *token_ids, size_t ntoken,
+                                   size_t k, float temperature);
+    // 无 draft 模型的投机：用 prompt lookup（n-gram 匹配上下文）提出至多 k 个候选，再一次前向验证
+    std::vector<int64_t> lookupStep(const int64_t *token_ids, size_t ntoken, size_t k, size_t max_ngram,
+                                    float temperature);
+    // 投机解码（两种模式以及请求级 prompt lookup）的累计统计
+    SpeculativeStats speculativeStats() const;
+    void setSeed(uint64_t seed);
+
+    // 请求级接口：提交后反复调用 step()，每步按 token 预算把 prefill 分块并与 decode 拼在一起执行
+    // lookup_tokens > 0 时该请求 decode 阶段开启 prompt lookup 投机（贪心结果不变）
+    int64_t addRequest(const int64_t *token_ids, size_t ntoken, size_t max_new_tokens,
+                       size_t lookup_tokens = 0, size_t lookup_ngram = DEFAULT_LOOKUP_NGRAM);
+    std::vector<StepOutput> step();
+    size_t numRequests() const;
+    // 每步（以及 infer 的 prefill 每块）最多计算的 token 数，0 表示不分块
+    void setChunkSize(size_t token_budget);
+
+    // StreamingLLM 式的流式模式：KV Cache 只保留前 sink 个 token 和最近 window 个 token（ring buffer），
+    // 显存和每个 token 的计算量与对话长度无关。sink 与其它 token 的 RoPE 距离按 cache 内的位置计算。
+    // window 为 0 时关闭；流式 cache 不使用前缀缓存。只能在没有进行中的请求时切换，会清空默认序列的 cache
+    void setStreaming(size_t sink, size_t window);
+
+    // Quest 式的稀疏 attention：KV Cache 按 page_size 分页并维护每页 key 的逐维最小值 / 最大值，
+    // decode 时每个 query 按点积上界只读 top_pages 页加最近 recent 个位置。prefill 仍然是稠密的。
+    // page_size 为 0 时关闭；不能与流式模式同时使用。只能在没有进行中的请求时切换，会清空默认序列的 cache
+    void setSparseAttention(size_t page_size, size_t top_pages, size_t recent);
+
+    // 默认序列（infer / logits 使用的 cache）的 KV 快照：保存 token 历史和全部 K/V，
+    // 进程重启后加载即可跳过 prefill。加载时校验快照版本、模型 meta 和模型 hash，返回恢复的 token 历史
+    void saveCache(const std::string &path);
+    std::vector<int64_t> loadCache(const std::string &path);
+
+    // budget_bytes 为 0 时关闭前缀缓存
+    void setPrefixCache(size_t block_size, size_t budget_bytes);
+    // 前缀缓存的冷存储：超出前缀缓存预算的块换出到 dir 下的内存映射文件（dir 为空时为主机内存），
+    // 最多 budget_bytes 字节，命中时再换入。请求级接口在 addRequest 时发起异步换入，与下一步的计算重叠。
+    // budget_bytes 为 0 时关闭；会清空前缀缓存
+    void setKVOffload(const std::string &dir, size_t budget_bytes);
+    PrefixCacheStats prefixCacheStats() const;
+
+    // 把之后的 addRequest 和 infer 调用记录到 path，path 为空时停止记录
+    void setTrace(const std::string &path, llaisysQwen2TraceContent_t content);
+};
+} // namespace llaisys::models
@@ -0,0 +1,461 @@
+#include "request_trace.hpp"
+
+#include "../../utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace llaisys::models {
+namespace {
+constexpr char TRACE_MAGIC[8] = {'L', 'L', 'A', 'I', 'S', 'Y', 'T', 'R'};
+// 找共享前缀时按块比较：每块 TRACE_BLOCK 个 token 的链式 hash
+constexpr size_t TRACE_BLOCK = 16;
+// 保留最近这么多条记录的完整序列，用于逐 token 比较块内的部分
+constexpr size_t RECENT_SEQUENCES = 64;
+// 块 hash 表超过这个大小时清空（之后的请求只能与新记录共享前缀）
+constexpr size_t MAX_BLOCKS = size_t(1) << 20;
+
+enum : uint8_t {
+    TAG_REQUEST = LLAISYS_QWEN2_TRACE_REQUEST,
+    TAG_INFER = LLAISYS_QWEN2_TRACE_INFER,
+    TAG_FINISH = 2,
+};
+
+// 所有字段都是定长整数，浮点按位保存，文件头与编译器的结构体布局无关
+struct TraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t content;
+    uint32_t dtype;
+    uint32_t epsilon_bits, theta_bits;
+    uint32_t reserved;
+    uint64_t nlayer, hs, nh, nkvh, dh, di, maxseq, voc;
+    int64_t end_token;
+};
+static_assert(sizeof(TraceHeader) == 104, "TraceHeader must have no padding");
+
+uint32_t float_bits(float x) {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+float bits_float(uint32_t bits) {
+    float x;
+    std::memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+uint64_t hashBlock(uint64_t h, const int64_t *tokens) {
+    for (size_t i = 0; i < TRACE_BLOCK; i++) {
+        h = mix(h ^ static_cast<uint64_t>(tokens[i]));
+    }
+    return h;
+}
+
+// 回放用的伪 token：由记录序号、位置和用途（prompt / 输出）确定
+int64_t pseudoToken(size_t index, size_t pos, uint64_t salt, size_t voc) {
+    return static_cast<int64_t>(mix(mix(index * 2 + salt) ^ pos) % voc);
+}
+
+int64_t clampToken(int64_t token, size_t voc) {
+    return token >= 0 ? token % static_cast<int64_t>(voc) : 0;
+}
+
+uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+void putVarint(std::string &buf, uint64_t v) {
+    while (v >= 0x80) {
+        buf.push_back(static_cast<char>(v | 0x80));
+        v >>= 7;
+    }
+    buf.push_back(static_cast<char>(v));
+}
+
+void putFloat(std::string &buf, float x) {
+    const uint32_t bits = float_bits(x);
+    for (int i = 0; i < 4; i++) {
+        buf.push_back(static_cast<char>(bits >> (8 * i)));
+    }
+}
+
+// 顺序读取记录，越界时 ok 变为 false（文件末尾写了一半的记录）
+struct Cursor {
+    const std::string &data;
+    size_t pos;
+    bool ok = true;
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; ok; shift += 7) {
+            if (pos >= data.size() || shift > 63) {
+                ok = false;
+                break;
+            }
+            const auto byte = static_cast<uint8_t>(data[pos++]);
+            v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+        }
+        return v;
+    }
+
+    float f32() {
+        if (pos + 4 > data.size()) {
+            ok = false;
+            return 0;
+        }
+        uint32_t bits = 0;
+        for (int i = 0; i < 4; i++) {
+            bits |= static_cast<uint32_t>(static_cast<uint8_t>(data[pos++])) << (8 * i);
+        }
+        return bits_float(bits);
+    }
+
+    void tokens(std::vector<int64_t> &out, uint64_t n) {
+        // 数量本身可能来自写了一半的记录，每个 token 至少一个字节
+        if (n > data.size() - pos) {
+            ok = false;
+            return;
+        }
+        out.resize(n);
+        for (auto &t : out) {
+            t = unzigzag(varint());
+        }
+    }
+};
+} // namespace
+
+RequestTraceWriter::RequestTraceWriter(const std::string &path, llaisysQwen2TraceContent_t content,
+                                       const LlaisysQwen2Meta &meta)
+    : _out(path, std::ios::binary | std::ios::trunc), _content(content),
+      _start(std::chrono::steady_clock::now()), _nrecord(0) {
+    CHECK_ARGUMENT(_out.good(), "RequestTrace: cannot open " + path);
+    CHECK_ARGUMENT(content == LLAISYS_QWEN2_TRACE_ANONYMOUS || content == LLAISYS_QWEN2_TRACE_TOKENS,
+                   "RequestTrace: unknown trace content");
+    TraceHeader h{};
+    std::memcpy(h.magic, TRACE_MAGIC, sizeof(h.magic));
+    h.version = REQUEST_TRACE_VERSION;
+    h.content = static_cast<uint32_t>(content);
+    h.dtype = static_cast<uint32_t>(meta.dtype);
+    h.epsilon_bits = float_bits(meta.epsilon);
+    h.theta_bits = float_bits(meta.theta);
+    h.nlayer = meta.nlayer;
+    h.hs = meta.hs;
+    h.nh = meta.nh;
+    h.nkvh = meta.nkvh;
+    h.dh = meta.dh;
+    h.di = meta.di;
+    h.maxseq = meta.maxseq;
+    h.voc = meta.voc;
+    h.end_token = meta.end_token;
+    _out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    _out.flush();
+}
+
+uint64_t RequestTraceWriter::now() const {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count());
+}
+
+void RequestTraceWriter::_extend(size_t index, const int64_t *token_ids, size_t ntoken, size_t from) {
+    if (_blocks.size() > MAX_BLOCKS) {
+        _blocks.clear();
+    }
+    uint64_t h = 0;
+    for (size_t b = 0; (b + 1) * TRACE_BLOCK <= ntoken; b++) {
+        h = hashBlock(h, token_ids + b * TRACE_BLOCK);
+        if ((b + 1) * TRACE_BLOCK > from) {
+            _blocks[h] = index;
+        }
+    }
+}
+
+void RequestTraceWriter::_prefix(const int64_t *token_ids, size_t ntoken, TraceRequest &r) {
+    r.ref = 0;
+    r.shared = 0;
+    // 先按块找最长的共享前缀，再逐 token 比较块内剩余的部分
+    uint64_t h = 0;
+    for (size_t b = 0; (b + 1) * TRACE_BLOCK <= ntoken; b++) {
+        h = hashBlock(h, token_ids + b * TRACE_BLOCK);
+        auto it = _blocks.find(h);
+        if (it == _blocks.end()) {
+            break;
+        }
+        r.ref = it->second + 1;
+        r.shared = (b + 1) * TRACE_BLOCK;
+    }
+    auto extend = [&](size_t index, size_t from) {
+        auto it = _recent.find(index);
+        if (it == _recent.end()) {
+            return;
+        }
+        const auto &seq = it->second;
+        size_t n = from;
+        while (n < ntoken && n < seq.size() && seq[n] == token_ids[n]) {
+            n++;
+        }
+        if (n > r.shared) {
+            r.ref = index + 1;
+            r.shared = n;
+        }
+    };
+    if (r.ref > 0) {
+        extend(r.ref - 1, r.shared);
+    }
+    // 上一条记录（例如逐 token 调用的 infer）直接逐 token 比较，不足一块的共享前缀也能找到
+    if (_nrecord > 0) {
+        extend(_nrecord - 1, 0);
+    }
+
+    const size_t index = _nrecord++;
+    _recent[index].assign(token_ids, token_ids + ntoken);
+    if (index >= RECENT_SEQUENCES) {
+        _recent.erase(index - RECENT_SEQUENCES);
+    }
+    _extend(index, token_ids, ntoken, 0);
+}
+
+void RequestTraceWriter::_write(const TraceRequest &r) {
+    std::string buf;
+    buf.push_back(static_cast<char>(r.kind));
+    putVarint(buf, r.arrival_ns);
+    if (r.kind == LLAISYS_QWEN2_TRACE_INFER) {
+        putVarint(buf, r.finish_ns);
+    } else {
+        putVarint(buf, zigzag(r.request_id));
+    }
+    putVarint(buf, r.prompt_len);
+    putVarint(buf, r.ref);
+    putVarint(buf, r.shared);
+    putVarint(buf, r.max_new_tokens);
+    putVarint(buf, r.lookup_tokens);
+    putVarint(buf, r.lookup_ngram);
+    putFloat(buf, r.temperature);
+    putVarint(buf, zigzag(r.top_k));
+    putFloat(buf, r.top_p);
+    if (_content == LLAISYS_QWEN2_TRACE_TOKENS) {
+        for (auto t : r.tokens) {
+            putVarint(buf, zigzag(t));
+        }
+        for (auto t : r.outputs) {
+            putVarint(buf, zigzag(t));
+        }
+    }
+    _out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    _out.flush();
+}
+
+void RequestTraceWriter::request(int64_t request_id, const int64_t *token_ids, size_t ntoken, size_t max_new_tokens,
+                                 size_t lookup_tokens, size_t lookup_ngram) {
+    TraceRequest r{};
+    r.kind = LLAISYS_QWEN2_TRACE_REQUEST;
+    r.request_id = request_id;
+    r.arrival_ns = now();
+    r.prompt_len = ntoken;
+    r.max_new_tokens = max_new_tokens;
+    r.lookup_tokens = lookup_tokens;
+    r.lookup_ngram = lookup_ngram;
+    // 请求级接口是贪心的
+    r.temperature = 0.0f;
+    r.top_k = 1;
+    r.top_p = 1.0f;
+    _inflight[request_id] = _nrecord;
+    _prefix(token_ids, ntoken, r);
+    if (_content == LLAISYS_QWEN2_TRACE_TOKENS) {
+        r.tokens.assign(token_ids + r.shared, token_ids + ntoken);
+    }
+    _write(r);
+}
+
+void RequestTraceWriter::finish(int64_t request_id, const int64_t *token_ids, size_t ntoken, size_t generated) {
+    auto it = _inflight.find(request_id);
+    if (it == _inflight.end()) {
+        return;
+    }
+    const size_t index = it->second;
+    _inflight.erase(it);
+    // 之后的请求（例如多轮对话的下一轮）可以共享这条请求的输出
+    auto seq = _recent.find(index);
+    if (seq != _recent.end()) {
+        seq->second.assign(token_ids, token_ids + ntoken);
+    }
+    _extend(index, token_ids, ntoken, ntoken - generated);
+
+    std::string buf;
+    buf.push_back(static_cast<char>(TAG_FINISH));
+    putVarint(buf, zigzag(request_id));
+    putVarint(buf, now());
+    putVarint(buf, generated);
+    if (_content == LLAISYS_QWEN2_TRACE_TOKENS) {
+        for (size_t i = ntoken - generated; i < ntoken; i++) {
+            putVarint(buf, zigzag(token_ids[i]));
+        }
+    }
+    _out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    _out.flush();
+}
+
+void RequestTraceWriter::infer(uint64_t arrival_ns, const int64_t *token_ids, size_t ntoken, int64_t output,
+                               float temperature, int64_t top_k, float top_p) {
+    TraceRequest r{};
+    r.kind = LLAISYS_QWEN2_TRACE_INFER;
+    r.request_id = -1;
+    r.arrival_ns = arrival_ns;
+    r.finish_ns = now();
+    r.prompt_len = ntoken;
+    r.max_new_tokens = 1;
+    r.generated = 1;
+    r.temperature = temperature;
+    r.top_k = top_k;
+    r.top_p = top_p;
+    const size_t index = _nrecord;
+    _prefix(token_ids, ntoken, r);
+    // 下一次调用的上下文一般是这次的上下文加上这次的输出
+    _recent[index].push_back(output);
+    _extend(index, _recent[index].data(), ntoken + 1, ntoken);
+    if (_content == LLAISYS_QWEN2_TRACE_TOKENS) {
+        r.tokens.assign(token_ids + r.shared, token_ids + ntoken);
+        r.outputs = {output};
+    }
+    _write(r);
+}
+
+RequestTrace::RequestTrace(const std::string &path) : _voc(0) {
+    std::ifstream in(path, std::ios::binary);
+    CHECK_ARGUMENT(in.good(), "RequestTrace: cannot open " + path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string data = ss.str();
+
+    TraceHeader h;
+    CHECK_ARGUMENT(data.size() >= sizeof(h), "RequestTrace: file too small");
+    std::memcpy(&h, data.data(), sizeof(h));
+    CHECK_ARGUMENT(std::memcmp(h.magic, TRACE_MAGIC, sizeof(h.magic)) == 0, "RequestTrace: not a request trace");
+    CHECK_ARGUMENT(h.version == REQUEST_TRACE_VERSION, "RequestTrace: unsupported trace version");
+    CHECK_ARGUMENT(h.content == LLAISYS_QWEN2_TRACE_ANONYMOUS || h.content == LLAISYS_QWEN2_TRACE_TOKENS,
+                   "RequestTrace: unknown trace content");
+    _content = static_cast<llaisysQwen2TraceContent_t>(h.content);
+    _meta = {static_cast<llaisysDataType_t>(h.dtype), h.nlayer, h.hs, h.nh, h.nkvh, h.dh, h.di, h.maxseq, h.voc,
+             bits_float(h.epsilon_bits), bits_float(h.theta_bits), h.end_token};
+    const bool tokens = _content == LLAISYS_QWEN2_TRACE_TOKENS;
+
+    std::unordered_map<int64_t, size_t> ids;
+    Cursor c{data, sizeof(h)};
+    while (c.pos < data.size()) {
+        const auto tag = static_cast<uint8_t>(data[c.pos++]);
+        if (tag == TAG_FINISH) {
+            const int64_t id = unzigzag(c.varint());
+            const uint64_t finish_ns = c.varint();
+            const uint64_t generated = c.varint();
+            std::vector<int64_t> outputs;
+            if (tokens) {
+                c.tokens(outputs, generated);
+            }
+            auto it = ids.find(id);
+            if (!c.ok || it == ids.end()) {
+                break;
+            }
+            auto &r = _requests[it->second];
+            r.finish_ns = finish_ns;
+            r.generated = generated;
+            r.outputs = std::move(outputs);
+            continue;
+        }
+        CHECK_ARGUMENT(tag == TAG_REQUEST || tag == TAG_INFER, "RequestTrace: corrupted record");
+        TraceRequest r{};
+        r.kind = static_cast<llaisysQwen2TraceKind_t>(tag);
+        r.arrival_ns = c.varint();
+        if (tag == TAG_INFER) {
+            r.request_id = -1;
+            r.finish_ns = c.varint();
+            r.generated = 1;
+        } else {
+            r.request_id = unzigzag(c.varint());
+        }
+        r.prompt_len = c.varint();
+        r.ref = c.varint();
+        r.shared = c.varint();
+        r.max_new_tokens = c.varint();
+        r.lookup_tokens = c.varint();
+        r.lookup_ngram = c.varint();
+        r.temperature = c.f32();
+        r.top_k = unzigzag(c.varint());
+        r.top_p = c.f32();
+        if (tokens && c.ok) {
+            c.tokens(r.tokens, r.prompt_len - std::min(r.shared, r.prompt_len));
+            if (tag == TAG_INFER) {
+                c.tokens(r.outputs, 1);
+            }
+        }
+        if (!c.ok) {
+            break;
+        }
+        CHECK_ARGUMENT(r.ref <= _requests.size() && r.shared <= r.prompt_len && (r.ref > 0 || r.shared == 0),
+                       "RequestTrace: corrupted record");
+        if (tag == TAG_REQUEST) {
+            ids[r.request_id] = _requests.size();
+        }
+        _requests.push_back(std::move(r));
+    }
+    _outputs.resize(_requests.size());
+}
+
+int64_t RequestTrace::_sequenceToken(size_t index, size_t pos) const {
+    const auto &r = _requests[index];
+    if (pos < r.prompt_len) {
+        return _prompts[index][pos];
+    }
+    const size_t k = pos - r.prompt_len;
+    const auto &outputs = _content == LLAISYS_QWEN2_TRACE_TOKENS ? r.outputs : _outputs[index];
+    if (k < outputs.size()) {
+        return clampToken(outputs[k], _voc);
+    }
+    // 回放时还不知道这条记录的输出：共享它的后续记录之间仍然共享同样的 token
+    return pseudoToken(index, pos, 1, _voc);
+}
+
+const std::vector<int64_t> &RequestTrace::prompt(size_t index, size_t voc) {
+    CHECK_ARGUMENT(index < _requests.size(), "RequestTrace: index out of range");
+    CHECK_ARGUMENT(voc > 0, "RequestTrace: voc must be positive");
+    if (voc != _voc) {
+        _voc = voc;
+        _prompts.clear();
+    }
+    while (_prompts.size() <= index) {
+        const size_t i = _prompts.size();
+        const auto &r = _requests[i];
+        std::vector<int64_t> p;
+        p.reserve(r.prompt_len);
+        for (size_t pos = 0; pos < r.shared; pos++) {
+            p.push_back(_sequenceToken(r.ref - 1, pos));
+        }
+        for (size_t pos = r.shared; pos < r.prompt_len; pos++) {
+            p.push_back(_content == LLAISYS_QWEN2_TRACE_TOKENS ? clampToken(r.tokens[pos - r.shared], voc)
+                                                               : pseudoToken(i, pos, 0, voc));
+        }
+        _prompts.push_back(std::move(p));
+    }
+    return _prompts[index];
+}
+
+void RequestTrace::setOutput(size_t index, const int64_t *tokens, size_t ntoken) {
+    CHECK_ARGUMENT(index < _requests.size(), "RequestTrace: index out of range");
+    _outputs[index].assign(tokens, tokens + ntoken);
+}
+} // namespace llaisys::models
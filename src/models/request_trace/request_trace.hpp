@@ -0,0 +1,94 @@
+#pragma once
+
+#include "llaisys/models/qwen2.h"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace llaisys::models {
+// 请求 trace 文件：定长文件头（magic、版本、记录内容、模型 meta）之后是一串变长记录，整数都用 LEB128 变长编码。
+// 匿名模式不保存 token：每个 prompt 只记录与此前哪条记录（prompt + 输出）共享多长的前缀，
+// 回放时据此生成伪 token，前缀缓存 / 默认序列复用的命中情况与原始负载一致。格式变化时递增版本号
+constexpr uint32_t REQUEST_TRACE_VERSION = 1;
+
+struct TraceRequest {
+    llaisysQwen2TraceKind_t kind;
+    int64_t request_id;
+    uint64_t arrival_ns;
+    uint64_t finish_ns;
+    size_t prompt_len;
+    size_t ref;    // 共享前缀来自第几条记录（从 1 开始），0 表示没有
+    size_t shared; // 共享前缀的长度
+    size_t max_new_tokens;
+    size_t generated;
+    size_t lookup_tokens;
+    size_t lookup_ngram;
+    float temperature;
+    int64_t top_k;
+    float top_p;
+    // TOKENS 模式：prompt 中共享前缀之后的 token，以及生成的 token
+    std::vector<int64_t> tokens;
+    std::vector<int64_t> outputs;
+};
+
+class RequestTraceWriter {
+private:
+    std::ofstream _out;
+    llaisysQwen2TraceContent_t _content;
+    std::chrono::steady_clock::time_point _start;
+    size_t _nrecord;
+    // 最近若干条记录的 prompt + 输出，用来精确到 token 地找共享前缀
+    std::unordered_map<size_t, std::vector<int64_t>> _recent;
+    // 前缀块的链式 hash -> 最近一条包含该前缀的记录
+    std::unordered_map<uint64_t, size_t> _blocks;
+    std::unordered_map<int64_t, size_t> _inflight; // request_id -> 记录序号
+
+    // 找出与此前记录最长的共享前缀，并登记这条记录
+    void _prefix(const int64_t *token_ids, size_t ntoken, TraceRequest &r);
+    // 记录 index 的完整序列（prompt + 输出）确定之后，登记输出部分的前缀块
+    void _extend(size_t index, const int64_t *token_ids, size_t ntoken, size_t from);
+    void _write(const TraceRequest &r);
+
+public:
+    RequestTraceWriter(const std::string &path, llaisysQwen2TraceContent_t content, const LlaisysQwen2Meta &meta);
+
+    uint64_t now() const;
+    // 请求到达时记录
+    void request(int64_t request_id, const int64_t *token_ids, size_t ntoken, size_t max_new_tokens,
+                 size_t lookup_tokens, size_t lookup_ngram);
+    // 请求结束：token_ids 为 prompt + 生成的 generated 个 token
+    void finish(int64_t request_id, const int64_t *token_ids, size_t ntoken, size_t generated);
+    // 一次 infer 调用返回时记录，arrival_ns 为调用开始的时间
+    void infer(uint64_t arrival_ns, const int64_t *token_ids, size_t ntoken, int64_t output, float temperature,
+               int64_t top_k, float top_p);
+};
+
+// 读取整个 trace（结束记录合并进对应的请求；末尾写了一半的记录被忽略），并为回放生成 prompt
+class RequestTrace {
+private:
+    llaisysQwen2TraceContent_t _content;
+    LlaisysQwen2Meta _meta;
+    std::vector<TraceRequest> _requests;
+    // 回放时实际的输出（匿名模式）
+    std::vector<std::vector<int64_t>> _outputs;
+    // 已经生成的回放 prompt，按记录顺序生成；voc 变化时重新生成
+    size_t _voc;
+    std::vector<std::vector<int64_t>> _prompts;
+
+    // 记录 index 的完整序列（prompt + 输出）中第 pos 个 token
+    int64_t _sequenceToken(size_t index, size_t pos) const;
+
+public:
+    explicit RequestTrace(const std::string &path);
+
+    llaisysQwen2TraceContent_t content() const { return _content; }
+    const LlaisysQwen2Meta &meta() const { return _meta; }
+    const std::vector<TraceRequest> &requests() const { return _requests; }
+    const std::vector<int64_t> &prompt(size_t index, size_t voc);
+    void setOutput(size_t index, const int64_t *tokens, size_t ntoken);
+};
+} // namespace llaisys::models
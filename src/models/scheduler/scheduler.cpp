@@ -0,0 +1,69 @@
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace llaisys::models {
+Scheduler::Scheduler(size_t token_budget) : _token_budget(token_budget) {}
+
+void Scheduler::setTokenBudget(size_t token_budget) {
+    _token_budget = token_budget;
+}
+
+size_t Scheduler::tokenBudget() const {
+    return _token_budget;
+}
+
+Sequence &Scheduler::add(std::unique_ptr<Sequence> seq) {
+    _sequences.push_back(std::move(seq));
+    return *_sequences.back();
+}
+
+size_t Scheduler::size() const {
+    return _sequences.size();
+}
+
+std::vector<ScheduledChunk> Scheduler::schedule() {
+    std::vector<ScheduledChunk> chunks;
+    size_t budget = _token_budget == 0 ? std::numeric_limits<size_t>::max() : _token_budget;
+
+    // 1. decode 优先，保证 inter-token latency 不被 prefill 拖长
+    for (auto &seq : _sequences) {
+        if (!seq->finished && !seq->paging_in && seq->decoding()) {
+            chunks.push_back({seq.get(), 1, true});
+            budget = budget > 0 ? budget - 1 : 0;
+        }
+    }
+
+    // 2. 剩余预算按到达顺序分给 prefill
+    for (auto &seq : _sequences) {
+        if (budget == 0) {
+            break;
+        }
+        if (seq->finished || seq->paging_in || seq->decoding()) {
+            continue;
+        }
+        // 流式模式下单次前向最多写 maxChunk 个 token，长 prompt 分多步 prefill
+        size_t n = std::min({seq->pending(), budget, seq->cache->maxChunk()});
+        chunks.push_back({seq.get(), n, n == seq->pending()});
+        budget -= n;
+    }
+    return chunks;
+}
+
+std::vector<Sequence *> Scheduler::pagingIn() const {
+    std::vector<Sequence *> result;
+    for (auto &seq : _sequences) {
+        if (seq->paging_in) {
+            result.push_back(seq.get());
+        }
+    }
+    return result;
+}
+
+void Scheduler::release() {
+    _sequences.erase(std::remove_if(_sequences.begin(), _sequences.end(),
+                                    [](const std::unique_ptr<Sequence> &seq) { return seq->finished; }),
+                     _sequences.end());
+}
+} // namespace llaisys::models
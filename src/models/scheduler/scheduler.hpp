@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../kv_cache/kv_cache.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace llaisys::models {
+// 一个生成请求：tokens 为 prompt + 已生成的 token，cache 中保存已经算过的前缀
+struct Sequence {
+    int64_t id;
+    std::vector<int64_t> tokens;
+    size_t prompt_len;
+    size_t max_new_tokens;
+    size_t generated = 0;
+    bool finished = false;
+    // prompt lookup 投机：decode 时每步最多额外验证 lookup_tokens 个候选（0 表示关闭）
+    size_t lookup_tokens = 0;
+    size_t lookup_ngram = 0;
+    // 前缀块正在从冷存储换入：换入完成、前缀复用之前不参与调度
+    bool paging_in = false;
+    std::unique_ptr<KVCache> cache;
+
+    // 还没有写进 KV Cache 的 token 数：prefill 阶段为剩余 prompt，decode 阶段为 1
+    size_t pending() const { return tokens.size() - cache->size(); }
+    bool decoding() const { return generated > 0; }
+};
+
+// 本步要计算的一段 token：seq->tokens[cache.size(), cache.size() + ntoken)
+struct ScheduledChunk {
+    Sequence *seq;
+    size_t ntoken;
+    bool sample; // 这一段是否到达序列末尾，需要产生下一个 token
+};
+
+// 分块 prefill 调度：每一步先给所有 decode 序列各 1 个 token，
+// 剩余的 token 预算按 FCFS 分给 prefill 序列，长 prompt 被切成多块跨步完成。
+// 这样长 prompt 不会让其它序列的 decode 停顿整个 prefill 的时间，同时每步的 GEMM 仍然足够大。
+class Scheduler {
+private:
+    size_t _token_budget;
+    std::vector<std::unique_ptr<Sequence>> _sequences;
+
+public:
+    explicit Scheduler(size_t token_budget);
+    ~Scheduler() = default;
+
+    // token_budget 为 0 表示不限制（prefill 一次完成）
+    void setTokenBudget(size_t token_budget);
+    size_t tokenBudget() const;
+
+    Sequence &add(std::unique_ptr<Sequence> seq);
+    size_t size() const;
+    std::vector<ScheduledChunk> schedule();
+    // 正在换入前缀的序列
+    std::vector<Sequence *> pagingIn() const;
+    // 移除已完成的序列
+    void release();
+};
+} // namespace llaisys::models
@@ -0,0 +1,140 @@
+#include "speculative.hpp"
+
+#include "../../core/llaisys_core.hpp"
+#include "../../utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace llaisys::models {
+template <typename T>
+static void cast_to_float(float *dst, const std::byte *src, size_t numel) {
+    const T *data = reinterpret_cast<const T *>(src);
+    for (size_t i = 0; i < numel; i++) {
+        dst[i] = utils::cast<float>(data[i]);
+    }
+}
+
+std::vector<float> logitsToHost(tensor_t logits) {
+    const size_t numel = logits->numel();
+    std::vector<std::byte> raw(numel * logits->elementSize());
+    core::context().setDevice(logits->deviceType(), logits->deviceId());
+    core::context().runtime().api()->memcpy_sync(raw.data(), logits->data(), raw.size(), LLAISYS_MEMCPY_D2H);
+
+    std::vector<float> host(numel);
+    switch (logits->dtype()) {
+    case LLAISYS_DTYPE_F32:
+        cast_to_float<float>(host.data(), raw.data(), numel);
+        break;
+    case LLAISYS_DTYPE_BF16:
+        cast_to_float<bf16_t>(host.data(), raw.data(), numel);
+        break;
+    case LLAISYS_DTYPE_F16:
+        cast_to_float<fp16_t>(host.data(), raw.data(), numel);
+        break;
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(logits->dtype());
+    }
+    return host;
+}
+
+void logitsToProbs(float *row, size_t voc, float temperature) {
+    // 与 ops::argmax 一致：取第一个最大值
+    size_t best = 0;
+    for (size_t i = 1; i < voc; i++) {
+        if (row[i] > row[best]) {
+            best = i;
+        }
+    }
+    if (temperature <= 0.0f) {
+        std::fill(row, row + voc, 0.0f);
+        row[best] = 1.0f;
+        return;
+    }
+    const float max_logit = row[best];
+    double sum = 0.0;
+    for (size_t i = 0; i < voc; i++) {
+        row[i] = std::exp((row[i] - max_logit) / temperature);
+        sum += row[i];
+    }
+    const float inv_sum = static_cast<float>(1.0 / sum);
+    for (size_t i = 0; i < voc; i++) {
+        row[i] *= inv_sum;
+    }
+}
+
+int64_t sampleFromProbs(const float *probs, size_t voc, std::mt19937_64 &rng) {
+    double total = 0.0;
+    for (size_t i = 0; i < voc; i++) {
+        total += probs[i];
+    }
+    double r = std::uniform_real_distribution<double>(0.0, total)(rng);
+    size_t last_nonzero = 0;
+    for (size_t i = 0; i < voc; i++) {
+        if (probs[i] <= 0.0f) {
+            continue;
+        }
+        last_nonzero = i;
+        r -= probs[i];
+        if (r < 0.0) {
+            return static_cast<int64_t>(i);
+        }
+    }
+    return static_cast<int64_t>(last_nonzero);
+}
+
+std::vector<int64_t> promptLookup(const int64_t *tokens, size_t n, size_t max_ngram, size_t k) {
+    for (size_t g = std::min(max_ngram, n > 0 ? n - 1 : 0); g > 0 && k > 0; g--) {
+        const int64_t *suffix = tokens + n - g;
+        // 从后往前找，越近的上下文越可能被继续复制
+        for (size_t i = n - g; i-- > 0;) {
+            if (std::equal(suffix, suffix + g, tokens + i)) {
+                const size_t begin = i + g;
+                return std::vector<int64_t>(tokens + begin, tokens + std::min(begin + k, n));
+            }
+        }
+    }
+    return {};
+}
+
+std::vector<int64_t> acceptDraft(const std::vector<int64_t> &draft_tokens,
+                                 const std::vector<float> &draft_probs, size_t draft_voc,
+                                 std::vector<float> &target_probs, size_t target_voc,
+                                 std::mt19937_64 &rng) {
+    std::vector<int64_t> out;
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    const size_t k = draft_tokens.size();
+    for (size_t i = 0; i < k; i++) {
+        float *p = target_probs.data() + i * target_voc;
+        const size_t x = static_cast<size_t>(draft_tokens[i]);
+        const float px = x < target_voc ? p[x] : 0.0f;
+        if (draft_probs.empty()) {
+            // q 为 one-hot：以 p(x) 的概率接受，否则从去掉 x 的 p 中采样
+            if (px >= 1.0f || uniform(rng) < px) {
+                out.push_back(draft_tokens[i]);
+                continue;
+            }
+            if (x < target_voc) {
+                p[x] = 0.0f;
+            }
+            out.push_back(sampleFromProbs(p, target_voc, rng));
+            return out;
+        }
+        const float *q = draft_probs.data() + i * draft_voc;
+        const float qx = q[x];
+        // 贪心时 p、q 都是 one-hot，这里退化成 "argmax 相同才接受"
+        if (px >= qx || uniform(rng) < px / qx) {
+            out.push_back(draft_tokens[i]);
+            continue;
+        }
+        // 拒绝：从残差分布 max(0, p - q) 中采样修正 token
+        for (size_t j = 0; j < target_voc; j++) {
+            p[j] = std::max(0.0f, p[j] - (j < draft_voc ? q[j] : 0.0f));
+        }
+        out.push_back(sampleFromProbs(p, target_voc, rng));
+        return out;
+    }
+    out.push_back(sampleFromProbs(target_probs.data() + k * target_voc, target_voc, rng));
+    return out;
+}
+} // namespace llaisys::models
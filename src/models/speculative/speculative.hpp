@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+
+#include <random>
+#include <vector>
+
+namespace llaisys::models {
+struct SpeculativeStats {
+    size_t steps = 0;     // target 的验证前向次数
+    size_t proposed = 0;  // 提出的候选 token 数
+    size_t accepted = 0;  // 被接受的候选 token 数
+    size_t generated = 0; // 实际输出的 token 数（被接受的候选 + 每步一个修正/bonus token）
+};
+
+// 把 logits [rows, voc] 拷回 host 并转成 float
+std::vector<float> logitsToHost(tensor_t logits);
+
+// 原地把一行 logits 变成概率分布；temperature <= 0 时为 argmax 的 one-hot（贪心）
+void logitsToProbs(float *row, size_t voc, float temperature);
+
+int64_t sampleFromProbs(const float *probs, size_t voc, std::mt19937_64 &rng);
+
+// prompt lookup：在 tokens[0, n) 中找与末尾 g 个 token（g 从 max_ngram 递减到 1）相同的最近一次出现，
+// 返回它后面的至多 k 个 token 作为候选；找不到则返回空
+std::vector<int64_t> promptLookup(const int64_t *tokens, size_t n, size_t max_ngram, size_t k);
+
+// 标准 speculative sampling 的接受/拒绝规则：
+// 第 i 个候选 x 以 min(1, p_i(x) / q_i(x)) 的概率接受；第一次拒绝时从 norm(max(0, p_i - q_i)) 中重新采样并结束；
+// 全部接受时再从 p_k 采样一个 bonus token。输出分布与只用 target 采样完全相同。
+// target_probs 有 k + 1 行（宽度 target_voc），draft_probs 有 k 行（宽度 draft_voc）；
+// draft_probs 为空表示候选是确定性给出的（q 为 one-hot），如 prompt lookup。
+std::vector<int64_t> acceptDraft(const std::vector<int64_t> &draft_tokens,
+                                 const std::vector<float> &draft_probs, size_t draft_voc,
+                                 std::vector<float> &target_probs, size_t target_voc,
+                                 std::mt19937_64 &rng);
+} // namespace llaisys::models
@@ -4,28 +4,51 @@
 
 #include <cmath>
 
-template <typename T>
-void add_(T *c, const T *a, const T *b, size_t numel) {
-    for (size_t i = 0; i < numel; i++) {
+// 最内层一段：CONTIG 时三者步长都是 1，编译期确定，可以向量化
+template <bool CONTIG, typename T>
+void add_(T *c, const T *a, const T *b, size_t n, ptrdiff_t cs, ptrdiff_t as, ptrdiff_t bs) {
+    for (size_t i = 0; i < n; i++) {
+        const ptrdiff_t j = static_cast<ptrdiff_t>(i);
+        T &ci = c[CONTIG ? j : j * cs];
+        const T &ai = a[CONTIG ? j : j * as], &bi = b[CONTIG ? j : j * bs];
         if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-            c[i] = llaisys::utils::cast<T>(llaisys::utils::cast<float>(a[i]) + llaisys::utils::cast<float>(b[i]));
+            ci = llaisys::utils::cast<T>(llaisys::utils::cast<float>(ai) + llaisys::utils::cast<float>(bi));
         } else {
-            c[i] = a[i] + b[i];
+            ci = ai + bi;
         }
     }
 }
 
+template <typename T>
+void add_(T *c, const T *a, const T *b, const llaisys::shape_t &shape, const llaisys::strides_t &c_strides,
+          const llaisys::strides_t &a_strides, const llaisys::strides_t &b_strides) {
+    const llaisys::utils::StridedLoop<3> loop(shape, {&c_strides, &a_strides, &b_strides});
+    const size_t n = loop.inner();
+    const auto s = loop.innerStrides();
+    const bool contig = loop.innerContiguous();
+    loop.forEach(0, loop.outer(), [&](const std::array<ptrdiff_t, 3> &off) {
+        if (contig) {
+            add_<true>(c + off[0], a + off[1], b + off[2], n, 1, 1, 1);
+        } else {
+            add_<false>(c + off[0], a + off[1], b + off[2], n, s[0], s[1], s[2]);
+        }
+    });
+}
+
 namespace llaisys::ops::cpu {
-void add(std::byte *c, const std::byte *a, const std::byte *b, llaisysDataType_t type, size_t numel) {
+void add(std::byte *c, const std::byte *a, const std::byte *b, llaisysDataType_t type, const shape_t &shape,
+         const strides_t &c_strides, const strides_t &a_strides,
+         const strides_t &b_strides) {
     switch (type) {
     case LLAISYS_DTYPE_F32:
-        return add_(reinterpret_cast<float *>(c), reinterpret_cast<const float *>(a), reinterpret_cast<const float *>(b), numel);
+        return add_(reinterpret_cast<float *>(c), reinterpret_cast<const float *>(a), reinterpret_cast<const float *>(b),
+                    shape, c_strides, a_strides, b_strides);
     case LLAISYS_DTYPE_BF16:
         return add_(reinterpret_cast<llaisys::bf16_t *>(c), reinterpret_cast<const llaisys::bf16_t *>(a),
-                    reinterpret_cast<const llaisys::bf16_t *>(b), numel);
+                    reinterpret_cast<const llaisys::bf16_t *>(b), shape, c_strides, a_strides, b_strides);
     case LLAISYS_DTYPE_F16:
         return add_(reinterpret_cast<llaisys::fp16_t *>(c), reinterpret_cast<const llaisys::fp16_t *>(a),
-                    reinterpret_cast<const llaisys::fp16_t *>(b), numel);
+                    reinterpret_cast<const llaisys::fp16_t *>(b), shape, c_strides, a_strides, b_strides);
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(type);
     }
@@ -1,8 +1,12 @@
 #pragma once
 #include "llaisys.h"
+#include "../../../utils/small_vector.hpp"
 
 #include <cstddef>
 
 namespace llaisys::ops::cpu {
-void add(std::byte *c, const std::byte *a, const std::byte *b, llaisysDataType_t type, size_t size);
-}
\ No newline at end of file
+// 三个张量形状相同，步长（元素）任意
+void add(std::byte *c, const std::byte *a, const std::byte *b, llaisysDataType_t type, const shape_t &shape,
+         const strides_t &c_strides, const strides_t &a_strides,
+         const strides_t &b_strides);
+}
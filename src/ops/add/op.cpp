@@ -5,24 +5,32 @@
 
 #include "cpu/add_cpu.hpp"
 
+#include "../pointwise/op.hpp"
+
 namespace llaisys::ops {
 void add(tensor_t c, tensor_t a, tensor_t b) {
     CHECK_SAME_DEVICE(c, a, b);
-    // Only support contiguous inputs with same shape for now.
+    // 形状相同，步长任意（slice / permute 得到的视图可以直接传入）
     CHECK_SAME_SHAPE(c->shape(), a->shape(), b->shape());
     CHECK_SAME_DTYPE(c->dtype(), a->dtype(), b->dtype());
-    ASSERT(c->isContiguous() && a->isContiguous() && b->isContiguous(), "Add: all tensors must be contiguous.");
+
+    // 延迟模式：记录下来，sync 时与相邻的逐元素运算融合成一次遍历
+    if (pointwise::defer(pointwise::ADD, c, a, b)) {
+        return;
+    }
+
+    LLAISYS_PROFILE_OP("add", c->dtype(), c->numel(), 3 * c->numel() * c->elementSize(), &c->shape());
 
     // always support cpu calculation
     if (c->deviceType() == LLAISYS_DEVICE_CPU) {
-        return cpu::add(c->data(), a->data(), b->data(), c->dtype(), c->numel());
+        return cpu::add(c->data(), a->data(), b->data(), c->dtype(), c->shape(), c->strides(), a->strides(), b->strides());
     }
 
     llaisys::core::context().setDevice(c->deviceType(), c->deviceId());
 
     switch (c->deviceType()) {
     case LLAISYS_DEVICE_CPU:
-        return cpu::add(c->data(), a->data(), b->data(), c->dtype(), c->numel());
+        return cpu::add(c->data(), a->data(), b->data(), c->dtype(), c->shape(), c->strides(), a->strides(), b->strides());
 #ifdef ENABLE_NVIDIA_API
     case LLAISYS_DEVICE_NVIDIA:
         TO_BE_IMPLEMENTED();
@@ -1,11 +1,15 @@
 #include "op.hpp"
+#include "../pointwise/op.hpp"
 #include "cpu/argmax_cpu.hpp"
 namespace llaisys::ops {
 void argmax(tensor_t max_idx, tensor_t max_val, tensor_t vals) {
+    pointwise::sync();
     // 获取vals的形状信息
     const size_t numel = vals->numel();
     CHECK_SAME_DTYPE(vals->dtype(), max_val->dtype());
 
+    LLAISYS_PROFILE_OP("argmax", vals->dtype(), numel, numel * vals->elementSize(), &vals->shape());
+
     // always support cpu calculation
     if (vals->deviceType() == LLAISYS_DEVICE_CPU) {
         return cpu::argmax(max_idx->data(), max_val->data(), vals->data(), vals->dtype(), numel);
@@ -0,0 +1,36 @@
+#include "op.hpp"
+
+#include "../../core/llaisys_core.hpp"
+#include "../../utils.hpp"
+
+#include "../pointwise/op.hpp"
+
+namespace llaisys::ops {
+// 把 in 转换成 out 的数据类型（f32 / f16 / bf16 之间），形状相同，步长任意
+void cast(tensor_t out, tensor_t in) {
+    CHECK_SAME_DEVICE(out, in);
+    CHECK_SAME_SHAPE(out->shape(), in->shape());
+
+    if (pointwise::defer(pointwise::CAST, out, in)) {
+        return;
+    }
+
+    if (out->deviceType() == LLAISYS_DEVICE_CPU) {
+        return pointwise::run(pointwise::CAST, out, in);
+    }
+
+    llaisys::core::context().setDevice(out->deviceType(), out->deviceId());
+
+    switch (out->deviceType()) {
+    case LLAISYS_DEVICE_CPU:
+        return pointwise::run(pointwise::CAST, out, in);
+#ifdef ENABLE_NVIDIA_API
+    case LLAISYS_DEVICE_NVIDIA:
+        TO_BE_IMPLEMENTED();
+        return;
+#endif
+    default:
+        EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+} // namespace llaisys::ops
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+
+namespace llaisys::ops {
+void cast(tensor_t out, tensor_t in);
+}
@@ -2,45 +2,60 @@
 #include "../../../utils.hpp"
 #include <cmath>
 
-template <typename T>
-void embedding_( T *out, const int64_t *index, const T *weight, size_t index_numel, const int64_t * stride) {
-   
+// CONTIG 时 out / weight 的列步长为 1（编译期确定），否则按步长逐个复制
+template <bool CONTIG, typename T>
+void embedding_(T *out, const int64_t *index, const T *weight, size_t index_numel, size_t embd_dim,
+                const int64_t *out_stride, ptrdiff_t index_stride, const int64_t *stride) {
+    const ptrdiff_t os = CONTIG ? 1 : out_stride[1], ws = CONTIG ? 1 : stride[1];
+
     for (size_t i = 0; i < index_numel; i++) {
-        int64_t idx = index[i];
+        int64_t idx = index[i * index_stride];
         const T *src = weight + idx * stride[0];
-        T *dst = out + i * stride[1];
+        T *dst = out + i * out_stride[0];
         if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-            for (size_t j = 0; j < static_cast<size_t>(stride[1]); j++) {
-                dst[j] = llaisys::utils::cast<T>(llaisys::utils::cast<float>(src[j]));
+            for (size_t j = 0; j < embd_dim; j++) {
+                dst[j * os] = llaisys::utils::cast<T>(llaisys::utils::cast<float>(src[j * ws]));
             }
         } else{
-            for (size_t j = 0; j < static_cast<size_t>(stride[1]); j++) {
-                dst[j] = src[j];
+            for (size_t j = 0; j < embd_dim; j++) {
+                dst[j * os] = src[j * ws];
         }
         }
-        
+
+    }
+}
+
+template <typename T>
+void embedding_(T *out, const int64_t *index, const T *weight, size_t index_numel, size_t embd_dim,
+                const int64_t *out_stride, ptrdiff_t index_stride, const int64_t *stride) {
+    if (out_stride[1] == 1 && stride[1] == 1) {
+        embedding_<true>(out, index, weight, index_numel, embd_dim, out_stride, index_stride, stride);
+    } else {
+        embedding_<false>(out, index, weight, index_numel, embd_dim, out_stride, index_stride, stride);
     }
-} 
-         
+}
+
 
 namespace llaisys::ops::cpu {
-    
-void embedding(std::byte * out, std::byte * index, const std::byte * weight, const llaisysDataType_t type, size_t index_numel, const int64_t * stride) {
 
+void embedding(std::byte * out, const std::byte * index, const std::byte * weight, const llaisysDataType_t type, size_t index_numel, size_t embd_dim,
+               const int64_t * out_stride, ptrdiff_t index_stride, const int64_t * stride) {
+
+    const int64_t *idx = reinterpret_cast<const int64_t *>(index);
     switch (type) {
         case LLAISYS_DTYPE_F32:
-            embedding_<float>(reinterpret_cast<float *>(out), reinterpret_cast<const int64_t *>(index), reinterpret_cast<const float *>(weight), index_numel, stride);
+            embedding_<float>(reinterpret_cast<float *>(out), idx, reinterpret_cast<const float *>(weight), index_numel, embd_dim, out_stride, index_stride, stride);
         break;
         case LLAISYS_DTYPE_BF16:
-            embedding_<llaisys::bf16_t>(reinterpret_cast<llaisys::bf16_t *>(out), reinterpret_cast<const int64_t *>(index), reinterpret_cast<const llaisys::bf16_t *>(weight), index_numel, stride);
+            embedding_<llaisys::bf16_t>(reinterpret_cast<llaisys::bf16_t *>(out), idx, reinterpret_cast<const llaisys::bf16_t *>(weight), index_numel, embd_dim, out_stride, index_stride, stride);
         break;
         case LLAISYS_DTYPE_F16:
-            embedding_<llaisys::fp16_t>(reinterpret_cast<llaisys::fp16_t *>(out), reinterpret_cast<const int64_t *>(index), reinterpret_cast<const llaisys::fp16_t *>(weight), index_numel, stride);
+            embedding_<llaisys::fp16_t>(reinterpret_cast<llaisys::fp16_t *>(out), idx, reinterpret_cast<const llaisys::fp16_t *>(weight), index_numel, embd_dim, out_stride, index_stride, stride);
         break;
         default:
             EXCEPTION_UNSUPPORTED_DATATYPE(type);
     }
-    
-    
+
+
 }
 } // namespace llaisys::ops::cpu
@@ -4,5 +4,7 @@
 #include <cstddef>
 
 namespace llaisys::ops::cpu {
-void embedding(std::byte *out, std::byte *index, const std::byte *weight, llaisysDataType_t type, size_t index_numel, const int64_t * stride);
-}
\ No newline at end of file
+// out 为 [index_numel, embd_dim]，out_stride / stride 分别为 out / weight 两维的步长（元素），index_stride 为 index 的步长
+void embedding(std::byte *out, const std::byte *index, const std::byte *weight, llaisysDataType_t type, size_t index_numel, size_t embd_dim,
+               const int64_t * out_stride, ptrdiff_t index_stride, const int64_t * stride);
+}
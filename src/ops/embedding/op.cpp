@@ -1,23 +1,35 @@
 #include "op.hpp"
+#include "../pointwise/op.hpp"
 #include "cpu/embedding_cpu.hpp"
 namespace llaisys::ops {
 /*
-从weight（2-D）中复制index（1-D）中的行到output（2-D）。index必须是Int64类型
+从weight（2-D）中复制index（1-D）中的行到output（2-D）。index必须是Int64类型，三者的步长任意
 */
 void embedding(tensor_t out, tensor_t index, tensor_t weight) {
+    pointwise::sync();
     CHECK_SAME_DEVICE(out , index, weight);
     ASSERT(index->dtype() == LLAISYS_DTYPE_I64, "Embedding: index tensor must be of type Int64");
     ASSERT(weight->shape().size() == 2, "Embedding: weight tensor must be 2-D");
+    ASSERT(index->ndim() == 1, "Embedding: index tensor must be 1-D");
+    ASSERT(out->ndim() == 2 && out->shape()[0] == index->shape()[0] && out->shape()[1] == weight->shape()[1],
+           "Embedding: output tensor must be [index length, embedding dim]");
+    CHECK_SAME_DTYPE(out->dtype(), weight->dtype());
+
+    LLAISYS_PROFILE_OP("embedding", out->dtype(), 0,
+                       2 * out->numel() * out->elementSize() + index->numel() * index->elementSize(),
+                       &index->shape(), &weight->shape());
 
  // always support cpu calculation
     if (out->deviceType() == LLAISYS_DEVICE_CPU) {
-        return cpu::embedding(out->data(), index->data(), weight->data(), out->dtype(), index->numel(), weight->strides().data());
+        return cpu::embedding(out->data(), index->data(), weight->data(), out->dtype(), index->numel(), weight->shape()[1],
+                              out->strides().data(), index->strides()[0], weight->strides().data());
     }
 
     llaisys::core::context().setDevice(out->deviceType(), out->deviceId());
     switch (out->deviceType()) {
     case LLAISYS_DEVICE_CPU:
-        return cpu::embedding(out->data(), index->data(), weight->data(), out->dtype(), index->numel(), weight->strides().data());
+        return cpu::embedding(out->data(), index->data(), weight->data(), out->dtype(), index->numel(), weight->shape()[1],
+                              out->strides().data(), index->strides()[0], weight->strides().data());
 #ifdef ENABLE_NVIDIA_API
     case LLAISYS_DEVICE_NVIDIA:
         TO_BE_IMPLEMENTED();
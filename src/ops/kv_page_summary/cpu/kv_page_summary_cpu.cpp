@@ -0,0 +1,48 @@
+#include "kv_page_summary_cpu.hpp"
+#include "../../../utils.hpp"
+
+#include <algorithm>
+
+namespace {
+template <typename T>
+void kv_page_summary_(float *page_min, float *page_max, const T *k, size_t len, size_t row, size_t page_size,
+                      size_t begin) {
+    const size_t first = begin / page_size, last = (len + page_size - 1) / page_size;
+    // decode 时只有最后一页需要更新，按页并行只在 prefill 写入多页时起作用
+#pragma omp parallel for schedule(static) if (last - first > 1)
+    for (size_t p = first; p < last; p++) {
+        float *mn = page_min + p * row;
+        float *mx = page_max + p * row;
+        const size_t end = std::min((p + 1) * page_size, len);
+        for (size_t j = 0; j < row; j++) {
+            mn[j] = mx[j] = llaisys::utils::cast<float>(k[p * page_size * row + j]);
+        }
+        for (size_t i = p * page_size + 1; i < end; i++) {
+            const T *src = k + i * row;
+            for (size_t j = 0; j < row; j++) {
+                const float x = llaisys::utils::cast<float>(src[j]);
+                mn[j] = std::min(mn[j], x);
+                mx[j] = std::max(mx[j], x);
+            }
+        }
+    }
+}
+} // namespace
+
+namespace llaisys::ops::cpu {
+void kv_page_summary(std::byte *page_min, std::byte *page_max, const std::byte *k, llaisysDataType_t type,
+                     size_t len, size_t row, size_t page_size, size_t begin) {
+    float *mn = reinterpret_cast<float *>(page_min);
+    float *mx = reinterpret_cast<float *>(page_max);
+    switch (type) {
+    case LLAISYS_DTYPE_F32:
+        return kv_page_summary_(mn, mx, reinterpret_cast<const float *>(k), len, row, page_size, begin);
+    case LLAISYS_DTYPE_BF16:
+        return kv_page_summary_(mn, mx, reinterpret_cast<const llaisys::bf16_t *>(k), len, row, page_size, begin);
+    case LLAISYS_DTYPE_F16:
+        return kv_page_summary_(mn, mx, reinterpret_cast<const llaisys::fp16_t *>(k), len, row, page_size, begin);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(type);
+    }
+}
+} // namespace llaisys::ops::cpu
@@ -0,0 +1,9 @@
+#pragma once
+#include "llaisys.h"
+
+#include <cstddef>
+
+namespace llaisys::ops::cpu {
+void kv_page_summary(std::byte *page_min, std::byte *page_max, const std::byte *k, llaisysDataType_t type,
+                     size_t len, size_t row, size_t page_size, size_t begin);
+}
@@ -0,0 +1,46 @@
+#include "op.hpp"
+#include "../pointwise/op.hpp"
+#include "cpu/kv_page_summary_cpu.hpp"
+namespace llaisys::ops {
+// k 为 [len, nkvhead, d]，page_min / page_max 为 [npages, nkvhead, d] 的 float32，npages 至少为 ceil(len / page_size)。
+// 第 p 页为 k 的 [p * page_size, min((p + 1) * page_size, len)) 行；begin 所在页之前的页保持不变。
+void kv_page_summary(tensor_t page_min, tensor_t page_max, tensor_t k, size_t page_size, size_t begin) {
+    pointwise::sync();
+    CHECK_SAME_DEVICE(page_min, page_max, k);
+    ASSERT(page_min->dtype() == LLAISYS_DTYPE_F32 && page_max->dtype() == LLAISYS_DTYPE_F32,
+           "KVPageSummary: page_min and page_max must be float32");
+    ASSERT(k->ndim() == 3 && page_min->ndim() == 3 && page_min->shape() == page_max->shape(),
+           "KVPageSummary: k must be [len, nkvhead, d] and summaries [npages, nkvhead, d]");
+    ASSERT(page_min->shape()[1] == k->shape()[1] && page_min->shape()[2] == k->shape()[2],
+           "KVPageSummary: head shape mismatch");
+    ASSERT(page_size > 0, "KVPageSummary: page_size must be positive");
+    const size_t len = k->shape()[0];
+    ASSERT(page_min->shape()[0] * page_size >= len, "KVPageSummary: not enough pages");
+    ASSERT(k->isContiguous() && page_min->isContiguous() && page_max->isContiguous(),
+           "KVPageSummary: all tensors must be contiguous");
+    if (begin >= len) {
+        return;
+    }
+    const size_t row = k->shape()[1] * k->shape()[2];
+    LLAISYS_PROFILE_OP("kv_page_summary", k->dtype(), 2 * (len - begin) * row, (len - begin) * row * k->elementSize(),
+                       &k->shape(), &page_min->shape());
+
+    if (k->deviceType() == LLAISYS_DEVICE_CPU) {
+        return cpu::kv_page_summary(page_min->data(), page_max->data(), k->data(), k->dtype(), len, row, page_size, begin);
+    }
+
+    llaisys::core::context().setDevice(k->deviceType(), k->deviceId());
+
+    switch (k->deviceType()) {
+    case LLAISYS_DEVICE_CPU:
+        return cpu::kv_page_summary(page_min->data(), page_max->data(), k->data(), k->dtype(), len, row, page_size, begin);
+#ifdef ENABLE_NVIDIA_API
+    case LLAISYS_DEVICE_NVIDIA:
+        TO_BE_IMPLEMENTED();
+        return;
+#endif
+    default:
+        EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+} // namespace llaisys::ops
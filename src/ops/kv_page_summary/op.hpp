@@ -0,0 +1,7 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+namespace llaisys::ops {
+// 稀疏 attention（Quest）用的每页 key 摘要：重新计算覆盖 [begin, len) 的各页在每个维度上的最小值和最大值
+void kv_page_summary(tensor_t page_min, tensor_t page_max, tensor_t k, size_t page_size, size_t begin);
+}
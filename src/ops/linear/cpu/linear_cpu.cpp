@@ -1,54 +1,193 @@
 #include "linear_cpu.hpp"
 #include "../../../utils.hpp"
+
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+// 输出按 tile_m 行 x tile_n 列分块。split_m 为 false 时线程只按列块划分，每个线程算所有行（M 小时的 GEMV），
+// 为 true 时按 (行块, 列块) 划分（GEMM）。不论哪种分块，每个输出都是按 k 顺序的 float 累加，结果与分块无关
+struct LinearConfig {
+    std::string name;
+    size_t tile_m;
+    size_t tile_n;
+    bool split_m;
+};
+
+// 乘加次数少于这个值时不开并行区域
+constexpr size_t PARALLEL_MIN_MACS = size_t(1) << 15;
+// 调优时每个候选只算部分列，乘加次数约为这个值（至少让每个线程分到一个最大的列块）
+constexpr size_t TRIAL_MACS = size_t(1) << 24;
+
+const std::vector<LinearConfig> &allConfigs() {
+    static const std::vector<LinearConfig> configs = [] {
+        std::vector<LinearConfig> c;
+        for (bool split_m : {false, true}) {
+            for (size_t tm : {1, 4, 16}) {
+                for (size_t tn : {4, 16, 64}) {
+                    c.push_back({std::string(split_m ? "mn:" : "n:") + std::to_string(tm) + "x" + std::to_string(tn),
+                                 tm, tn, split_m});
+                }
+            }
+        }
+        return c;
+    }();
+    return configs;
+}
+
+constexpr size_t MAX_TILE_N = 64;
+
+// 把 n 行（行距 stride）转成连续的 float；本来就是连续的 float 时直接返回
+template <typename T>
+const float *to_float_(const T *src, size_t stride, size_t n, size_t k, std::vector<float> &buf) {
+    if constexpr (std::is_same_v<T, float>) {
+        if (stride == k || n == 1) {
+            return src;
+        }
+    }
+    buf.resize(n * k);
+    for (size_t r = 0; r < n; r++) {
+        for (size_t i = 0; i < k; i++) {
+            buf[r * k + i] = llaisys::utils::cast<float>(src[r * stride + i]);
+        }
+    }
+    return buf.data();
+}
+
+template <typename T>
+void store_(T *out, float sum, const T *bias) {
+    float b_val = (bias == nullptr) ? 0.0f : llaisys::utils::cast<float>(*bias);
+    *out = llaisys::utils::cast<T>(sum + b_val);
+}
 
+// 一个块：a 为 mm 行输入，b 为 nn 行权重（都是连续的 float），每行同时算 4 列以复用 a 的读取
 template <typename T>
-void linear_(T *out, const T *in, const T *weight, const T *bias, llaisysDataType_t type, 
-             const size_t M, const size_t N, const size_t K, 
-             const int64_t *in_stride, const int64_t *weight_stride) {
-
-    for (size_t row = 0; row < M; row++) {
-        // in_src 只与 row 有关
-        const T *in_src = in + row * static_cast<size_t>(in_stride[0]); 
-        for (size_t col = 0; col < N; col++) {
-            // weight_src 指向第 col 行
-            const T *weight_src = weight + col * static_cast<size_t>(weight_stride[0]);
-            
-            float Mulsum = 0.0f;
+void tile_(T *out, size_t ldo, const float *a, const float *b, const T *bias, size_t mm, size_t nn, size_t K) {
+    for (size_t r = 0; r < mm; r++) {
+        const float *x = a + r * K;
+        T *o = out + r * ldo;
+        size_t c = 0;
+        for (; c + 4 <= nn; c += 4) {
+            const float *w0 = b + c * K, *w1 = w0 + K, *w2 = w1 + K, *w3 = w2 + K;
+            float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
             for (size_t k = 0; k < K; k++) {
-                if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-                    Mulsum += (llaisys::utils::cast<float>(in_src[k]) * llaisys::utils::cast<float>(weight_src[k]));
-                } else {
-                    Mulsum += static_cast<float>(in_src[k] * weight_src[k]);
-                }
+                s0 += x[k] * w0[k];
+                s1 += x[k] * w1[k];
+                s2 += x[k] * w2[k];
+                s3 += x[k] * w3[k];
+            }
+            store_(o + c, s0, bias ? bias + c : nullptr);
+            store_(o + c + 1, s1, bias ? bias + c + 1 : nullptr);
+            store_(o + c + 2, s2, bias ? bias + c + 2 : nullptr);
+            store_(o + c + 3, s3, bias ? bias + c + 3 : nullptr);
+        }
+        for (; c < nn; c++) {
+            const float *w = b + c * K;
+            float s = 0.0f;
+            for (size_t k = 0; k < K; k++) {
+                s += x[k] * w[k];
+            }
+            store_(o + c, s, bias ? bias + c : nullptr);
+        }
+    }
+}
+
+// 计算输出的前 ncol 列（out 的行距为 N）
+template <typename T>
+void linear_(T *out, const T *in, const T *weight, const T *bias, size_t M, size_t N, size_t K, size_t ncol,
+             size_t in_stride, size_t weight_stride, const LinearConfig &cfg) {
+    const size_t mtiles = (M + cfg.tile_m - 1) / cfg.tile_m;
+    const size_t ntiles = (ncol + cfg.tile_n - 1) / cfg.tile_n;
+    const size_t nwork = cfg.split_m ? mtiles * ntiles : ntiles;
+
+#pragma omp parallel if (nwork > 1 && M * ncol * K >= PARALLEL_MIN_MACS)
+    {
+        std::vector<float> abuf, bbuf;
+        const float *b = nullptr;
+        size_t cur_nt = std::numeric_limits<size_t>::max();
+#pragma omp for schedule(static)
+        for (size_t w = 0; w < nwork; w++) {
+            // 相邻的工作项属于同一个列块，权重块只在列块变化时重新转换
+            const size_t nt = cfg.split_m ? w / mtiles : w;
+            const size_t mt_begin = cfg.split_m ? w % mtiles : 0;
+            const size_t mt_end = cfg.split_m ? mt_begin + 1 : mtiles;
+            const size_t n0 = nt * cfg.tile_n, nn = std::min(cfg.tile_n, ncol - n0);
+            if (nt != cur_nt) {
+                b = to_float_(weight + n0 * weight_stride, weight_stride, nn, K, bbuf);
+                cur_nt = nt;
+            }
+            for (size_t mt = mt_begin; mt < mt_end; mt++) {
+                const size_t m0 = mt * cfg.tile_m, mm = std::min(cfg.tile_m, M - m0);
+                const float *a = to_float_(in + m0 * in_stride, in_stride, mm, K, abuf);
+                tile_(out + m0 * N + n0, N, a, b, bias ? bias + n0 : nullptr, mm, nn, K);
             }
+        }
+    }
+}
 
-            // 处理偏置和赋值
-            size_t out_indx = row * N + col;
-            float b_val = (bias == nullptr) ? 0.0f : llaisys::utils::cast<float>(bias[col]); // 注意这里是 bias[col]
-            
-            out[out_indx] = llaisys::utils::cast<T>(Mulsum + b_val);
+// 按 (M 分桶, N, K, dtype, 线程数) 调优选出配置后计算
+template <typename T>
+void linear_tuned_(T *out, const T *in, const T *weight, const T *bias, llaisysDataType_t type, size_t M, size_t N,
+                   size_t K, size_t in_stride, size_t weight_stride) {
+    if (M == 0 || N == 0) {
+        return;
+    }
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    // 行块大于 M 的配置与小一号的等价；只有一行时按行划分没有意义
+    const size_t mb = llaisys::autotune::bucket(M);
+    std::vector<const LinearConfig *> configs;
+    std::vector<std::string> names;
+    size_t fallback = 0;
+    for (const auto &c : allConfigs()) {
+        if (c.tile_m > mb || (mb == 1 && c.split_m)) {
+            continue;
+        }
+        // 默认：GEMV 按列划分，GEMM 按 4x16 的块划分
+        if ((mb == 1 && c.tile_n == 16) || (mb > 1 && c.split_m && c.tile_m == 4 && c.tile_n == 16)) {
+            fallback = configs.size();
         }
+        configs.push_back(&c);
+        names.push_back(c.name);
     }
+
+    const std::string key = std::string("linear|") + llaisys::utils::dtype_to_str(type) + "|" + std::to_string(mb)
+                          + "x" + std::to_string(N) + "x" + std::to_string(K) + "|t" + std::to_string(nthreads);
+    const size_t trial_cols = std::min(N, std::max(MAX_TILE_N * static_cast<size_t>(nthreads),
+                                                   (TRIAL_MACS / (M * K + 1) + MAX_TILE_N - 1) / MAX_TILE_N * MAX_TILE_N));
+    const size_t choice = llaisys::autotune::select(key, names, fallback, [&](size_t i) {
+        linear_(out, in, weight, bias, M, N, K, trial_cols, in_stride, weight_stride, *configs[i]);
+    });
+    linear_(out, in, weight, bias, M, N, K, N, in_stride, weight_stride, *configs[choice]);
 }
+} // namespace
 
 namespace llaisys::ops::cpu {
 
 void linear(std::byte *out, const std::byte *in, const std::byte *weight, const std::byte *bias, llaisysDataType_t type,
             const size_t M, const size_t N, const size_t K, const int64_t *in_stride, const int64_t *weight_stride) {
-
+    const size_t is = static_cast<size_t>(in_stride[0]), ws = static_cast<size_t>(weight_stride[0]);
     switch (type) {
     case LLAISYS_DTYPE_F32:
-        linear_<float>(reinterpret_cast<float *>(out), reinterpret_cast<const float *>(in), reinterpret_cast<const float *>(weight),
-                       reinterpret_cast<const float *>(bias), type, M, N, K, in_stride, weight_stride);
+        linear_tuned_<float>(reinterpret_cast<float *>(out), reinterpret_cast<const float *>(in), reinterpret_cast<const float *>(weight),
+                             reinterpret_cast<const float *>(bias), type, M, N, K, is, ws);
         break;
     case LLAISYS_DTYPE_BF16:
-        linear_<llaisys::bf16_t>(reinterpret_cast<bf16_t *>(out), reinterpret_cast<const bf16_t *>(in), reinterpret_cast<const bf16_t *>(weight),
-                                 reinterpret_cast<const bf16_t *>(bias), type, M, N, K, in_stride, weight_stride);
+        linear_tuned_<llaisys::bf16_t>(reinterpret_cast<bf16_t *>(out), reinterpret_cast<const bf16_t *>(in), reinterpret_cast<const bf16_t *>(weight),
+                                       reinterpret_cast<const bf16_t *>(bias), type, M, N, K, is, ws);
         break;
     case LLAISYS_DTYPE_F16:
-        linear_<llaisys::fp16_t>(reinterpret_cast<fp16_t *>(out), reinterpret_cast<const fp16_t *>(in), reinterpret_cast<const fp16_t *>(weight),
-                                 reinterpret_cast<const fp16_t *>(bias), type, M, N, K, in_stride, weight_stride);
+        linear_tuned_<llaisys::fp16_t>(reinterpret_cast<fp16_t *>(out), reinterpret_cast<const fp16_t *>(in), reinterpret_cast<const fp16_t *>(weight),
+                                       reinterpret_cast<const fp16_t *>(bias), type, M, N, K, is, ws);
         break;
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(type);
@@ -1,8 +1,11 @@
 #include "op.hpp"
+#include "../pointwise/op.hpp"
 #include "cpu/linear_cpu.hpp"
 
 namespace llaisys::ops {
 void linear(tensor_t out, tensor_t in, tensor_t weight, tensor_t bias) {
+    // 挂起的逐元素运算可能写入了输入，先执行（非逐元素的算子都一样）
+    pointwise::sync();
     
     ASSERT(weight->isContiguous(), "Linear: weight tensor must be contiguous");
     ASSERT(in->shape().size() == 2 , "Linear: input tensor must be 2-D ");
@@ -12,6 +15,8 @@ void linear(tensor_t out, tensor_t in, tensor_t weight, tensor_t bias) {
     const size_t M = out->shape()[0];
     const size_t N = out->shape()[1];
     const size_t K =  in->shape()[1];
+    LLAISYS_PROFILE_OP("linear", in->dtype(), 2 * M * N * K, (M * K + N * K + M * N) * in->elementSize(),
+                       &in->shape(), &weight->shape());
     // std::cout<< "weight info"<< std::endl;
     // weight->debug();
     // std::cout<< "indata info"<< std::endl;
@@ -20,13 +25,13 @@ void linear(tensor_t out, tensor_t in, tensor_t weight, tensor_t bias) {
     // bias->debug();
 
     if(out->deviceType() == LLAISYS_DEVICE_CPU) {
-        return cpu::linear(out->data(), in->data(), weight->data(), bias->data(), in->dtype() ,M, N ,K ,in->strides().data(),weight->strides().data());
+        return cpu::linear(out->data(), in->data(), weight->data(), bias ? bias->data() : nullptr, in->dtype() ,M, N ,K ,in->strides().data(),weight->strides().data());
     }
 
     llaisys::core::context().setDevice(out->deviceType(), out->deviceId());
     switch (out->deviceType()) {
     case LLAISYS_DEVICE_CPU:
-        return cpu::linear(out->data(), in->data(), weight->data(),bias->data(), in->dtype(), M , N ,K ,in->strides().data(),weight->strides().data());
+        return cpu::linear(out->data(), in->data(), weight->data(), bias ? bias->data() : nullptr, in->dtype(), M , N ,K ,in->strides().data(),weight->strides().data());
 #ifdef ENABLE_NVIDIA_API
     case LLAISYS_DEVICE_NVIDIA:
         TO_BE_IMPLEMENTED();
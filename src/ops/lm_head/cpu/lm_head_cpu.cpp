@@ -0,0 +1,251 @@
+#include "lm_head_cpu.hpp"
+#include "../../../utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+struct Candidate {
+    float val;
+    int64_t idx;
+};
+
+// 值大的在前，相同值下标小的在前（与 argmax 取第一个最大值一致）
+bool better(const Candidate &a, const Candidate &b) {
+    return a.val > b.val || (a.val == b.val && a.idx < b.idx);
+}
+
+// 一次转换的词表行数：转换后的权重块（16 x hs 个 float）留在缓存中，与 m 个 hidden 分别做点积
+constexpr size_t VOCAB_TILE = 16;
+// 元素少于这个值时 rms_norm 不开并行区域
+constexpr size_t PARALLEL_MIN_ELEMS = size_t(1) << 15;
+
+// final rms_norm，结果按 T 取整，与单独的 rms_norm 算子一致
+template <typename T>
+std::vector<float> rms_norm_rows(const T *in, const T *norm_w, size_t m, size_t hs, float eps) {
+    using llaisys::utils::cast;
+    std::vector<float> h(m * hs);
+#pragma omp parallel for schedule(static) if (m > 1 && m * hs >= PARALLEL_MIN_ELEMS)
+    for (size_t r = 0; r < m; r++) {
+        const T *x = in + r * hs;
+        double sum_sq = 0.0;
+        for (size_t i = 0; i < hs; i++) {
+            float val = cast<float>(x[i]);
+            sum_sq += static_cast<double>(val * val);
+        }
+        float inv_rms = static_cast<float>(1.0 / std::sqrt(sum_sq / hs + static_cast<double>(eps)));
+        for (size_t i = 0; i < hs; i++) {
+            h[r * hs + i] = cast<float>(cast<T>(cast<float>(x[i]) * inv_rms * cast<float>(norm_w[i])));
+        }
+    }
+    return h;
+}
+
+// n 行连续的权重转成 float；本来就是 float 时直接返回
+template <typename T>
+const float *to_float_(const T *src, size_t n, size_t hs, std::vector<float> &buf) {
+    if constexpr (std::is_same_v<T, float>) {
+        return src;
+    } else {
+        buf.resize(n * hs);
+        for (size_t i = 0; i < n * hs; i++) {
+            buf[i] = llaisys::utils::cast<float>(src[i]);
+        }
+        return buf.data();
+    }
+}
+
+// logit 按 T 取整，与 linear 算子输出 T 类型的 logits 一致
+template <typename T>
+float round_(float sum) {
+    return llaisys::utils::cast<float>(llaisys::utils::cast<T>(sum));
+}
+
+// x 与 nn 行权重 w 的 logits。与 linear 的块相同，每次 4 列、各自独立累加；每个输出仍按 k 顺序累加
+template <typename T>
+void tile_logits_(float *out, const float *x, const float *w, size_t nn, size_t hs) {
+    size_t c = 0;
+    for (; c + 4 <= nn; c += 4) {
+        const float *w0 = w + c * hs, *w1 = w0 + hs, *w2 = w1 + hs, *w3 = w2 + hs;
+        float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+        for (size_t i = 0; i < hs; i++) {
+            s0 += x[i] * w0[i];
+            s1 += x[i] * w1[i];
+            s2 += x[i] * w2[i];
+            s3 += x[i] * w3[i];
+        }
+        out[c] = round_<T>(s0);
+        out[c + 1] = round_<T>(s1);
+        out[c + 2] = round_<T>(s2);
+        out[c + 3] = round_<T>(s3);
+    }
+    for (; c < nn; c++) {
+        const float *wc = w + c * hs;
+        float sum = 0.0f;
+        for (size_t i = 0; i < hs; i++) {
+            sum += x[i] * wc[i];
+        }
+        out[c] = round_<T>(sum);
+    }
+}
+
+// 词表按 VOCAB_TILE 行分块、按线程切分：每个线程流式计算自己那些块的 logits，交给每一行的 State::push(val, idx)；
+// 每个权重块只转换、读取一次，同时与 m 个 hidden 做点积。返回 [线程][行] 的 State，由调用者合并
+template <typename T, typename State>
+std::vector<std::vector<State>> stream_logits(const std::vector<float> &h, const T *weight, size_t m, size_t voc,
+                                              size_t hs, const State &init) {
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    std::vector<std::vector<State>> local(nthreads, std::vector<State>(m, init));
+    const size_t ntiles = (voc + VOCAB_TILE - 1) / VOCAB_TILE;
+#pragma omp parallel num_threads(nthreads)
+    {
+        int tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        auto &states = local[tid];
+        std::vector<float> buf;
+        float logits[VOCAB_TILE];
+#pragma omp for schedule(static)
+        for (size_t t = 0; t < ntiles; t++) {
+            const size_t v0 = t * VOCAB_TILE, nn = std::min(VOCAB_TILE, voc - v0);
+            const float *w = to_float_(weight + v0 * hs, nn, hs, buf);
+            for (size_t r = 0; r < m; r++) {
+                tile_logits_<T>(logits, h.data() + r * hs, w, nn, hs);
+                for (size_t j = 0; j < nn; j++) {
+                    states[r].push(logits[j], static_cast<int64_t>(v0 + j));
+                }
+            }
+        }
+    }
+    return local;
+}
+
+// 容量为 k 的小顶堆：堆顶是当前保留的最差候选
+struct TopK {
+    size_t k;
+    std::vector<Candidate> heap;
+
+    void push(float val, int64_t idx) {
+        Candidate c{val, idx};
+        if (heap.size() < k) {
+            heap.push_back(c);
+            std::push_heap(heap.begin(), heap.end(), better);
+        } else if (better(c, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = c;
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+    }
+};
+
+// online logsumexp：sum 以当前的 max 为基准
+struct LogSumExp {
+    float max = -INFINITY;
+    double sum = 0.0;
+
+    void push(float val, int64_t) {
+        if (val > max) {
+            sum = sum * std::exp(static_cast<double>(max - val)) + 1.0;
+            max = val;
+        } else {
+            sum += std::exp(static_cast<double>(val - max));
+        }
+    }
+};
+
+template <typename T>
+void lm_head_topk_(int64_t *out_idx, T *out_val, const T *in, const T *norm_w, const T *weight,
+                   size_t m, size_t voc, size_t hs, size_t k, float eps) {
+    auto h = rms_norm_rows(in, norm_w, m, hs, eps);
+    auto local = stream_logits(h, weight, m, voc, hs, TopK{k, {}});
+
+    // 合并各线程的候选
+    std::vector<Candidate> merged;
+    for (size_t r = 0; r < m; r++) {
+        merged.clear();
+        for (auto &states : local) {
+            merged.insert(merged.end(), states[r].heap.begin(), states[r].heap.end());
+        }
+        std::partial_sort(merged.begin(), merged.begin() + k, merged.end(), better);
+        for (size_t j = 0; j < k; j++) {
+            out_idx[r * k + j] = merged[j].idx;
+            out_val[r * k + j] = llaisys::utils::cast<T>(merged[j].val);
+        }
+    }
+}
+
+template <typename T>
+void lm_head_logprob_(float *out, const T *in, const T *norm_w, const T *weight, const int64_t *targets,
+                      size_t m, size_t voc, size_t hs, float eps) {
+    auto h = rms_norm_rows(in, norm_w, m, hs, eps);
+    auto local = stream_logits(h, weight, m, voc, hs, LogSumExp{});
+
+    std::vector<float> buf;
+    for (size_t r = 0; r < m; r++) {
+        // 合并各线程的 (max, sum)
+        float max_val = -INFINITY;
+        for (auto &states : local) {
+            max_val = std::max(max_val, states[r].max);
+        }
+        double sum = 0.0;
+        for (auto &states : local) {
+            if (states[r].sum > 0.0) {
+                sum += states[r].sum * std::exp(static_cast<double>(states[r].max - max_val));
+            }
+        }
+        ASSERT(targets[r] >= 0 && static_cast<size_t>(targets[r]) < voc, "LMHeadLogprob: target out of range");
+        float target;
+        const float *w = to_float_(weight + static_cast<size_t>(targets[r]) * hs, 1, hs, buf);
+        tile_logits_<T>(&target, h.data() + r * hs, w, 1, hs);
+        out[r] = static_cast<float>(static_cast<double>(target - max_val) - std::log(sum));
+    }
+}
+} // namespace
+
+namespace llaisys::ops::cpu {
+void lm_head_topk(std::byte *out_idx, std::byte *out_val, const std::byte *in, const std::byte *norm_w,
+                  const std::byte *weight, llaisysDataType_t type, size_t m, size_t voc, size_t hs, size_t k, float eps) {
+    int64_t *idx = reinterpret_cast<int64_t *>(out_idx);
+    switch (type) {
+    case LLAISYS_DTYPE_F32:
+        return lm_head_topk_(idx, reinterpret_cast<float *>(out_val), reinterpret_cast<const float *>(in),
+                             reinterpret_cast<const float *>(norm_w), reinterpret_cast<const float *>(weight), m, voc, hs, k, eps);
+    case LLAISYS_DTYPE_BF16:
+        return lm_head_topk_(idx, reinterpret_cast<llaisys::bf16_t *>(out_val), reinterpret_cast<const llaisys::bf16_t *>(in),
+                             reinterpret_cast<const llaisys::bf16_t *>(norm_w), reinterpret_cast<const llaisys::bf16_t *>(weight), m, voc, hs, k, eps);
+    case LLAISYS_DTYPE_F16:
+        return lm_head_topk_(idx, reinterpret_cast<llaisys::fp16_t *>(out_val), reinterpret_cast<const llaisys::fp16_t *>(in),
+                             reinterpret_cast<const llaisys::fp16_t *>(norm_w), reinterpret_cast<const llaisys::fp16_t *>(weight), m, voc, hs, k, eps);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(type);
+    }
+}
+
+void lm_head_logprob(std::byte *out, const std::byte *in, const std::byte *norm_w, const std::byte *weight,
+                     const std::byte *targets, llaisysDataType_t type, size_t m, size_t voc, size_t hs, float eps) {
+    float *o = reinterpret_cast<float *>(out);
+    const int64_t *t = reinterpret_cast<const int64_t *>(targets);
+    switch (type) {
+    case LLAISYS_DTYPE_F32:
+        return lm_head_logprob_(o, reinterpret_cast<const float *>(in), reinterpret_cast<const float *>(norm_w),
+                                reinterpret_cast<const float *>(weight), t, m, voc, hs, eps);
+    case LLAISYS_DTYPE_BF16:
+        return lm_head_logprob_(o, reinterpret_cast<const llaisys::bf16_t *>(in), reinterpret_cast<const llaisys::bf16_t *>(norm_w),
+                                reinterpret_cast<const llaisys::bf16_t *>(weight), t, m, voc, hs, eps);
+    case LLAISYS_DTYPE_F16:
+        return lm_head_logprob_(o, reinterpret_cast<const llaisys::fp16_t *>(in), reinterpret_cast<const llaisys::fp16_t *>(norm_w),
+                                reinterpret_cast<const llaisys::fp16_t *>(weight), t, m, voc, hs, eps);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(type);
+    }
+}
+} // namespace llaisys::ops::cpu
@@ -0,0 +1,11 @@
+#pragma once
+#include "llaisys.h"
+
+#include <cstddef>
+
+namespace llaisys::ops::cpu {
+void lm_head_topk(std::byte *out_idx, std::byte *out_val, const std::byte *in, const std::byte *norm_w,
+                  const std::byte *weight, llaisysDataType_t type, size_t m, size_t voc, size_t hs, size_t k, float eps);
+void lm_head_logprob(std::byte *out, const std::byte *in, const std::byte *norm_w, const std::byte *weight,
+                     const std::byte *targets, llaisysDataType_t type, size_t m, size_t voc, size_t hs, float eps);
+}
@@ -0,0 +1,85 @@
+#include "op.hpp"
+#include "../pointwise/op.hpp"
+#include "cpu/lm_head_cpu.hpp"
+namespace llaisys::ops {
+// in 为 [m, hs] 的 hidden states，norm_w 为 [hs]，weight 为 [voc, hs]；
+// out_idx [m, k] (int64) / out_val [m, k] 为每一行 rms_norm(in) * weight^T 中最大的 k 个 logits，按值降序（相同值按下标升序）。
+// k = 1 即 argmax。数值与 rms_norm -> linear -> argmax 逐步计算的结果一致。
+void lm_head_topk(tensor_t out_idx, tensor_t out_val, tensor_t in, tensor_t norm_w, tensor_t weight, float eps) {
+    pointwise::sync();
+    CHECK_SAME_DEVICE(out_idx, out_val, in, norm_w, weight);
+    CHECK_SAME_DTYPE(in->dtype(), out_val->dtype(), norm_w->dtype(), weight->dtype());
+    ASSERT(out_idx->dtype() == LLAISYS_DTYPE_I64, "LMHeadTopK: out_idx must be int64");
+    ASSERT(in->ndim() == 2 && weight->ndim() == 2 && norm_w->ndim() == 1, "LMHeadTopK: invalid tensor rank");
+    ASSERT(out_idx->ndim() == 2 && out_idx->shape() == out_val->shape(), "LMHeadTopK: out_idx and out_val must be [m, k]");
+    ASSERT(in->shape()[1] == weight->shape()[1] && norm_w->shape()[0] == in->shape()[1], "LMHeadTopK: hidden size mismatch");
+    ASSERT(out_idx->shape()[0] == in->shape()[0], "LMHeadTopK: output rows mismatch");
+    ASSERT(out_idx->shape()[1] > 0 && out_idx->shape()[1] <= weight->shape()[0], "LMHeadTopK: invalid k");
+    ASSERT(in->isContiguous() && weight->isContiguous() && norm_w->isContiguous()
+               && out_idx->isContiguous() && out_val->isContiguous(),
+           "LMHeadTopK: all tensors must be contiguous");
+    const size_t m = in->shape()[0], hs = in->shape()[1];
+    const size_t voc = weight->shape()[0], k = out_idx->shape()[1];
+    LLAISYS_PROFILE_OP("lm_head_topk", in->dtype(), 2 * m * voc * hs, (m * hs + voc * hs) * in->elementSize(),
+                       &in->shape(), &weight->shape());
+
+    if (in->deviceType() == LLAISYS_DEVICE_CPU) {
+        return cpu::lm_head_topk(out_idx->data(), out_val->data(), in->data(), norm_w->data(), weight->data(),
+                                 in->dtype(), m, voc, hs, k, eps);
+    }
+
+    llaisys::core::context().setDevice(in->deviceType(), in->deviceId());
+
+    switch (in->deviceType()) {
+    case LLAISYS_DEVICE_CPU:
+        return cpu::lm_head_topk(out_idx->data(), out_val->data(), in->data(), norm_w->data(), weight->data(),
+                                 in->dtype(), m, voc, hs, k, eps);
+#ifdef ENABLE_NVIDIA_API
+    case LLAISYS_DEVICE_NVIDIA:
+        TO_BE_IMPLEMENTED();
+        return;
+#endif
+    default:
+        EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+
+// out 为 [m] 的 float32，targets 为 [m] 的 int64：out[i] = log_softmax(rms_norm(in[i]) * weight^T)[targets[i]]。
+// 词表流式计算 online logsumexp，不生成 logits。
+void lm_head_logprob(tensor_t out, tensor_t in, tensor_t norm_w, tensor_t weight, tensor_t targets, float eps) {
+    pointwise::sync();
+    CHECK_SAME_DEVICE(out, in, norm_w, weight, targets);
+    CHECK_SAME_DTYPE(in->dtype(), norm_w->dtype(), weight->dtype());
+    ASSERT(out->dtype() == LLAISYS_DTYPE_F32, "LMHeadLogprob: out must be float32");
+    ASSERT(targets->dtype() == LLAISYS_DTYPE_I64, "LMHeadLogprob: targets must be int64");
+    ASSERT(in->ndim() == 2 && weight->ndim() == 2 && norm_w->ndim() == 1, "LMHeadLogprob: invalid tensor rank");
+    ASSERT(in->shape()[1] == weight->shape()[1] && norm_w->shape()[0] == in->shape()[1], "LMHeadLogprob: hidden size mismatch");
+    ASSERT(out->numel() == in->shape()[0] && targets->numel() == in->shape()[0], "LMHeadLogprob: one target per row");
+    ASSERT(in->isContiguous() && weight->isContiguous() && norm_w->isContiguous()
+               && out->isContiguous() && targets->isContiguous(),
+           "LMHeadLogprob: all tensors must be contiguous");
+    const size_t m = in->shape()[0], hs = in->shape()[1], voc = weight->shape()[0];
+    LLAISYS_PROFILE_OP("lm_head_logprob", in->dtype(), 2 * m * voc * hs, (m * hs + voc * hs) * in->elementSize(),
+                       &in->shape(), &weight->shape());
+
+    if (in->deviceType() == LLAISYS_DEVICE_CPU) {
+        return cpu::lm_head_logprob(out->data(), in->data(), norm_w->data(), weight->data(), targets->data(),
+                                    in->dtype(), m, voc, hs, eps);
+    }
+
+    llaisys::core::context().setDevice(in->deviceType(), in->deviceId());
+
+    switch (in->deviceType()) {
+    case LLAISYS_DEVICE_CPU:
+        return cpu::lm_head_logprob(out->data(), in->data(), norm_w->data(), weight->data(), targets->data(),
+                                    in->dtype(), m, voc, hs, eps);
+#ifdef ENABLE_NVIDIA_API
+    case LLAISYS_DEVICE_NVIDIA:
+        TO_BE_IMPLEMENTED();
+        return;
+#endif
+    default:
+        EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+} // namespace llaisys::ops
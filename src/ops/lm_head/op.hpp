@@ -0,0 +1,9 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+namespace llaisys::ops {
+// 融合 final norm + LM head + top-k：不生成完整的 logits
+void lm_head_topk(tensor_t out_idx, tensor_t out_val, tensor_t in, tensor_t norm_w, tensor_t weight, float eps);
+// 融合 final norm + LM head + log_softmax + gather：每一行只输出 targets 对应 token 的 log 概率
+void lm_head_logprob(tensor_t out, tensor_t in, tensor_t norm_w, tensor_t weight, tensor_t targets, float eps);
+}
@@ -0,0 +1,213 @@
+#include "pointwise_cpu.hpp"
+#include "../../../utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+using llaisys::ops::cpu::PointwiseInstr;
+using llaisys::ops::cpu::PointwiseOp;
+using llaisys::ops::cpu::PointwiseOperand;
+using llaisys::ops::cpu::PointwiseProgram;
+
+// 一个块的元素个数：全部寄存器共 16 KB，留在 L1 中
+constexpr size_t BLOCK = 256;
+// 元素少于这个值时不开并行区域
+constexpr size_t PARALLEL_MIN_ELEMS = size_t(1) << 15;
+
+// 所有操作数共同的循环：去掉长度为 1 的维度，合并所有操作数都能合并的相邻维度。
+// strides[d * nop + k] 为操作数 k 在第 d 维上的步长
+struct Loop {
+    std::vector<size_t> shape;
+    std::vector<ptrdiff_t> strides;
+};
+
+Loop makeLoop(const llaisys::shape_t &shape, const std::vector<PointwiseOperand> &operands) {
+    const size_t nop = operands.size();
+    Loop loop;
+    for (size_t d = 0; d < shape.size(); d++) {
+        if (shape[d] == 1) {
+            continue;
+        }
+        bool mergeable = !loop.shape.empty();
+        const size_t last = loop.strides.size() - (mergeable ? nop : 0);
+        for (size_t k = 0; k < nop && mergeable; k++) {
+            mergeable = loop.strides[last + k] == (*operands[k].strides)[d] * static_cast<ptrdiff_t>(shape[d]);
+        }
+        if (mergeable) {
+            loop.shape.back() *= shape[d];
+        } else {
+            loop.shape.push_back(shape[d]);
+            loop.strides.resize(loop.strides.size() + nop);
+        }
+        for (size_t k = 0; k < nop; k++) {
+            loop.strides[loop.strides.size() - nop + k] = (*operands[k].strides)[d];
+        }
+    }
+    if (loop.shape.empty()) {
+        loop.shape.push_back(1);
+        loop.strides.assign(nop, 1);
+    }
+    return loop;
+}
+
+template <typename T>
+void load_(float *dst, const T *src, ptrdiff_t stride, size_t n) {
+    if (stride == 1) {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = llaisys::utils::cast<float>(src[i]);
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = llaisys::utils::cast<float>(src[static_cast<ptrdiff_t>(i) * stride]);
+        }
+    }
+}
+
+template <typename T>
+void store_(T *dst, const float *src, ptrdiff_t stride, size_t n) {
+    if (stride == 1) {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = llaisys::utils::cast<T>(src[i]);
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            dst[static_cast<ptrdiff_t>(i) * stride] = llaisys::utils::cast<T>(src[i]);
+        }
+    }
+}
+
+template <typename T>
+void round_(float *dst, const float *src, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = llaisys::utils::cast<float>(llaisys::utils::cast<T>(src[i]));
+    }
+}
+
+// 按 dtype 分发：f(T 类型的空指针)
+template <typename F>
+void dispatch_(llaisysDataType_t dtype, const F &f) {
+    switch (dtype) {
+    case LLAISYS_DTYPE_F32:
+        return f(static_cast<float *>(nullptr));
+    case LLAISYS_DTYPE_BF16:
+        return f(static_cast<llaisys::bf16_t *>(nullptr));
+    case LLAISYS_DTYPE_F16:
+        return f(static_cast<llaisys::fp16_t *>(nullptr));
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(dtype);
+    }
+}
+
+// 对一个块（n 个元素）执行整个程序。off 为各操作数在块起点的偏移，step 为块内的步长（元素）
+void runBlock(const PointwiseProgram &prog, const std::vector<PointwiseOperand> &operands,
+              const std::vector<float> &params, const ptrdiff_t *off, const ptrdiff_t *step, float *regs, size_t n) {
+    // 寄存器的当前内容：指向 regs 中的块，或者（连续的 f32 操作数）直接指向操作数的内存
+    const float *rp[llaisys::ops::cpu::POINTWISE_MAX_REGS];
+    for (const PointwiseInstr &ins : prog.code) {
+        float *d = regs + ins.dst * BLOCK;
+        const float *a = rp[ins.a];
+        const float *b = rp[ins.b];
+        switch (ins.op) {
+        case PointwiseOp::LOAD:
+            if (ins.dtype == LLAISYS_DTYPE_F32 && step[ins.operand] == 1 && !ins.copy) {
+                rp[ins.dst] = reinterpret_cast<const float *>(operands[ins.operand].data) + off[ins.operand];
+                continue;
+            }
+            dispatch_(ins.dtype, [&](auto *tag) {
+                using T = std::remove_pointer_t<decltype(tag)>;
+                load_(d, reinterpret_cast<const T *>(operands[ins.operand].data) + off[ins.operand], step[ins.operand], n);
+            });
+            break;
+        case PointwiseOp::STORE:
+            dispatch_(ins.dtype, [&](auto *tag) {
+                using T = std::remove_pointer_t<decltype(tag)>;
+                store_(reinterpret_cast<T *>(operands[ins.operand].data) + off[ins.operand], a, step[ins.operand], n);
+            });
+            break;
+        case PointwiseOp::ROUND:
+            if (ins.dtype == LLAISYS_DTYPE_BF16) {
+                round_<llaisys::bf16_t>(d, a, n);
+            } else if (ins.dtype == LLAISYS_DTYPE_F16) {
+                round_<llaisys::fp16_t>(d, a, n);
+            } else if (d != a) {
+                std::copy(a, a + n, d);
+            }
+            break;
+        case PointwiseOp::ADD:
+            for (size_t i = 0; i < n; i++) {
+                d[i] = a[i] + b[i];
+            }
+            break;
+        case PointwiseOp::SCALE: {
+            const float alpha = params[ins.param];
+            for (size_t i = 0; i < n; i++) {
+                d[i] = a[i] * alpha;
+            }
+            break;
+        }
+        case PointwiseOp::SWIGLU:
+            // 与 swiglu 算子的公式逐位相同
+            for (size_t i = 0; i < n; i++) {
+                const float g = a[i];
+                float gatenorm = 1.0 / (1 + std::exp(-1.0 * g));
+                d[i] = b[i] * g * gatenorm;
+            }
+            break;
+        }
+        if (ins.op != PointwiseOp::STORE) {
+            rp[ins.dst] = d;
+        }
+    }
+}
+} // namespace
+
+namespace llaisys::ops::cpu {
+void pointwise(const PointwiseProgram &prog, const std::vector<PointwiseOperand> &operands,
+               const std::vector<float> &params, const shape_t &shape) {
+    for (auto n : shape) {
+        if (n == 0) {
+            return;
+        }
+    }
+    ASSERT(prog.nreg <= POINTWISE_MAX_REGS, "pointwise: too many registers");
+    const Loop loop = makeLoop(shape, operands);
+    const size_t nop = operands.size();
+    const size_t nd = loop.shape.size() - 1; // 外层维数
+    const size_t inner = loop.shape.back();
+    const ptrdiff_t *step = loop.strides.data() + nd * nop;
+    const size_t nblk = (inner + BLOCK - 1) / BLOCK;
+    size_t outer = 1;
+    for (size_t d = 0; d < nd; d++) {
+        outer *= loop.shape[d];
+    }
+    const size_t nwork = outer * nblk;
+
+    // 工作项为 (外层位置, 内层块)，每个工作项的偏移直接由下标算出
+#pragma omp parallel if (nwork > 1 && outer * inner >= PARALLEL_MIN_ELEMS)
+    {
+        alignas(64) float regs[POINTWISE_MAX_REGS * BLOCK];
+        std::vector<ptrdiff_t> off(nop);
+#pragma omp for schedule(static)
+        for (size_t w = 0; w < nwork; w++) {
+            size_t o = w / nblk;
+            const size_t j0 = w % nblk * BLOCK;
+            for (size_t k = 0; k < nop; k++) {
+                off[k] = static_cast<ptrdiff_t>(j0) * step[k];
+            }
+            for (size_t d = nd; d-- > 0;) {
+                const auto idx = static_cast<ptrdiff_t>(o % loop.shape[d]);
+                o /= loop.shape[d];
+                for (size_t k = 0; k < nop; k++) {
+                    off[k] += idx * loop.strides[d * nop + k];
+                }
+            }
+            runBlock(prog, operands, params, off.data(), step, regs, std::min(BLOCK, inner - j0));
+        }
+    }
+}
+} // namespace llaisys::ops::cpu
@@ -0,0 +1,52 @@
+#pragma once
+#include "llaisys.h"
+#include "../../../utils/small_vector.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace llaisys::ops::cpu {
+// 融合后的逐元素程序。寄存器是一段 float（一个块的元素），每条指令对整个块执行一次，
+// 块内的中间结果留在 L1 中，不写回内存
+enum class PointwiseOp {
+    LOAD,   // dst <- operands[operand]
+    STORE,  // operands[operand] <- a
+    ROUND,  // dst <- a 按 dtype 舍入一次（与先写回该类型再读出的结果相同）
+    ADD,    // dst <- a + b
+    SCALE,  // dst <- a * params[param]
+    SWIGLU, // dst <- b * silu(a)，a 为 gate，b 为 up
+};
+
+struct PointwiseInstr {
+    PointwiseOp op;
+    size_t dst = 0;
+    size_t a = 0;
+    size_t b = 0;
+    size_t operand = 0;                         // LOAD / STORE
+    size_t param = 0;                           // SCALE
+    llaisysDataType_t dtype = LLAISYS_DTYPE_F32; // LOAD / STORE / ROUND
+    // LOAD：连续的 f32 操作数默认直接读内存、不复制；值会被原样写回某个操作数时必须复制，
+    // 否则先执行的 STORE 可能改掉它读的内存
+    bool copy = false;
+};
+
+struct PointwiseProgram {
+    std::vector<PointwiseInstr> code;
+    size_t nreg = 0;
+    size_t noperand = 0;
+    size_t flops = 0; // 每个元素的浮点运算次数和读写的字节数（profiler 用）
+    size_t bytes = 0;
+};
+
+// 程序最多使用的寄存器个数
+constexpr size_t POINTWISE_MAX_REGS = 16;
+
+// 一个操作数：形状都相同，步长（元素）任意
+struct PointwiseOperand {
+    std::byte *data;
+    const strides_t *strides;
+};
+
+void pointwise(const PointwiseProgram &prog, const std::vector<PointwiseOperand> &operands,
+               const std::vector<float> &params, const shape_t &shape);
+} // namespace llaisys::ops::cpu
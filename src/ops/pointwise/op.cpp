@@ -0,0 +1,490 @@
+#include "op.hpp"
+
+#include "../../utils.hpp"
+
+#include "../add/cpu/add_cpu.hpp"
+#include "../swiglu/cpu/swiglu_cpu.hpp"
+#include "cpu/pointwise_cpu.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace llaisys::ops::pointwise {
+namespace {
+constexpr size_t NONE = static_cast<size_t>(-1);
+
+struct Node {
+    Kind kind;
+    tensor_t out;
+    tensor_t a;
+    tensor_t b; // 只有 ADD / SWIGLU 使用
+    float alpha;
+};
+
+// 每个线程各自的延迟状态
+struct State {
+    int depth = 0;
+    std::vector<Node> pending;
+};
+
+State &state() {
+    thread_local State s;
+    return s;
+}
+
+const char *kindName(Kind kind) {
+    switch (kind) {
+    case ADD:
+        return "add";
+    case SWIGLU:
+        return "swiglu";
+    case SCALE:
+        return "scale";
+    default:
+        return "cast";
+    }
+}
+
+bool fusible(const tensor_t &t) {
+    const auto dt = t->dtype();
+    return t->deviceType() == LLAISYS_DEVICE_CPU
+        && (dt == LLAISYS_DTYPE_F32 || dt == LLAISYS_DTYPE_F16 || dt == LLAISYS_DTYPE_BF16);
+}
+
+// 张量占用的字节范围 [lo, hi)
+struct Range {
+    const std::byte *lo;
+    const std::byte *hi;
+};
+
+Range range(const Tensor &t) {
+    ptrdiff_t lo = 0, hi = 0;
+    for (size_t d = 0; d < t.ndim(); d++) {
+        if (t.shape()[d] == 0) {
+            return {t.data(), t.data()};
+        }
+        const ptrdiff_t span = t.strides()[d] * static_cast<ptrdiff_t>(t.shape()[d] - 1);
+        (span < 0 ? lo : hi) += span;
+    }
+    const auto es = static_cast<ptrdiff_t>(t.elementSize());
+    return {t.data() + lo * es, t.data() + (hi + 1) * es};
+}
+
+// 同一个视图：同一块内存、同样的 dtype 和步长（组内的形状都相同）
+bool sameView(const Tensor &x, const Tensor &y) {
+    return x.data() == y.data() && x.dtype() == y.dtype() && x.strides() == y.strides();
+}
+
+// t 的内存与 r 有交集（同一个视图的情况由调用者先排除）
+bool overlaps(const Range &r, const Tensor &t) {
+    const Range q = range(t);
+    return q.lo < r.hi && r.lo < q.hi;
+}
+
+// 融合程序的缓存：签名 -> 程序。签名只含运算的种类、数据类型和操作数之间的关系，与形状、步长和 alpha 无关
+struct Cache {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<const cpu::PointwiseProgram>> programs;
+};
+
+Cache &cache() {
+    static Cache c;
+    return c;
+}
+
+using RefCounts = std::unordered_map<const Tensor *, size_t>;
+
+// 融合成一次遍历的一组相邻运算：形状相同，操作数之间要么是同一个视图，要么写入的内存互不重叠
+class Group {
+private:
+    struct View {
+        const tensor_t *t; // 第一次出现时的张量
+        Range r;
+        bool written = false;
+        bool multi = false; // 有不同的张量对象表示这个视图
+    };
+    struct Slots {
+        size_t out, a, b;
+    };
+
+    const shape_t &_shape;
+    std::vector<const Node *> _nodes;
+    std::vector<Slots> _slots;
+    std::vector<View> _views;
+    RefCounts _refs; // 组内对每个张量对象的引用次数
+
+    size_t find(const tensor_t &t) const {
+        for (size_t v = 0; v < _views.size(); v++) {
+            if (sameView(**_views[v].t, *t)) {
+                return v;
+            }
+        }
+        return NONE;
+    }
+
+    size_t use(const tensor_t &t, bool write) {
+        _refs[t.get()]++;
+        size_t v = find(t);
+        if (v == NONE) {
+            v = _views.size();
+            _views.push_back({&t, range(*t)});
+        } else if (_views[v].t->get() != t.get()) {
+            _views[v].multi = true;
+        }
+        _views[v].written = _views[v].written || write;
+        return v;
+    }
+
+    // t 与组内已有的视图没有冲突：重叠的内存只能是同一个视图，或者两边都只读。
+    // t 已经在组内时也要检查：只读过的视图变成写入目标后，不能与组内其他视图部分重叠
+    bool compatible(const tensor_t &t, bool write, size_t &fresh) const {
+        if (find(t) == NONE) {
+            fresh++;
+        }
+        for (const auto &v : _views) {
+            if ((write || v.written) && !sameView(**v.t, *t) && overlaps(v.r, *t)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 写入的视图在这组之后不再被读到：组外没有其他引用，也没有其他张量共享存储
+    bool dead(const View &v, const RefCounts &total) const {
+        const Tensor *t = v.t->get();
+        const size_t n = total.at(t);
+        return !v.multi && _refs.at(t) == n && static_cast<size_t>(v.t->use_count()) == n && t->uniqueStorage();
+    }
+
+    std::string signature(const std::vector<bool> &store) const {
+        std::string sig;
+        for (size_t i = 0; i < _nodes.size(); i++) {
+            const auto &s = _slots[i];
+            sig += std::to_string(_nodes[i]->kind) + ":" + std::to_string(s.out) + "," + std::to_string(s.a) + ","
+                 + (s.b == NONE ? std::string("-") : std::to_string(s.b)) + ";";
+        }
+        sig += "|";
+        for (size_t v = 0; v < _views.size(); v++) {
+            sig += std::to_string((**_views[v].t).dtype()) + (store[v] ? "s" : "") + ";";
+        }
+        return sig;
+    }
+
+    cpu::PointwiseProgram compile(const std::vector<bool> &store) const;
+
+public:
+    explicit Group(const Node &first) : _shape(first.out->shape()) {
+        add(first);
+    }
+
+    bool accepts(const Node &n) const {
+        if (n.out->shape() != _shape) {
+            return false;
+        }
+        size_t fresh = 0;
+        bool ok = compatible(n.a, false, fresh) && (!n.b || compatible(n.b, false, fresh))
+               && compatible(n.out, true, fresh);
+        return ok && _views.size() + fresh <= cpu::POINTWISE_MAX_REGS;
+    }
+
+    void add(const Node &n) {
+        _nodes.push_back(&n);
+        Slots s;
+        s.a = use(n.a, false);
+        s.b = n.b ? use(n.b, false) : NONE;
+        s.out = use(n.out, true);
+        _slots.push_back(s);
+    }
+
+    void run(const RefCounts &total);
+};
+
+// 先按虚拟寄存器生成代码（每个值一个寄存器），去掉结果用不到的指令，再按生存期分配物理寄存器
+cpu::PointwiseProgram Group::compile(const std::vector<bool> &store) const {
+    using cpu::PointwiseInstr;
+    using cpu::PointwiseOp;
+    std::vector<PointwiseInstr> code;
+    size_t nv = 0;
+    std::vector<size_t> cur(_views.size(), NONE);
+    auto read = [&](size_t v) {
+        if (cur[v] == NONE) {
+            PointwiseInstr ins{PointwiseOp::LOAD};
+            ins.dst = nv;
+            ins.operand = v;
+            ins.dtype = (**_views[v].t).dtype();
+            code.push_back(ins);
+            cur[v] = nv++;
+        }
+        return cur[v];
+    };
+    size_t nparam = 0;
+    for (size_t i = 0; i < _nodes.size(); i++) {
+        const auto &s = _slots[i];
+        const size_t a = read(s.a);
+        const size_t b = s.b == NONE ? 0 : read(s.b);
+        size_t res = a;
+        if (_nodes[i]->kind != CAST) {
+            PointwiseInstr ins{_nodes[i]->kind == ADD ? PointwiseOp::ADD
+                               : _nodes[i]->kind == SWIGLU ? PointwiseOp::SWIGLU
+                                                           : PointwiseOp::SCALE};
+            ins.dst = res = nv++;
+            ins.a = a;
+            ins.b = b;
+            ins.param = _nodes[i]->kind == SCALE ? nparam++ : 0;
+            code.push_back(ins);
+        }
+        // 结果先按 out 的类型舍入，后面的运算读到的值与先写回内存再读出的相同
+        const auto dt = _nodes[i]->out->dtype();
+        if (dt != LLAISYS_DTYPE_F32) {
+            PointwiseInstr ins{PointwiseOp::ROUND};
+            ins.dst = nv;
+            ins.a = res;
+            ins.dtype = dt;
+            code.push_back(ins);
+            res = nv++;
+        }
+        cur[s.out] = res;
+    }
+    // 每个写入的视图只写回最后的值
+    for (size_t v = 0; v < _views.size(); v++) {
+        if (store[v]) {
+            PointwiseInstr ins{PointwiseOp::STORE};
+            ins.a = cur[v];
+            ins.operand = v;
+            ins.dtype = (**_views[v].t).dtype();
+            code.push_back(ins);
+        }
+    }
+
+    auto reads_b = [](PointwiseOp op) { return op == PointwiseOp::ADD || op == PointwiseOp::SWIGLU; };
+    auto reads_a = [](PointwiseOp op) { return op != PointwiseOp::LOAD; };
+    // 只被同类型的 STORE 使用的 ROUND 是多余的（写回时本来就按该类型舍入），STORE 直接读舍入前的值
+    for (const auto &r : code) {
+        if (r.op != PointwiseOp::ROUND) {
+            continue;
+        }
+        bool only_store = true;
+        for (const auto &ins : code) {
+            const bool uses = (reads_a(ins.op) && ins.a == r.dst) || (reads_b(ins.op) && ins.b == r.dst);
+            only_store = only_store && (!uses || (ins.op == PointwiseOp::STORE && ins.dtype == r.dtype));
+        }
+        if (only_store) {
+            for (auto &ins : code) {
+                if (ins.op == PointwiseOp::STORE && ins.a == r.dst) {
+                    ins.a = r.a;
+                }
+            }
+        }
+    }
+    // 要写回的值是原样读入的（例如同类型的 cast）时，LOAD 必须复制
+    for (const auto &st : code) {
+        for (auto &ins : code) {
+            if (st.op == PointwiseOp::STORE && ins.op == PointwiseOp::LOAD && ins.dst == st.a) {
+                ins.copy = true;
+            }
+        }
+    }
+    std::vector<bool> needed(nv, false);
+    std::vector<PointwiseInstr> kept;
+    for (size_t i = code.size(); i-- > 0;) {
+        const auto &ins = code[i];
+        if (ins.op != PointwiseOp::STORE && !needed[ins.dst]) {
+            continue;
+        }
+        if (reads_a(ins.op)) {
+            needed[ins.a] = true;
+        }
+        if (reads_b(ins.op)) {
+            needed[ins.b] = true;
+        }
+        kept.push_back(ins);
+    }
+    std::reverse(kept.begin(), kept.end());
+
+    std::vector<size_t> last(nv, 0);
+    for (size_t i = 0; i < kept.size(); i++) {
+        if (reads_a(kept[i].op)) {
+            last[kept[i].a] = i;
+        }
+        if (reads_b(kept[i].op)) {
+            last[kept[i].b] = i;
+        }
+    }
+    cpu::PointwiseProgram prog;
+    prog.noperand = _views.size();
+    std::vector<size_t> phys(nv, NONE);
+    std::vector<bool> busy(cpu::POINTWISE_MAX_REGS, false);
+    for (size_t i = 0; i < kept.size(); i++) {
+        auto &ins = kept[i];
+        const size_t va = ins.a, vb = ins.b;
+        if (reads_a(ins.op)) {
+            ins.a = phys[va];
+        }
+        if (reads_b(ins.op)) {
+            ins.b = phys[vb];
+        }
+        // 最后一次读取的寄存器先释放，结果可以直接写在原处
+        if (reads_a(ins.op) && last[va] == i) {
+            busy[ins.a] = false;
+        }
+        if (reads_b(ins.op) && last[vb] == i) {
+            busy[ins.b] = false;
+        }
+        if (ins.op != PointwiseOp::STORE) {
+            const size_t p = static_cast<size_t>(std::find(busy.begin(), busy.end(), false) - busy.begin());
+            ASSERT(p < busy.size(), "pointwise: out of registers");
+            busy[p] = true;
+            phys[ins.dst] = p;
+            ins.dst = p;
+            prog.nreg = std::max(prog.nreg, p + 1);
+        }
+        if (ins.op == PointwiseOp::LOAD || ins.op == PointwiseOp::STORE) {
+            prog.bytes += utils::dsize(ins.dtype);
+        } else if (ins.op == PointwiseOp::SWIGLU) {
+            prog.flops += 4;
+        } else if (ins.op != PointwiseOp::ROUND) {
+            prog.flops += 1;
+        }
+    }
+    prog.code = std::move(kept);
+    return prog;
+}
+
+void Group::run(const RefCounts &total) {
+    std::vector<bool> store(_views.size());
+    for (size_t v = 0; v < _views.size(); v++) {
+        store[v] = _views[v].written && !dead(_views[v], total);
+    }
+    const std::string sig = signature(store);
+    std::shared_ptr<const cpu::PointwiseProgram> prog;
+    {
+        auto &c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        auto it = c.programs.find(sig);
+        if (it != c.programs.end()) {
+            prog = it->second;
+        }
+    }
+    if (!prog) {
+        prog = std::make_shared<const cpu::PointwiseProgram>(compile(store));
+        auto &c = cache();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        prog = c.programs.emplace(sig, prog).first->second;
+    }
+
+    std::vector<cpu::PointwiseOperand> operands;
+    for (const auto &v : _views) {
+        operands.push_back({(*v.t)->data(), &(*v.t)->strides()});
+    }
+    std::vector<float> params;
+    for (const Node *n : _nodes) {
+        if (n->kind == SCALE) {
+            params.push_back(n->alpha);
+        }
+    }
+    size_t numel = 1;
+    for (auto d : _shape) {
+        numel *= d;
+    }
+    LLAISYS_PROFILE_OP(_nodes.size() == 1 ? kindName(_nodes[0]->kind) : "fused_pointwise",
+                       _nodes.back()->out->dtype(), prog->flops * numel, prog->bytes * numel, &_shape);
+    cpu::pointwise(*prog, operands, params, _shape);
+}
+
+// 没有可以融合的邻居的 add / swiglu 直接用它们自己的内核，与立即执行完全相同
+bool runAlone(const Node &n) {
+    const auto &c = n.out;
+    const auto bytes = 3 * c->numel() * c->elementSize();
+    if (n.kind == ADD) {
+        LLAISYS_PROFILE_OP("add", c->dtype(), c->numel(), bytes, &c->shape());
+        cpu::add(c->data(), n.a->data(), n.b->data(), c->dtype(), c->shape(), c->strides(), n.a->strides(), n.b->strides());
+        return true;
+    }
+    if (n.kind == SWIGLU) {
+        LLAISYS_PROFILE_OP("swiglu", c->dtype(), 4 * c->numel(), bytes, &c->shape());
+        cpu::swiglu(c->data(), n.a->data(), n.b->data(), c->dtype(), c->shape(), c->strides(), n.a->strides(), n.b->strides());
+        return true;
+    }
+    return false;
+}
+
+// 按顺序执行：相邻的运算能合并就合并到同一组
+void execute(const std::vector<Node> &nodes) {
+    RefCounts total;
+    for (const auto &n : nodes) {
+        for (const tensor_t *t : {&n.out, &n.a, &n.b}) {
+            if (*t) {
+                total[t->get()]++;
+            }
+        }
+    }
+    for (size_t b = 0; b < nodes.size();) {
+        Group g(nodes[b]);
+        size_t e = b + 1;
+        while (e < nodes.size() && g.accepts(nodes[e])) {
+            g.add(nodes[e++]);
+        }
+        if (e > b + 1 || !runAlone(nodes[b])) {
+            g.run(total);
+        }
+        b = e;
+    }
+}
+} // namespace
+
+void begin() {
+    state().depth++;
+}
+
+void end() {
+    auto &s = state();
+    ASSERT(s.depth > 0, "pointwise: end() without begin()");
+    if (--s.depth == 0) {
+        sync();
+    }
+}
+
+void sync() {
+    auto &s = state();
+    if (s.pending.empty()) {
+        return;
+    }
+    // 先取出再执行，出错时不会留下执行了一半的队列
+    std::vector<Node> nodes;
+    nodes.swap(s.pending);
+    execute(nodes);
+}
+
+bool defer(Kind kind, tensor_t out, tensor_t a, tensor_t b, float alpha) {
+    auto &s = state();
+    if (s.depth == 0) {
+        return false;
+    }
+    // 输出与输入部分重叠时，按块执行与逐元素执行的结果不同，只能立即执行；
+    // 立即执行之前先执行挂起的运算，保持顺序
+    const Range r = range(*out);
+    auto clash = [&](const tensor_t &in) { return !sameView(*in, *out) && overlaps(r, *in); };
+    if (!fusible(out) || !fusible(a) || (b && !fusible(b)) || clash(a) || (b && clash(b))) {
+        sync();
+        return false;
+    }
+    s.pending.push_back({kind, std::move(out), std::move(a), std::move(b), alpha});
+    return true;
+}
+
+void run(Kind kind, tensor_t out, tensor_t a, tensor_t b, float alpha) {
+    CHECK_ARGUMENT(fusible(out) && fusible(a) && (!b || fusible(b)), "pointwise: only f32 / f16 / bf16 on CPU");
+    const std::vector<Node> nodes{{kind, std::move(out), std::move(a), std::move(b), alpha}};
+    execute(nodes);
+}
+
+size_t cachedKernels() {
+    auto &c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    return c.programs.size();
+}
+} // namespace llaisys::ops::pointwise
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+
+namespace llaisys::ops::pointwise {
+// 可以延迟执行的逐元素运算（out 与输入形状相同，步长任意）
+enum Kind {
+    ADD,    // out = a + b
+    SWIGLU, // out = b * silu(a)，a 为 gate，b 为 up
+    SCALE,  // out = a * alpha
+    CAST,   // out = a 转换成 out 的 dtype
+};
+
+// 延迟模式（只对当前线程有效，可以嵌套）：begin 之后 add / swiglu / scale / cast 只记录不执行，
+// 在 sync、最外层的 end、或者任何非逐元素的算子（linear、attention、norm 等）和读写张量数据的 C API 之前一起执行。
+// 执行时相邻的、形状相同的运算融合成一次遍历，中间结果只在寄存器中传递
+void begin();
+void end();
+// 执行当前线程挂起的全部运算；没有挂起的运算时只是一次判断
+void sync();
+
+// 延迟模式下记录一个运算并返回 true；否则（或者设备 / 数据类型不支持融合）返回 false，由调用者立即执行
+bool defer(Kind kind, tensor_t out, tensor_t a, tensor_t b = nullptr, float alpha = 1.0f);
+// 立即执行单个运算（scale / cast 没有单独的内核）
+void run(Kind kind, tensor_t out, tensor_t a, tensor_t b = nullptr, float alpha = 1.0f);
+
+// 已编译并缓存的融合程序的个数（按表达式的签名缓存，与形状、步长和 alpha 无关）
+size_t cachedKernels();
+} // namespace llaisys::ops::pointwise
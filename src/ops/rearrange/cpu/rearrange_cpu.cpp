@@ -0,0 +1,240 @@
+#include "rearrange_cpu.hpp"
+#include "../../../utils.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+// 复制量少于这个字节数时不开并行区域
+constexpr size_t PARALLEL_MIN_BYTES = size_t(1) << 20;
+// 转置块的边长（元素）：块内 src 的每条 cache line 在写完 TILE 列之前一直留在 L1
+constexpr size_t TILE = 32;
+
+struct Dim {
+    size_t n;
+    ptrdiff_t ds; // dst 的步长
+    ptrdiff_t ss; // src 的步长
+};
+
+// 去掉长度为 1 的维度，按 dst 步长从大到小排列（尽量顺序写 dst），再合并两边都能合并的相邻维度。
+// 复制与遍历顺序无关，所以可以任意调整维度的顺序
+std::vector<Dim> canonicalize(const llaisys::shape_t &shape, const llaisys::strides_t &dst_strides,
+                              const llaisys::strides_t &src_strides) {
+    std::vector<Dim> dims;
+    for (size_t i = 0; i < shape.size(); i++) {
+        if (shape[i] != 1) {
+            dims.push_back({shape[i], dst_strides[i], src_strides[i]});
+        }
+    }
+    std::stable_sort(dims.begin(), dims.end(),
+                     [](const Dim &a, const Dim &b) { return std::abs(a.ds) > std::abs(b.ds); });
+    std::vector<Dim> merged;
+    for (const auto &d : dims) {
+        const auto n = static_cast<ptrdiff_t>(d.n);
+        if (!merged.empty() && merged.back().ds == d.ds * n && merged.back().ss == d.ss * n) {
+            merged.back() = {merged.back().n * d.n, d.ds, d.ss};
+        } else {
+            merged.push_back(d);
+        }
+    }
+    return merged;
+}
+
+// 外层维度上的一个位置及其在 dst / src 中的偏移（元素）
+class Cursor {
+private:
+    const std::vector<Dim> &_dims;
+    std::vector<size_t> _idx;
+
+public:
+    ptrdiff_t doff = 0;
+    ptrdiff_t soff = 0;
+
+    explicit Cursor(const std::vector<Dim> &dims) : _dims(dims), _idx(dims.size()) {}
+
+    void seek(size_t o) {
+        doff = soff = 0;
+        for (size_t i = _dims.size(); i-- > 0;) {
+            _idx[i] = o % _dims[i].n;
+            o /= _dims[i].n;
+            doff += static_cast<ptrdiff_t>(_idx[i]) * _dims[i].ds;
+            soff += static_cast<ptrdiff_t>(_idx[i]) * _dims[i].ss;
+        }
+    }
+
+    void next() {
+        for (size_t i = _dims.size(); i-- > 0;) {
+            doff += _dims[i].ds;
+            soff += _dims[i].ss;
+            if (++_idx[i] < _dims[i].n) {
+                return;
+            }
+            doff -= static_cast<ptrdiff_t>(_dims[i].n) * _dims[i].ds;
+            soff -= static_cast<ptrdiff_t>(_dims[i].n) * _dims[i].ss;
+            _idx[i] = 0;
+        }
+    }
+};
+
+size_t count(const std::vector<Dim> &dims) {
+    size_t n = 1;
+    for (const auto &d : dims) {
+        n *= d.n;
+    }
+    return n;
+}
+
+// 外层的 O 个位置静态地分给各个线程，每个线程从自己的起点顺序遍历，f(dst 偏移, src 偏移)
+template <typename F>
+void for_outer_(const std::vector<Dim> &outer, size_t bytes, const F &f) {
+    const size_t total = count(outer);
+#pragma omp parallel if (total > 1 && bytes >= PARALLEL_MIN_BYTES)
+    {
+        size_t tid = 0, nthreads = 1;
+#ifdef _OPENMP
+        tid = static_cast<size_t>(omp_get_thread_num());
+        nthreads = static_cast<size_t>(omp_get_num_threads());
+#endif
+        const size_t begin = total * tid / nthreads, end = total * (tid + 1) / nthreads;
+        if (begin < end) {
+            Cursor c(outer);
+            c.seek(begin);
+            for (size_t o = begin; o < end; o++, c.next()) {
+                f(c.doff, c.soff);
+            }
+        }
+    }
+}
+
+// 最内层两边都连续：每个外层位置一次 memcpy；只有一段时按线程切成几段
+template <typename E>
+void runs_(E *dst, const E *src, const std::vector<Dim> &outer, size_t len) {
+    const size_t bytes = count(outer) * len * sizeof(E);
+    if (outer.empty()) {
+#pragma omp parallel if (bytes >= PARALLEL_MIN_BYTES)
+        {
+            size_t tid = 0, nthreads = 1;
+#ifdef _OPENMP
+            tid = static_cast<size_t>(omp_get_thread_num());
+            nthreads = static_cast<size_t>(omp_get_num_threads());
+#endif
+            const size_t begin = len * tid / nthreads, end = len * (tid + 1) / nthreads;
+            std::memcpy(dst + begin, src + begin, (end - begin) * sizeof(E));
+        }
+        return;
+    }
+    for_outer_(outer, bytes, [&](ptrdiff_t doff, ptrdiff_t soff) {
+        std::memcpy(dst + doff, src + soff, len * sizeof(E));
+    });
+}
+
+// rows 在 src 中连续，cols 在 dst 中连续：按 TILE x TILE 的块转置，块内按 dst 顺序写、src 的 cache line 在块内复用。
+// 工作项为 (外层位置, 行块, 列块)，只有一个外层位置的二维转置也能并行
+template <typename E>
+void transpose_(E *dst, const E *src, const std::vector<Dim> &outer, const Dim &rows, const Dim &cols) {
+    const size_t ntr = (rows.n + TILE - 1) / TILE, ntc = (cols.n + TILE - 1) / TILE;
+    const size_t nwork = count(outer) * ntr * ntc;
+    const size_t bytes = count(outer) * rows.n * cols.n * sizeof(E);
+#pragma omp parallel if (nwork > 1 && bytes >= PARALLEL_MIN_BYTES)
+    {
+        Cursor c(outer);
+#pragma omp for schedule(static)
+        for (size_t w = 0; w < nwork; w++) {
+            c.seek(w / (ntr * ntc));
+            const size_t tr = w % (ntr * ntc) / ntc, tc = w % ntc;
+            const size_t r0 = tr * TILE, r1 = std::min(r0 + TILE, rows.n);
+            const size_t c0 = tc * TILE, c1 = std::min(c0 + TILE, cols.n);
+            E *d = dst + c.doff;
+            const E *s = src + c.soff;
+            for (size_t r = r0; r < r1; r++) {
+                E *drow = d + static_cast<ptrdiff_t>(r) * rows.ds;
+                const E *scol = s + r;
+                for (size_t j = c0; j < c1; j++) {
+                    drow[j] = scol[static_cast<ptrdiff_t>(j) * cols.ss];
+                }
+            }
+        }
+    }
+}
+
+// 其他情况：最内层逐个元素按步长复制
+template <typename E>
+void strided_(E *dst, const E *src, const std::vector<Dim> &outer, const Dim &inner) {
+    const size_t bytes = count(outer) * inner.n * sizeof(E);
+    for_outer_(outer, bytes, [&](ptrdiff_t doff, ptrdiff_t soff) {
+        E *d = dst + doff;
+        const E *s = src + soff;
+        for (size_t j = 0; j < inner.n; j++) {
+            d[static_cast<ptrdiff_t>(j) * inner.ds] = s[static_cast<ptrdiff_t>(j) * inner.ss];
+        }
+    });
+}
+
+template <typename E>
+void rearrange_(E *dst, const E *src, std::vector<Dim> dims) {
+    if (dims.empty()) {
+        *dst = *src;
+        return;
+    }
+    const Dim last = dims.back();
+    if (last.ds == 1 && last.ss == 1) {
+        dims.pop_back();
+        return runs_(dst, src, dims, last.n);
+    }
+    // 排序后 dst 连续的维度在最后；再找 src 连续的维度，有的话两者组成转置块
+    if (last.ds == 1) {
+        for (size_t t = 0; t + 1 < dims.size(); t++) {
+            if (dims[t].ss == 1) {
+                const Dim rows = dims[t];
+                dims.pop_back();
+                dims.erase(dims.begin() + static_cast<ptrdiff_t>(t));
+                return transpose_(dst, src, dims, rows, last);
+            }
+        }
+    }
+    dims.pop_back();
+    strided_(dst, src, dims, last);
+}
+} // namespace
+
+namespace llaisys::ops::cpu {
+void rearrange(std::byte *dst, const std::byte *src, const shape_t &shape,
+               const strides_t &dst_strides, const strides_t &src_strides, size_t elem_size) {
+    for (auto n : shape) {
+        if (n == 0) {
+            return;
+        }
+    }
+    auto dims = canonicalize(shape, dst_strides, src_strides);
+    switch (elem_size) {
+    case 1:
+        return rearrange_(reinterpret_cast<uint8_t *>(dst), reinterpret_cast<const uint8_t *>(src), std::move(dims));
+    case 2:
+        return rearrange_(reinterpret_cast<uint16_t *>(dst), reinterpret_cast<const uint16_t *>(src), std::move(dims));
+    case 4:
+        return rearrange_(reinterpret_cast<uint32_t *>(dst), reinterpret_cast<const uint32_t *>(src), std::move(dims));
+    case 8:
+        return rearrange_(reinterpret_cast<uint64_t *>(dst), reinterpret_cast<const uint64_t *>(src), std::move(dims));
+    default: {
+        // 其他大小的元素按字节复制：步长换成字节，再加上元素内部连续的一维
+        shape_t bshape(shape);
+        strides_t bdst(dst_strides), bsrc(src_strides);
+        for (size_t i = 0; i < shape.size(); i++) {
+            bdst[i] *= static_cast<ptrdiff_t>(elem_size);
+            bsrc[i] *= static_cast<ptrdiff_t>(elem_size);
+        }
+        bshape.push_back(elem_size);
+        bdst.push_back(1);
+        bsrc.push_back(1);
+        return rearrange_(reinterpret_cast<uint8_t *>(dst), reinterpret_cast<const uint8_t *>(src),
+                          canonicalize(bshape, bdst, bsrc));
+    }
+    }
+}
+} // namespace llaisys::ops::cpu
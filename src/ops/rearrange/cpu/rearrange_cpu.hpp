@@ -0,0 +1,11 @@
+#pragma once
+#include "llaisys.h"
+#include "../../../utils/small_vector.hpp"
+
+#include <cstddef>
+
+namespace llaisys::ops::cpu {
+// 按 shape 把 src 复制到 dst，两边的步长（以元素为单位）任意，元素大小为 elem_size 字节
+void rearrange(std::byte *dst, const std::byte *src, const shape_t &shape,
+               const strides_t &dst_strides, const strides_t &src_strides, size_t elem_size);
+}
@@ -1,7 +1,37 @@
 #include "op.hpp"
+#include "../pointwise/op.hpp"
+
+#include "../../core/llaisys_core.hpp"
+#include "../../utils.hpp"
+
+#include "cpu/rearrange_cpu.hpp"
 
 namespace llaisys::ops {
+// 把 in 按元素复制到形状相同的 out，两者的步长任意（permute / slice 得到的视图，或者连续化）
 void rearrange(tensor_t out, tensor_t in) {
-    TO_BE_IMPLEMENTED();
+    pointwise::sync();
+    CHECK_SAME_DEVICE(out, in);
+    CHECK_SAME_SHAPE(out->shape(), in->shape());
+    CHECK_SAME_DTYPE(out->dtype(), in->dtype());
+
+    LLAISYS_PROFILE_OP("rearrange", out->dtype(), 0, 2 * out->numel() * out->elementSize(), &in->shape());
+
+    if (out->deviceType() == LLAISYS_DEVICE_CPU) {
+        return cpu::rearrange(out->data(), in->data(), out->shape(), out->strides(), in->strides(), out->elementSize());
+    }
+
+    llaisys::core::context().setDevice(out->deviceType(), out->deviceId());
+
+    switch (out->deviceType()) {
+    case LLAISYS_DEVICE_CPU:
+        return cpu::rearrange(out->data(), in->data(), out->shape(), out->strides(), in->strides(), out->elementSize());
+#ifdef ENABLE_NVIDIA_API
+    case LLAISYS_DEVICE_NVIDIA:
+        TO_BE_IMPLEMENTED();
+        return;
+#endif
+    default:
+        EXCEPTION_UNSUPPORTED_DEVICE;
+    }
 }
 } // namespace llaisys::ops
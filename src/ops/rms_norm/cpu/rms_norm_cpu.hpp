@@ -4,5 +4,8 @@
 #include <cstddef>
 
 namespace llaisys::ops::cpu {
-void rms_norm(std::byte *out, const std::byte *in, const std::byte *weight, const size_t dimM,const size_t dimk, const int64_t* stride_W, float eps ,llaisysDataType_t type);
-}
\ No newline at end of file
+// in / out 为 [dimM, dimk]，stride_out / stride_in 为两维的步长（元素），stride_W 为 weight 的步长
+void rms_norm(std::byte *out, const std::byte *in, const std::byte *weight, const size_t dimM, const size_t dimk,
+              const int64_t *stride_out, const int64_t *stride_in, const int64_t *stride_W, float eps,
+              llaisysDataType_t type);
+}
@@ -5,12 +5,14 @@
 
 namespace llaisys::ops::cpu {
 
-template <typename T>
-void rope_(T *out, const T *in, const int64_t *pos_ids, 
-           size_t seqlen, size_t nhead, size_t d, float theta) {
-    
+// CONTIG 时 in / out 的最后一维步长为 1（编译期确定），前两维总是按步长访问
+template <bool CONTIG, typename T>
+void rope_(T *out, const T *in, const int64_t *pos_ids, size_t seqlen, size_t nhead, size_t d,
+           const ptrdiff_t *out_strides, const ptrdiff_t *in_strides, ptrdiff_t pos_stride, float theta) {
+
     const size_t half_d = d / 2;
-    
+    const ptrdiff_t os = CONTIG ? 1 : out_strides[2], is = CONTIG ? 1 : in_strides[2];
+
     // 优化 1：将频率计算提前到 head 循环之外
     // 这样每一行（每个 token）只需要计算一次频率向量
     std::vector<double> inv_freqs(half_d);
@@ -19,8 +21,8 @@ void rope_(T *out, const T *in, const int64_t *pos_ids,
     }
 
     for (size_t i = 0; i < seqlen; ++i) {
-        double p_i = static_cast<double>(pos_ids[i]); 
-        
+        double p_i = static_cast<double>(pos_ids[i * pos_stride]);
+
         for (size_t j = 0; j < half_d; ++j) {
             // 优化 2：统一计算当前维度在当前位置的角度
             double phi = p_i * inv_freqs[j];
@@ -30,40 +32,50 @@ void rope_(T *out, const T *in, const int64_t *pos_ids,
             for (size_t h = 0; h < nhead; ++h) {
                 // 优化 3：调整循环顺序，提高内存访问的局部性
                 // 将 nhead 放在最内层（如果数据是连续的，这样可以利用 L1 Cache）
-                size_t base_offset = i * nhead * d + h * d;
-                size_t idx_a = base_offset + j;
-                size_t idx_b = base_offset + j + half_d;
+                const T *src = in + i * in_strides[0] + h * in_strides[1];
+                T *dst = out + i * out_strides[0] + h * out_strides[1];
 
-                float a = llaisys::utils::cast<float>(in[idx_a]);
-                float b = llaisys::utils::cast<float>(in[idx_b]);
+                float a = llaisys::utils::cast<float>(src[j * is]);
+                float b = llaisys::utils::cast<float>(src[(j + half_d) * is]);
 
-                out[idx_a] = llaisys::utils::cast<T>(a * cos_phi - b * sin_phi);
-                out[idx_b] = llaisys::utils::cast<T>(b * cos_phi + a * sin_phi);
+                dst[j * os] = llaisys::utils::cast<T>(a * cos_phi - b * sin_phi);
+                dst[(j + half_d) * os] = llaisys::utils::cast<T>(b * cos_phi + a * sin_phi);
             }
         }
     }
 }
 
-void rope(std::byte *out, const std::byte *in, const std::byte *pos_ids, 
-          llaisysDataType_t type, size_t seqlen, size_t nhead, size_t d, float theta) {
-    
+template <typename T>
+void rope_(T *out, const T *in, const int64_t *pos_ids, size_t seqlen, size_t nhead, size_t d,
+           const ptrdiff_t *out_strides, const ptrdiff_t *in_strides, ptrdiff_t pos_stride, float theta) {
+    if (out_strides[2] == 1 && in_strides[2] == 1) {
+        rope_<true>(out, in, pos_ids, seqlen, nhead, d, out_strides, in_strides, pos_stride, theta);
+    } else {
+        rope_<false>(out, in, pos_ids, seqlen, nhead, d, out_strides, in_strides, pos_stride, theta);
+    }
+}
+
+void rope(std::byte *out, const std::byte *in, const std::byte *pos_ids,
+          llaisysDataType_t type, size_t seqlen, size_t nhead, size_t d,
+          const ptrdiff_t *out_strides, const ptrdiff_t *in_strides, ptrdiff_t pos_stride, float theta) {
+
     const int64_t *pids = reinterpret_cast<const int64_t *>(pos_ids);
 
     switch (type) {
     case LLAISYS_DTYPE_F32:
-        return rope_<float>(reinterpret_cast<float *>(out), reinterpret_cast<const float *>(in), 
-                            pids, seqlen, nhead, d, theta);
+        return rope_<float>(reinterpret_cast<float *>(out), reinterpret_cast<const float *>(in),
+                            pids, seqlen, nhead, d, out_strides, in_strides, pos_stride, theta);
     case LLAISYS_DTYPE_BF16:
-        return rope_<llaisys::bf16_t>(reinterpret_cast<llaisys::bf16_t *>(out), 
-                                      reinterpret_cast<const llaisys::bf16_t *>(in), 
-                                      pids, seqlen, nhead, d, theta);
+        return rope_<llaisys::bf16_t>(reinterpret_cast<llaisys::bf16_t *>(out),
+                                      reinterpret_cast<const llaisys::bf16_t *>(in),
+                                      pids, seqlen, nhead, d, out_strides, in_strides, pos_stride, theta);
     case LLAISYS_DTYPE_F16:
-        return rope_<llaisys::fp16_t>(reinterpret_cast<llaisys::fp16_t *>(out), 
-                                      reinterpret_cast<const llaisys::fp16_t *>(in), 
-                                      pids, seqlen, nhead, d, theta);
+        return rope_<llaisys::fp16_t>(reinterpret_cast<llaisys::fp16_t *>(out),
+                                      reinterpret_cast<const llaisys::fp16_t *>(in),
+                                      pids, seqlen, nhead, d, out_strides, in_strides, pos_stride, theta);
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(type);
     }
 }
 
-} // namespace llaisys::ops::cpu
\ No newline at end of file
+} // namespace llaisys::ops::cpu
@@ -4,6 +4,8 @@
 #include <cstddef>
 
 namespace llaisys::ops::cpu {
-void rope(std::byte *out, const std::byte *in, const std::byte *pos_ids, 
-          llaisysDataType_t type, size_t seqlen, size_t nhead, size_t d, float theta);
-}
\ No newline at end of file
+// in / out 为 [seqlen, nhead, d]，out_strides / in_strides 为三维的步长（元素），pos_stride 为 pos_ids 的步长
+void rope(std::byte *out, const std::byte *in, const std::byte *pos_ids,
+          llaisysDataType_t type, size_t seqlen, size_t nhead, size_t d,
+          const ptrdiff_t *out_strides, const ptrdiff_t *in_strides, ptrdiff_t pos_stride, float theta);
+}
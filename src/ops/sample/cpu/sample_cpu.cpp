@@ -0,0 +1,151 @@
+#include "sample_cpu.hpp"
+#include "../../../utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace {
+// 词表较大且只有一行时，行内的转换/归约也用多线程
+constexpr size_t PARALLEL_ROW_THRESHOLD = 32768;
+// top-p 不配合 top-k 时，从这么多个候选开始做部分选择，质量不够再倍增
+constexpr size_t TOP_P_INITIAL_CANDIDATES = 1024;
+
+// splitmix64：每一行由 (seed, 行号) 得到独立且可复现的随机数
+uint64_t splitmix64(uint64_t &state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+double uniform(uint64_t seed, size_t row) {
+    uint64_t state = seed ^ (static_cast<uint64_t>(row) * 0xd1b54a32d192ed03ULL);
+    return static_cast<double>(splitmix64(state) >> 11) * 0x1.0p-53;
+}
+
+// idx[0, m) 为按概率降序排好的候选，w 为未归一化概率，norm 为归一化常数：
+// 保留累积概率刚好达到 top_p 的最小前缀（至少 1 个），再在其中抽样
+int64_t nucleus(const float *w, const int32_t *idx, size_t m, double norm, float top_p, double u) {
+    size_t n = 0;
+    double kept = 0.0;
+    while (n < m && (n == 0 || kept < static_cast<double>(top_p) * norm)) {
+        kept += w[idx[n]];
+        n++;
+    }
+    double r = u * kept;
+    for (size_t j = 0; j < n; j++) {
+        r -= w[idx[j]];
+        if (r < 0.0) {
+            return idx[j];
+        }
+    }
+    return idx[n - 1];
+}
+
+template <typename T>
+int64_t sample_row(const T *row, float *x, std::vector<int32_t> &idx, size_t voc, float temperature,
+                   size_t top_k, float top_p, double u, bool parallel) {
+    // 1. 转成 float 并求最大值
+    float max_val = -INFINITY;
+#pragma omp parallel for simd reduction(max : max_val) schedule(static) if (parallel)
+    for (size_t i = 0; i < voc; i++) {
+        x[i] = llaisys::utils::cast<float>(row[i]);
+        max_val = std::max(max_val, x[i]);
+    }
+    if (temperature <= 0.0f || top_k == 1) {
+        // 与 argmax 一致：取第一个最大值
+        return static_cast<int64_t>(std::find(x, x + voc, max_val) - x);
+    }
+
+    const float inv_t = 1.0f / temperature;
+    const size_t k = top_k > 0 ? std::min(top_k, voc) : voc;
+    auto greater = [x](int32_t a, int32_t b) { return x[a] > x[b] || (x[a] == x[b] && a < b); };
+    idx.resize(voc);
+    std::iota(idx.begin(), idx.end(), 0);
+
+    if (k < voc) {
+        // 2a. top-k：exp 单调，直接在 logits 上做部分选择，只对 k 个候选求 exp
+        std::nth_element(idx.begin(), idx.begin() + (k - 1), idx.end(), greater);
+        std::sort(idx.begin(), idx.begin() + k, greater);
+        double mass = 0.0;
+        for (size_t j = 0; j < k; j++) {
+            x[idx[j]] = std::exp((x[idx[j]] - max_val) * inv_t);
+            mass += x[idx[j]];
+        }
+        return nucleus(x, idx.data(), k, mass, top_p, u);
+    }
+
+    // 2b. 整个词表的未归一化概率 exp((x - max) / T)
+    float total = 0.0f;
+#pragma omp parallel for simd reduction(+ : total) schedule(static) if (parallel)
+    for (size_t i = 0; i < voc; i++) {
+        x[i] = std::exp((x[i] - max_val) * inv_t);
+        total += x[i];
+    }
+    if (top_p >= 1.0f) {
+        // 不截断：直接在整行上按累积和抽样
+        double r = u * total;
+        for (size_t i = 0; i < voc; i++) {
+            r -= x[i];
+            if (r < 0.0) {
+                return static_cast<int64_t>(i);
+            }
+        }
+        return static_cast<int64_t>(std::max_element(x, x + voc) - x);
+    }
+
+    // 3. 只用 top-p：从 TOP_P_INITIAL_CANDIDATES 个候选开始部分选择，概率和不到 top_p 就倍增
+    size_t m = 0;
+    size_t next = std::min(voc, TOP_P_INITIAL_CANDIDATES);
+    double mass = 0.0; // 前 m 个候选的概率和
+    for (;;) {
+        // [0, m) 已经有序，只需在剩下的元素中选出下一段
+        std::nth_element(idx.begin() + m, idx.begin() + (next - 1), idx.end(), greater);
+        std::sort(idx.begin() + m, idx.begin() + next, greater);
+        for (; m < next; m++) {
+            mass += x[idx[m]];
+        }
+        if (m == voc || mass >= static_cast<double>(top_p) * total) {
+            break;
+        }
+        next = std::min(voc, m * 2);
+    }
+    return nucleus(x, idx.data(), m, total, top_p, u);
+}
+
+template <typename T>
+void sample_(int64_t *out_idx, const T *logits, size_t batch, size_t voc, float temperature, size_t top_k,
+             float top_p, uint64_t seed) {
+    const bool parallel_row = batch == 1 && voc >= PARALLEL_ROW_THRESHOLD;
+#pragma omp parallel if (batch > 1)
+    {
+        std::vector<float> x(voc);
+        std::vector<int32_t> idx;
+#pragma omp for schedule(dynamic)
+        for (size_t b = 0; b < batch; b++) {
+            out_idx[b] = sample_row(logits + b * voc, x.data(), idx, voc, temperature, top_k, top_p,
+                                    uniform(seed, b), parallel_row);
+        }
+    }
+}
+} // namespace
+
+namespace llaisys::ops::cpu {
+void sample(std::byte *out_idx, const std::byte *logits, llaisysDataType_t type, size_t batch, size_t voc,
+            float temperature, int64_t top_k, float top_p, uint64_t seed) {
+    int64_t *out = reinterpret_cast<int64_t *>(out_idx);
+    const size_t k = top_k > 0 ? static_cast<size_t>(top_k) : 0;
+    switch (type) {
+    case LLAISYS_DTYPE_F32:
+        return sample_(out, reinterpret_cast<const float *>(logits), batch, voc, temperature, k, top_p, seed);
+    case LLAISYS_DTYPE_BF16:
+        return sample_(out, reinterpret_cast<const llaisys::bf16_t *>(logits), batch, voc, temperature, k, top_p, seed);
+    case LLAISYS_DTYPE_F16:
+        return sample_(out, reinterpret_cast<const llaisys::fp16_t *>(logits), batch, voc, temperature, k, top_p, seed);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(type);
+    }
+}
+} // namespace llaisys::ops::cpu
@@ -0,0 +1,10 @@
+#pragma once
+#include "llaisys.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace llaisys::ops::cpu {
+void sample(std::byte *out_idx, const std::byte *logits, llaisysDataType_t type, size_t batch, size_t voc,
+            float temperature, int64_t top_k, float top_p, uint64_t seed);
+}
@@ -0,0 +1,38 @@
+#include "op.hpp"
+#include "../pointwise/op.hpp"
+#include "cpu/sample_cpu.hpp"
+namespace llaisys::ops {
+// logits 为 [batch, voc] 或 [voc] 的连续张量，out_idx 为 [batch] 的 int64 张量。
+// temperature <= 0 或 top_k == 1 时退化为 argmax；top_k <= 0 表示不限制，top_p >= 1 表示不截断。
+// 每一行使用由 (seed, 行号) 派生的独立随机数，结果与线程数无关。
+void sample(tensor_t out_idx, tensor_t logits, float temperature, int64_t top_k, float top_p, uint64_t seed) {
+    pointwise::sync();
+    CHECK_SAME_DEVICE(out_idx, logits);
+    ASSERT(out_idx->dtype() == LLAISYS_DTYPE_I64, "Sample: out_idx must be int64");
+    ASSERT(logits->ndim() == 1 || logits->ndim() == 2, "Sample: logits must be 1D or 2D");
+    ASSERT(logits->isContiguous() && out_idx->isContiguous(), "Sample: all tensors must be contiguous");
+    const size_t batch = logits->ndim() == 2 ? logits->shape()[0] : 1;
+    const size_t voc = logits->shape().back();
+    ASSERT(out_idx->numel() == batch, "Sample: out_idx must have one element per row");
+    ASSERT(voc > 0, "Sample: empty vocabulary");
+    LLAISYS_PROFILE_OP("sample", logits->dtype(), batch * voc, batch * voc * logits->elementSize(), &logits->shape());
+
+    if (logits->deviceType() == LLAISYS_DEVICE_CPU) {
+        return cpu::sample(out_idx->data(), logits->data(), logits->dtype(), batch, voc, temperature, top_k, top_p, seed);
+    }
+
+    llaisys::core::context().setDevice(logits->deviceType(), logits->deviceId());
+
+    switch (logits->deviceType()) {
+    case LLAISYS_DEVICE_CPU:
+        return cpu::sample(out_idx->data(), logits->data(), logits->dtype(), batch, voc, temperature, top_k, top_p, seed);
+#ifdef ENABLE_NVIDIA_API
+    case LLAISYS_DEVICE_NVIDIA:
+        TO_BE_IMPLEMENTED();
+        return;
+#endif
+    default:
+        EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+} // namespace llaisys::ops
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+namespace llaisys::ops {
+// 对 logits 的每一行做 temperature -> top-k -> top-p 采样，结果写入 out_idx
+void sample(tensor_t out_idx, tensor_t logits, float temperature, int64_t top_k, float top_p, uint64_t seed);
+}
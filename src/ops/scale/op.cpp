@@ -0,0 +1,39 @@
+#include "op.hpp"
+
+#include "../../core/llaisys_core.hpp"
+#include "../../utils.hpp"
+
+#include "../pointwise/op.hpp"
+
+namespace llaisys::ops {
+// out = in * alpha，形状和类型相同，步长任意；可以原地（out 与 in 为同一个张量）
+void scale(tensor_t out, tensor_t in, float alpha) {
+    CHECK_SAME_DEVICE(out, in);
+    CHECK_SAME_SHAPE(out->shape(), in->shape());
+    CHECK_SAME_DTYPE(out->dtype(), in->dtype());
+
+    // 延迟模式下只记录，与前后的逐元素运算一起执行
+    if (pointwise::defer(pointwise::SCALE, out, in, nullptr, alpha)) {
+        return;
+    }
+
+    // 没有单独的内核，按只有一个运算的融合程序执行
+    if (out->deviceType() == LLAISYS_DEVICE_CPU) {
+        return pointwise::run(pointwise::SCALE, out, in, nullptr, alpha);
+    }
+
+    llaisys::core::context().setDevice(out->deviceType(), out->deviceId());
+
+    switch (out->deviceType()) {
+    case LLAISYS_DEVICE_CPU:
+        return pointwise::run(pointwise::SCALE, out, in, nullptr, alpha);
+#ifdef ENABLE_NVIDIA_API
+    case LLAISYS_DEVICE_NVIDIA:
+        TO_BE_IMPLEMENTED();
+        return;
+#endif
+    default:
+        EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+} // namespace llaisys::ops
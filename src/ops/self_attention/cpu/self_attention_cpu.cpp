@@ -1,100 +1,285 @@
 #include "self_attention_cpu.hpp"
 #include "../../../utils.hpp"
 #include <cmath>
+#include <limits>
 #include <vector>
 #include <algorithm>
+#include <numeric>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace llaisys::ops::cpu {
 
+// 连续存放的一段可见 K/V 行，以及与它们做点积的 query
 template <typename T>
-void self_attention_(T *attn_val, const T *q, const T *k, const T *v,
-                     size_t seqlen, size_t total_len, size_t nhead, size_t nkvhead,
-                     size_t d, size_t dv, float scale) {
-    
-    size_t group_size = nhead / nkvhead;
-    size_t past_len = total_len - seqlen;
-
-    for (size_t i = 0; i < seqlen; ++i) {
-        for (size_t h = 0; h < nhead; ++h) {
-            size_t h_kv = h / group_size;
-            const T *q_ptr = q + (i * nhead + h) * d;
-            
-            // 使用 float 存储中间分数，保证 Softmax 精度
-            std::vector<float> scores(total_len);
-            float max_score = -std::numeric_limits<float>::infinity();
-
-            // --- 环节 1: QK^T 计算 (高精度累加) ---
-            for (size_t j = 0; j < total_len; ++j) {
-                if (j > (past_len + i)) {
-                    scores[j] = -1e10f; 
-                    continue;
-                }
-                const T *k_ptr = k + (j * nkvhead + h_kv) * d;
-                
-                // 使用 double 累加点积，减少 FP16 精度丢失
-                double dot = 0.0;
-                for (size_t dim = 0; dim < d; ++dim) {
-                    dot += (double)llaisys::utils::cast<float>(q_ptr[dim]) * (double)llaisys::utils::cast<float>(k_ptr[dim]);
-                }
-                scores[j] = (float)(dot * (double)scale);
-                if (scores[j] > max_score) max_score = scores[j];
+struct Span {
+    const T *q;
+    size_t row;
+    size_t n;
+};
+
+// 单个 (query 行, head) 的 attention：可见的 K/V 按位置顺序分成若干段（sink、ring 回绕前后、稀疏选中的页）
+template <typename T>
+void attention_row_(T *out_ptr, const Span<T> *spans, size_t nspan, const T *k, const T *v,
+                    const RowHeadStrides &ks, const RowHeadStrides &vs, size_t h_kv, size_t d, size_t dv, float scale,
+                    std::vector<float> &scores, std::vector<float> &line_buffer) {
+    size_t nvisible = 0;
+    for (size_t p = 0; p < nspan; ++p) nvisible += spans[p].n;
+    // 使用 float 存储中间分数，保证 Softmax 精度
+    scores.resize(nvisible);
+    float max_score = -std::numeric_limits<float>::infinity();
+
+    // --- 环节 1: QK^T 计算 (高精度累加)，mask 掉的位置直接跳过 ---
+    size_t j = 0;
+    for (size_t p = 0; p < nspan; ++p) {
+        const T *q_ptr = spans[p].q;
+        for (size_t r = spans[p].row; r < spans[p].row + spans[p].n; ++r, ++j) {
+            const T *k_ptr = k + static_cast<ptrdiff_t>(r) * ks.row + static_cast<ptrdiff_t>(h_kv) * ks.head;
+
+            // 使用 double 累加点积，减少 FP16 精度丢失
+            double dot = 0.0;
+            for (size_t dim = 0; dim < d; ++dim) {
+                dot += (double)llaisys::utils::cast<float>(q_ptr[dim]) * (double)llaisys::utils::cast<float>(k_ptr[dim]);
             }
+            scores[j] = (float)(dot * (double)scale);
+            if (scores[j] > max_score) max_score = scores[j];
+        }
+    }
+
+    // --- 环节 2: Softmax 计算 (Double 累加分母) ---
+    double sum_exp = 0.0;
+    for (j = 0; j < nvisible; ++j) {
+        scores[j] = std::exp(scores[j] - max_score);
+        sum_exp += (double)scores[j];
+    }
+    float inv_sum = (float)(1.0 / (sum_exp + 1e-12));
+
+    // --- 环节 3: Score * V 计算 (Float32 累加输出) ---
+    // 使用临时 float 数组存储这一行的结果，避免频繁 cast
+    line_buffer.assign(dv, 0.0f);
+
+    j = 0;
+    for (size_t p = 0; p < nspan; ++p) {
+        for (size_t r = spans[p].row; r < spans[p].row + spans[p].n; ++r, ++j) {
+            float s = scores[j] * inv_sum;
+            if (s < 1e-8f) continue;
 
-            // --- 环节 2: Softmax 计算 (Double 累加分母) ---
-            double sum_exp = 0.0;
-            for (size_t j = 0; j < total_len; ++j) {
-                scores[j] = std::exp(scores[j] - max_score);
-                sum_exp += (double)scores[j];
+            const T *v_ptr = v + static_cast<ptrdiff_t>(r) * vs.row + static_cast<ptrdiff_t>(h_kv) * vs.head;
+            for (size_t dim = 0; dim < dv; ++dim) {
+                // 在 float 空间累加
+                line_buffer[dim] += s * llaisys::utils::cast<float>(v_ptr[dim]);
             }
-            float inv_sum = (float)(1.0 / (sum_exp + 1e-12));
-
-            // --- 环节 3: Score * V 计算 (Float32 累加输出) ---
-            T *out_ptr = attn_val + (i * nhead + h) * dv;
-            
-            // 使用临时 float 数组存储这一行的结果，避免频繁 cast
-            std::vector<float> line_buffer(dv, 0.0f);
-
-            for (size_t j = 0; j < total_len; ++j) {
-                float s = scores[j] * inv_sum;
-                if (s < 1e-8f) continue; 
-
-                const T *v_ptr = v + (j * nkvhead + h_kv) * dv;
-                for (size_t dim = 0; dim < dv; ++dim) {
-                    // 在 float 空间累加
-                    line_buffer[dim] += s * llaisys::utils::cast<float>(v_ptr[dim]);
-                }
+        }
+    }
+
+    // 最后统一写回 T 类型
+    for (size_t dim = 0; dim < dv; ++dim) {
+        out_ptr[dim] = llaisys::utils::cast<T>(line_buffer[dim]);
+    }
+}
+
+// 每个线程复用的临时缓冲
+template <typename T>
+struct RowScratch {
+    std::vector<Span<T>> spans;
+    std::vector<float> scores;
+    std::vector<float> line_buffer;
+    std::vector<float> page_scores;
+    std::vector<size_t> pages;
+};
+
+// Quest：页 p 的得分为 q 与页内任意 key 点积的上界 sum_d max(q_d * min_d, q_d * max_d)，
+// 选出得分最高的 top_pages 页（最近 recent 个位置之前的部分），按位置顺序加入 spans
+template <typename T>
+void select_pages_(const T *q_ptr, const AttentionKV &seq, const AttentionMask &mask, size_t recent_begin,
+                   size_t nkvhead, size_t h_kv, size_t d, RowScratch<T> &scratch) {
+    const size_t npages = (recent_begin + mask.page - 1) / mask.page;
+    scratch.page_scores.resize(npages);
+    for (size_t p = 0; p < npages; ++p) {
+        const float *mn = seq.page_min + (p * nkvhead + h_kv) * d;
+        const float *mx = seq.page_max + (p * nkvhead + h_kv) * d;
+        float bound = 0.0f;
+        for (size_t dim = 0; dim < d; ++dim) {
+            float x = llaisys::utils::cast<float>(q_ptr[dim]);
+            bound += std::max(x * mn[dim], x * mx[dim]);
+        }
+        scratch.page_scores[p] = bound;
+    }
+    auto &pages = scratch.pages;
+    pages.resize(npages);
+    std::iota(pages.begin(), pages.end(), size_t(0));
+    const auto &score = scratch.page_scores;
+    std::nth_element(pages.begin(), pages.begin() + (mask.top_pages - 1), pages.end(),
+                     [&](size_t a, size_t b) { return score[a] > score[b] || (score[a] == score[b] && a < b); });
+    std::sort(pages.begin(), pages.begin() + mask.top_pages);
+    for (size_t i = 0; i < mask.top_pages; ++i) {
+        size_t begin = pages[i] * mask.page, n = std::min(begin + mask.page, recent_begin) - begin;
+        auto &spans = scratch.spans;
+        if (!spans.empty() && spans.back().row + spans.back().n == begin) {
+            spans.back().n += n; // 相邻的页合并成一段
+        } else {
+            spans.push_back({q_ptr, begin, n});
+        }
+    }
+}
+
+// (行, head) 工作项的划分：head_major 时同一个 head 的各行相邻（共享同一组 K/V），
+// 否则同一行的各个 head 相邻（共享 q 的一行）；chunk 为 dynamic 调度每次取的工作项数
+struct AttentionConfig {
+    std::string name;
+    bool head_major;
+    size_t chunk;
+};
+
+const std::vector<AttentionConfig> &attentionConfigs() {
+    static const std::vector<AttentionConfig> configs = [] {
+        std::vector<AttentionConfig> c;
+        for (bool head_major : {false, true}) {
+            for (size_t chunk : {1, 4, 16}) {
+                c.push_back({std::string(head_major ? "head:" : "row:") + std::to_string(chunk), head_major, chunk});
             }
+        }
+        return c;
+    }();
+    return configs;
+}
 
-            // 最后统一写回 T 类型
-            for (size_t dim = 0; dim < dv; ++dim) {
-                out_ptr[dim] = llaisys::utils::cast<T>(line_buffer[dim]);
+template <typename T>
+void self_attention_varlen_(T *attn_val, const T *q, const T *q_sink, const AttentionKV *kv,
+                            const size_t *cu_seqlens, size_t nseq, const AttentionMask &mask,
+                            size_t nhead, size_t nkvhead, size_t d, size_t dv, float scale,
+                            const RowHeadStrides &os, const RowHeadStrides &qs,
+                            const std::vector<size_t> &seq_of, const AttentionConfig &cfg) {
+    size_t group_size = nhead / nkvhead;
+    size_t ntoken = cu_seqlens[nseq];
+    const size_t sink = mask.sink, window = mask.window;
+    const size_t chunk = cfg.chunk;
+
+#pragma omp parallel
+    {
+        RowScratch<T> scratch;
+#pragma omp for schedule(dynamic, chunk)
+        for (size_t w = 0; w < ntoken * nhead; ++w) {
+            size_t i = cfg.head_major ? w % ntoken : w / nhead, h = cfg.head_major ? w / ntoken : w % nhead;
+            size_t s = seq_of[i];
+            const AttentionKV &seq = kv[s];
+            // 序列内第 i - cu_seqlens[s] 个 query 的位置，能看到 [0, pos] 的 K/V
+            size_t pos = seq.len - (cu_seqlens[s + 1] - cu_seqlens[s]) + (i - cu_seqlens[s]);
+            // 行、head 按步长定位，同一 head 的 d 个元素连续
+            const ptrdiff_t q_off = static_cast<ptrdiff_t>(i) * qs.row + static_cast<ptrdiff_t>(h) * qs.head;
+            const T *q_ptr = q + q_off;
+
+            auto &spans = scratch.spans;
+            spans.clear();
+            size_t begin = 0; // 连续可见的最早位置
+            if (window > 0 && pos + 1 > sink + window) {
+                spans.push_back({q_sink ? q_sink + q_off : q_ptr, 0, sink});
+                begin = pos + 1 - window;
+            } else if (mask.page > 0 && seq.sparse && pos + 1 > mask.top_pages * mask.page + mask.recent) {
+                begin = pos + 1 - mask.recent;
+                select_pages_(q_ptr, seq, mask, begin, nkvhead, h / group_size, d, scratch);
+            }
+            // [begin, pos] 在 ring 中可能回绕成两段；ring 为 0 表示位置即行号
+            size_t ring = seq.len > seq.rows ? seq.rows - sink : 0;
+            for (size_t a = begin; a <= pos;) {
+                size_t row = a, n = pos + 1 - a;
+                if (ring > 0 && a < sink) {
+                    n = std::min(n, sink - a);
+                } else if (ring > 0) {
+                    row = sink + (a - sink) % ring;
+                    n = std::min(n, seq.rows - row);
+                }
+                spans.push_back({q_ptr, row, n});
+                a += n;
             }
+            attention_row_(attn_val + static_cast<ptrdiff_t>(i) * os.row + static_cast<ptrdiff_t>(h) * os.head,
+                           spans.data(), spans.size(), reinterpret_cast<const T *>(seq.k),
+                           reinterpret_cast<const T *>(seq.v), seq.k_strides, seq.v_strides, h / group_size, d, dv,
+                           scale, scratch.scores, scratch.line_buffer);
         }
     }
 }
 
-void self_attention(std::byte *attn_val, const std::byte *q, const std::byte *k, const std::byte *v,
-                    llaisysDataType_t type, size_t seqlen, size_t total_len, size_t nhead, 
-                    size_t nkvhead, size_t d, size_t dv, float scale) {
+// 按 (query 行数、最长 K/V 长度分桶, head 配置, dtype, 线程数) 调优选出划分方式后计算；
+// 调优时每个候选都完整计算一遍（只写 attn_val，可以重复执行）
+template <typename T>
+void self_attention_tuned_(T *attn_val, const T *q, const T *q_sink, const AttentionKV *kv,
+                           const size_t *cu_seqlens, llaisysDataType_t type, size_t nseq, const AttentionMask &mask,
+                           size_t nhead, size_t nkvhead, size_t d, size_t dv, float scale,
+                           const RowHeadStrides &os, const RowHeadStrides &qs) {
+    size_t ntoken = cu_seqlens[nseq];
+    if (ntoken == 0) {
+        return;
+    }
+    // 每个 query 行所属的序列，所有序列的 (行, head) 一起并行，长短序列混合时也能均衡
+    std::vector<size_t> seq_of(ntoken);
+    size_t max_len = 0;
+    for (size_t s = 0; s < nseq; ++s) {
+        std::fill(seq_of.begin() + cu_seqlens[s], seq_of.begin() + cu_seqlens[s + 1], s);
+        max_len = std::max(max_len, kv[s].len);
+    }
+
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    const auto &configs = attentionConfigs();
+    std::vector<std::string> names;
+    for (const auto &c : configs) {
+        names.push_back(c.name);
+    }
+    const bool masked = mask.window > 0 || mask.page > 0;
+    const std::string key = std::string("self_attention|") + llaisys::utils::dtype_to_str(type) + "|q"
+                          + std::to_string(llaisys::autotune::bucket(ntoken)) + "s"
+                          + std::to_string(llaisys::autotune::bucket(nseq)) + "kv"
+                          + std::to_string(llaisys::autotune::bucket(max_len)) + "h" + std::to_string(nhead) + ":"
+                          + std::to_string(nkvhead) + "d" + std::to_string(d) + ":" + std::to_string(dv)
+                          + (masked ? "m" : "") + "|t" + std::to_string(nthreads);
+    auto run = [&](size_t i) {
+        self_attention_varlen_(attn_val, q, q_sink, kv, cu_seqlens, nseq, mask, nhead, nkvhead, d, dv, scale, os, qs,
+                               seq_of, configs[i]);
+    };
+    // 默认与原来相同：按行，每次取一个工作项
+    run(llaisys::autotune::select(key, names, 0, run));
+}
+
+void self_attention_varlen(std::byte *attn_val, const std::byte *q, const std::byte *q_sink, const AttentionKV *kv,
+                           const size_t *cu_seqlens, llaisysDataType_t type, size_t nseq, const AttentionMask &mask,
+                           size_t nhead, size_t nkvhead, size_t d, size_t dv, float scale,
+                           const RowHeadStrides &out_strides, const RowHeadStrides &q_strides) {
     // 根据数据类型分发模板
     switch (type) {
         case LLAISYS_DTYPE_F32:
-            self_attention_<float>((float*)attn_val, (const float*)q, (const float*)k, (const float*)v, 
-                                   seqlen, total_len, nhead, nkvhead, d, dv, scale);
+            self_attention_tuned_<float>((float*)attn_val, (const float*)q, (const float*)q_sink, kv, cu_seqlens,
+                                         type, nseq, mask, nhead, nkvhead, d, dv, scale, out_strides, q_strides);
             break;
         case LLAISYS_DTYPE_BF16:
-            self_attention_<llaisys::bf16_t>((llaisys::bf16_t*)attn_val, (const llaisys::bf16_t*)q, 
-                                            (const llaisys::bf16_t*)k, (const llaisys::bf16_t*)v, 
-                                            seqlen, total_len, nhead, nkvhead, d, dv, scale);
+            self_attention_tuned_<llaisys::bf16_t>((llaisys::bf16_t*)attn_val, (const llaisys::bf16_t*)q,
+                                                   (const llaisys::bf16_t*)q_sink, kv, cu_seqlens,
+                                                   type, nseq, mask, nhead, nkvhead, d, dv, scale, out_strides, q_strides);
             break;
         case LLAISYS_DTYPE_F16:
-            self_attention_<llaisys::fp16_t>((llaisys::fp16_t*)attn_val, (const llaisys::fp16_t*)q, 
-                                            (const llaisys::fp16_t*)k, (const llaisys::fp16_t*)v, 
-                                            seqlen, total_len, nhead, nkvhead, d, dv, scale);
+            self_attention_tuned_<llaisys::fp16_t>((llaisys::fp16_t*)attn_val, (const llaisys::fp16_t*)q,
+                                                   (const llaisys::fp16_t*)q_sink, kv, cu_seqlens,
+                                                   type, nseq, mask, nhead, nkvhead, d, dv, scale, out_strides, q_strides);
             break;
         default:
             EXCEPTION_UNSUPPORTED_DATATYPE(type);
     }
 }
 
-} // namespace llaisys::ops::cpu
\ No newline at end of file
+void self_attention(std::byte *attn_val, const std::byte *q, const std::byte *k, const std::byte *v,
+                    llaisysDataType_t type, size_t seqlen, size_t total_len, size_t nhead, 
+                    size_t nkvhead, size_t d, size_t dv, float scale, const RowHeadStrides &out_strides,
+                    const RowHeadStrides &q_strides, const RowHeadStrides &k_strides, const RowHeadStrides &v_strides) {
+    // 单条序列即 nseq = 1 的 varlen
+    const size_t cu_seqlens[2] = {0, seqlen};
+    const AttentionKV kv{k, v, total_len, total_len, nullptr, nullptr, false, k_strides, v_strides};
+    self_attention_varlen(attn_val, q, nullptr, &kv, cu_seqlens, type, 1, {}, nhead, nkvhead, d, dv, scale,
+                          out_strides, q_strides);
+}
+
+} // namespace llaisys::ops::cpu
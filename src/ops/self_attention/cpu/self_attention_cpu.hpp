@@ -4,7 +4,47 @@
 #include <cstddef>
 
 namespace llaisys::ops::cpu {
+// [行, head, dim] 张量前两维的步长（元素）；最后一维必须连续
+struct RowHeadStrides {
+    ptrdiff_t row;
+    ptrdiff_t head;
+};
+
 void self_attention(std::byte *attn_val, const std::byte *q, const std::byte *k, const std::byte *v,
                     llaisysDataType_t type, size_t seqlen, size_t total_len, size_t nhead, 
-                    size_t nkvhead, size_t d, size_t dv, float scale) ;
-}
\ No newline at end of file
+                    size_t nkvhead, size_t d, size_t dv, float scale, const RowHeadStrides &out_strides,
+                    const RowHeadStrides &q_strides, const RowHeadStrides &k_strides, const RowHeadStrides &v_strides);
+
+// 一条序列的 K/V：len 个位置存放在 rows 行中。位置 a < sink 在第 a 行，
+// 其余位置在第 sink + (a - sink) % (rows - sink) 行（len <= rows 时即第 a 行）。
+// page_min / page_max 非空且 sparse 时按页摘要 [npages, nkvhead, d]（float32，连续）做稀疏 attention
+struct AttentionKV {
+    const std::byte *k;
+    const std::byte *v;
+    size_t len;
+    size_t rows;
+    const float *page_min;
+    const float *page_max;
+    bool sparse;
+    RowHeadStrides k_strides;
+    RowHeadStrides v_strides;
+};
+
+// 每个 query 能看到的位置：
+// window > 0 时只看前 sink 个位置和最近 window 个位置（StreamingLLM）；
+// page > 0 时稀疏序列只看按 query 与页摘要的上界得分最高的 top_pages 页，以及最近 recent 个位置（Quest）
+struct AttentionMask {
+    size_t sink;
+    size_t window;
+    size_t page;
+    size_t top_pages;
+    size_t recent;
+};
+
+// 第 s 条序列的 query 为 q / attn_val 的 [cu_seqlens[s], cu_seqlens[s + 1]) 行，对齐到 kv[s] 的末尾做因果 mask。
+// q_sink 非空时与 sink 位置做点积改用 q_sink（步长与 q 相同）
+void self_attention_varlen(std::byte *attn_val, const std::byte *q, const std::byte *q_sink, const AttentionKV *kv,
+                           const size_t *cu_seqlens, llaisysDataType_t type, size_t nseq, const AttentionMask &mask,
+                           size_t nhead, size_t nkvhead, size_t d, size_t dv, float scale,
+                           const RowHeadStrides &out_strides, const RowHeadStrides &q_strides);
+}
@@ -1,10 +1,76 @@
 #include "op.hpp"
+#include "../pointwise/op.hpp"
 #include "../../core/llaisys_core.hpp"
 #include "../../utils.hpp"
+#include "../rearrange/op.hpp"
 #include "cpu/self_attention_cpu.hpp"
+
+#include <algorithm>
 namespace llaisys::ops {
+namespace {
+// [行, head, dim] 张量前两维的步长，kernel 按步长定位每个 (行, head)，只要求 head_dim 连续
+cpu::RowHeadStrides row_head(const tensor_t &t) {
+    return {t->strides()[0], t->strides()[1]};
+}
+
+bool unit_last_dim(const tensor_t &t) {
+    return t->strides().back() == 1 || t->shape().back() == 1;
+}
+
+void check_varlen(tensor_t attn_val, tensor_t q, size_t nkvhead, size_t d, size_t dv,
+                  const std::vector<size_t> &cu_seqlens, const std::vector<cpu::AttentionKV> &kv,
+                  const cpu::AttentionMask &mask) {
+    ASSERT(q->ndim() == 3 && attn_val->ndim() == 3, "SelfAttentionVarlen: q and attn_val must be [ntoken, nhead, d].");
+    ASSERT(q->shape()[2] == d, "SelfAttentionVarlen: Q and K head_dim mismatch.");
+    ASSERT(q->shape()[1] % nkvhead == 0, "SelfAttentionVarlen: nhead must be divisible by nkvhead (GQA).");
+    ASSERT(attn_val->shape()[0] == q->shape()[0] && attn_val->shape()[1] == q->shape()[1] && attn_val->shape()[2] == dv,
+           "SelfAttentionVarlen: output shape mismatch.");
+    ASSERT(unit_last_dim(q) && unit_last_dim(attn_val), "SelfAttentionVarlen: q and attn_val must have a contiguous head_dim.");
+    const size_t nseq = kv.size();
+    ASSERT(cu_seqlens.size() == nseq + 1 && cu_seqlens[0] == 0 && cu_seqlens[nseq] == q->shape()[0],
+           "SelfAttentionVarlen: cu_seqlens must start at 0 and end at ntoken.");
+    for (size_t s = 0; s < nseq; s++) {
+        ASSERT(cu_seqlens[s] <= cu_seqlens[s + 1], "SelfAttentionVarlen: cu_seqlens must be non-decreasing.");
+        const size_t qlen = cu_seqlens[s + 1] - cu_seqlens[s];
+        ASSERT(qlen <= kv[s].len, "SelfAttentionVarlen: a sequence has more queries than keys.");
+        if (kv[s].len > kv[s].rows) {
+            // ring buffer：块内最早的 query 需要的窗口不能被同一块写入的 K/V 覆盖
+            ASSERT(mask.window > 0 && kv[s].rows >= mask.sink + mask.window + qlen - 1,
+                   "SelfAttentionVarlen: ring buffer too small for the sliding window.");
+        }
+        if (kv[s].sparse) {
+            ASSERT(mask.page > 0 && mask.top_pages > 0 && mask.window == 0 && kv[s].page_min && kv[s].page_max,
+                   "SelfAttentionVarlen: sparse attention needs page summaries and no sliding window.");
+        }
+    }
+}
+
+// profiler 用：一条序列 qlen 个 query 在 causal mask 下实际参与计算的 (query, key) 对数，
+// 每个 query 最多看 budget 个 key（0 表示不限制）
+uint64_t attention_pairs(size_t qlen, size_t len, size_t budget) {
+    uint64_t pairs = 0;
+    for (size_t i = 0; i < qlen; i++) {
+        const size_t visible = len - qlen + i + 1;
+        pairs += budget ? std::min(visible, budget) : visible;
+    }
+    return pairs;
+}
+
+// FLOPs 为 QK^T 与 PV 两次乘加，访存按 q / out 各一遍、每条序列可见的 K/V 各读一遍估算
+struct AttentionCost {
+    uint64_t flops = 0;
+    uint64_t bytes = 0;
+};
+
+void add_sequence_cost(AttentionCost &cost, size_t qlen, size_t len, size_t budget, size_t nhead, size_t nkvhead,
+                       size_t d, size_t dv, size_t es) {
+    cost.flops += 2 * attention_pairs(qlen, len, budget) * nhead * (d + dv);
+    cost.bytes += (budget ? std::min(len, budget) : len) * nkvhead * (d + dv) * es + qlen * nhead * (d + dv) * es;
+}
+} // namespace
 
 void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale) {
+    pointwise::sync();
     // 1. 基础校验
     CHECK_SAME_DEVICE(attn_val, q, k, v);
     CHECK_SAME_DTYPE(attn_val->dtype(), q->dtype(), k->dtype(), v->dtype());
@@ -24,17 +90,165 @@ void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float
     ASSERT(attn_val->shape()[0] == seqlen && attn_val->shape()[1] == nhead && attn_val->shape()[2] == dv, 
            "SelfAttention: output shape mismatch.");
 
-    // 4. 分发到 CPU
+    // head_dim 不连续（很少见）的张量先复制成连续的，输出算完再写回
+    if (!unit_last_dim(q) || !unit_last_dim(k) || !unit_last_dim(v) || !unit_last_dim(attn_val)) {
+        auto out = unit_last_dim(attn_val) ? attn_val
+                                           : Tensor::create(attn_val->shape(), attn_val->dtype(),
+                                                            attn_val->deviceType(), attn_val->deviceId());
+        self_attention(out, unit_last_dim(q) ? q : q->contiguous(), unit_last_dim(k) ? k : k->contiguous(),
+                       unit_last_dim(v) ? v : v->contiguous(), scale);
+        if (out != attn_val) {
+            rearrange(attn_val, out);
+        }
+        return;
+    }
+
+    AttentionCost cost;
+    if (llaisys::profiler::enabled()) {
+        add_sequence_cost(cost, seqlen, total_len, 0, nhead, nkvhead, d, dv, q->elementSize());
+    }
+    LLAISYS_PROFILE_OP("self_attention", q->dtype(), cost.flops, cost.bytes, &q->shape(), &k->shape());
+
+    // 4. 分发到 CPU：前两维的步长直接传给 kernel，q/k/v 切片、按 head 排列的 KV 都不用复制
     if (attn_val->deviceType() == LLAISYS_DEVICE_CPU) {
-        return cpu::self_attention(attn_val->data(), q->data(), k->data(), v->data(), 
-                                  attn_val->dtype(), seqlen, total_len, nhead, nkvhead, d, dv, scale);
+        return cpu::self_attention(attn_val->data(), q->data(), k->data(), v->data(), attn_val->dtype(), seqlen,
+                                   total_len, nhead, nkvhead, d, dv, scale, row_head(attn_val), row_head(q),
+                                   row_head(k), row_head(v));
     }
 
     llaisys::core::context().setDevice(attn_val->deviceType(), attn_val->deviceId());
     switch (attn_val->deviceType()) {
         case LLAISYS_DEVICE_CPU:
-            return cpu::self_attention(attn_val->data(), q->data(), k->data(), v->data(), 
-                                      attn_val->dtype(), seqlen, total_len, nhead, nkvhead, d, dv, scale);
+            return cpu::self_attention(attn_val->data(), q->data(), k->data(), v->data(), attn_val->dtype(), seqlen,
+                                       total_len, nhead, nkvhead, d, dv, scale, row_head(attn_val), row_head(q),
+                                       row_head(k), row_head(v));
+#ifdef ENABLE_NVIDIA_API
+        case LLAISYS_DEVICE_NVIDIA:
+            TO_BE_IMPLEMENTED();
+            return;
+#endif
+        default:
+            EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+
+void self_attention_varlen(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v,
+                           tensor_t cu_seqlens_q, tensor_t cu_seqlens_k, float scale) {
+    pointwise::sync();
+    CHECK_SAME_DEVICE(attn_val, q, k, v, cu_seqlens_q, cu_seqlens_k);
+    CHECK_SAME_DTYPE(attn_val->dtype(), q->dtype(), k->dtype(), v->dtype());
+    ASSERT(cu_seqlens_q->dtype() == LLAISYS_DTYPE_I64 && cu_seqlens_k->dtype() == LLAISYS_DTYPE_I64,
+           "SelfAttentionVarlen: cu_seqlens must be int64.");
+    ASSERT(cu_seqlens_q->ndim() == 1 && cu_seqlens_q->shape() == cu_seqlens_k->shape() && cu_seqlens_q->numel() > 0,
+           "SelfAttentionVarlen: cu_seqlens_q and cu_seqlens_k must be [nseq + 1].");
+    ASSERT(k->ndim() == 3 && v->ndim() == 3 && v->shape()[0] == k->shape()[0] && v->shape()[1] == k->shape()[1],
+           "SelfAttentionVarlen: K and V shape mismatch.");
+    ASSERT(unit_last_dim(k) && unit_last_dim(v), "SelfAttentionVarlen: K and V must have a contiguous head_dim.");
+    const size_t nkvhead = k->shape()[1], d = k->shape()[2], dv = v->shape()[2];
+
+    if (attn_val->deviceType() == LLAISYS_DEVICE_CPU) {
+        const size_t nseq = cu_seqlens_q->numel() - 1;
+        const auto cu_q_host = cu_seqlens_q->contiguous(), cu_k_host = cu_seqlens_k->contiguous();
+        const auto *cu_q = reinterpret_cast<const int64_t *>(cu_q_host->data());
+        const auto *cu_k = reinterpret_cast<const int64_t *>(cu_k_host->data());
+        ASSERT(cu_k[0] == 0 && static_cast<size_t>(cu_k[nseq]) == k->shape()[0],
+               "SelfAttentionVarlen: cu_seqlens_k must start at 0 and end at total_kv.");
+        std::vector<size_t> cu_seqlens(cu_q, cu_q + nseq + 1);
+        std::vector<cpu::AttentionKV> kv;
+        for (size_t s = 0; s < nseq; s++) {
+            ASSERT(cu_k[s] <= cu_k[s + 1], "SelfAttentionVarlen: cu_seqlens must be non-decreasing.");
+            const size_t len = static_cast<size_t>(cu_k[s + 1] - cu_k[s]);
+            kv.push_back({k->data() + cu_k[s] * k->strides()[0] * k->elementSize(),
+                          v->data() + cu_k[s] * v->strides()[0] * v->elementSize(), len, len, nullptr, nullptr, false,
+                          row_head(k), row_head(v)});
+        }
+        const cpu::AttentionMask mask{};
+        check_varlen(attn_val, q, nkvhead, d, dv, cu_seqlens, kv, mask);
+        AttentionCost cost;
+        if (llaisys::profiler::enabled()) {
+            for (size_t s = 0; s < nseq; s++) {
+                add_sequence_cost(cost, cu_seqlens[s + 1] - cu_seqlens[s], kv[s].len, 0, q->shape()[1], nkvhead, d,
+                                  dv, q->elementSize());
+            }
+        }
+        LLAISYS_PROFILE_OP("self_attention_varlen", q->dtype(), cost.flops, cost.bytes, &q->shape(), &k->shape());
+        return cpu::self_attention_varlen(attn_val->data(), q->data(), nullptr, kv.data(), cu_seqlens.data(),
+                                          attn_val->dtype(), nseq, mask, q->shape()[1], nkvhead, d, dv, scale,
+                                          row_head(attn_val), row_head(q));
+    }
+
+    llaisys::core::context().setDevice(attn_val->deviceType(), attn_val->deviceId());
+    switch (attn_val->deviceType()) {
+#ifdef ENABLE_NVIDIA_API
+        case LLAISYS_DEVICE_NVIDIA:
+            TO_BE_IMPLEMENTED();
+            return;
+#endif
+        default:
+            EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+
+void self_attention_varlen(tensor_t attn_val, tensor_t q, const std::vector<SequenceKV> &seqs,
+                           const std::vector<size_t> &cu_seqlens_q, float scale, const AttentionMask &mask,
+                           tensor_t q_sink) {
+    pointwise::sync();
+    ASSERT(!seqs.empty(), "SelfAttentionVarlen: need at least one sequence.");
+    const size_t nkvhead = seqs[0].k->shape()[1], d = seqs[0].k->shape()[2], dv = seqs[0].v->shape()[2];
+    std::vector<cpu::AttentionKV> kv;
+    for (auto &seq : seqs) {
+        const auto &k = seq.k, &v = seq.v;
+        CHECK_SAME_DEVICE(attn_val, q, k, v);
+        CHECK_SAME_DTYPE(attn_val->dtype(), q->dtype(), k->dtype(), v->dtype());
+        ASSERT(k->ndim() == 3 && v->ndim() == 3 && k->shape()[0] == v->shape()[0]
+                   && k->shape()[1] == nkvhead && k->shape()[2] == d
+                   && v->shape()[1] == nkvhead && v->shape()[2] == dv,
+               "SelfAttentionVarlen: K and V shape mismatch.");
+        ASSERT(unit_last_dim(k) && unit_last_dim(v), "SelfAttentionVarlen: K and V must have a contiguous head_dim.");
+        const float *page_min = nullptr, *page_max = nullptr;
+        if (seq.sparse) {
+            ASSERT(seq.page_min && seq.page_max && seq.page_min->dtype() == LLAISYS_DTYPE_F32
+                       && seq.page_min->shape() == seq.page_max->shape()
+                       && seq.page_min->shape()[0] * mask.page >= seq.len
+                       && seq.page_min->shape()[1] == nkvhead && seq.page_min->shape()[2] == d
+                       && seq.page_min->isContiguous() && seq.page_max->isContiguous(),
+                   "SelfAttentionVarlen: page summaries must be contiguous float32 [npages, nkvhead, d].");
+            page_min = reinterpret_cast<const float *>(seq.page_min->data());
+            page_max = reinterpret_cast<const float *>(seq.page_max->data());
+        }
+        kv.push_back({k->data(), v->data(), seq.len, k->shape()[0], page_min, page_max, seq.sparse, row_head(k),
+                      row_head(v)});
+    }
+    const cpu::AttentionMask cpu_mask{mask.sink, mask.window, mask.page, mask.top_pages, mask.recent};
+    check_varlen(attn_val, q, nkvhead, d, dv, cu_seqlens_q, kv, cpu_mask);
+    if (q_sink) {
+        CHECK_SAME_DEVICE(q, q_sink);
+        CHECK_SAME_DTYPE(q->dtype(), q_sink->dtype());
+        ASSERT(q_sink->shape() == q->shape() && q_sink->strides() == q->strides(),
+               "SelfAttentionVarlen: q_sink must be like q.");
+    }
+    AttentionCost cost;
+    if (llaisys::profiler::enabled()) {
+        for (size_t s = 0; s < kv.size(); s++) {
+            // 流式模式每个 query 最多看 sink + window 个 key，稀疏 decode 最多看 top_pages 页加 recent 个位置
+            size_t budget = cpu_mask.window ? cpu_mask.sink + cpu_mask.window : 0;
+            if (kv[s].sparse) {
+                budget = cpu_mask.top_pages * cpu_mask.page + cpu_mask.recent;
+            }
+            add_sequence_cost(cost, cu_seqlens_q[s + 1] - cu_seqlens_q[s], kv[s].len, budget, q->shape()[1],
+                              nkvhead, d, dv, q->elementSize());
+        }
+    }
+    LLAISYS_PROFILE_OP("self_attention_varlen", q->dtype(), cost.flops, cost.bytes, &q->shape(), &attn_val->shape());
+
+    if (attn_val->deviceType() == LLAISYS_DEVICE_CPU) {
+        return cpu::self_attention_varlen(attn_val->data(), q->data(), q_sink ? q_sink->data() : nullptr, kv.data(),
+                                          cu_seqlens_q.data(), attn_val->dtype(), kv.size(), cpu_mask,
+                                          q->shape()[1], nkvhead, d, dv, scale, row_head(attn_val), row_head(q));
+    }
+
+    llaisys::core::context().setDevice(attn_val->deviceType(), attn_val->deviceId());
+    switch (attn_val->deviceType()) {
 #ifdef ENABLE_NVIDIA_API
         case LLAISYS_DEVICE_NVIDIA:
             TO_BE_IMPLEMENTED();
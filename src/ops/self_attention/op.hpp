@@ -2,6 +2,39 @@
 
 #include "../../tensor/tensor.hpp"
 
+#include <vector>
+
 namespace llaisys::ops {
 void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale);
+
+// 多条序列打包的 attention：q / attn_val 为 [ntoken, nhead, d]，k / v 为 [total_kv, nkvhead, d]，
+// cu_seqlens_q / cu_seqlens_k 为 [nseq + 1] 的 int64 累积偏移。每条序列只看自己的 K/V，并各自做因果 mask
+void self_attention_varlen(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v,
+                           tensor_t cu_seqlens_q, tensor_t cu_seqlens_k, float scale);
+// 一条序列的 K/V（例如它的 KV Cache）：k / v 为 [rows, nkvhead, d]，共 len 个位置。
+// len 超过 rows 时为 ring buffer：位置 a >= sink 存在第 sink + (a - sink) % (rows - sink) 行。
+// page_min / page_max 为 kv_page_summary 维护的每页 key 摘要，sparse 为 true 时这条序列使用稀疏 attention
+struct SequenceKV {
+    tensor_t k;
+    tensor_t v;
+    size_t len;
+    tensor_t page_min = nullptr;
+    tensor_t page_max = nullptr;
+    bool sparse = false;
+};
+// 每个 query 能看到的位置，全为 0 时为普通的因果 attention。
+// StreamingLLM：window > 0 时只看前 sink 个位置和最近 window 个位置。
+// Quest：page > 0 时稀疏序列只看与 query 的点积上界最高的 top_pages 页和最近 recent 个位置
+struct AttentionMask {
+    size_t sink = 0;
+    size_t window = 0;
+    size_t page = 0;
+    size_t top_pages = 0;
+    size_t recent = 0;
+};
+// 同上，但每条序列的 K/V 是独立的张量，cu_seqlens_q 在 host 上。
+// q_sink 非空时，query 与 sink 位置的点积改用 q_sink（按 cache 内位置做 RoPE 的 query）
+void self_attention_varlen(tensor_t attn_val, tensor_t q, const std::vector<SequenceKV> &kv,
+                           const std::vector<size_t> &cu_seqlens_q, float scale, const AttentionMask &mask = {},
+                           tensor_t q_sink = nullptr);
 }
@@ -4,44 +4,58 @@
 #include <algorithm>
 
 namespace llaisys::ops::cpu {
-template <typename T>
-void swiglu_(T *out , const T* gate ,const T* up , size_t slen ,size_t inter_size ){
+// 最内层一段：CONTIG 时三者步长都是 1，编译期确定
+template <bool CONTIG, typename T>
+void swiglu_(T *out, const T *gate, const T *up, size_t n, ptrdiff_t os, ptrdiff_t gs, ptrdiff_t us) {
     float temp_swiglu = 0.0;
-    for (size_t i = 0; i < slen; i++)
+    for (size_t i = 0; i < n; i++)
     {
-        for (size_t j = 0; j < inter_size ;j++)
-        {
-            size_t index =  i*inter_size+j;
-            float gatenorm = 1.0 /(1+std::exp(-1.0 *llaisys::utils::cast<float>(gate[index])));
-            temp_swiglu = llaisys::utils::cast<float>(up[index]) * llaisys::utils::cast<float>(gate[index]) * gatenorm;
-            out[index] = llaisys::utils::cast<T>(temp_swiglu);
-        }
-        
+        const ptrdiff_t j = static_cast<ptrdiff_t>(i);
+        const float g = llaisys::utils::cast<float>(gate[CONTIG ? j : j * gs]);
+        float gatenorm = 1.0 /(1+std::exp(-1.0 * g));
+        temp_swiglu = llaisys::utils::cast<float>(up[CONTIG ? j : j * us]) * g * gatenorm;
+        out[CONTIG ? j : j * os] = llaisys::utils::cast<T>(temp_swiglu);
     }
 }
 
-void swiglu(std::byte *out ,std::byte *gate , std::byte *up ,llaisysDataType_t type , size_t slen ,size_t inter_size){
+template <typename T>
+void swiglu_(T *out, const T *gate, const T *up, const llaisys::shape_t &shape,
+             const llaisys::strides_t &out_strides, const llaisys::strides_t &gate_strides,
+             const llaisys::strides_t &up_strides) {
+    const llaisys::utils::StridedLoop<3> loop(shape, {&out_strides, &gate_strides, &up_strides});
+    const size_t n = loop.inner();
+    const auto s = loop.innerStrides();
+    const bool contig = loop.innerContiguous();
+    loop.forEach(0, loop.outer(), [&](const std::array<ptrdiff_t, 3> &off) {
+        if (contig) {
+            swiglu_<true>(out + off[0], gate + off[1], up + off[2], n, 1, 1, 1);
+        } else {
+            swiglu_<false>(out + off[0], gate + off[1], up + off[2], n, s[0], s[1], s[2]);
+        }
+    });
+}
+
+void swiglu(std::byte *out, const std::byte *gate, const std::byte *up, llaisysDataType_t type,
+            const shape_t &shape, const strides_t &out_strides,
+            const strides_t &gate_strides, const strides_t &up_strides) {
 
 // 根据数据类型分发模板
     switch (type) {
         case LLAISYS_DTYPE_F32:
-            swiglu_<float>((float*)out, (const float*)gate, (const float*)up,  slen ,inter_size);
+            swiglu_<float>((float*)out, (const float*)gate, (const float*)up, shape, out_strides, gate_strides, up_strides);
             break;
         case LLAISYS_DTYPE_BF16:
-            swiglu_<llaisys::bf16_t>((llaisys::bf16_t*)out, (const llaisys::bf16_t*)gate, 
-                                            (const llaisys::bf16_t*)up,  slen ,inter_size);
+            swiglu_<llaisys::bf16_t>((llaisys::bf16_t*)out, (const llaisys::bf16_t*)gate,
+                                     (const llaisys::bf16_t*)up, shape, out_strides, gate_strides, up_strides);
             break;
         case LLAISYS_DTYPE_F16:
-            swiglu_<llaisys::fp16_t>((llaisys::fp16_t*)out, (const llaisys::fp16_t*)gate, 
-                                            (const llaisys::fp16_t*)up, slen ,inter_size);
+            swiglu_<llaisys::fp16_t>((llaisys::fp16_t*)out, (const llaisys::fp16_t*)gate,
+                                     (const llaisys::fp16_t*)up, shape, out_strides, gate_strides, up_strides);
             break;
         default:
             EXCEPTION_UNSUPPORTED_DATATYPE(type);
     }
-
-
-
 }
 
 
-}
\ No newline at end of file
+}
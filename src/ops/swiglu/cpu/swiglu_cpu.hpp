@@ -1,8 +1,12 @@
 #pragma once
 #include "llaisys.h"
+#include "../../../utils/small_vector.hpp"
 
 #include <cstddef>
 
 namespace llaisys::ops::cpu {
-void swiglu(std::byte *out ,std::byte *gate , std::byte *up ,llaisysDataType_t type, size_t slen ,size_t inter_size);
-}
\ No newline at end of file
+// 三个张量形状相同，步长（元素）任意
+void swiglu(std::byte *out, const std::byte *gate, const std::byte *up, llaisysDataType_t type,
+            const shape_t &shape, const strides_t &out_strides,
+            const strides_t &gate_strides, const strides_t &up_strides);
+}
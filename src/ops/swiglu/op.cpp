@@ -1,22 +1,27 @@
 #include "op.hpp"
 #include "cpu/swiglu_cpu.hpp"
+#include "../pointwise/op.hpp"
 namespace llaisys::ops {
-    //out、up和gate是具有相同形状 [seqlen, intermediate_size] 的2D连续张量。
+    //out、up和gate形状相同（通常为 [seqlen, intermediate_size]），步长任意，例如从合并的 gate_up 输出中切出的视图
 void swiglu(tensor_t out, tensor_t gate, tensor_t up) {
     CHECK_SAME_DEVICE(out , gate , up);
-    ASSERT(out->shape()[0] == up->shape()[0]&&out->shape()[0] == gate->shape()[0] ,"out in gate tensor must be the same shape dim0");
-    ASSERT(out->shape()[1] == up->shape()[1]&&out->shape()[1] == gate->shape()[1] ,"out in gate tensor must be the same shape dim1");
+    CHECK_SAME_SHAPE(out->shape(), gate->shape(), up->shape());
     CHECK_SAME_DTYPE(out->dtype(),gate->dtype(),up->dtype());
+    // 延迟模式下不立即计算
+    if (pointwise::defer(pointwise::SWIGLU, out, gate, up)) {
+        return;
+    }
     llaisysDataType_t type = out->dtype();
+    LLAISYS_PROFILE_OP("swiglu", type, 4 * out->numel(), 3 * out->numel() * out->elementSize(), &out->shape());
 
     if(out->deviceType() == LLAISYS_DEVICE_CPU){
-        return cpu::swiglu(out->data(),gate->data(),up->data(),type,gate->shape()[0],gate->shape()[1]);
+        return cpu::swiglu(out->data(),gate->data(),up->data(),type,out->shape(),out->strides(),gate->strides(),up->strides());
     }
 
     llaisys::core::context().setDevice(out->deviceType(),out->deviceId());
     switch (out->deviceType()) {
         case LLAISYS_DEVICE_CPU:
-            return cpu::swiglu(out->data(),gate->data(),up->data(),type,gate->shape()[0],gate->shape()[1]);
+            return cpu::swiglu(out->data(),gate->data(),up->data(),type,out->shape(),out->strides(),gate->strides(),up->strides());
 #ifdef ENABLE_NVIDIA_API
         case LLAISYS_DEVICE_NVIDIA:
             TO_BE_IMPLEMENTED();
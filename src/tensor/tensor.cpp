@@ -1,5 +1,6 @@
 #include "tensor.hpp"
 
+#include "../ops/rearrange/op.hpp"
 #include "../utils.hpp"
 
 #include <cstring>
@@ -8,15 +9,19 @@
 
 namespace llaisys {
 
-Tensor::Tensor(TensorMeta meta, core::storage_t storage, size_t offset)
+Tensor::Tensor(Token, TensorMeta meta, core::storage_t storage, size_t offset)
     : _meta(std::move(meta)), _storage(std::move(storage)), _offset(offset) {}
 
-tensor_t Tensor::create(const std::vector<size_t> &shape,
+tensor_t Tensor::make(TensorMeta meta, core::storage_t storage, size_t offset) {
+    return std::make_shared<Tensor>(Token{}, std::move(meta), std::move(storage), offset);
+}
+
+tensor_t Tensor::create(const shape_t &shape,
                         llaisysDataType_t dtype,
                         llaisysDeviceType_t device_type,
                         int device) {
     size_t ndim_ = shape.size();
-    std::vector<ptrdiff_t> strides(ndim_);
+    strides_t strides(ndim_);
     size_t stride = 1;
     for (size_t i = 1; i <= ndim_; i++) {  // 高纬度 ---> 低纬度
         strides[ndim_ - i] = stride;
@@ -28,11 +33,11 @@ tensor_t Tensor::create(const std::vector<size_t> &shape,
 
     if (device_type == LLAISYS_DEVICE_CPU && core::context().runtime().deviceType() != LLAISYS_DEVICE_CPU) {
         auto storage = core::context().runtime().allocateHostStorage(total_elems * dtype_size);
-        return std::shared_ptr<Tensor>(new Tensor(meta, storage));
+        return make(std::move(meta), std::move(storage));
     } else {
         core::context().setDevice(device_type, device);
         auto storage = core::context().runtime().allocateDeviceStorage(total_elems * dtype_size);
-        return std::shared_ptr<Tensor>(new Tensor(meta, storage));
+        return make(std::move(meta), std::move(storage));
     }
 }
 
@@ -48,11 +53,11 @@ size_t Tensor::ndim() const {
     return _meta.shape.size();
 }
 
-const std::vector<size_t> &Tensor::shape() const {
+const shape_t &Tensor::shape() const {
     return _meta.shape;
 }
 
-const std::vector<ptrdiff_t> &Tensor::strides() const {
+const strides_t &Tensor::strides() const {
     return _meta.strides;
 }
 
@@ -94,7 +99,7 @@ std::string Tensor::info() const {
 }
 
 template <typename T>
-void print_data(const T *data, const std::vector<size_t> &shape, const std::vector<ptrdiff_t> &strides, size_t dim) {
+void print_data(const T *data, const shape_t &shape, const strides_t &strides, size_t dim) {
     if (dim == shape.size() - 1) {
         for (size_t i = 0; i < shape[dim]; i++) {
             if constexpr (std::is_same_v<T, bf16_t> || std::is_same_v<T, fp16_t>) {
@@ -112,7 +117,7 @@ void print_data(const T *data, const std::vector<size_t> &shape, const std::vect
 }
 
 
-void debug_print(const std::byte *data, const std::vector<size_t> &shape, const std::vector<ptrdiff_t> &strides, llaisysDataType_t dtype) {
+void debug_print(const std::byte *data, const shape_t &shape, const strides_t &strides, llaisysDataType_t dtype) {
     switch (dtype) {
     case LLAISYS_DTYPE_BYTE:
         return print_data(reinterpret_cast<const char *>(data), shape, strides, 0);
@@ -185,38 +190,40 @@ bool Tensor::isContiguous() const {
         }
     }
     return true;}
+
+bool Tensor::uniqueStorage() const {
+    return _storage.use_count() == 1;
+}
+
 //创建一个新张量，改变原始张量维度的顺序。不涉及数据传输
 //例如，将形状为(2, 3, 4)的张量的维度顺序更改为(4, 2, 3)。
-tensor_t Tensor::permute(const std::vector<size_t> &order) const {
+tensor_t Tensor::permute(const shape_t &order) const {
     size_t ndim_ = this->ndim();
     
     // 1. 校验输入合法性
     CHECK_ARGUMENT(order.size() == ndim_, "Permute order size must match tensor ndim");
     
-    std::vector<bool> used(ndim_, false);
+    utils::SmallVector<char, INLINE_NDIM> used(ndim_, 0);
     for (auto d : order) {
         CHECK_ARGUMENT(d < ndim_, "Permute axis out of range");
         CHECK_ARGUMENT(!used[d], "Permute order must not contain duplicate axes");
-        used[d] = true;
+        used[d] = 1;
     }
 
     // 2. 构造新的元数据
-    std::vector<size_t> new_shape(ndim_);
-    std::vector<ptrdiff_t> new_strides(ndim_);
+    TensorMeta new_meta{this->dtype(), shape_t(ndim_), strides_t(ndim_)};
 
     for (size_t i = 0; i < ndim_; i++) {
         // 将旧的维度信息映射到新位置
-        new_shape[i] = _meta.shape[order[i]];
-        new_strides[i] = _meta.strides[order[i]];
+        new_meta.shape[i] = _meta.shape[order[i]];
+        new_meta.strides[i] = _meta.strides[order[i]];
     }
 
-    TensorMeta new_meta{this->dtype(), new_shape, new_strides};
-
-    return std::shared_ptr<Tensor>(new Tensor(new_meta, this->_storage,this->_offset));
+    return make(std::move(new_meta), this->_storage, this->_offset);
 }
 //创建一个新张量，通过拆分或合并原始维度将原始张量重塑为给定形状。不涉及数据传输
 //例如，通过合并最后两个维度，将形状为(2, 3, 5)的张量更改为(2, 15)。
-tensor_t Tensor::view(const std::vector<size_t> &new_shape) const {
+tensor_t Tensor::view(const shape_t &new_shape) const {
     // 1. 校验元素总数是否匹配
     size_t new_numel = 1;
     for (auto s : new_shape) new_numel *= s;
@@ -226,7 +233,7 @@ tensor_t Tensor::view(const std::vector<size_t> &new_shape) const {
     ASSERT(this->isContiguous(), "View only supports contiguous tensors");
 
     // 3. 计算新步长 (Row-major)
-    std::vector<ptrdiff_t> new_strides(new_shape.size());
+    strides_t new_strides(new_shape.size());
     size_t st = 1;
     size_t n_dim = new_shape.size();
     for (size_t i = 1; i <= n_dim; i++) {  // 高纬度 ---> 低纬度
@@ -238,8 +245,8 @@ tensor_t Tensor::view(const std::vector<size_t> &new_shape) const {
     TensorMeta new_meta{this->dtype(), new_shape, new_strides};
 
     // 5. 创建新 Tensor 对象，共享 _storage，传递当前的 _offset
-    // 注意：这里调用的是私有构造函数
-    return std::shared_ptr<Tensor>(new Tensor(new_meta, this->_storage, this->_offset));
+    // 注意：这里调用的是私有的 make（对象与控制块一次分配）
+    return make(std::move(new_meta), this->_storage, this->_offset);
 }
 //创建一个新张量，沿给定维度，start（包含）和end（不包含）索引对原始张量进行切片操作。
 tensor_t Tensor::slice(size_t dim, size_t start, size_t end) const {
@@ -249,11 +256,10 @@ tensor_t Tensor::slice(size_t dim, size_t start, size_t end) const {
 
     //如果start不是0，说明有偏移
     size_t new_offset = _offset + start * _meta.strides[dim] * this->elementSize();
-    std::vector<size_t> new_shape = this->shape();
-    new_shape[dim] = end - start;
-    TensorMeta new_meta{this->dtype(), new_shape, this->strides()};
+    TensorMeta new_meta{this->dtype(), this->shape(), this->strides()};
+    new_meta.shape[dim] = end - start;
 
-    return std::shared_ptr<Tensor>(new Tensor(new_meta, this->_storage, new_offset));
+    return make(std::move(new_meta), this->_storage, new_offset);
 }
 //将主机（cpu）数据加载到张量（可以在设备上）
 void Tensor::load(const void *src_) {  //src_ 指向主机内存
@@ -266,19 +272,66 @@ void Tensor::load(const void *src_) {  //src_ 指向主机内存
         Kind);
 }
 
+//返回连续存储的张量：本身连续时与原张量共享存储，否则通过 rearrange 复制一份
 tensor_t Tensor::contiguous() const {
-    TO_BE_IMPLEMENTED();
-    return std::shared_ptr<Tensor>(new Tensor(_meta, _storage));
+    auto self = make(_meta, _storage, _offset);
+    if (this->isContiguous()) {
+        return self;
+    }
+    auto out = create(this->shape(), this->dtype(), this->deviceType(), this->deviceId());
+    ops::rearrange(out, self);
+    return out;
 }
 
-tensor_t Tensor::reshape(const std::vector<size_t> &shape) const {
-    TO_BE_IMPLEMENTED();
-    return std::shared_ptr<Tensor>(new Tensor(_meta, _storage));
+namespace {
+// 不复制数据时 shape -> new_shape 的步长（同 PyTorch 的 computeStride）：原张量中可以合并的相邻维度组成一块，
+// 新形状的维度必须恰好划分这些块。做不到时返回 false
+bool view_strides(const shape_t &shape, const strides_t &strides, const shape_t &new_shape, strides_t &new_strides) {
+    new_strides.assign(new_shape.size(), 1);
+    if (shape.empty()) {
+        return true; // 标量只能变成全 1 的形状
+    }
+    ptrdiff_t view_d = static_cast<ptrdiff_t>(new_shape.size()) - 1;
+    ptrdiff_t chunk_base_stride = strides.back();
+    size_t tensor_numel = 1, view_numel = 1;
+    for (ptrdiff_t d = static_cast<ptrdiff_t>(shape.size()) - 1; d >= 0; d--) {
+        tensor_numel *= shape[d];
+        if (d == 0 || (shape[d - 1] != 1 && strides[d - 1] != static_cast<ptrdiff_t>(tensor_numel) * chunk_base_stride)) {
+            while (view_d >= 0 && (view_numel < tensor_numel || new_shape[view_d] == 1)) {
+                new_strides[view_d] = static_cast<ptrdiff_t>(view_numel) * chunk_base_stride;
+                view_numel *= new_shape[view_d];
+                view_d--;
+            }
+            if (view_numel != tensor_numel) {
+                return false;
+            }
+            if (d > 0) {
+                chunk_base_stride = strides[d - 1];
+                tensor_numel = 1;
+                view_numel = 1;
+            }
+        }
+    }
+    return view_d == -1;
+}
+} // namespace
+
+//与 view 相同，但原张量的步长无法直接表示新形状时（例如 permute 之后合并维度）先复制成连续的
+tensor_t Tensor::reshape(const shape_t &shape) const {
+    size_t new_numel = 1;
+    for (auto s : shape) new_numel *= s;
+    CHECK_ARGUMENT(new_numel == this->numel(), "Total elements must remain the same in reshape");
+
+    strides_t new_strides;
+    if (new_numel > 0 && view_strides(this->shape(), this->strides(), shape, new_strides)) {
+        return make(TensorMeta{this->dtype(), shape, new_strides}, this->_storage, this->_offset);
+    }
+    return this->contiguous()->view(shape);
 }
 
 tensor_t Tensor::to(llaisysDeviceType_t device_type, int device) const {
     TO_BE_IMPLEMENTED();
-    return std::shared_ptr<Tensor>(new Tensor(_meta, _storage));
+    return make(_meta, _storage);
 }
 
 } // namespace llaisys
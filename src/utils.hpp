@@ -1,5 +1,9 @@
 #pragma once
+#include "utils/autotune.hpp"
 #include "utils/check.hpp"
+#include "utils/profiler.hpp"
+#include "utils/small_vector.hpp"
+#include "utils/strides.hpp"
 #include "utils/types.hpp"
 #ifdef _WIN32
     using stride_t = long long;
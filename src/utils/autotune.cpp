@@ -0,0 +1,267 @@
+#include "autotune.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace llaisys::autotune {
+namespace {
+const char *CACHE_HEADER = "# llaisys autotune cache v1: key<TAB>config<TAB>us";
+// 每个候选最多计时的次数；单次已经超过 MIN_TIME 时只测一次
+constexpr int MAX_REPS = 3;
+constexpr double MIN_TIME_US = 20000.0;
+
+struct Entry {
+    std::string config;
+    double us;
+};
+
+Mode initialMode() {
+    const char *env = std::getenv("LLAISYS_AUTOTUNE");
+    if (!env) {
+        return ON;
+    }
+    const std::string v(env);
+    if (v == "0" || v == "off") {
+        return OFF;
+    }
+    return v == "cached" ? CACHED : ON;
+}
+
+std::string defaultPath() {
+    if (const char *env = std::getenv("LLAISYS_TUNE_CACHE")) {
+        return env;
+    }
+    if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        return std::string(xdg) + "/llaisys/tune.cache";
+    }
+    if (const char *home = std::getenv("HOME"); home && *home) {
+        return std::string(home) + "/.cache/llaisys/tune.cache";
+    }
+    return "";
+}
+
+std::atomic<Mode> &modeRef() {
+    static std::atomic<Mode> mode{initialMode()};
+    return mode;
+}
+
+// 内存中的结果（key 含 CPU 型号），第一次使用时从缓存文件读入
+struct Cache {
+    std::mutex mutex;
+    bool loaded = false;
+    std::string path = defaultPath();
+    std::unordered_map<std::string, Entry> entries;
+    std::vector<std::string> order; // 插入顺序，entries() 按此输出
+    // 同一时间只有一个调优在计时，避免并发的调优互相干扰
+    std::mutex tuning;
+};
+
+Cache &cache() {
+    static Cache c;
+    return c;
+}
+
+void put(Cache &c, const std::string &key, Entry e) {
+    if (c.entries.find(key) == c.entries.end()) {
+        c.order.push_back(key);
+    }
+    c.entries[key] = std::move(e);
+}
+
+// 调用者持有 c.mutex。文件中同一个 key 出现多次时以最后一次为准
+void load(Cache &c) {
+    if (c.loaded) {
+        return;
+    }
+    c.loaded = true;
+    if (c.path.empty()) {
+        return;
+    }
+    std::ifstream in(c.path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        const auto t1 = line.find('\t');
+        const auto t2 = t1 == std::string::npos ? t1 : line.find('\t', t1 + 1);
+        if (t2 == std::string::npos) {
+            continue;
+        }
+        put(c, line.substr(0, t1), {line.substr(t1 + 1, t2 - t1 - 1), std::atof(line.c_str() + t2 + 1)});
+    }
+}
+
+// 追加一行；写不了（只读目录等）时只保留在内存中
+void append(const Cache &c, const std::string &key, const Entry &e) {
+    if (c.path.empty()) {
+        return;
+    }
+    std::error_code ec;
+    const auto dir = std::filesystem::path(c.path).parent_path();
+    if (!dir.empty()) {
+        std::filesystem::create_directories(dir, ec);
+    }
+    const bool fresh = !std::filesystem::exists(c.path, ec) || std::filesystem::file_size(c.path, ec) == 0;
+    std::ofstream out(c.path, std::ios::app);
+    if (!out) {
+        return;
+    }
+    if (fresh) {
+        out << CACHE_HEADER << "\n";
+    }
+    // 整行一次写入，多个进程同时追加时行不会交错
+    std::ostringstream line;
+    line << key << "\t" << e.config << "\t" << e.us << "\n";
+    out << line.str();
+}
+
+std::string fullKey(const std::string &key) {
+    return key + "|" + cpuModel();
+}
+
+size_t indexOf(const std::vector<std::string> &candidates, const std::string &config) {
+    return static_cast<size_t>(std::find(candidates.begin(), candidates.end(), config) - candidates.begin());
+}
+} // namespace
+
+Mode mode() {
+    return modeRef().load(std::memory_order_relaxed);
+}
+
+void setMode(Mode mode) {
+    modeRef().store(mode, std::memory_order_relaxed);
+}
+
+std::string cachePath() {
+    auto &c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    return c.path;
+}
+
+void setCachePath(const std::string &path) {
+    auto &c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    c.path = path;
+    c.entries.clear();
+    c.order.clear();
+    c.loaded = false;
+}
+
+void clear() {
+    auto &c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    c.entries.clear();
+    c.order.clear();
+    c.loaded = false;
+}
+
+const std::string &cpuModel() {
+    static const std::string model = [] {
+        std::string name;
+        std::ifstream in("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(in, line)) {
+            // x86 为 "model name"，部分 ARM 内核为 "Processor"
+            if (line.rfind("model name", 0) == 0 || line.rfind("Processor", 0) == 0) {
+                const auto colon = line.find(':');
+                if (colon != std::string::npos) {
+                    name = line.substr(colon + 1);
+                    break;
+                }
+            }
+        }
+        // 去掉首尾空白，中间的制表符和 '|' 换成空格，保证缓存文件的格式
+        std::replace_if(name.begin(), name.end(), [](char ch) { return ch == '\t' || ch == '|'; }, ' ');
+        const auto b = name.find_first_not_of(' ');
+        const auto e = name.find_last_not_of(' ');
+        return b == std::string::npos ? std::string("unknown") : name.substr(b, e - b + 1);
+    }();
+    return model;
+}
+
+size_t select(const std::string &key, const std::vector<std::string> &candidates, size_t fallback,
+              const std::function<void(size_t)> &run) {
+    const Mode m = mode();
+    if (m == OFF || candidates.size() <= 1) {
+        return fallback;
+    }
+    auto &c = cache();
+    const auto full = fullKey(key);
+    auto lookup = [&]() -> size_t {
+        std::lock_guard<std::mutex> lock(c.mutex);
+        load(c);
+        auto it = c.entries.find(full);
+        return it == c.entries.end() ? candidates.size() : indexOf(candidates, it->second.config);
+    };
+    size_t found = lookup();
+    if (found < candidates.size()) {
+        return found;
+    }
+    if (m != ON) {
+        return fallback;
+    }
+
+    std::lock_guard<std::mutex> tuning(c.tuning);
+    // 等锁期间可能已经由其他线程调好
+    if ((found = lookup()) < candidates.size()) {
+        return found;
+    }
+    using clock = std::chrono::steady_clock;
+    run(fallback); // 预热：线程池、缓存和页表
+    size_t best = fallback;
+    double best_us = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < candidates.size(); i++) {
+        double min_us = std::numeric_limits<double>::infinity(), total_us = 0;
+        for (int rep = 0; rep < MAX_REPS && total_us < MIN_TIME_US; rep++) {
+            const auto t0 = clock::now();
+            run(i);
+            const double us = std::chrono::duration<double, std::micro>(clock::now() - t0).count();
+            min_us = std::min(min_us, us);
+            total_us += us;
+        }
+        if (min_us < best_us) {
+            best = i;
+            best_us = min_us;
+        }
+    }
+
+    Entry e{candidates[best], best_us};
+    std::lock_guard<std::mutex> lock(c.mutex);
+    append(c, full, e);
+    put(c, full, std::move(e));
+    return best;
+}
+
+std::string entries() {
+    auto &c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    load(c);
+    const std::string suffix = "|" + cpuModel();
+    std::ostringstream out;
+    for (const auto &key : c.order) {
+        if (key.size() < suffix.size() || key.compare(key.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            continue;
+        }
+        const auto &e = c.entries.at(key);
+        out << key.substr(0, key.size() - suffix.size()) << "\t" << e.config << "\t" << e.us << "\n";
+    }
+    return out.str();
+}
+
+size_t bucket(size_t n) {
+    size_t b = 1;
+    while (b < n) {
+        b <<= 1;
+    }
+    return b;
+}
+} // namespace llaisys::autotune
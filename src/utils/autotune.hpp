@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 算子配置（分块大小、线程划分方式等）的自动调优。算子给出一个 key（形状、dtype、线程数）和若干候选配置，
+// 第一次遇到该 key（加上 CPU 型号）时逐个计时，选出最快的写入缓存文件；之后的调用和其他进程直接读缓存。
+// 候选配置只改变计算的划分，不改变每个输出的累加顺序，所以调优不影响数值结果
+namespace llaisys::autotune {
+enum Mode {
+    OFF,    // 总是使用默认配置
+    CACHED, // 只使用缓存中已有的结果，未命中时用默认配置
+    ON,     // 未命中时调优并写入缓存
+};
+
+// 默认由环境变量 LLAISYS_AUTOTUNE 决定（off / cached / on），未设置时为 ON
+Mode mode();
+void setMode(Mode mode);
+
+// 缓存文件默认为 $LLAISYS_TUNE_CACHE，其次 $XDG_CACHE_HOME/llaisys/tune.cache、~/.cache/llaisys/tune.cache；
+// 空字符串表示只保存在内存中。修改路径会丢弃内存中的结果，下次使用时从新文件读取
+std::string cachePath();
+void setCachePath(const std::string &path);
+// 丢弃内存中的结果（缓存文件不变），下次使用时重新读取
+void clear();
+
+// /proc/cpuinfo 中的型号名，缓存的 key 包含它，不同机器可以共用同一个缓存文件
+const std::string &cpuModel();
+
+// 在 candidates（配置名）中为 key 选择配置，返回下标。缓存中没有（或记录的配置已不在 candidates 中）时：
+// ON 模式下依次调用 run(i) 计时，取最快的写入缓存；其他模式返回 fallback。
+// run 会被调用多次，必须可以重复执行（例如只写输出缓冲）
+size_t select(const std::string &key, const std::vector<std::string> &candidates, size_t fallback,
+              const std::function<void(size_t)> &run);
+
+// 当前 CPU 型号下的所有结果，每行 "key<TAB>配置<TAB>微秒"
+std::string entries();
+
+// 把 n 向上取到 2 的幂，key 中的 token 数等按此分桶，避免每个长度都调优一次
+size_t bucket(size_t n);
+} // namespace llaisys::autotune
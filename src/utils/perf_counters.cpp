@@ -0,0 +1,362 @@
+#include "perf_counters.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace llaisys::profiler::counters {
+namespace detail {
+std::atomic<bool> enabled{false};
+} // namespace detail
+
+const char *name(Counter c) {
+    static const char *NAMES[NUM_COUNTERS] = {"cycles", "instructions", "llc_misses", "dtlb_misses",
+                                             "page_faults", "task_clock_ns", "mem_bytes"};
+    return c < NUM_COUNTERS ? NAMES[c] : "unknown";
+}
+
+#ifdef __linux__
+namespace {
+// 新线程（例如第一次并行区域才创建的 OpenMP 工作线程）最多延迟这么久被发现
+constexpr auto RESCAN_INTERVAL = std::chrono::milliseconds(100);
+
+struct EventSpec {
+    Counter counter;
+    uint32_t type;
+    uint64_t config;
+};
+
+// 组内第一个打开成功的事件是 leader。task clock 作为组员时读组不会刷新它的值，所以放在最前面
+const EventSpec THREAD_EVENTS[] = {
+    {TASK_CLOCK_NS, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {LLC_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {DTLB_MISSES, PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PAGE_FAULTS, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+constexpr size_t NUM_THREAD_EVENTS = sizeof(THREAD_EVENTS) / sizeof(THREAD_EVENTS[0]);
+
+int openEvent(perf_event_attr &attr, pid_t pid, int cpu, int group) {
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, pid, cpu, group, PERF_FLAG_FD_CLOEXEC));
+}
+
+// 一个线程上的一组计数器，PERF_FORMAT_GROUP 一次 read 取回整组
+struct ThreadGroup {
+    std::vector<int> fds; // fds[0] 为 leader
+    std::vector<Counter> order;
+
+    ~ThreadGroup() {
+        for (int fd : fds) {
+            close(fd);
+        }
+    }
+};
+
+struct Uncore {
+    int fd;
+    double bytes_per_count;
+};
+
+struct State {
+    std::mutex mutex;
+    std::map<pid_t, std::unique_ptr<ThreadGroup>> threads;
+    std::vector<Uncore> uncore;
+    bool tried = false;
+    bool available[NUM_COUNTERS] = {};
+    std::string errors[NUM_COUNTERS];
+    std::chrono::steady_clock::time_point last_scan;
+};
+
+State &state() {
+    static State s;
+    return s;
+}
+
+std::string readFile(const std::string &path) {
+    std::ifstream in(path);
+    std::string s;
+    std::getline(in, s);
+    return s;
+}
+
+std::string explain(int err) {
+    std::string msg = std::strerror(err);
+    if (err == ENOENT || err == EOPNOTSUPP) {
+        msg += " (not supported by this CPU / hypervisor)";
+    } else if (err == EACCES || err == EPERM) {
+        msg += " (perf_event_paranoid = " + readFile("/proc/sys/kernel/perf_event_paranoid") + ")";
+    }
+    return msg;
+}
+
+// first 为 true 时逐个尝试所有事件并记录哪些可用，之后的线程只打开可用的事件
+std::unique_ptr<ThreadGroup> openThread(State &s, pid_t tid, bool first) {
+    auto group = std::make_unique<ThreadGroup>();
+    for (const auto &spec : THREAD_EVENTS) {
+        if (!first && !s.available[spec.counter]) {
+            continue;
+        }
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = spec.type;
+        attr.config = spec.config;
+        attr.exclude_kernel = 1; // perf_event_paranoid = 2 时只允许统计用户态
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        const int fd = openEvent(attr, tid, -1, group->fds.empty() ? -1 : group->fds[0]);
+        if (fd < 0) {
+            if (first) {
+                s.errors[spec.counter] = explain(errno);
+            }
+            continue;
+        }
+        group->fds.push_back(fd);
+        group->order.push_back(spec.counter);
+        if (first) {
+            s.available[spec.counter] = true;
+        }
+    }
+    return group->fds.empty() ? nullptr : std::move(group);
+}
+
+std::vector<pid_t> listThreads() {
+    std::vector<pid_t> tids;
+    if (DIR *dir = opendir("/proc/self/task")) {
+        while (auto *entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') {
+                tids.push_back(static_cast<pid_t>(std::atoi(entry->d_name)));
+            }
+        }
+        closedir(dir);
+    }
+    return tids;
+}
+
+// 已经退出的线程保留其计数器（读数不再变化），否则总和会变小
+void scanThreads(State &s) {
+    for (pid_t tid : listThreads()) {
+        if (s.threads.count(tid) == 0) {
+            if (auto group = openThread(s, tid, false)) {
+                s.threads.emplace(tid, std::move(group));
+            }
+        }
+    }
+    s.last_scan = std::chrono::steady_clock::now();
+}
+
+// "event=0x04,umask=0x03" -> config
+bool parseConfig(const std::string &spec, uint64_t &config) {
+    config = 0;
+    if (spec.empty()) {
+        return false;
+    }
+    std::stringstream ss(spec);
+    std::string term;
+    while (std::getline(ss, term, ',')) {
+        const auto eq = term.find('=');
+        if (eq == std::string::npos) {
+            return false;
+        }
+        const auto key = term.substr(0, eq);
+        const uint64_t value = std::strtoull(term.c_str() + eq + 1, nullptr, 0);
+        if (key == "event") {
+            config |= value & 0xff;
+        } else if (key == "umask") {
+            config |= (value & 0xff) << 8;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<int> parseCpus(const std::string &mask) {
+    std::vector<int> cpus;
+    std::stringstream ss(mask);
+    std::string term;
+    while (std::getline(ss, term, ',')) {
+        const auto dash = term.find('-');
+        const int lo = std::atoi(term.c_str());
+        const int hi = dash == std::string::npos ? lo : std::atoi(term.c_str() + dash + 1);
+        for (int c = lo; c <= hi; c++) {
+            cpus.push_back(c);
+        }
+    }
+    return cpus;
+}
+
+// Intel 的 uncore_imc_* PMU：每个内存控制器的 CAS 读写次数，需要 perf_event_paranoid <= 0 或 CAP_PERFMON
+void openUncore(State &s) {
+    const std::string root = "/sys/bus/event_source/devices/";
+    DIR *dir = opendir(root.c_str());
+    if (!dir) {
+        s.errors[MEM_BYTES] = "no " + root;
+        return;
+    }
+    int last_errno = 0;
+    bool found = false;
+    while (auto *entry = readdir(dir)) {
+        const std::string pmu = entry->d_name;
+        if (pmu.rfind("uncore_imc", 0) != 0) {
+            continue;
+        }
+        found = true;
+        const uint32_t type = static_cast<uint32_t>(std::strtoul(readFile(root + pmu + "/type").c_str(), nullptr, 0));
+        for (const char *event : {"cas_count_read", "cas_count_write"}) {
+            const std::string base = root + pmu + "/events/" + event;
+            uint64_t config;
+            if (!parseConfig(readFile(base), config)) {
+                continue;
+            }
+            const auto scale_text = readFile(base + ".scale");
+            const double scale = scale_text.empty() ? 64.0 : std::strtod(scale_text.c_str(), nullptr);
+            const double unit = readFile(base + ".unit") == "MiB" ? 1048576.0 : 1.0;
+            for (int cpu : parseCpus(readFile(root + pmu + "/cpumask"))) {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = type;
+                attr.config = config;
+                const int fd = openEvent(attr, -1, cpu, -1);
+                if (fd < 0) {
+                    last_errno = errno;
+                    continue;
+                }
+                s.uncore.push_back({fd, scale_text.empty() ? scale : scale * unit});
+            }
+        }
+    }
+    closedir(dir);
+    s.available[MEM_BYTES] = !s.uncore.empty();
+    if (s.uncore.empty()) {
+        s.errors[MEM_BYTES] = found ? explain(last_errno) : "no uncore_imc PMU";
+    }
+}
+
+void closeAll(State &s) {
+    s.threads.clear();
+    for (auto &u : s.uncore) {
+        close(u.fd);
+    }
+    s.uncore.clear();
+}
+} // namespace
+
+bool setEnabled(bool enabled) {
+    auto &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    detail::enabled.store(false, std::memory_order_relaxed);
+    closeAll(s);
+    if (!enabled) {
+        return false;
+    }
+    s.tried = true;
+    for (size_t c = 0; c < NUM_COUNTERS; c++) {
+        s.available[c] = false;
+        s.errors[c].clear();
+    }
+    // 先在当前线程上确定哪些事件可用，再给进程内其余线程打开同样的事件
+    const auto self = static_cast<pid_t>(syscall(SYS_gettid));
+    if (auto group = openThread(s, self, true)) {
+        s.threads.emplace(self, std::move(group));
+        scanThreads(s);
+    }
+    openUncore(s);
+    bool any = false;
+    for (bool a : s.available) {
+        any = any || a;
+    }
+    detail::enabled.store(any, std::memory_order_relaxed);
+    return any;
+}
+
+bool available(Counter c) {
+    auto &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return c < NUM_COUNTERS && s.available[c];
+}
+
+std::string status() {
+    auto &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (!s.tried) {
+        return "counters not enabled\n";
+    }
+    std::ostringstream os;
+    for (size_t c = 0; c < NUM_COUNTERS; c++) {
+        os << name(static_cast<Counter>(c)) << ": " << (s.available[c] ? "ok" : "unavailable, " + s.errors[c])
+           << "\n";
+    }
+    if (enabled()) {
+        os << "threads: " << s.threads.size() << ", uncore events: " << s.uncore.size() << "\n";
+    }
+    return os.str();
+}
+
+void read(uint64_t values[NUM_COUNTERS]) {
+    std::fill(values, values + NUM_COUNTERS, 0);
+    if (!enabled()) {
+        return;
+    }
+    auto &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (std::chrono::steady_clock::now() - s.last_scan > RESCAN_INTERVAL) {
+        scanThreads(s);
+    }
+    // nr, time_enabled, time_running, values[nr]
+    uint64_t buf[3 + NUM_THREAD_EVENTS];
+    for (auto &[tid, group] : s.threads) {
+        const auto n = ::read(group->fds[0], buf, sizeof(buf));
+        if (n < static_cast<ssize_t>(3 * sizeof(uint64_t))) {
+            continue;
+        }
+        // 计数器被分时复用时按实际运行时间的比例放大
+        const double scale = buf[2] > 0 && buf[2] < buf[1] ? static_cast<double>(buf[1]) / buf[2] : 1.0;
+        for (size_t i = 0; i < buf[0] && i < group->order.size(); i++) {
+            values[group->order[i]] += static_cast<uint64_t>(buf[3 + i] * scale);
+        }
+    }
+    for (auto &u : s.uncore) {
+        uint64_t count;
+        if (::read(u.fd, &count, sizeof(count)) == sizeof(count)) {
+            values[MEM_BYTES] += static_cast<uint64_t>(count * u.bytes_per_count);
+        }
+    }
+}
+#else
+bool setEnabled(bool) {
+    return false;
+}
+
+bool available(Counter) {
+    return false;
+}
+
+std::string status() {
+    return "perf events are only supported on Linux\n";
+}
+
+void read(uint64_t values[NUM_COUNTERS]) {
+    std::memset(values, 0, sizeof(uint64_t) * NUM_COUNTERS);
+}
+#endif
+} // namespace llaisys::profiler::counters
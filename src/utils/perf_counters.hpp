@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// 基于 perf_event_open 的硬件计数器，供 profiler 在每次算子调用前后读取。
+// 进程内每个线程（包括 OpenMP 的工作线程）各开一组计数器，读数为所有线程之和，
+// 所以多个线程同时执行算子时各自的读数会互相混入；内存带宽来自 uncore IMC，是整个 socket 的流量。
+// 内核不允许（perf_event_paranoid、容器、虚拟机没有 PMU）或不是 Linux 时，打不开的计数器记为不可用
+namespace llaisys::profiler::counters {
+enum Counter {
+    CYCLES,
+    INSTRUCTIONS,
+    LLC_MISSES,
+    DTLB_MISSES,
+    PAGE_FAULTS,
+    TASK_CLOCK_NS, // 线程实际在 CPU 上运行的时间，cycles / task_clock 即有效频率
+    MEM_BYTES,     // uncore IMC 的 CAS 读写次数换算成字节
+    NUM_COUNTERS
+};
+
+const char *name(Counter c);
+
+namespace detail {
+extern std::atomic<bool> enabled;
+} // namespace detail
+
+inline bool enabled() {
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+// 打开或关闭计数器，返回是否至少有一个计数器可用
+bool setEnabled(bool enabled);
+// 最近一次开启时是否可用（关闭后保持不变，已有的记录照常导出）
+bool available(Counter c);
+// 每个计数器是否可用，不可用时的原因
+std::string status();
+// 当前所有线程的累计值之和，不可用的计数器为 0
+void read(uint64_t values[NUM_COUNTERS]);
+} // namespace llaisys::profiler::counters
@@ -0,0 +1,298 @@
+#include "profiler.hpp"
+#include "types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <tuple>
+
+namespace llaisys::profiler {
+namespace {
+// 单个线程的环形缓冲：只有所属线程写入，head 用 release 发布，导出时 acquire 读取。
+// 写入第 i 条记录之前先把 claimed 设为 i + 1（类似 seqlock），导出时据此丢弃复制期间可能被覆盖的槽
+struct Ring {
+    uint64_t tid;
+    std::atomic<uint64_t> claimed{0};
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0}; // clear() 时移到 head，之前的记录不再导出
+    std::array<Record, RING_CAPACITY> records;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+    uint64_t next_tid = 0;
+};
+
+Registry &registry() {
+    static Registry reg;
+    return reg;
+}
+
+// 线程第一次记录时注册自己的 ring（只加一次锁）
+Ring &threadRing() {
+    thread_local std::shared_ptr<Ring> ring = [] {
+        auto r = std::make_shared<Ring>();
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        r->tid = reg.next_tid++;
+        reg.rings.push_back(r);
+        return r;
+    }();
+    return *ring;
+}
+
+const auto EPOCH = std::chrono::steady_clock::now();
+
+struct Snapshot {
+    uint64_t tid;
+    Record record;
+};
+
+// 复制所有 ring 中已发布且未被覆盖的记录，按开始时间排序
+std::vector<Snapshot> collect() {
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        rings = reg.rings;
+    }
+    std::vector<Snapshot> out;
+    for (auto &ring : rings) {
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t begin = ring->tail.load(std::memory_order_relaxed);
+        if (head - begin > RING_CAPACITY) {
+            begin = head - RING_CAPACITY;
+        }
+        const size_t first = out.size();
+        for (uint64_t i = begin; i < head; i++) {
+            out.push_back({ring->tid, ring->records[i % RING_CAPACITY]});
+        }
+        // 复制之后再读 claimed：写第 j 条时覆盖第 j - RING_CAPACITY 条，
+        // 所以 i + RING_CAPACITY < claimed 的记录可能已经被（部分）覆盖，丢弃
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t claimed = ring->claimed.load(std::memory_order_relaxed);
+        const uint64_t valid = std::max(begin, claimed > RING_CAPACITY ? claimed - RING_CAPACITY : 0);
+        out.erase(out.begin() + static_cast<ptrdiff_t>(first),
+                  out.begin() + static_cast<ptrdiff_t>(first + (std::min(valid, head) - begin)));
+    }
+    std::stable_sort(out.begin(), out.end(),
+                     [](const Snapshot &a, const Snapshot &b) { return a.record.start_ns < b.record.start_ns; });
+    return out;
+}
+
+void availableCounters(bool available[counters::NUM_COUNTERS]) {
+    for (size_t c = 0; c < counters::NUM_COUNTERS; c++) {
+        available[c] = counters::available(static_cast<counters::Counter>(c));
+    }
+}
+
+// 算子名和形状只含字母数字和 "[],_ "，不需要转义
+void appendEvent(std::ostringstream &os, const Snapshot &s, const bool available[counters::NUM_COUNTERS]) {
+    const Record &r = s.record;
+    char buf[512];
+    std::snprintf(buf, sizeof(buf),
+                  "{\"name\":\"%s\",\"cat\":\"op\",\"ph\":\"X\",\"pid\":0,\"tid\":%llu,\"ts\":%.3f,\"dur\":%.3f,"
+                  "\"args\":{\"shapes\":\"%s\",\"dtype\":\"%s\",\"flops\":%llu,\"bytes\":%llu",
+                  r.op, static_cast<unsigned long long>(s.tid), r.start_ns / 1e3, (r.end_ns - r.start_ns) / 1e3,
+                  r.shapes, r.dtype == LLAISYS_DTYPE_INVALID ? "" : utils::dtype_to_str(r.dtype),
+                  static_cast<unsigned long long>(r.flops), static_cast<unsigned long long>(r.bytes));
+    os << buf;
+    for (size_t c = 0; r.has_counters && c < counters::NUM_COUNTERS; c++) {
+        if (available[c]) {
+            os << ",\"" << counters::name(static_cast<counters::Counter>(c)) << "\":" << r.counters[c];
+        }
+    }
+    os << "}}";
+}
+
+std::mutex roofline_mutex;
+double roofline_gflops = 0;
+double roofline_gbps = 0;
+} // namespace
+
+namespace detail {
+std::atomic<bool> enabled{false};
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - EPOCH).count());
+}
+
+void push(const Record &record) {
+    Ring &ring = threadRing();
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    ring.claimed.store(head + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ring.records[head % RING_CAPACITY] = record;
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void finishCounters(Record &record) {
+    uint64_t end[counters::NUM_COUNTERS];
+    counters::read(end);
+    for (size_t c = 0; c < counters::NUM_COUNTERS; c++) {
+        // 中途关闭计数器时结束值为 0
+        record.counters[c] = end[c] >= record.counters[c] ? end[c] - record.counters[c] : 0;
+    }
+}
+} // namespace detail
+
+void setEnabled(bool enabled) {
+    detail::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void setRoofline(double peak_gflops, double peak_gbps) {
+    std::lock_guard<std::mutex> lock(roofline_mutex);
+    roofline_gflops = peak_gflops;
+    roofline_gbps = peak_gbps;
+}
+
+void clear() {
+    auto &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (auto &ring : reg.rings) {
+        ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+void OpScope::set(llaisysDataType_t dtype, uint64_t flops, uint64_t bytes,
+                  std::initializer_list<const shape_t *> shapes) {
+    _record.dtype = dtype;
+    _record.flops = flops;
+    _record.bytes = bytes;
+    size_t pos = 0;
+    auto put = [&](const char *s) {
+        while (*s && pos + 1 < SHAPES_CHARS) {
+            _record.shapes[pos++] = *s++;
+        }
+    };
+    char num[24];
+    for (auto *shape : shapes) {
+        if (pos > 0) {
+            put(" ");
+        }
+        put("[");
+        for (size_t i = 0; i < shape->size(); i++) {
+            std::snprintf(num, sizeof(num), i ? ",%zu" : "%zu", (*shape)[i]);
+            put(num);
+        }
+        put("]");
+    }
+    _record.shapes[pos] = '\0';
+}
+
+std::string chromeTrace() {
+    std::ostringstream os;
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool available[counters::NUM_COUNTERS];
+    availableCounters(available);
+    bool first = true;
+    for (auto &s : collect()) {
+        if (!first) {
+            os << ",\n";
+        }
+        first = false;
+        appendEvent(os, s, available);
+    }
+    os << "]}\n";
+    return os.str();
+}
+
+std::string summary() {
+    struct Stat {
+        uint64_t calls = 0, ns = 0, flops = 0, bytes = 0;
+    };
+    std::map<std::string, Stat> stats;
+    uint64_t total_ns = 0;
+    for (auto &s : collect()) {
+        auto &st = stats[s.record.op];
+        const uint64_t ns = s.record.end_ns - s.record.start_ns;
+        st.calls++;
+        st.ns += ns;
+        st.flops += s.record.flops;
+        st.bytes += s.record.bytes;
+        total_ns += ns;
+    }
+    std::vector<std::pair<std::string, Stat>> rows(stats.begin(), stats.end());
+    std::stable_sort(rows.begin(), rows.end(), [](const auto &a, const auto &b) { return a.second.ns > b.second.ns; });
+
+    double peak_gflops, peak_gbps;
+    {
+        std::lock_guard<std::mutex> lock(roofline_mutex);
+        peak_gflops = roofline_gflops;
+        peak_gbps = roofline_gbps;
+    }
+    const bool roofline = peak_gflops > 0 && peak_gbps > 0;
+
+    std::ostringstream os;
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "%-24s %8s %12s %12s %7s %10s %10s", "op", "calls", "total(ms)", "avg(us)", "%",
+                  "GFLOP/s", "GB/s");
+    os << buf << (roofline ? "   flop/B   %roof\n" : "\n");
+    for (auto &[op, st] : rows) {
+        const double sec = st.ns / 1e9;
+        const double gflops = sec > 0 ? st.flops / sec / 1e9 : 0.0, gbps = sec > 0 ? st.bytes / sec / 1e9 : 0.0;
+        std::snprintf(buf, sizeof(buf), "%-24s %8llu %12.3f %12.3f %7.2f %10.2f %10.2f", op.c_str(),
+                      static_cast<unsigned long long>(st.calls), st.ns / 1e6, st.ns / 1e3 / st.calls,
+                      total_ns ? 100.0 * st.ns / total_ns : 0.0, gflops, gbps);
+        os << buf;
+        if (roofline) {
+            // 没有计算量的算子（embedding 等）只按带宽算
+            const double intensity = st.bytes ? static_cast<double>(st.flops) / st.bytes : 0.0;
+            const double pct = st.flops ? 100.0 * gflops / std::min(peak_gflops, intensity * peak_gbps)
+                                        : 100.0 * gbps / peak_gbps;
+            std::snprintf(buf, sizeof(buf), " %8.2f %7.1f", intensity, pct);
+            os << buf;
+        }
+        os << "\n";
+    }
+    return os.str();
+}
+
+std::string countersJson() {
+    struct Stat {
+        uint64_t calls = 0, ns = 0;
+        uint64_t counters[counters::NUM_COUNTERS] = {};
+    };
+    std::map<std::tuple<std::string, std::string, int>, Stat> stats;
+    for (auto &s : collect()) {
+        if (!s.record.has_counters) {
+            continue;
+        }
+        auto &st = stats[{s.record.op, s.record.shapes, static_cast<int>(s.record.dtype)}];
+        st.calls++;
+        st.ns += s.record.end_ns - s.record.start_ns;
+        for (size_t c = 0; c < counters::NUM_COUNTERS; c++) {
+            st.counters[c] += s.record.counters[c];
+        }
+    }
+    std::vector<std::pair<std::tuple<std::string, std::string, int>, Stat>> rows(stats.begin(), stats.end());
+    std::stable_sort(rows.begin(), rows.end(), [](const auto &a, const auto &b) { return a.second.ns > b.second.ns; });
+
+    bool available[counters::NUM_COUNTERS];
+    availableCounters(available);
+    std::ostringstream os;
+    os << "[";
+    for (size_t i = 0; i < rows.size(); i++) {
+        const auto &[key, st] = rows[i];
+        const auto dtype = static_cast<llaisysDataType_t>(std::get<2>(key));
+        os << (i ? ",\n" : "") << "{\"op\":\"" << std::get<0>(key) << "\",\"shapes\":\"" << std::get<1>(key)
+           << "\",\"dtype\":\"" << (dtype == LLAISYS_DTYPE_INVALID ? "" : utils::dtype_to_str(dtype))
+           << "\",\"calls\":" << st.calls << ",\"total_ns\":" << st.ns;
+        for (size_t c = 0; c < counters::NUM_COUNTERS; c++) {
+            if (available[c]) {
+                os << ",\"" << counters::name(static_cast<counters::Counter>(c)) << "\":" << st.counters[c];
+            }
+        }
+        os << "}";
+    }
+    os << "]\n";
+    return os.str();
+}
+} // namespace llaisys::profiler
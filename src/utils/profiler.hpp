@@ -0,0 +1,105 @@
+#pragma once
+
+#include "llaisys.h"
+#include "perf_counters.hpp"
+#include "small_vector.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// 算子级 profiler：每次算子调用记录起止时间、线程、形状、dtype 以及 FLOPs / 访存字节数。
+// 记录写入每个线程自己的环形缓冲（只有所属线程写，导出时读已经发布的部分），满了覆盖最旧的记录。
+// 关闭时每次调用只多一次 relaxed 的原子读，FLOPs 等表达式不会被求值
+namespace llaisys::profiler {
+// 每个线程最多保留的记录数
+constexpr size_t RING_CAPACITY = 1 << 14;
+constexpr size_t SHAPES_CHARS = 112;
+
+struct Record {
+    const char *op; // 算子名，必须是静态字符串
+    uint64_t start_ns;
+    uint64_t end_ns;
+    uint64_t flops;
+    uint64_t bytes;
+    llaisysDataType_t dtype;
+    char shapes[SHAPES_CHARS];
+    bool has_counters; // 开启了硬件计数器时 counters 为本次调用期间的增量
+    uint64_t counters[counters::NUM_COUNTERS];
+};
+
+namespace detail {
+extern std::atomic<bool> enabled;
+uint64_t now_ns();
+void push(const Record &record);
+// 读取结束时的计数器，把 record.counters 从起始值换成增量
+void finishCounters(Record &record);
+} // namespace detail
+
+inline bool enabled() {
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+void setEnabled(bool enabled);
+// 丢弃目前所有线程的记录
+void clear();
+
+// 导出为 Chrome trace（chrome://tracing / Perfetto 可直接打开）
+std::string chromeTrace();
+// 按算子汇总：调用次数、总时间、平均时间、占比、GFLOP/s、GB/s，按总时间降序。
+// 设置了机器峰值时再加上算术强度（FLOPs / 字节）和达到 roofline 的百分比
+std::string summary();
+// 机器峰值（例如 llaisys-bench calibrate 的结果），均为 0 表示不计算 roofline
+void setRoofline(double peak_gflops, double peak_gbps);
+// 带硬件计数器的记录按 (算子, 形状, dtype) 汇总成 JSON 数组，按总时间降序；只包含可用的计数器
+std::string countersJson();
+
+// 作用域内的一次算子调用，开启时在析构时写入一条记录
+class OpScope {
+private:
+    Record _record;
+    bool _active;
+
+public:
+    explicit OpScope(const char *op) : _active(enabled()) {
+        if (_active) {
+            _record.op = op;
+            _record.flops = 0;
+            _record.bytes = 0;
+            _record.dtype = LLAISYS_DTYPE_INVALID;
+            _record.shapes[0] = '\0';
+            // 先读计数器再计时，读计数器的系统调用不算进算子的耗时
+            _record.has_counters = counters::enabled();
+            if (_record.has_counters) {
+                counters::read(_record.counters);
+            }
+            _record.start_ns = detail::now_ns();
+        }
+    }
+    ~OpScope() {
+        if (_active) {
+            _record.end_ns = detail::now_ns();
+            if (_record.has_counters) {
+                detail::finishCounters(_record);
+            }
+            detail::push(_record);
+        }
+    }
+    OpScope(const OpScope &) = delete;
+    OpScope &operator=(const OpScope &) = delete;
+
+    bool active() const { return _active; }
+    // shapes 格式化为 "[m,k] [n,k] ..."，超长时截断
+    void set(llaisysDataType_t dtype, uint64_t flops, uint64_t bytes,
+             std::initializer_list<const shape_t *> shapes);
+};
+} // namespace llaisys::profiler
+
+// 在算子入口（参数检查之后）使用：name 为算子名，后面的表达式只在 profiler 开启时求值。
+// shapes 为若干 const shape_t *，一般是各个张量的 &t->shape()
+#define LLAISYS_PROFILE_OP(name, dtype, flops, bytes, ...)                      \
+    ::llaisys::profiler::OpScope llaisys_profile_scope_(name);                 \
+    if (llaisys_profile_scope_.active()) {                                      \
+        llaisys_profile_scope_.set((dtype), (flops), (bytes), {__VA_ARGS__}); \
+    }
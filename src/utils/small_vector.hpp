@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace llaisys {
+namespace utils {
+// 元素不超过 N 个时存放在对象内部、不分配内存的 vector（张量的形状和步长用）；超过时退回 std::vector。
+// 只提供张量元数据用到的接口，可以与 std::vector 互相转换和比较
+template <typename T, size_t N>
+class SmallVector {
+private:
+    size_t _size = 0;
+    std::array<T, N> _inline{};
+    std::vector<T> _heap; // 只在 _size > N 时使用
+
+    bool inlined() const { return _size <= N; }
+
+public:
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    SmallVector() = default;
+    explicit SmallVector(size_t n, const T &value = T()) { assign(n, value); }
+    SmallVector(std::initializer_list<T> init) { assign(init.begin(), init.end()); }
+    template <typename It, typename = decltype(*std::declval<It>())>
+    SmallVector(It first, It last) { assign(first, last); }
+    // 允许从 std::vector 隐式构造，原来接受 std::vector 的调用不用修改
+    SmallVector(const std::vector<T> &v) { assign(v.begin(), v.end()); }
+
+    void assign(size_t n, const T &value) {
+        resize(0);
+        resize(n, value);
+    }
+
+    template <typename It>
+    void assign(It first, It last) {
+        const auto n = static_cast<size_t>(std::distance(first, last));
+        _size = n;
+        if (n <= N) {
+            _heap.clear();
+            std::copy(first, last, _inline.begin());
+        } else {
+            _heap.assign(first, last);
+        }
+    }
+
+    void resize(size_t n, const T &value = T()) {
+        if (n <= N) {
+            if (!inlined()) {
+                std::copy(_heap.begin(), _heap.begin() + n, _inline.begin());
+                _heap.clear();
+            } else if (n > _size) {
+                std::fill(_inline.begin() + _size, _inline.begin() + n, value);
+            }
+        } else {
+            if (inlined()) {
+                _heap.assign(_inline.begin(), _inline.begin() + _size);
+            }
+            _heap.resize(n, value);
+        }
+        _size = n;
+    }
+
+    void push_back(const T &value) {
+        resize(_size + 1, value);
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    T *data() { return inlined() ? _inline.data() : _heap.data(); }
+    const T *data() const { return inlined() ? _inline.data() : _heap.data(); }
+    T *begin() { return data(); }
+    T *end() { return data() + _size; }
+    const T *begin() const { return data(); }
+    const T *end() const { return data() + _size; }
+
+    T &operator[](size_t i) { return data()[i]; }
+    const T &operator[](size_t i) const { return data()[i]; }
+    T &front() { return data()[0]; }
+    const T &front() const { return data()[0]; }
+    T &back() { return data()[_size - 1]; }
+    const T &back() const { return data()[_size - 1]; }
+
+    operator std::vector<T>() const { return std::vector<T>(begin(), end()); }
+
+    friend bool operator==(const SmallVector &a, const SmallVector &b) {
+        return a._size == b._size && std::equal(a.begin(), a.end(), b.begin());
+    }
+    friend bool operator!=(const SmallVector &a, const SmallVector &b) { return !(a == b); }
+};
+} // namespace utils
+
+// 张量的形状和步长：不超过 INLINE_NDIM 维时内联存放，创建视图不需要为元数据分配内存
+constexpr size_t INLINE_NDIM = 6;
+using shape_t = utils::SmallVector<size_t, INLINE_NDIM>;
+using strides_t = utils::SmallVector<ptrdiff_t, INLINE_NDIM>;
+} // namespace llaisys
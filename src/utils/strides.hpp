@@ -0,0 +1,96 @@
+#pragma once
+
+#include "small_vector.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace llaisys::utils {
+// N 个形状相同、步长任意的张量按元素共同遍历（逐元素算子用）。去掉长度为 1 的维度，
+// 并合并所有张量都能合并的相邻维度：全部连续时只剩一维，最内层逐元素处理、外层逐个位置调用
+template <size_t N>
+class StridedLoop {
+private:
+    SmallVector<size_t, INLINE_NDIM> _shape;
+    SmallVector<std::array<ptrdiff_t, N>, INLINE_NDIM> _strides;
+
+public:
+    StridedLoop(const shape_t &shape, const std::array<const strides_t *, N> &strides) {
+        for (size_t d = 0; d < shape.size(); d++) {
+            if (shape[d] == 1) {
+                continue;
+            }
+            std::array<ptrdiff_t, N> s;
+            bool mergeable = !_shape.empty();
+            for (size_t t = 0; t < N; t++) {
+                s[t] = (*strides[t])[d];
+                mergeable = mergeable && _strides.back()[t] == s[t] * static_cast<ptrdiff_t>(shape[d]);
+            }
+            if (mergeable) {
+                _shape.back() *= shape[d];
+                _strides.back() = s;
+            } else {
+                _shape.push_back(shape[d]);
+                _strides.push_back(s);
+            }
+        }
+        if (_shape.empty()) {
+            _shape.push_back(1);
+            _strides.push_back({});
+            _strides.back().fill(1);
+        }
+    }
+
+    // 最内层的长度和各张量的步长
+    size_t inner() const { return _shape.back(); }
+    const std::array<ptrdiff_t, N> &innerStrides() const { return _strides.back(); }
+    bool innerContiguous() const {
+        for (auto s : _strides.back()) {
+            if (s != 1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 外层位置的个数（有长度为 0 的维度时为 0）
+    size_t outer() const {
+        size_t n = 1;
+        for (size_t d = 0; d + 1 < _shape.size(); d++) {
+            n *= _shape[d];
+        }
+        return _shape.back() == 0 ? 0 : n;
+    }
+
+    // 对外层位置 [begin, end) 依次调用 f(offsets)，offsets 为各张量在该位置的偏移（元素）
+    template <typename F>
+    void forEach(size_t begin, size_t end, const F &f) const {
+        const size_t nd = _shape.size() - 1;
+        SmallVector<size_t, INLINE_NDIM> idx(nd);
+        std::array<ptrdiff_t, N> off{};
+        size_t o = begin;
+        for (size_t d = nd; d-- > 0;) {
+            idx[d] = o % _shape[d];
+            o /= _shape[d];
+            for (size_t t = 0; t < N; t++) {
+                off[t] += static_cast<ptrdiff_t>(idx[d]) * _strides[d][t];
+            }
+        }
+        for (size_t p = begin; p < end; p++) {
+            f(off);
+            for (size_t d = nd; d-- > 0;) {
+                for (size_t t = 0; t < N; t++) {
+                    off[t] += _strides[d][t];
+                }
+                if (++idx[d] < _shape[d]) {
+                    break;
+                }
+                for (size_t t = 0; t < N; t++) {
+                    off[t] -= static_cast<ptrdiff_t>(_shape[d]) * _strides[d][t];
+                }
+                idx[d] = 0;
+            }
+        }
+    }
+};
+} // namespace llaisys::utils
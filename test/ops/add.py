@@ -30,6 +30,17 @@ def test_op_add(
 
     assert check_equal(c_, c, atol=atol, rtol=rtol)
 
+    # 转置 / 切片得到的视图直接作为输入和输出
+    at, at_ = random_tensor(shape[::-1], dtype_name, device_name)
+    bs, bs_ = random_tensor((shape[0] + 1, shape[1]), dtype_name, device_name)
+    ct, ct_ = random_tensor(shape[::-1], dtype_name, device_name)
+    a, a_ = at.t(), at_.permute(1, 0)
+    b, b_ = bs[1:], bs_.slice(0, 1, shape[0] + 1)
+    c, c_ = ct.t(), ct_.permute(1, 0)
+    torch_add(c, a, b)
+    llaisys.Ops.add(c_, a_, b_)
+    assert check_equal(c_, c, atol=atol, rtol=rtol)
+
     if profile:
         benchmark(
             lambda: torch_add(c, a, b),
@@ -0,0 +1,69 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, zero_tensor, check_equal, benchmark
+
+
+def torch_cast(out, inp):
+    out.copy_(inp)
+
+
+def test_op_cast(
+    shape,
+    src_dtype="f32",
+    dst_dtype="bf16",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   shape {shape} <{src_dtype}> -> <{dst_dtype}>")
+    x, x_ = random_tensor(shape, src_dtype, device_name)
+
+    out, out_ = zero_tensor(shape, dst_dtype, device_name)
+    torch_cast(out, x)
+    llaisys.Ops.cast(out_, x_)
+    assert check_equal(out_, out, atol=atol, rtol=rtol)
+
+    # 输入为切片得到的视图
+    xs, xs_ = random_tensor((shape[0], shape[1] + 2), src_dtype, device_name)
+    x, x_ = xs[:, 1 : shape[1] + 1], xs_.slice(1, 1, shape[1] + 1)
+    torch_cast(out, x)
+    llaisys.Ops.cast(out_, x_)
+    assert check_equal(out_, out, atol=atol, rtol=rtol)
+
+    if profile:
+        benchmark(
+            lambda: torch_cast(out, x),
+            lambda: llaisys.Ops.cast(out_, x_),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [(2, 3), (512, 4096)]
+    testDtypePrec = [
+        # src, dst, atol, rtol
+        ("f32", "bf16", 1e-2, 1e-2),
+        ("f32", "f16", 1e-3, 1e-3),
+        ("bf16", "f32", 0, 0),
+        ("f16", "f32", 0, 0),
+        ("bf16", "f16", 1e-2, 1e-2),
+        ("f32", "f32", 0, 0),
+    ]
+    print(f"Testing Ops.cast on {args.device}")
+    for shape in testShapes:
+        for src_dtype, dst_dtype, atol, rtol in testDtypePrec:
+            test_op_cast(shape, src_dtype, dst_dtype, atol, rtol, args.device, args.profile)
+
+    print("\033[92mTest passed!\033[0m\n")
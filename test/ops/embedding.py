@@ -27,6 +27,15 @@ def test_op_embedding(
 
     check_equal(out_, out, strict=True)
 
+    # 权重为切出的列，输出为转置后的视图
+    cols = embd_shape[1] // 2
+    embd, embd_ = embd[:, :cols], embd_.slice(1, 0, cols)
+    outt, outt_ = random_tensor((cols, idx_shape[0]), dtype_name, device_name)
+    out, out_ = outt.t(), outt_.permute(1, 0)
+    torch_embedding(out, idx, embd)
+    llaisys.Ops.embedding(out_, idx_, embd_)
+    assert check_equal(out_, out, strict=True)
+
     if profile:
         benchmark(
             lambda: torch_embedding(out, idx, embd),
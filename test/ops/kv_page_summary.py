@@ -0,0 +1,69 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, zero_tensor, check_equal, benchmark
+
+
+def torch_kv_page_summary(page_min, page_max, k, page_size, begin):
+    for p in range(begin // page_size, (k.shape[0] + page_size - 1) // page_size):
+        page = k[p * page_size : (p + 1) * page_size].float()
+        page_min[p] = page.amin(0)
+        page_max[p] = page.amax(0)
+
+
+def test_op_kv_page_summary(
+    len_,
+    nkvh,
+    hd,
+    page_size,
+    begin,
+    dtype_name="f32",
+    device_name="cpu",
+    profile=False,
+):
+    print(
+        f"   len={len_} nkvh={nkvh} hd={hd} page_size={page_size} begin={begin} dtype <{dtype_name}>"
+    )
+    npages = (len_ + page_size - 1) // page_size + 1
+    k, k_ = random_tensor((len_, nkvh, hd), dtype_name, device_name)
+    # begin 之前的页不应被修改
+    page_min, page_min_ = zero_tensor((npages, nkvh, hd), "f32", device_name)
+    page_max, page_max_ = zero_tensor((npages, nkvh, hd), "f32", device_name)
+    torch_kv_page_summary(page_min, page_max, k, page_size, begin)
+    llaisys.Ops.kv_page_summary(page_min_, page_max_, k_, page_size, begin)
+    assert check_equal(page_min_, page_min, strict=True)
+    assert check_equal(page_max_, page_max, strict=True)
+
+    if profile:
+        benchmark(
+            lambda: torch_kv_page_summary(page_min, page_max, k, page_size, begin),
+            lambda: llaisys.Ops.kv_page_summary(page_min_, page_max_, k_, page_size, begin),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [
+        # len, nkvh, hd, page_size, begin
+        (16, 1, 4, 16, 0),
+        (37, 2, 8, 16, 0),
+        (37, 2, 8, 16, 33),
+        (1000, 2, 128, 16, 512),
+    ]
+    testDtypes = ["f32", "f16", "bf16"]
+    print(f"Testing Ops.kv_page_summary on {args.device}")
+    for shape in testShapes:
+        for dtype_name in testDtypes:
+            test_op_kv_page_summary(*shape, dtype_name, args.device, args.profile)
+
+    print("\033[92mTest passed!\033[0m\n")
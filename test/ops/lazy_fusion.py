@@ -0,0 +1,149 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, zero_tensor, check_equal, benchmark
+
+
+def torch_chain(out, x, res, up, alpha):
+    # out = cast(swiglu(gate=(x + res) * alpha, up))
+    gate = ((x + res) * alpha).to(x.dtype)
+    out.copy_(up * (gate / (1 + torch.exp(-gate.float()).to(x.dtype))))
+
+
+def llaisys_chain(out_, x_, res_, up_, tmp_, alpha):
+    llaisys.Ops.add(tmp_, x_, res_)
+    llaisys.Ops.scale(tmp_, tmp_, alpha)
+    llaisys.Ops.swiglu(tmp_, tmp_, up_)
+    llaisys.Ops.cast(out_, tmp_)
+
+
+def lazy_chain(out_, x_, res_, up_, tmp_, alpha):
+    with llaisys.Ops.lazy():
+        llaisys_chain(out_, x_, res_, up_, tmp_, alpha)
+
+
+def test_lazy_fusion(
+    shape,
+    dtype_name="f32",
+    out_dtype="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   shape {shape} dtype <{dtype_name}> -> <{out_dtype}>")
+    alpha = 0.5
+    x, x_ = random_tensor(shape, dtype_name, device_name)
+    res, res_ = random_tensor(shape, dtype_name, device_name)
+    up, up_ = random_tensor(shape, dtype_name, device_name)
+    _, tmp_ = zero_tensor(shape, dtype_name, device_name)
+
+    # 立即执行的结果作为参照：融合后的结果必须逐位相同
+    eager, eager_ = zero_tensor(shape, out_dtype, device_name)
+    llaisys_chain(eager_, x_, res_, up_, tmp_, alpha)
+    api = llaisys.RuntimeAPI(eager_.device_type())
+    api.memcpy_sync(
+        eager.data_ptr(),
+        eager_.data_ptr(),
+        eager.numel() * eager.element_size(),
+        llaisys.MemcpyKind.D2D,
+    )
+
+    ans, _ = zero_tensor(shape, out_dtype, device_name)
+    torch_chain(ans, x, res, up, alpha)
+
+    _, out_ = zero_tensor(shape, out_dtype, device_name)
+    lazy_chain(out_, x_, res_, up_, tmp_, alpha)
+    assert check_equal(out_, eager, strict=True)
+    assert check_equal(out_, ans, atol=atol, rtol=rtol)
+
+    # 在 lazy 块内读数据（data_ptr）之前自动执行挂起的运算
+    _, out_ = zero_tensor(shape, out_dtype, device_name)
+    with llaisys.Ops.lazy():
+        llaisys_chain(out_, x_, res_, up_, tmp_, alpha)
+        assert check_equal(out_, eager, strict=True)
+
+    # 表达式相同的链只编译一次
+    cached = llaisys.Ops.lazy_cached_kernels()
+    lazy_chain(out_, x_, res_, up_, tmp_, alpha)
+    assert llaisys.Ops.lazy_cached_kernels() == cached
+
+    if profile:
+        print("      eager:")
+        benchmark(
+            lambda: torch_chain(ans, x, res, up, alpha),
+            lambda: llaisys_chain(eager_, x_, res_, up_, tmp_, alpha),
+            device_name,
+        )
+        print("      lazy:")
+        benchmark(
+            lambda: torch_chain(ans, x, res, up, alpha),
+            lambda: lazy_chain(out_, x_, res_, up_, tmp_, alpha),
+            device_name,
+        )
+
+
+
+def test_lazy_overlap(shape, dtype_name="f32", atol=1e-5, rtol=1e-5, device_name="cpu"):
+    # 同一块内存上部分重叠的切片：x[1:] 先被读、再被写，融合后也必须与立即执行逐位相同
+    print(f"   overlapping slices {shape} dtype <{dtype_name}>")
+    n, m = shape
+    alpha = -1.5
+    x, x_ = random_tensor((n + 1, m), dtype_name, device_name)
+    y, y_ = zero_tensor(shape, dtype_name, device_name)
+    xe, xe_ = zero_tensor((n + 1, m), dtype_name, device_name)
+    ye, ye_ = zero_tensor(shape, dtype_name, device_name)
+    llaisys.Ops.rearrange(xe_, x_)
+
+    def chain(x_, y_):
+        llaisys.Ops.add(y_, x_.slice(0, 0, n), x_.slice(0, 1, n + 1))
+        llaisys.Ops.scale(x_.slice(0, 1, n + 1), x_.slice(0, 1, n + 1), alpha)
+        llaisys.Ops.add(x_.slice(0, 0, n), x_.slice(0, 0, n), y_)
+
+    torch.add(x[:n], x[1:], out=y)
+    torch.mul(x[1:], alpha, out=x[1:])
+    torch.add(x[:n], y, out=x[:n])
+
+    chain(xe_, ye_)
+    with llaisys.Ops.lazy():
+        chain(x_, y_)
+
+    for out_, ref, ref_ in [(x_, xe, xe_), (y_, ye, ye_)]:
+        llaisys.RuntimeAPI(ref_.device_type()).memcpy_sync(
+            ref.data_ptr(),
+            ref_.data_ptr(),
+            ref.numel() * ref.element_size(),
+            llaisys.MemcpyKind.D2D,
+        )
+        assert check_equal(out_, ref, strict=True)
+    assert check_equal(x_, x, atol=atol, rtol=rtol)
+    assert check_equal(y_, y, atol=atol, rtol=rtol)
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [(2, 3), (512, 4096)]
+    testDtypePrec = [
+        # type, out type, atol, rtol
+        ("f32", "f32", 1e-5, 1e-5),
+        ("f32", "bf16", 1e-2, 1e-2),
+        ("f16", "f32", 1e-2, 1e-2),
+        ("bf16", "f32", 5e-2, 5e-2),
+    ]
+    print(f"Testing lazy pointwise fusion on {args.device}")
+    for shape in testShapes:
+        for dtype_name, out_dtype, atol, rtol in testDtypePrec:
+            test_lazy_fusion(shape, dtype_name, out_dtype, atol, rtol, args.device, args.profile)
+        for dtype_name, _, atol, rtol in testDtypePrec[:1] + testDtypePrec[2:]:
+            test_lazy_overlap(shape, dtype_name, atol, rtol, args.device)
+
+    print("\033[92mTest passed!\033[0m\n")
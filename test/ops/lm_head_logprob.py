@@ -0,0 +1,68 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, random_int_tensor, check_equal, benchmark, zero_tensor
+
+
+def torch_lm_head_logprob(out, x, norm_w, w, targets, eps):
+    normed = x.float() * torch.rsqrt(x.float().pow(2).mean(-1, keepdim=True) + eps)
+    normed = (normed * norm_w.float()).to(x.dtype)
+    logits = torch.nn.functional.linear(normed, w).float()
+    out.copy_(torch.log_softmax(logits, dim=-1).gather(-1, targets[:, None])[:, 0])
+
+
+def test_op_lm_head_logprob(
+    m,
+    hs,
+    voc,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   m {m} hs {hs} voc {voc} dtype <{dtype_name}>")
+    x, x_ = random_tensor((m, hs), dtype_name, device_name)
+    norm_w, norm_w_ = random_tensor((hs,), dtype_name, device_name)
+    w, w_ = random_tensor((voc, hs), dtype_name, device_name, scale=0.5, bias=-0.25)
+    targets, targets_ = random_int_tensor((m,), device_name, high=voc)
+    out, out_ = zero_tensor((m,), "f32", device_name)
+    eps = 1e-6
+
+    torch_lm_head_logprob(out, x, norm_w, w, targets, eps)
+    llaisys.Ops.lm_head_logprob(out_, x_, norm_w_, w_, targets_, eps)
+
+    assert check_equal(out_, out, atol=atol, rtol=rtol)
+
+    if profile:
+        benchmark(
+            lambda: torch_lm_head_logprob(out, x, norm_w, w, targets, eps),
+            lambda: llaisys.Ops.lm_head_logprob(out_, x_, norm_w_, w_, targets_, eps),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [(1, 16, 100), (8, 256, 8192)]
+    testDtypePrec = [
+        # type, atol, rtol
+        ("f32", 1e-4, 1e-4),
+        ("f16", 1e-2, 1e-2),
+        ("bf16", 5e-2, 1e-2),
+    ]
+    print(f"Testing Ops.lm_head_logprob on {args.device}")
+    for m, hs, voc in testShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_lm_head_logprob(m, hs, voc, dtype_name, atol, rtol, args.device, args.profile)
+
+    print("\033[92mTest passed!\033[0m\n")
@@ -0,0 +1,70 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, check_equal, benchmark, zero_tensor
+
+
+def torch_lm_head_topk(out_idx, out_val, x, norm_w, w, eps):
+    normed = x.float() * torch.rsqrt(x.float().pow(2).mean(-1, keepdim=True) + eps)
+    normed = (normed * norm_w.float()).to(x.dtype)
+    logits = torch.nn.functional.linear(normed, w)
+    torch.topk(logits, out_idx.shape[-1], dim=-1, out=(out_val, out_idx))
+
+
+def test_op_lm_head_topk(
+    m,
+    hs,
+    voc,
+    k,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   m {m} hs {hs} voc {voc} k {k} dtype <{dtype_name}>")
+    x, x_ = random_tensor((m, hs), dtype_name, device_name)
+    norm_w, norm_w_ = random_tensor((hs,), dtype_name, device_name)
+    w, w_ = random_tensor((voc, hs), dtype_name, device_name, scale=0.1, bias=-0.05)
+    out_idx, out_idx_ = zero_tensor((m, k), "i64", device_name)
+    out_val, out_val_ = zero_tensor((m, k), dtype_name, device_name)
+    eps = 1e-6
+
+    torch_lm_head_topk(out_idx, out_val, x, norm_w, w, eps)
+    llaisys.Ops.lm_head_topk(out_idx_, out_val_, x_, norm_w_, w_, eps)
+
+    # 下标在近似相等的 logits 之间可能交换顺序，因此比较值
+    assert check_equal(out_val_, out_val, atol=atol, rtol=rtol)
+
+    if profile:
+        benchmark(
+            lambda: torch_lm_head_topk(out_idx, out_val, x, norm_w, w, eps),
+            lambda: llaisys.Ops.lm_head_topk(out_idx_, out_val_, x_, norm_w_, w_, eps),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [(1, 16, 100, 1), (4, 256, 8192, 1), (2, 256, 8192, 50)]
+    testDtypePrec = [
+        # type, atol, rtol
+        ("f32", 1e-4, 1e-4),
+        ("f16", 1e-3, 1e-3),
+        ("bf16", 1e-2, 1e-2),
+    ]
+    print(f"Testing Ops.lm_head_topk on {args.device}")
+    for m, hs, voc, k in testShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_lm_head_topk(m, hs, voc, k, dtype_name, atol, rtol, args.device, args.profile)
+
+    print("\033[92mTest passed!\033[0m\n")
@@ -0,0 +1,73 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, zero_tensor, check_equal, benchmark
+
+
+def test_op_rearrange(
+    shape,
+    perm,
+    dtype_name="f32",
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   shape {shape} perm {perm} dtype <{dtype_name}>")
+    x, x_ = random_tensor(shape, dtype_name, device_name)
+
+    # 转置 / 切片后的输入复制到连续的输出
+    src, src_ = x.permute(*perm), x_.permute(*perm)
+    out, out_ = zero_tensor(src.shape, dtype_name, device_name)
+    out.copy_(src)
+    llaisys.Ops.rearrange(out_, src_)
+    assert check_equal(out_, out, strict=True)
+
+    src, src_ = x[1:], x_.slice(0, 1, shape[0])
+    out, out_ = zero_tensor(src.shape, dtype_name, device_name)
+    out.copy_(src)
+    llaisys.Ops.rearrange(out_, src_)
+    assert check_equal(out_, out, strict=True)
+
+    # 连续的输入写入转置后的输出
+    dst, dst_ = zero_tensor(shape, dtype_name, device_name)
+    dst, dst_ = dst.permute(*perm), dst_.permute(*perm)
+    src, src_ = x.permute(*perm).contiguous(), x_.permute(*perm).contiguous()
+    dst.copy_(src)
+    llaisys.Ops.rearrange(dst_, src_)
+    assert check_equal(dst_, dst, strict=True)
+
+    if profile:
+        src, src_ = x.permute(*perm), x_.permute(*perm)
+        out, out_ = zero_tensor(src.shape, dtype_name, device_name)
+        benchmark(
+            lambda: out.copy_(src),
+            lambda: llaisys.Ops.rearrange(out_, src_),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [
+        # shape, perm
+        ((2, 3), (1, 0)),
+        ((4, 5, 6), (2, 0, 1)),
+        ((3, 1, 7, 9), (0, 2, 1, 3)),
+        ((128, 8, 64), (1, 0, 2)),
+        ((1024, 1024), (1, 0)),
+    ]
+    testDtype = ["f32", "f16", "bf16"]
+    print(f"Testing Ops.rearrange on {args.device}")
+    for shape, perm in testShapes:
+        for dtype_name in testDtype:
+            test_op_rearrange(shape, perm, dtype_name, args.device, args.profile)
+
+    print("\033[92mTest passed!\033[0m\n")
@@ -36,6 +36,15 @@ def test_op_rms_norm(
 
     assert check_equal(c_, c, atol=atol, rtol=rtol)
 
+    # 输入为更宽的张量中切出的列，输出为转置后的视图
+    xs, xs_ = random_tensor((shape[0], shape[1] + 8), dtype_name, device_name)
+    x, x_ = xs[:, 4 : 4 + shape[1]], xs_.slice(1, 4, 4 + shape[1])
+    ct, ct_ = random_tensor(shape[::-1], dtype_name, device_name)
+    c, c_ = ct.t(), ct_.permute(1, 0)
+    torch_rms_norm(c, x, w, eps)
+    llaisys.Ops.rms_norm(c_, x_, w_, eps)
+    assert check_equal(c_, c, atol=atol, rtol=rtol)
+
     if profile:
         benchmark(
             lambda: torch_rms_norm(c, x, w, eps),
@@ -51,6 +51,16 @@ def test_op_rope(
 
     assert check_equal(y_, y, atol=atol, rtol=rtol)
 
+    # 输入为合并的 qkv 中切出的 head，输出为按 head 排列的张量转置后的视图
+    seqlen, nhead, d = shape
+    xs, xs_ = random_tensor((seqlen, 2 * nhead, d), dtype_name, device_name)
+    x, x_ = xs[:, :nhead], xs_.slice(1, 0, nhead)
+    yt, yt_ = random_tensor((nhead, seqlen, d), dtype_name, device_name)
+    y, y_ = yt.transpose(0, 1), yt_.permute(1, 0, 2)
+    torch_rope(y, x, pos_ids, theta)
+    llaisys.Ops.rope(y_, x_, pos_ids_, theta)
+    assert check_equal(y_, y, atol=atol, rtol=rtol)
+
     if profile:
         benchmark(
             lambda: torch_rope(y, x, pos_ids, theta),
@@ -0,0 +1,104 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, check_equal, benchmark, zero_tensor, llaisys_device
+
+
+def torch_sample_probs(logits, temperature, top_k, top_p):
+    """temperature -> top_k -> top_p 之后每个 token 的概率"""
+    probs = torch.softmax(logits.float() / temperature, dim=-1)
+    sorted_probs, sorted_idx = torch.sort(probs, dim=-1, descending=True, stable=True)
+    if top_k > 0:
+        sorted_probs[..., top_k:] = 0
+        sorted_probs = sorted_probs / sorted_probs.sum(dim=-1, keepdim=True)
+    # 保留累积概率刚好达到 top_p 的最小前缀
+    exclusive = torch.cumsum(sorted_probs, dim=-1) - sorted_probs
+    sorted_probs[exclusive >= top_p] = 0
+    sorted_probs = sorted_probs / sorted_probs.sum(dim=-1, keepdim=True)
+    return torch.zeros_like(probs).scatter(-1, sorted_idx, sorted_probs)
+
+
+def test_op_sample_greedy(shape, dtype_name="f32", device_name="cpu"):
+    print(f"   greedy shape {shape} dtype <{dtype_name}>")
+    logits, logits_ = random_tensor(shape, dtype_name, device_name)
+    out, out_ = zero_tensor((shape[0],), "i64", device_name)
+    torch.argmax(logits, dim=-1, out=out)
+    llaisys.Ops.sample(out_, logits_, temperature=0.0)
+    assert check_equal(out_, out, strict=True)
+
+
+def test_op_sample_distribution(
+    voc, temperature, top_k, top_p, dtype_name="f32", device_name="cpu", nsample=8192
+):
+    print(
+        f"   voc {voc} temperature {temperature} top_k {top_k} top_p {top_p} dtype <{dtype_name}>"
+    )
+    row, _ = random_tensor((1, voc), dtype_name, device_name, scale=4.0)
+    logits, logits_ = random_tensor((nsample, voc), dtype_name, device_name)
+    logits.copy_(row.expand(nsample, voc))
+    api = llaisys.RuntimeAPI(llaisys_device(device_name))
+    api.memcpy_sync(
+        logits_.data_ptr(),
+        logits.data_ptr(),
+        logits.numel() * logits.element_size(),
+        llaisys.MemcpyKind.D2D,
+    )
+    out, out_ = zero_tensor((nsample,), "i64", device_name)
+
+    llaisys.Ops.sample(out_, logits_, temperature, top_k, top_p, seed=2026)
+    api.memcpy_sync(
+        out.data_ptr(), out_.data_ptr(), out.numel() * out.element_size(), llaisys.MemcpyKind.D2D
+    )
+
+    expected = torch_sample_probs(row[0], temperature, top_k, top_p).cpu()
+    counts = torch.bincount(out.cpu(), minlength=voc).float() / nsample
+    # 被截断的 token 一定不能被采到，其余按频率比较
+    assert torch.all(counts[expected == 0] == 0)
+    assert torch.allclose(counts, expected, atol=0.03)
+
+    # 相同种子结果相同
+    out2, out2_ = zero_tensor((nsample,), "i64", device_name)
+    llaisys.Ops.sample(out2_, logits_, temperature, top_k, top_p, seed=2026)
+    assert check_equal(out2_, out, strict=True)
+
+
+def test_op_sample_profile(shape, dtype_name="f32", device_name="cpu"):
+    print(f"   profile shape {shape} dtype <{dtype_name}>")
+    logits, logits_ = random_tensor(shape, dtype_name, device_name, scale=8.0)
+    out, out_ = zero_tensor((shape[0],), "i64", device_name)
+
+    def torch_sample():
+        probs = torch_sample_probs(logits, 0.8, 50, 0.9)
+        torch.multinomial(probs, 1)
+
+    benchmark(
+        torch_sample,
+        lambda: llaisys.Ops.sample(out_, logits_, 0.8, 50, 0.9, seed=0),
+        device_name,
+    )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testDtype = ["f32", "f16", "bf16"]
+    print(f"Testing Ops.sample on {args.device}")
+    for dtype_name in testDtype:
+        for shape in [(1, 4), (4, 4096)]:
+            test_op_sample_greedy(shape, dtype_name, args.device)
+    for temperature, top_k, top_p in [(1.0, 0, 1.0), (0.7, 5, 1.0), (1.0, 0, 0.8), (1.3, 8, 0.9)]:
+        test_op_sample_distribution(16, temperature, top_k, top_p, "f32", args.device)
+    if args.profile:
+        for dtype_name in testDtype:
+            test_op_sample_profile((1, 151936), dtype_name, args.device)
+            test_op_sample_profile((8, 151936), dtype_name, args.device)
+
+    print("\033[92mTest passed!\033[0m\n")
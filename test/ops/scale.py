@@ -0,0 +1,67 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, check_equal, benchmark
+
+
+def torch_scale(out, inp, alpha):
+    torch.mul(inp, alpha, out=out)
+
+
+def test_op_scale(
+    shape,
+    alpha,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   shape {shape} alpha {alpha} dtype <{dtype_name}>")
+    x, x_ = random_tensor(shape, dtype_name, device_name)
+
+    out, out_ = random_tensor(shape, dtype_name, device_name)
+    torch_scale(out, x, alpha)
+    llaisys.Ops.scale(out_, x_, alpha)
+    assert check_equal(out_, out, atol=atol, rtol=rtol)
+
+    # 原地缩放转置的视图
+    xt, xt_ = random_tensor(shape[::-1], dtype_name, device_name)
+    x, x_ = xt.t(), xt_.permute(1, 0)
+    torch_scale(x, x, alpha)
+    llaisys.Ops.scale(x_, x_, alpha)
+    assert check_equal(x_, x, atol=atol, rtol=rtol)
+
+    if profile:
+        benchmark(
+            lambda: torch_scale(out, x, alpha),
+            lambda: llaisys.Ops.scale(out_, x_, alpha),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [(2, 3), (512, 4096)]
+    testDtypePrec = [
+        # type, atol, rtol
+        ("f32", 1e-5, 1e-5),
+        ("f16", 1e-3, 1e-3),
+        ("bf16", 1e-2, 1e-2),
+    ]
+    print(f"Testing Ops.scale on {args.device}")
+    for shape in testShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_scale(shape, 0.125, dtype_name, atol, rtol, args.device, args.profile)
+            test_op_scale(shape, -3.0, dtype_name, atol, rtol, args.device, args.profile)
+
+    print("\033[92mTest passed!\033[0m\n")
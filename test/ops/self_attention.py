@@ -53,6 +53,18 @@ def test_op_self_attention(
     llaisys.Ops.self_attention(attn_val_, q_, k_, v_, scale)
     assert check_equal(attn_val_, attn_val, atol=atol, rtol=rtol)
 
+    # q / k / v 为合并的 qkv 输出中切出的 head，K 按 head 排列，输出为转置后的视图
+    qkv, qkv_ = random_tensor((qlen, nh + 2 * nkvh, hd), dtype_name, device_name)
+    q, q_ = qkv[:, :nh], qkv_.slice(1, 0, nh)
+    v, v_ = qkv[:, nh + nkvh :], qkv_.slice(1, nh + nkvh, nh + 2 * nkvh)
+    kt, kt_ = random_tensor((nkvh, qlen, hd), dtype_name, device_name)
+    k, k_ = kt.transpose(0, 1), kt_.permute(1, 0, 2)
+    outt, outt_ = random_tensor((nh, qlen, hd), dtype_name, device_name)
+    attn_val, attn_val_ = outt.transpose(0, 1), outt_.permute(1, 0, 2)
+    torch_self_attention(attn_val, q, k, v, scale)
+    llaisys.Ops.self_attention(attn_val_, q_, k_, v_, scale)
+    assert check_equal(attn_val_, attn_val, atol=atol, rtol=rtol)
+
     if profile:
         benchmark(
             lambda: torch_self_attention(attn_val, q, k, v, scale),
@@ -0,0 +1,94 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, check_equal, benchmark, llaisys_device
+from self_attention import torch_self_attention
+
+
+def offsets_tensor(lens, device_name):
+    cu = torch.tensor([0] + lens, dtype=torch.int64).cumsum(0)
+    cu_ = llaisys.Tensor((len(cu),), dtype=llaisys.DataType.I64, device=llaisys_device(device_name))
+    cu_.load(cu.data_ptr())
+    return cu.tolist(), cu_
+
+
+def torch_self_attention_varlen(attn_val, q, k, v, cu_q, cu_k, scale):
+    # 逐条序列调用单序列的参考实现
+    for s in range(len(cu_q) - 1):
+        torch_self_attention(
+            attn_val[cu_q[s] : cu_q[s + 1]],
+            q[cu_q[s] : cu_q[s + 1]],
+            k[cu_k[s] : cu_k[s + 1]],
+            v[cu_k[s] : cu_k[s + 1]],
+            scale,
+        )
+
+
+def test_op_self_attention_varlen(
+    qlens,
+    kvlens,
+    nh,
+    nkvh,
+    hd,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(
+        f"   qlens={qlens} kvlens={kvlens} nh={nh} nkvh={nkvh} hd={hd} dtype <{dtype_name}>"
+    )
+    q, q_ = random_tensor((sum(qlens), nh, hd), dtype_name, device_name)
+    k, k_ = random_tensor((sum(kvlens), nkvh, hd), dtype_name, device_name)
+    v, v_ = random_tensor((sum(kvlens), nkvh, hd), dtype_name, device_name)
+    cu_q, cu_q_ = offsets_tensor(qlens, device_name)
+    cu_k, cu_k_ = offsets_tensor(kvlens, device_name)
+    scale = 1.0 / (hd**0.5)
+
+    attn_val, attn_val_ = random_tensor((sum(qlens), nh, hd), dtype_name, device_name)
+    torch_self_attention_varlen(attn_val, q, k, v, cu_q, cu_k, scale)
+    llaisys.Ops.self_attention_varlen(attn_val_, q_, k_, v_, cu_q_, cu_k_, scale)
+    assert check_equal(attn_val_, attn_val, atol=atol, rtol=rtol)
+
+    if profile:
+        benchmark(
+            lambda: torch_self_attention_varlen(attn_val, q, k, v, cu_q, cu_k, scale),
+            lambda: llaisys.Ops.self_attention_varlen(
+                attn_val_, q_, k_, v_, cu_q_, cu_k_, scale
+            ),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [
+        # qlens, kvlens, nh, nkvh, hd
+        ([2], [2], 1, 1, 4),
+        ([5, 1, 3], [11, 7, 3], 4, 2, 8),
+        ([1, 1, 1, 1], [9, 4, 16, 1], 4, 1, 8),
+    ]
+    testDtypePrec = [
+        # type, atol, rtol
+        ("f32", 1e-5, 1e-5),
+        ("f16", 1e-3, 1e-3),
+        ("bf16", 1e-2, 1e-2),
+    ]
+    print(f"Testing Ops.self_attention_varlen on {args.device}")
+    for shape in testShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_self_attention_varlen(
+                *shape, dtype_name, atol, rtol, args.device, args.profile
+            )
+
+    print("\033[92mTest passed!\033[0m\n")
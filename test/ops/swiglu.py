@@ -30,6 +30,15 @@ def test_op_swiglu(
 
     assert check_equal(out_, out, atol=atol, rtol=rtol)
 
+    # gate / up 为合并的 gate_up 输出的左右两半
+    n = shape[1]
+    gate_up, gate_up_ = random_tensor((shape[0], 2 * n), dtype_name, device_name)
+    gate, gate_ = gate_up[:, :n], gate_up_.slice(1, 0, n)
+    up, up_ = gate_up[:, n:], gate_up_.slice(1, n, 2 * n)
+    torch_swiglu(out, gate, up)
+    llaisys.Ops.swiglu(out_, gate_, up_)
+    assert check_equal(out_, out, atol=atol, rtol=rtol)
+
     if profile:
         benchmark(
             lambda: torch_swiglu(out, gate, up),
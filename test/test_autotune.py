@@ -0,0 +1,78 @@
+import llaisys
+import torch
+from test_utils import random_tensor
+import argparse
+import os
+import tempfile
+
+
+def to_torch(t: llaisys.Tensor, like: torch.Tensor) -> torch.Tensor:
+    result = torch.zeros_like(like)
+    api = llaisys.RuntimeAPI(t.device_type())
+    api.memcpy_sync(result.data_ptr(), t.data_ptr(), result.numel() * result.element_size(), llaisys.MemcpyKind.D2D)
+    return result
+
+
+def test_autotune(device_name: str = "cpu"):
+    M, N, K = 7, 96, 64
+    qlen, kvlen, nh, nkvh, d = 5, 11, 4, 2, 16
+    x, x_ = random_tensor((M, K), "bf16", device_name)
+    w, w_ = random_tensor((N, K), "bf16", device_name)
+    b, b_ = random_tensor((N,), "bf16", device_name)
+    q, q_ = random_tensor((qlen, nh, d), "f32", device_name)
+    k, k_ = random_tensor((kvlen, nkvh, d), "f32", device_name)
+    v, v_ = random_tensor((kvlen, nkvh, d), "f32", device_name)
+
+    def run():
+        out, out_ = random_tensor((M, N), "bf16", device_name)
+        attn, attn_ = random_tensor((qlen, nh, d), "f32", device_name)
+        llaisys.Ops.linear(out_, x_, w_, b_)
+        llaisys.Ops.self_attention(attn_, q_, k_, v_, 0.25)
+        return to_torch(out_, out), to_torch(attn_, attn)
+
+    old_mode, old_path = llaisys.Autotune.mode(), llaisys.Autotune.cache_path()
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "sub", "tune.cache")
+        llaisys.Autotune.set_cache_path(path)
+        assert llaisys.Autotune.cache_path() == path
+
+        llaisys.Autotune.set_mode("off")
+        ref_linear, ref_attn = run()
+        assert llaisys.Autotune.entries() == [] and not os.path.exists(path)
+
+        # 调优只改变分块方式，结果逐位相同
+        llaisys.Autotune.set_mode("on")
+        assert llaisys.Autotune.mode() == "on"
+        tuned_linear, tuned_attn = run()
+        assert torch.equal(tuned_linear, ref_linear) and torch.equal(tuned_attn, ref_attn)
+        entries = llaisys.Autotune.entries()
+        print(entries)
+        ops = sorted(key.split("|")[0] for key, _, _ in entries)
+        assert ops == ["linear", "self_attention"]
+        assert all(us > 0 for _, _, us in entries)
+        with open(path) as f:
+            assert len([line for line in f if not line.startswith("#")]) == 2
+
+        # 缓存命中时不再调优，重新读文件得到相同的结果
+        run()
+        llaisys.Autotune.clear()
+        llaisys.Autotune.set_mode("cached")
+        assert llaisys.Autotune.entries() == entries
+        cached_linear, _ = run()
+        assert torch.equal(cached_linear, ref_linear)
+
+        # 与 torch 的结果一致
+        answer = torch.nn.functional.linear(x.float(), w.float(), b.float()).to(torch.bfloat16)
+        assert torch.allclose(tuned_linear.float(), answer.float(), atol=5e-2, rtol=5e-2)
+
+    llaisys.Autotune.set_mode(old_mode)
+    llaisys.Autotune.set_cache_path(old_path)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    args = parser.parse_args()
+    test_autotune(args.device)
+
+    print("\033[92mTest passed!\033[0m\n")
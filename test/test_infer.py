@@ -6,6 +6,7 @@ from transformers import AutoModelForCausalLM, AutoTokenizer
 import torch
 from huggingface_hub import snapshot_download
 import os
+import tempfile
 import time
 import llaisys
 import sys
@@ -146,4 +147,123 @@ if __name__ == "__main__":
 
     if args.test:
         assert llaisys_tokens == tokens
+
+        # 同一个 prompt 再跑一次：前缀应该从前缀缓存中命中，结果保持一致
+        cached_tokens, _ = llaisys_infer(
+            args.prompt,
+            tokenizer,
+            model,
+            max_new_tokens=args.max_steps,
+            top_p=top_p,
+            top_k=top_k,
+            temperature=temperature,
+        )
+        stats = model.prefix_cache_stats()
+        print(f"Prefix cache: {stats}")
+        assert cached_tokens == tokens
+
+        # 分块 prefill 与 decode 交错调度，结果应与逐个生成一致
+        input_content = tokenizer.apply_chat_template(
+            conversation=[{"role": "user", "content": args.prompt}],
+            add_generation_prompt=True,
+            tokenize=False,
+        )
+        inputs = tokenizer.encode(input_content)
+        model.set_chunk_size(8)
+
+        # 所有位置的 logits：最后一行的 argmax 即第一个生成的 token，且与只算最后一个位置的结果相同
+        all_logits = model.logits(inputs, positions="all")
+        assert all_logits.shape[0] == len(inputs)
+        assert int(all_logits[-1].argmax()) == tokens[len(inputs)]
+        last_logits = model.logits(inputs, positions="last")
+        assert torch.allclose(last_logits[0].float(), all_logits[-1].float(), atol=1e-2, rtol=1e-2)
+
+        # 批量打分：与所有位置 logits 的 log_softmax 一致
+        continuation = tokens[len(inputs):]
+        scores = model.score([(inputs, continuation), (inputs[:-1], inputs[-1:])])
+        full = model.logits(inputs + continuation, positions="all").float().log_softmax(-1)
+        expected = full[len(inputs) - 1 : -1].gather(-1, torch.tensor(continuation)[:, None])[:, 0]
+        assert torch.allclose(torch.tensor(scores[0]), expected, atol=5e-2)
+        assert len(scores[1]) == 1
+
+        batch_tokens = model.generate_batch([inputs, inputs[:-1]], max_new_tokens=args.max_steps)
+        assert batch_tokens[0] == tokens
+
+        # 投机解码（贪心）：无论 draft 接受率如何，结果都应与逐个生成一致
+        draft = load_llaisys_model(model_path, args.device)
+        spec_tokens = model.generate_speculative(
+            inputs, draft, max_new_tokens=args.max_steps, num_draft_tokens=4
+        )
+        print(f"Speculative decoding: {model.speculative_stats()}")
+        assert spec_tokens == tokens
+
+        # prompt lookup 自投机：standalone 与请求级两种用法
+        lookup_tokens = model.generate_speculative(
+            inputs, max_new_tokens=args.max_steps, num_draft_tokens=4
+        )
+        assert lookup_tokens == tokens
+        batch_tokens = model.generate_batch(
+            [inputs, inputs[:-1]], max_new_tokens=args.max_steps, num_lookup_tokens=[4, 0]
+        )
+        print(f"Prompt lookup: {model.speculative_stats()}")
+        assert batch_tokens[0] == tokens
+
+        # 流式模式：窗口覆盖整个对话时与普通模式一致；小窗口下可以生成超过窗口长度的序列
+        model.set_streaming(sink=4, window=len(tokens))
+        assert model.generate(inputs, max_new_tokens=args.max_steps, top_k=1) == tokens
+        model.set_streaming(sink=4, window=16)
+        streaming_tokens = model.generate(inputs, max_new_tokens=args.max_steps, top_k=1)
+        assert streaming_tokens[: len(inputs)] == inputs
+        # 请求级：prompt 比窗口长时 prefill 按窗口分块
+        model.set_streaming(sink=4, window=8)
+        assert len(inputs) > 8
+        streaming_tokens = model.generate(inputs, max_new_tokens=args.max_steps, top_k=1)
+        assert model.generate_batch([inputs], max_new_tokens=args.max_steps)[0] == streaming_tokens
+        model.set_streaming(window=0)
+
+        # 稀疏 attention：长 prompt 上 teacher forcing 稠密模式的续写，比较每步 top-1 与 decode 时间
+        long_inputs = (inputs * (1024 // len(inputs) + 1))[:1024]
+        dense_tokens = model.generate(long_inputs, max_new_tokens=32, top_k=1)
+        report = {}
+        for name, page_size in (("dense", 0), ("sparse", 16)):
+            model.set_sparse_attention(page_size=page_size, top_pages=16, recent=128)
+            model.logits(long_inputs, positions="last")
+            predictions = []
+            start = time.time()
+            for n in range(len(long_inputs), len(dense_tokens)):
+                predictions.append(int(model.logits(dense_tokens[:n], positions="last")[0].argmax()))
+            report[name] = (predictions, (time.time() - start) / len(predictions))
+        agreement = sum(
+            a == b for a, b in zip(report["dense"][0], report["sparse"][0])
+        ) / len(report["dense"][0])
+        print(
+            f"Sparse attention: context={len(long_inputs)} budget={16 * 16 + 128} "
+            f"top-1 agreement={agreement:.3f} "
+            f"decode dense={report['dense'][1] * 1000:.1f}ms sparse={report['sparse'][1] * 1000:.1f}ms"
+        )
+        assert report["dense"][0] == dense_tokens[len(long_inputs):]
+        assert agreement >= 0.75
+        model.set_sparse_attention(page_size=0)
+
+        # KV 冷存储：前缀缓存只留很少的热块，其余换出到磁盘上的映射文件；切换会话后再回来时换入，结果不变
+        model.set_prefix_cache(block_size=16, budget_bytes=1 << 20)
+        model.set_kv_offload(budget_bytes=1 << 30, path=tempfile.gettempdir())
+        offload_tokens = model.generate(long_inputs, max_new_tokens=8, top_k=1)
+        model.generate(inputs[:-1], max_new_tokens=8, top_k=1)
+        assert model.generate(long_inputs, max_new_tokens=8, top_k=1) == offload_tokens
+        assert model.generate_batch([long_inputs], max_new_tokens=8)[0] == offload_tokens
+        stats = model.prefix_cache_stats()
+        print(f"KV offload: {stats}")
+        assert stats["paged_in_blocks"] > 0
+        model.set_kv_offload(budget_bytes=0)
+        model.set_prefix_cache()
+
+        # KV 快照：保存当前对话，在另一个加载了同一模型的实例上恢复后继续生成，结果一致
+        snapshot = os.path.join(tempfile.gettempdir(), "llaisys_kv_snapshot.bin")
+        model.generate(inputs, max_new_tokens=args.max_steps, top_k=1)
+        model.save_cache(snapshot)
+        history = draft.load_cache(snapshot)
+        assert len(history) >= len(inputs) and history == tokens[: len(history)]
+        assert draft.generate(inputs, max_new_tokens=args.max_steps, top_k=1) == tokens
+        os.remove(snapshot)
         print("\033[92mTest passed!\033[0m\n")
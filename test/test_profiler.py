@@ -0,0 +1,89 @@
+import llaisys
+import torch
+from test_utils import random_tensor
+import argparse
+import json
+import os
+import tempfile
+
+
+def test_profiler(device_name: str = "cpu"):
+    M, N, K = 16, 32, 64
+    out, out_ = random_tensor((M, N), "f32", device_name)
+    x, x_ = random_tensor((M, K), "f32", device_name)
+    w, w_ = random_tensor((N, K), "f32", device_name)
+
+    # 关闭时不记录
+    llaisys.Profiler.clear()
+    llaisys.Ops.linear(out_, x_, w_, None)
+    assert not llaisys.Profiler.enabled()
+    assert llaisys.Profiler.chrome_trace()["traceEvents"] == []
+
+    with llaisys.Profiler() as prof:
+        assert prof.enabled()
+        for _ in range(3):
+            llaisys.Ops.linear(out_, x_, w_, None)
+            llaisys.Ops.add(out_, out_, out_)
+    assert not llaisys.Profiler.enabled()
+
+    events = prof.chrome_trace()["traceEvents"]
+    linear = [e for e in events if e["name"] == "linear"]
+    assert len(linear) == 3 and len(events) == 6
+    for e in linear:
+        assert e["ph"] == "X" and e["dur"] >= 0
+        assert e["args"]["shapes"] == f"[{M},{K}] [{N},{K}]"
+        assert e["args"]["flops"] == 2 * M * N * K
+        assert e["args"]["bytes"] == (M * K + N * K + M * N) * 4
+
+    summary = prof.summary()
+    print(summary)
+    assert "linear" in summary and "add" in summary
+
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "trace.json")
+        prof.save(path)
+        with open(path) as f:
+            assert len(json.load(f)["traceEvents"]) == 6
+
+    # roofline：读取 calibrate 的结果后汇总表格多出算术强度和 % of roofline
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "peaks.json")
+        with open(path, "w") as f:
+            json.dump({"meta": {"suite": "calibrate"}, "peaks": [
+                {"threads": 1, "peak_gbps": 10.0, "peak_gflops": 20.0},
+                {"threads": 8, "peak_gbps": 40.0, "peak_gflops": 160.0}]}, f)
+        assert prof.load_roofline(path, threads=6)["threads"] == 8
+    summary = prof.summary()
+    print(summary)
+    assert "%roof" in summary.splitlines()[0]
+    prof.set_roofline(0, 0)
+    assert "%roof" not in prof.summary()
+
+    prof.clear()
+    assert prof.chrome_trace()["traceEvents"] == []
+
+    # 硬件计数器：内核不允许时只是没有计数器，计时照常
+    with llaisys.Profiler(counters=True) as prof:
+        available = prof.counters_enabled()
+        for _ in range(3):
+            llaisys.Ops.linear(out_, x_, w_, None)
+    print(prof.counters_status())
+    assert not prof.counters_enabled()
+    rows = prof.counters()
+    assert len(prof.chrome_trace()["traceEvents"]) == 3
+    if available:
+        assert len(rows) == 1 and rows[0]["op"] == "linear" and rows[0]["calls"] == 3
+        assert rows[0]["shapes"] == f"[{M},{K}] [{N},{K}]"
+        print(rows)
+    else:
+        assert rows == []
+    prof.clear()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    args = parser.parse_args()
+    test_profiler(args.device)
+
+    print("\033[92mTest passed!\033[0m\n")
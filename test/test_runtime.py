@@ -18,6 +18,7 @@ def test_basic_runtime_api(device_name: str = "cpu"):
         print("Testing device {i}...")
         api.set_device(i)
         test_memcpy(api, 1024 * 1024)
+        test_stream_event(api, 1024 * 1024)
 
         print("     Passed")
 
@@ -53,6 +54,30 @@ def test_memcpy(api, size_bytes: int):
     torch.testing.assert_close(a, b)
 
 
+def test_stream_event(api, size_bytes: int):
+    a = torch.zeros((size_bytes,), dtype=torch.uint8, device=torch_device("cpu"))
+    b = torch.zeros_like(a)
+    device_a = api.malloc_device(size_bytes)
+    stream1 = api.create_stream()
+    stream2 = api.create_stream()
+    event = api.create_event()
+
+    # stream1 先填 a 再拷到 device；stream2 等 event 之后再拷回 b
+    api.launch_host_func(stream1, lambda: a.fill_(7))
+    api.memcpy_async(device_a, a.data_ptr(), size_bytes, llaisys.MemcpyKind.H2D, stream1)
+    api.event_record(event, stream1)
+    api.stream_wait_event(stream2, event)
+    api.memcpy_async(b.data_ptr(), device_a, size_bytes, llaisys.MemcpyKind.D2H, stream2)
+    api.stream_synchronize(stream2)
+    torch.testing.assert_close(b, torch.full_like(a, 7))
+
+    api.event_synchronize(event)
+    api.destroy_event(event)
+    api.destroy_stream(stream1)
+    api.destroy_stream(stream2)
+    api.free_device(device_a)
+
+
 if __name__ == "__main__":
     parser = argparse.ArgumentParser()
     parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
@@ -48,6 +48,31 @@ def test_tensor():
     assert llaisys_tensor.is_contiguous() == torch_tensor.is_contiguous()
     assert check_equal(llaisys_tensor_slice, torch_tensor_slice)
 
+    # Test contiguous
+    print("===Test contiguous===")
+    torch_tensor_contig = torch_tensor_perm.contiguous()
+    llaisys_tensor_contig = llaisys_tensor_perm.contiguous()
+    assert llaisys_tensor_contig.is_contiguous()
+    assert llaisys_tensor_contig.strides() == torch_tensor_contig.stride()
+    assert check_equal(llaisys_tensor_contig, torch_tensor_contig, strict=True)
+
+    # Test reshape
+    print("===Test reshape===")
+    # 能表示成视图时与 torch 的步长相同，否则复制
+    torch_tensor_reshape = torch_tensor_slice.reshape(12, 3)
+    llaisys_tensor_reshape = llaisys_tensor_slice.reshape(12, 3)
+    assert llaisys_tensor_reshape.shape() == torch_tensor_reshape.shape
+    assert llaisys_tensor_reshape.strides() == torch_tensor_reshape.stride()
+    assert check_equal(llaisys_tensor_reshape, torch_tensor_reshape, strict=True)
+    torch_tensor_reshape = torch_tensor_perm.reshape(5, 12)
+    llaisys_tensor_reshape = llaisys_tensor_perm.reshape(5, 12)
+    assert llaisys_tensor_reshape.strides() == torch_tensor_reshape.stride()
+    assert check_equal(llaisys_tensor_reshape, torch_tensor_reshape, strict=True)
+    torch_tensor_reshape = torch_tensor_perm.reshape(5, 3, 2, 2)
+    llaisys_tensor_reshape = llaisys_tensor_perm.reshape(5, 3, 2, 2)
+    assert llaisys_tensor_reshape.strides() == torch_tensor_reshape.stride()
+    assert check_equal(llaisys_tensor_reshape, torch_tensor_reshape, strict=True)
+
 
 if __name__ == "__main__":
     test_tensor()
@@ -95,6 +95,21 @@ target("llaisys-ops")
     on_install(function (target) end)
 target_end()
 
+target("llaisys-models")
+    set_kind("static")
+    add_deps("llaisys-ops")
+
+    set_languages("cxx17")
+    set_warnings("all", "error")
+    if not is_plat("windows") then
+        add_cxflags("-fPIC", "-Wno-unknown-pragmas")
+    end
+
+    add_files("src/models/*/*.cpp")
+
+    on_install(function (target) end)
+target_end()
+
 target("llaisys")
     set_kind("shared")
     add_deps("llaisys-utils")
@@ -102,10 +117,12 @@ target("llaisys")
     add_deps("llaisys-core")
     add_deps("llaisys-tensor")
     add_deps("llaisys-ops")
+    add_deps("llaisys-models")
 
     set_languages("cxx17")
     set_warnings("all", "error")
     add_files("src/llaisys/*.cc")
+    add_files("src/llaisys/*/*.cc")
     set_installdir(".")
 
     
@@ -119,4 +136,25 @@ target("llaisys")
             os.cp("lib/*.so", "python/llaisys/libllaisys/")
         end
     end)
-target_end()
\ No newline at end of file
+target_end()
+
+-- 原生 benchmark：xmake build llaisys-bench && xmake run llaisys-bench --help
+target("llaisys-bench")
+    set_kind("binary")
+    set_default(false)
+    add_deps("llaisys")
+
+    set_languages("cxx17")
+    set_warnings("all", "error")
+    if is_plat("windows") then
+        add_cxflags("/openmp")
+        add_syslinks("psapi")
+    else
+        add_cxflags("-fopenmp", "-Wno-unknown-pragmas")
+        add_syslinks("gomp")
+    end
+
+    add_files("bench/*.cpp")
+
+    on_install(function (target) end)
+target_end()
@@ -20,6 +20,14 @@ target("llaisys-ops-cpu")
         add_cxflags("-fPIC", "-Wno-unknown-pragmas")
     end
 
+    -- OpenMP：CPU 算子内部的多线程与 `#pragma omp simd`
+    if is_plat("windows") then
+        add_cxflags("/openmp")
+    else
+        add_cxflags("-fopenmp")
+        add_syslinks("gomp", {public = true})
+    end
+
     add_files("../src/ops/*/cpu/*.cpp")
 
     on_install(function (target) end)